@@ -147,12 +147,20 @@ EdgeList* makePath(Edge* distTree, int vertex, int startVertex) {
  ** Required functions
  *************************************************************************/
 Edge* getMSTprim(Graph* graph, int startVertex) {
+  if (startVertex < 0 || startVertex >= graph->numVertices ||
+      graph->vertices[startVertex] == NULL) {
+    return NULL;
+  }
+
   Records* records = initRecords(graph, startVertex);
 
   while (!isEmpty(records->heap)) {
     HeapNode minNode = extractMin(records->heap);
     int minVertex = minNode.id;
 
+    // the rest of the heap is in other components
+    if (minNode.priority == INT_MAX) break;
+
     records->finished[minVertex] = true;
 
     if (records->predecessors[minVertex] != NOTHING) {
@@ -228,6 +236,9 @@ Edge* getDistanceTreeDijkstra(Graph* graph, int startVertex) {
     int vertexMin = nodeMin.id;
     int currDis = nodeMin.priority;
 
+    // the rest of the heap is unreachable from the start vertex
+    if (currDis == INT_MAX) break;
+
     records->finished[vertexMin] = true;
 
     if (records->predecessors[vertexMin] != NOTHING) {
@@ -262,7 +273,11 @@ Edge* getDistanceTreeDijkstra(Graph* graph, int startVertex) {
     Edge* edge = adjList->edge;
     int toVertex = edge->toVertex;
     int weight = edge->weight;
-    
+    if (weight > INT_MAX - 1 - currDis) {  // too far to ever be reached
+      adjList = adjList->next;
+      continue;
+    }
+
     int newDist = currDis + weight;
 
     if(!records->finished[toVertex] &&
@@ -0,0 +1,703 @@
+/*
+ * ALT (A*, landmarks, triangle inequality) goal-directed shortest path
+ * search.
+ *
+ * Landmark distances are stored vertex-major, so the k bounds for a vertex
+ * are read from one contiguous block when its heuristic is evaluated.
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#include "graph_alt.h"
+#include "minheap.h"
+
+#define NOTHING -1
+#define ALT_MAGIC "GALT"
+#define ALT_VERSION 1
+
+/*************************************************************************
+ ** Adjacency arrays
+ *************************************************************************/
+
+/* Returns newly created adjacency arrays with the edges of Graph 'graph',
+ * reversed iff 'reversed' is true.
+ */
+static AltAdjacency* newAltAdjacency(Graph* graph, bool reversed) {
+  AltAdjacency* adj = (AltAdjacency*)malloc(sizeof(AltAdjacency));
+  if (adj == NULL) {
+    printf("Error: Memory allocation failed for adjacency arrays\n");
+    exit(1);
+  }
+
+  int numVertices = graph->numVertices;
+  adj->numVertices = numVertices;
+  adj->offsets = (int*)calloc(numVertices + 1, sizeof(int));
+  adj->heads = (int*)malloc(sizeof(int) * (graph->numEdges + 1));
+  adj->weights = (int*)malloc(sizeof(int) * (graph->numEdges + 1));
+  if (adj->offsets == NULL || adj->heads == NULL || adj->weights == NULL) {
+    printf("Error: Memory allocation failed for adjacency arrays\n");
+    exit(1);
+  }
+
+  // count edges per vertex, then turn counts into end offsets
+  for (int i = 0; i < numVertices; i++) {
+    if (graph->vertices[i] == NULL) continue;
+    for (EdgeList* e = graph->vertices[i]->adjList; e != NULL; e = e->next) {
+      int owner = reversed ? e->edge->toVertex : e->edge->fromVertex;
+      adj->offsets[owner + 1]++;
+    }
+  }
+  for (int i = 0; i < numVertices; i++) {
+    adj->offsets[i + 1] += adj->offsets[i];
+  }
+
+  int* next = (int*)malloc(sizeof(int) * (numVertices + 1));
+  if (next == NULL) {
+    printf("Error: Memory allocation failed for adjacency cursors\n");
+    exit(1);
+  }
+  memcpy(next, adj->offsets, sizeof(int) * (numVertices + 1));
+
+  for (int i = 0; i < numVertices; i++) {
+    if (graph->vertices[i] == NULL) continue;
+    for (EdgeList* e = graph->vertices[i]->adjList; e != NULL; e = e->next) {
+      int owner = reversed ? e->edge->toVertex : e->edge->fromVertex;
+      int head = reversed ? e->edge->fromVertex : e->edge->toVertex;
+      adj->heads[next[owner]] = head;
+      adj->weights[next[owner]] = e->edge->weight;
+      next[owner]++;
+    }
+  }
+  free(next);
+
+  return adj;
+}
+
+/* Frees all memory allocated for adjacency arrays 'adj'. */
+static void deleteAltAdjacency(AltAdjacency* adj) {
+  if (adj == NULL) return;
+
+  free(adj->offsets);
+  free(adj->heads);
+  free(adj->weights);
+  free(adj);
+}
+
+/* Runs Dijkstra's algorithm over 'adj' from the 'numSources' vertices in
+ * 'sources' and fills in 'distances' (INT_MAX if unreached). If 'parents'
+ * is not NULL, fills in each vertex's predecessor. If 'order' is not NULL,
+ * fills it with the finished vertices in the order they were finished and
+ * returns their number.
+ */
+static int runAdjacencyDijkstra(AltAdjacency* adj, int* sources,
+                                int numSources, int* distances, int* parents,
+                                int* order) {
+  int numVertices = adj->numVertices;
+  MinHeap* heap = newHeap(numVertices);
+  bool* finished = (bool*)malloc(sizeof(bool) * numVertices);
+  if (finished == NULL) {
+    printf("Error: Memory allocation failed for finished array\n");
+    exit(1);
+  }
+
+  for (int i = 0; i < numVertices; i++) {
+    distances[i] = INT_MAX;
+    finished[i] = false;
+    if (parents != NULL) parents[i] = NOTHING;
+  }
+  for (int i = 0; i < numSources; i++) {
+    if (distances[sources[i]] == 0) continue;
+    distances[sources[i]] = 0;
+    insert(heap, 0, sources[i]);
+  }
+
+  int numFinished = 0;
+  while (heap->size > 0) {
+    HeapNode minNode = extractMin(heap);
+    int v = minNode.id;
+    int currDis = minNode.priority;
+
+    finished[v] = true;
+    if (order != NULL) order[numFinished] = v;
+    numFinished++;
+
+    for (int i = adj->offsets[v]; i < adj->offsets[v + 1]; i++) {
+      int to = adj->heads[i];
+      int weight = adj->weights[i];
+      if (finished[to] || weight > INT_MAX - 1 - currDis ||
+          currDis + weight >= distances[to]) {
+        continue;
+      }
+      if (distances[to] == INT_MAX) {
+        insert(heap, currDis + weight, to);
+      } else {
+        decreasePriority(heap, to, currDis + weight);
+      }
+      distances[to] = currDis + weight;
+      if (parents != NULL) parents[to] = v;
+    }
+  }
+
+  free(finished);
+  deleteHeap(heap);
+  return numFinished;
+}
+
+/*************************************************************************
+ ** Landmark selection
+ *************************************************************************/
+
+/* Returns the vertex farthest from all 'numLandmarks' landmarks in
+ * 'landmarks' over 'adj', preferring vertices no landmark reaches.
+ * 'distances' is scratch space for numVertices ints.
+ */
+static int farthestVertex(AltAdjacency* adj, int* landmarks, int numLandmarks,
+                          int* distances) {
+  runAdjacencyDijkstra(adj, landmarks, numLandmarks, distances, NULL, NULL);
+
+  int farthest = 0;
+  for (int i = 1; i < adj->numVertices; i++) {
+    if (distances[i] > distances[farthest]) farthest = i;
+  }
+  return farthest;
+}
+
+/* Stores the distance tables of landmark number 'index' of 'table'.
+ * 'distances' is scratch space for numVertices ints.
+ */
+static void fillLandmarkTables(LandmarkTable* table, int index,
+                               int* distances) {
+  int k = table->numLandmarks;
+  int landmark = table->landmarks[index];
+
+  runAdjacencyDijkstra(table->forward, &landmark, 1, distances, NULL, NULL);
+  for (int v = 0; v < table->numVertices; v++) {
+    table->fromLandmark[(size_t)v * k + index] = distances[v];
+  }
+
+  runAdjacencyDijkstra(table->reverse, &landmark, 1, distances, NULL, NULL);
+  for (int v = 0; v < table->numVertices; v++) {
+    table->toLandmark[(size_t)v * k + index] = distances[v];
+  }
+}
+
+/* Returns the lower bound on d('u', 'v') given by the first 'count'
+ * landmarks of 'table'.
+ */
+static int lowerBound(LandmarkTable* table, int count, int u, int v) {
+  int k = table->numLandmarks;
+  int* fromU = &table->fromLandmark[(size_t)u * k];
+  int* fromV = &table->fromLandmark[(size_t)v * k];
+  int* toU = &table->toLandmark[(size_t)u * k];
+  int* toV = &table->toLandmark[(size_t)v * k];
+
+  int bound = 0;
+  for (int i = 0; i < count; i++) {
+    if (fromU[i] != INT_MAX && fromV[i] != INT_MAX &&
+        fromV[i] - fromU[i] > bound) {
+      bound = fromV[i] - fromU[i];
+    }
+    if (toU[i] != INT_MAX && toV[i] != INT_MAX && toU[i] - toV[i] > bound) {
+      bound = toU[i] - toV[i];
+    }
+  }
+  return bound;
+}
+
+/* Returns the next landmark chosen by avoid selection, given that the first
+ * 'count' landmarks of 'table' are already chosen and their tables filled.
+ * A shortest path tree is grown from a root; every vertex is weighted by how
+ * badly the current landmarks bound its distance from the root, and the
+ * search descends into the heaviest subtree that contains no landmark.
+ */
+static int avoidVertex(LandmarkTable* table, int count, int* distances) {
+  int numVertices = table->numVertices;
+  int root = (int)((count * 2654435761u) % (unsigned)numVertices);
+
+  int* parents = (int*)malloc(sizeof(int) * numVertices);
+  int* order = (int*)malloc(sizeof(int) * numVertices);
+  long long* sizes = (long long*)malloc(sizeof(long long) * numVertices);
+  int* bestChild = (int*)malloc(sizeof(int) * numVertices);
+  bool* covered = (bool*)malloc(sizeof(bool) * numVertices);
+  if (parents == NULL || order == NULL || sizes == NULL ||
+      bestChild == NULL || covered == NULL) {
+    printf("Error: Memory allocation failed for avoid selection\n");
+    exit(1);
+  }
+
+  int numOrder = runAdjacencyDijkstra(table->forward, &root, 1, distances,
+                                      parents, order);
+  for (int i = 0; i < numOrder; i++) {
+    int v = order[i];
+    sizes[v] = distances[v] - lowerBound(table, count, root, v);
+    bestChild[v] = NOTHING;
+    covered[v] = false;
+  }
+  for (int i = 0; i < count; i++) {
+    if (distances[table->landmarks[i]] != INT_MAX) {
+      covered[table->landmarks[i]] = true;
+    }
+  }
+
+  // children finish after their parents, so walk the order backwards
+  for (int i = numOrder - 1; i > 0; i--) {
+    int v = order[i];
+    int parent = parents[v];
+    if (covered[v]) {
+      sizes[v] = 0;
+      covered[parent] = true;
+      continue;
+    }
+    sizes[parent] += sizes[v];
+    if (bestChild[parent] == NOTHING || sizes[v] > sizes[bestChild[parent]]) {
+      bestChild[parent] = v;
+    }
+  }
+
+  int leaf = root;
+  while (bestChild[leaf] != NOTHING && sizes[bestChild[leaf]] > 0) {
+    leaf = bestChild[leaf];
+  }
+  if (covered[leaf] || (leaf == root && sizes[root] == 0)) {
+    leaf = farthestVertex(table->forward, table->landmarks, count, distances);
+  }
+
+  free(parents);
+  free(order);
+  free(sizes);
+  free(bestChild);
+  free(covered);
+
+  return leaf;
+}
+
+/*************************************************************************
+ ** Landmark tables
+ *************************************************************************/
+
+/* Returns a newly created table for 'numLandmarks' landmarks on Graph
+ * 'graph', with adjacency arrays built and landmark arrays allocated.
+ */
+static LandmarkTable* allocLandmarkTable(Graph* graph, int numLandmarks) {
+  LandmarkTable* table = (LandmarkTable*)malloc(sizeof(LandmarkTable));
+  if (table == NULL) {
+    printf("Error: Memory allocation failed for landmark table\n");
+    exit(1);
+  }
+
+  int numVertices = graph->numVertices;
+  size_t numEntries = (size_t)numVertices * numLandmarks;
+  table->numVertices = numVertices;
+  table->numEdges = graph->numEdges;
+  table->numLandmarks = numLandmarks;
+  table->landmarks = (int*)malloc(sizeof(int) * numLandmarks);
+  table->fromLandmark = (int*)malloc(sizeof(int) * numEntries);
+  table->toLandmark = (int*)malloc(sizeof(int) * numEntries);
+  if (table->landmarks == NULL || table->fromLandmark == NULL ||
+      table->toLandmark == NULL) {
+    printf("Error: Memory allocation failed for landmark distances\n");
+    exit(1);
+  }
+  table->forward = newAltAdjacency(graph, false);
+  table->reverse = newAltAdjacency(graph, true);
+
+  return table;
+}
+
+LandmarkTable* newLandmarkTable(Graph* graph, int numLandmarks,
+                                LandmarkSelection method) {
+  if (graph == NULL || numLandmarks < 1 ||
+      numLandmarks > graph->numVertices) {
+    return NULL;
+  }
+
+  LandmarkTable* table = allocLandmarkTable(graph, numLandmarks);
+  int* distances = (int*)malloc(sizeof(int) * graph->numVertices);
+  if (distances == NULL) {
+    printf("Error: Memory allocation failed for distances array\n");
+    exit(1);
+  }
+
+  int start = 0;
+  table->landmarks[0] = farthestVertex(table->forward, &start, 1, distances);
+  fillLandmarkTables(table, 0, distances);
+
+  for (int i = 1; i < numLandmarks; i++) {
+    if (method == LANDMARKS_AVOID) {
+      table->landmarks[i] = avoidVertex(table, i, distances);
+    } else {
+      table->landmarks[i] =
+          farthestVertex(table->forward, table->landmarks, i, distances);
+    }
+    fillLandmarkTables(table, i, distances);
+  }
+
+  free(distances);
+  return table;
+}
+
+int getLandmarkLowerBound(LandmarkTable* table, int fromVertex, int toVertex) {
+  return lowerBound(table, table->numLandmarks, fromVertex, toVertex);
+}
+
+/*************************************************************************
+ ** Queries
+ *************************************************************************/
+
+typedef struct alt_search {  // state of one direction of an ALT query
+  AltAdjacency* adj;  // edges this direction relaxes
+  MinHeap* heap;      // priority queue keyed by distance plus potential
+  int* distances;     // distances[id] is the tentative distance of id
+  int* predecessors;  // predecessors[id] is the previous vertex towards the
+                      //   start of this direction
+  int* predWeights;   // predWeights[id] is the weight of that edge
+  bool* finished;     // finished[id] is true iff vertex id is finished
+} AltSearch;
+
+/* Returns a newly created search over 'adj' with no vertex reached. */
+static AltSearch* newAltSearch(AltAdjacency* adj) {
+  AltSearch* search = (AltSearch*)malloc(sizeof(AltSearch));
+  if (search == NULL) {
+    printf("Error: Memory allocation failed for ALT search\n");
+    exit(1);
+  }
+
+  int numVertices = adj->numVertices;
+  search->adj = adj;
+  search->heap = newHeap(numVertices);
+  search->distances = (int*)malloc(sizeof(int) * numVertices);
+  search->predecessors = (int*)malloc(sizeof(int) * numVertices);
+  search->predWeights = (int*)malloc(sizeof(int) * numVertices);
+  search->finished = (bool*)malloc(sizeof(bool) * numVertices);
+  if (search->distances == NULL || search->predecessors == NULL ||
+      search->predWeights == NULL || search->finished == NULL) {
+    printf("Error: Memory allocation failed for ALT search arrays\n");
+    exit(1);
+  }
+
+  for (int i = 0; i < numVertices; i++) {
+    search->distances[i] = INT_MAX;
+    search->predecessors[i] = NOTHING;
+    search->finished[i] = false;
+  }
+
+  return search;
+}
+
+/* Frees all memory allocated for 'search'. */
+static void deleteAltSearch(AltSearch* search) {
+  deleteHeap(search->heap);
+  free(search->distances);
+  free(search->predecessors);
+  free(search->predWeights);
+  free(search->finished);
+  free(search);
+}
+
+/* Returns 'distance' + 'potential', saturated to stay below INT_MAX. */
+static int altKey(int distance, int potential) {
+  long long key = (long long)distance + potential;
+  if (key >= INT_MAX) return INT_MAX - 1;
+  if (key <= INT_MIN) return INT_MIN + 1;
+  return (int)key;
+}
+
+/* Sets the tentative distance of 'id' in 'search' to 'distance', reached
+ * over an edge of weight 'weight' from 'pred', with heap key 'key'.
+ */
+static void reachAltVertex(AltSearch* search, int id, int distance, int key,
+                           int pred, int weight) {
+  if (search->distances[id] == INT_MAX) {
+    insert(search->heap, key, id);
+  } else {
+    decreasePriority(search->heap, id, key);
+  }
+  search->distances[id] = distance;
+  search->predecessors[id] = pred;
+  search->predWeights[id] = weight;
+}
+
+/* Returns a newly created result for a query from 'source' to 'target'. */
+static AltResult* newAltResult(int source, int target) {
+  AltResult* result = (AltResult*)malloc(sizeof(AltResult));
+  if (result == NULL) {
+    printf("Error: Memory allocation failed for ALT result\n");
+    exit(1);
+  }
+
+  result->source = source;
+  result->target = target;
+  result->distance = INT_MAX;
+  result->path = NULL;
+  result->numSettled = 0;
+
+  return result;
+}
+
+/* Appends 'node' to the list with head '*head' and tail '*tail'. */
+static void appendAltEdge(EdgeList** head, EdgeList** tail, EdgeList* node) {
+  if (*tail == NULL) {
+    *head = node;
+  } else {
+    (*tail)->next = node;
+  }
+  *tail = node;
+}
+
+/* Returns the path through edge ('meetFrom' -- 'meetTo', 'weight'): from
+ * the start of 'backward' back to 'meetTo', that edge, then from 'meetFrom'
+ * back to the start of 'forward', in the format produced by
+ * getShortestPaths. If 'backward' is NULL, returns only the path from
+ * 'meetFrom' back to the start of 'forward'.
+ */
+static EdgeList* makeAltPath(AltSearch* forward, AltSearch* backward,
+                             int meetFrom, int meetTo, int weight) {
+  EdgeList* head = NULL;
+  EdgeList* tail = NULL;
+
+  if (backward != NULL) {
+    // the backward search stores successors on the path; prepend them so
+    // the edge nearest the target ends up first
+    for (int v = meetTo; backward->predecessors[v] != NOTHING;
+         v = backward->predecessors[v]) {
+      int next = backward->predecessors[v];
+      head = newEdgeList(newEdge(v, next, backward->predWeights[v]), head);
+      if (tail == NULL) tail = head;
+    }
+    appendAltEdge(&head, &tail,
+                  newEdgeList(newEdge(meetFrom, meetTo, weight), NULL));
+  }
+
+  for (int v = meetFrom; forward->predecessors[v] != NOTHING;
+       v = forward->predecessors[v]) {
+    int pred = forward->predecessors[v];
+    appendAltEdge(&head, &tail, newEdgeList(
+                                    newEdge(pred, v, forward->predWeights[v]),
+                                    NULL));
+  }
+
+  return head;
+}
+
+/* Runs unidirectional A* from 'source' to 'target' into 'result'. */
+static void runUnidirectionalALT(LandmarkTable* table, int source, int target,
+                                 AltResult* result) {
+  AltSearch* search = newAltSearch(table->forward);
+  int* heuristic = (int*)malloc(sizeof(int) * table->numVertices);
+  if (heuristic == NULL) {
+    printf("Error: Memory allocation failed for heuristic array\n");
+    exit(1);
+  }
+  for (int i = 0; i < table->numVertices; i++) heuristic[i] = NOTHING;
+
+  heuristic[source] = getLandmarkLowerBound(table, source, target);
+  reachAltVertex(search, source, 0, heuristic[source], NOTHING, 0);
+
+  while (search->heap->size > 0) {
+    int v = extractMin(search->heap).id;
+    int currDis = search->distances[v];
+
+    search->finished[v] = true;
+    result->numSettled++;
+    if (v == target) break;
+
+    AltAdjacency* adj = search->adj;
+    for (int i = adj->offsets[v]; i < adj->offsets[v + 1]; i++) {
+      int to = adj->heads[i];
+      int weight = adj->weights[i];
+      if (search->finished[to] || weight > INT_MAX - 1 - currDis ||
+          currDis + weight >= search->distances[to]) {
+        continue;
+      }
+      if (heuristic[to] == NOTHING) {
+        heuristic[to] = getLandmarkLowerBound(table, to, target);
+      }
+      reachAltVertex(search, to, currDis + weight,
+                     altKey(currDis + weight, heuristic[to]), v, weight);
+    }
+  }
+
+  if (search->finished[target]) {
+    result->distance = search->distances[target];
+    result->path = makeAltPath(search, NULL, target, NOTHING, 0);
+  }
+
+  free(heuristic);
+  deleteAltSearch(search);
+}
+
+/* Runs bidirectional A* from 'source' to 'target' into 'result'. Both
+ * directions use the average potential p(v) = (lb(v, t) - lb(s, v)) / 2;
+ * keys are doubled to keep them integral.
+ */
+static void runBidirectionalALT(LandmarkTable* table, int source, int target,
+                                AltResult* result) {
+  AltSearch* searches[2] = {newAltSearch(table->forward),
+                            newAltSearch(table->reverse)};
+  int* potentials = (int*)malloc(sizeof(int) * table->numVertices);
+  bool* hasPotential = (bool*)calloc(table->numVertices, sizeof(bool));
+  if (potentials == NULL || hasPotential == NULL) {
+    printf("Error: Memory allocation failed for potential arrays\n");
+    exit(1);
+  }
+
+  int ends[2] = {source, target};
+  for (int side = 0; side < 2; side++) {
+    int v = ends[side];
+    potentials[v] = getLandmarkLowerBound(table, v, target) -
+                    getLandmarkLowerBound(table, source, v);
+    hasPotential[v] = true;
+    int sign = side == 0 ? 1 : -1;
+    reachAltVertex(searches[side], v, 0, sign * potentials[v], NOTHING, 0);
+  }
+
+  int best = INT_MAX;
+  int meetFrom = NOTHING;
+  int meetTo = NOTHING;
+  int meetWeight = 0;
+  while (searches[0]->heap->size > 0 && searches[1]->heap->size > 0) {
+    int topForward = getMin(searches[0]->heap).priority;
+    int topBackward = getMin(searches[1]->heap).priority;
+    if (best != INT_MAX &&
+        (long long)topForward + topBackward >= 2LL * best) {
+      break;
+    }
+
+    int side = topForward <= topBackward ? 0 : 1;
+    int sign = side == 0 ? 1 : -1;
+    AltSearch* search = searches[side];
+    AltSearch* other = searches[1 - side];
+
+    int v = extractMin(search->heap).id;
+    int currDis = search->distances[v];
+    search->finished[v] = true;
+    result->numSettled++;
+
+    AltAdjacency* adj = search->adj;
+    for (int i = adj->offsets[v]; i < adj->offsets[v + 1]; i++) {
+      int to = adj->heads[i];
+      int weight = adj->weights[i];
+      if (weight > INT_MAX - 1 - currDis) continue;
+      int newDist = currDis + weight;
+
+      // every edge between the two searches closes an s-t path
+      if (other->distances[to] != INT_MAX &&
+          (long long)newDist + other->distances[to] < best) {
+        best = newDist + other->distances[to];
+        meetFrom = side == 0 ? v : to;
+        meetTo = side == 0 ? to : v;
+        meetWeight = weight;
+      }
+
+      if (search->finished[to] || newDist >= search->distances[to]) continue;
+      if (!hasPotential[to]) {
+        potentials[to] = getLandmarkLowerBound(table, to, target) -
+                         getLandmarkLowerBound(table, source, to);
+        hasPotential[to] = true;
+      }
+      reachAltVertex(search, to, newDist,
+                     altKey(2 * newDist, sign * potentials[to]), v, weight);
+    }
+  }
+
+  if (best != INT_MAX) {
+    result->distance = best;
+    result->path = makeAltPath(searches[0], searches[1], meetFrom, meetTo,
+                               meetWeight);
+  }
+
+  free(potentials);
+  free(hasPotential);
+  deleteAltSearch(searches[0]);
+  deleteAltSearch(searches[1]);
+}
+
+AltResult* getShortestPathALT(LandmarkTable* table, int source, int target,
+                              bool bidirectional) {
+  if (table == NULL || source < 0 || source >= table->numVertices ||
+      target < 0 || target >= table->numVertices) {
+    return NULL;
+  }
+
+  AltResult* result = newAltResult(source, target);
+  if (source == target) {
+    result->distance = 0;
+    return result;
+  }
+
+  if (bidirectional) {
+    runBidirectionalALT(table, source, target, result);
+  } else {
+    runUnidirectionalALT(table, source, target, result);
+  }
+  return result;
+}
+
+/*************************************************************************
+ ** Serialization
+ *************************************************************************/
+
+bool saveLandmarkTable(LandmarkTable* table, FILE* f) {
+  if (table == NULL || f == NULL) return false;
+
+  int header[4] = {ALT_VERSION, table->numVertices, table->numEdges,
+                   table->numLandmarks};
+  size_t numEntries = (size_t)table->numVertices * table->numLandmarks;
+
+  return fwrite(ALT_MAGIC, 1, 4, f) == 4 &&
+         fwrite(header, sizeof(int), 4, f) == 4 &&
+         fwrite(table->landmarks, sizeof(int), table->numLandmarks, f) ==
+             (size_t)table->numLandmarks &&
+         fwrite(table->fromLandmark, sizeof(int), numEntries, f) ==
+             numEntries &&
+         fwrite(table->toLandmark, sizeof(int), numEntries, f) == numEntries;
+}
+
+LandmarkTable* loadLandmarkTable(Graph* graph, FILE* f) {
+  if (graph == NULL || f == NULL) return NULL;
+
+  char magic[4];
+  int header[4];
+  if (fread(magic, 1, 4, f) != 4 || memcmp(magic, ALT_MAGIC, 4) != 0 ||
+      fread(header, sizeof(int), 4, f) != 4 || header[0] != ALT_VERSION) {
+    printf("Not a landmark table file. Giving up.\n");
+    return NULL;
+  }
+  if (header[1] != graph->numVertices || header[2] != graph->numEdges ||
+      header[3] < 1 || header[3] > graph->numVertices) {
+    printf("Landmark table does not match the graph. Giving up.\n");
+    return NULL;
+  }
+
+  LandmarkTable* table = allocLandmarkTable(graph, header[3]);
+  size_t numEntries = (size_t)table->numVertices * table->numLandmarks;
+  if (fread(table->landmarks, sizeof(int), table->numLandmarks, f) !=
+          (size_t)table->numLandmarks ||
+      fread(table->fromLandmark, sizeof(int), numEntries, f) != numEntries ||
+      fread(table->toLandmark, sizeof(int), numEntries, f) != numEntries) {
+    printf("Landmark table file is truncated. Giving up.\n");
+    deleteLandmarkTable(table);
+    return NULL;
+  }
+
+  return table;
+}
+
+void deleteLandmarkTable(LandmarkTable* table) {
+  if (table == NULL) return;
+
+  free(table->landmarks);
+  free(table->fromLandmark);
+  free(table->toLandmark);
+  deleteAltAdjacency(table->forward);
+  deleteAltAdjacency(table->reverse);
+  free(table);
+}
+
+void deleteAltResult(AltResult* result) {
+  if (result == NULL) return;
+
+  deleteEdgeList(result->path);
+  free(result);
+}
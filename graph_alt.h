@@ -0,0 +1,91 @@
+/*
+ * Header file for ALT (A*, landmarks, triangle inequality) goal-directed
+ * shortest path search.
+ *
+ * A LandmarkTable holds, for a small set of landmarks L, the distances
+ * d(L, v) and d(v, L) for every vertex v. By the triangle inequality these
+ * give lower bounds on d(u, v), which guide A* towards the target.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Alt_header
+#define __Graph_Alt_header
+
+typedef enum landmark_selection {
+  LANDMARKS_FARTHEST,  // each landmark is the vertex farthest from the
+                       //   landmarks selected so far
+  LANDMARKS_AVOID      // each landmark is a leaf of a shortest path tree in a
+                       //   region the landmarks selected so far bound poorly
+} LandmarkSelection;
+
+typedef struct alt_adjacency {  // compact adjacency arrays of one direction
+  int numVertices;  // total number of vertices
+  int* offsets;     // edges of vertex id are at [offsets[id], offsets[id+1])
+  int* heads;       // heads[i] is the other endpoint of edge i
+  int* weights;     // weights[i] is the weight of edge i
+} AltAdjacency;
+
+typedef struct landmark_table {
+  int numVertices;        // total number of vertices in the graph
+  int numEdges;           // total number of edges in the graph
+  int numLandmarks;       // number of landmarks k
+  int* landmarks;         // IDs of the k landmarks
+  int* fromLandmark;      // fromLandmark[id * k + i] is d(landmarks[i], id),
+                          //   or INT_MAX if id is not reachable
+  int* toLandmark;        // toLandmark[id * k + i] is d(id, landmarks[i]),
+                          //   or INT_MAX if landmarks[i] is not reachable
+  AltAdjacency* forward;  // edges of the graph
+  AltAdjacency* reverse;  // edges of the graph, reversed
+} LandmarkTable;
+
+typedef struct alt_result {
+  int source;      // ID of the source vertex of this query
+  int target;      // ID of the target vertex of this query
+  int distance;    // distance from source to target, INT_MAX if unreachable
+  EdgeList* path;  // path from target to source in the format produced by
+                   //   getShortestPaths; NULL if unreachable or equal
+  int numSettled;  // number of vertices settled by the search
+} AltResult;
+
+/* Selects 'numLandmarks' landmarks in Graph 'graph' using 'method', computes
+ * their distance tables, and returns the resulting LandmarkTable.
+ * Returns NULL if 'numLandmarks' is not in [1, graph->numVertices].
+ * Precondition: every vertex of 'graph' is not NULL.
+ */
+LandmarkTable* newLandmarkTable(Graph* graph, int numLandmarks,
+                                LandmarkSelection method);
+
+/* Returns a lower bound on the distance from vertex with ID 'fromVertex' to
+ * vertex with ID 'toVertex', derived from the landmarks in 'table'.
+ */
+int getLandmarkLowerBound(LandmarkTable* table, int fromVertex, int toVertex);
+
+/* Runs A* on the graph of 'table' from vertex with ID 'source' to vertex
+ * with ID 'target', using landmark lower bounds as the heuristic. If
+ * 'bidirectional' is true, searches from both ends at once with averaged
+ * landmark potentials. Returns NULL if 'source' or 'target' is not valid.
+ */
+AltResult* getShortestPathALT(LandmarkTable* table, int source, int target,
+                              bool bidirectional);
+
+/* Writes 'table' to the binary stream 'f'. Returns true iff successful. */
+bool saveLandmarkTable(LandmarkTable* table, FILE* f);
+
+/* Reads a LandmarkTable for Graph 'graph' previously written by
+ * saveLandmarkTable from the binary stream 'f'. Returns NULL if 'f' does not
+ * contain a landmark table for a graph of the same size as 'graph'.
+ */
+LandmarkTable* loadLandmarkTable(Graph* graph, FILE* f);
+
+/* Frees all memory allocated for 'table'. */
+void deleteLandmarkTable(LandmarkTable* table);
+
+/* Frees all memory allocated for 'result', including its path. */
+void deleteAltResult(AltResult* result);
+
+#endif
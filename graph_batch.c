@@ -0,0 +1,368 @@
+/*
+ * Batched shortest path queries.
+ *
+ * Every query settles a vertex in four steps, and the group advances one
+ * step of each query in turn:
+ *   - STAGE_POP pops the closest entry from the query's heap and
+ *     prefetches the distance, predecessor and offsets of its vertex;
+ *   - STAGE_LOAD skips the entry if it is stale, or else settles the vertex,
+ *     reads its edge range and prefetches the first chunk of heads and
+ *     weights;
+ *   - STAGE_SCAN prefetches the distances of the heads in the chunk, and
+ *     the heads and weights of the next chunk;
+ *   - STAGE_RELAX relaxes the edges of the chunk, and goes back to
+ *     STAGE_SCAN for the next chunk or to STAGE_POP.
+ * Each query keeps its (distance, vertex) entries in a radix heap, which
+ * works because Dijkstra's algorithm never pushes a distance below the last
+ * one popped: bucket 0 holds the entries equal to the last minimum, and
+ * bucket i > 0 those whose highest bit that differs from it is bit i - 1.
+ * Entries are only appended to buckets and scanned in order, so, unlike
+ * the sift paths of a binary heap, the heap adds no cache misses of its
+ * own. There is no index map: an entry whose distance is above the
+ * vertex's current distance is stale and skipped. With weights that are
+ * not negative, a settled vertex is never improved, so no finished flags
+ * are needed, and the weight of a tree edge is the difference of the
+ * distances at its ends, filled in when the query finishes.
+ */
+
+#include <limits.h>
+
+#include "graph_batch.h"
+#include "graph_memory.h"
+#include "minheap.h"
+
+#define NOTHING -1
+#define CHUNK_EDGES 32          // edges relaxed per step
+#define INTS_PER_LINE 16        // ints in a 64 byte cache line
+#define NUM_BUCKETS 33          // radix heap buckets for 32 bit distances
+#define INITIAL_BUCKET_SIZE 16  // entries in a new radix heap bucket
+
+#if defined(__GNUC__)
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address)
+#endif
+
+typedef enum query_stage {
+  STAGE_POP,    // settle the next vertex
+  STAGE_LOAD,   // read the edge range of the settled vertex
+  STAGE_SCAN,   // prefetch the distances of the next chunk of heads
+  STAGE_RELAX,  // relax the chunk
+  STAGE_DONE    // no query left for this slot
+} QueryStage;
+
+typedef struct radix_bucket {  // one bucket of a radix heap
+  HeapNode* entries;  // (distance, vertex) entries in no order
+  int size;           // number of entries
+  int capacity;       // number of entries 'entries' has room for
+} RadixBucket;
+
+typedef struct batch_query {  // one slot of the group
+  QueryStage stage;      // what the next step does
+  int index;             // index of the source in the batch
+  int* distances;        // distances[id] is the best known distance to id
+  int* preds;            // preds[id] is the vertex before id, or -1
+  LargeBlock workspace;  // holds 'distances' and 'preds'
+  RadixBucket* buckets;  // the NUM_BUCKETS buckets of the radix heap
+  unsigned lastMin;      // distance popped last from the heap
+  int heapSize;          // number of entries in all buckets
+  int vertex;            // vertex being settled
+  int distance;          // distance of the last entry popped
+  int next;              // next edge of 'vertex' to relax
+  int chunkEnd;          // end of the chunk of edges being relaxed
+  int last;              // end of the edges of 'vertex'
+  Edge* tree;            // tree of this query
+  int numTreeEdges;      // number of edges in 'tree'
+} BatchQuery;
+
+typedef struct batch_state {  // what all slots share
+  CompactGraph* graph;  // graph searched
+  const int* sources;   // sources of the batch
+  int numSources;       // number of sources
+  int nextSource;       // index of the next source to start
+  Edge** trees;         // trees[i] is the tree of sources[i]
+  int* numTreeEdges;    // number of edges of each tree, or NULL
+} BatchState;
+
+/*************************************************************************
+ ** Query heaps
+ *************************************************************************/
+
+/* Returns the bucket of distance 'key' in a radix heap whose last minimum
+ * is 'lastMin'.
+ */
+static inline int bucketOf(unsigned key, unsigned lastMin) {
+  if (key == lastMin) return 0;
+#if defined(__GNUC__)
+  return 32 - __builtin_clz(key ^ lastMin);
+#else
+  int bucket = 0;
+  for (unsigned bits = key ^ lastMin; bits != 0; bits >>= 1) bucket++;
+  return bucket;
+#endif
+}
+
+/* Appends 'entry' to 'bucket'. */
+static inline void appendEntry(RadixBucket* bucket, HeapNode entry) {
+  if (bucket->size == bucket->capacity) {
+    bucket->capacity =
+        bucket->capacity == 0 ? INITIAL_BUCKET_SIZE : 2 * bucket->capacity;
+    bucket->entries = (HeapNode*)realloc(bucket->entries,
+                                         sizeof(HeapNode) * bucket->capacity);
+    if (bucket->entries == NULL) {
+      printf("Error: Memory allocation failed for radix heap\n");
+      exit(1);
+    }
+  }
+  bucket->entries[bucket->size++] = entry;
+}
+
+/* Adds vertex 'id' with distance 'distance', which must not be below the
+ * last distance popped, to the heap of 'query'.
+ */
+static inline void pushEntry(BatchQuery* query, int id, int distance) {
+  HeapNode entry = {distance, id};
+  appendEntry(&query->buckets[bucketOf(distance, query->lastMin)], entry);
+  query->heapSize++;
+}
+
+/* Removes an entry of minimum distance from the non-empty heap of 'query'
+ * and returns it.
+ */
+static HeapNode popEntry(BatchQuery* query) {
+  RadixBucket* buckets = query->buckets;
+  if (buckets[0].size == 0) {
+    // spread the first non-empty bucket over the buckets below it
+    int first = 1;
+    while (buckets[first].size == 0) first++;
+    RadixBucket* bucket = &buckets[first];
+    unsigned lastMin = UINT_MAX;
+    for (int i = 0; i < bucket->size; i++) {
+      if ((unsigned)bucket->entries[i].priority < lastMin) {
+        lastMin = bucket->entries[i].priority;
+      }
+    }
+    for (int i = 0; i < bucket->size; i++) {
+      HeapNode entry = bucket->entries[i];
+      appendEntry(&buckets[bucketOf(entry.priority, lastMin)], entry);
+    }
+    bucket->size = 0;
+    query->lastMin = lastMin;
+  }
+
+  query->heapSize--;
+  return buckets[0].entries[--buckets[0].size];
+}
+
+/*************************************************************************
+ ** Queries
+ *************************************************************************/
+
+/* Prefetches the ints of 'array' in [first, end). */
+static inline void prefetchRange(const int* array, int first, int end) {
+  if (first >= end) return;
+  for (int i = first; i < end; i += INTS_PER_LINE) PREFETCH(&array[i]);
+  PREFETCH(&array[end - 1]);
+}
+
+/* Starts the next valid source of 'state' in slot 'query', giving the
+ * sources that are not valid a NULL tree. Returns false, and marks the
+ * slot done, if no source is left.
+ */
+static bool startQuery(BatchState* state, BatchQuery* query) {
+  CompactGraph* graph = state->graph;
+  while (state->nextSource < state->numSources) {
+    int index = state->nextSource++;
+    int source = state->sources[index];
+    if (source < 0 || source >= graph->numVertices) {
+      state->trees[index] = NULL;
+      if (state->numTreeEdges != NULL) state->numTreeEdges[index] = 0;
+      continue;
+    }
+
+    for (int v = 0; v < graph->numVertices; v++) {
+      query->distances[v] = INT_MAX;
+      query->preds[v] = NOTHING;
+    }
+    query->tree = (Edge*)malloc(sizeof(Edge) * graph->numVertices);
+    if (query->tree == NULL) {
+      printf("Error: Memory allocation failed for distance tree\n");
+      exit(1);
+    }
+    query->index = index;
+    query->numTreeEdges = 0;
+    for (int b = 0; b < NUM_BUCKETS; b++) query->buckets[b].size = 0;
+    query->lastMin = 0;
+    query->heapSize = 0;
+    query->distances[source] = 0;
+    pushEntry(query, source, 0);
+    query->stage = STAGE_POP;
+    return true;
+  }
+
+  query->stage = STAGE_DONE;
+  return false;
+}
+
+/* Hands the tree of the finished query in slot 'query' to 'state'. */
+static void finishQuery(BatchState* state, BatchQuery* query) {
+  for (int i = 0; i < query->numTreeEdges; i++) {
+    Edge* edge = &query->tree[i];
+    edge->weight =
+        query->distances[edge->toVertex] - query->distances[edge->fromVertex];
+  }
+  state->trees[query->index] = query->tree;
+  if (state->numTreeEdges != NULL) {
+    state->numTreeEdges[query->index] = query->numTreeEdges;
+  }
+  query->tree = NULL;
+}
+
+/* Runs the next step of the query in slot 'query' on 'graph'. Returns
+ * false if the query has finished.
+ */
+static bool stepQuery(CompactGraph* graph, BatchQuery* query) {
+  int* distances = query->distances;
+  switch (query->stage) {
+    case STAGE_POP: {
+      if (query->heapSize == 0) return false;
+      HeapNode entry = popEntry(query);
+      query->vertex = entry.id;
+      query->distance = entry.priority;
+      PREFETCH(&distances[entry.id]);
+      PREFETCH(&query->preds[entry.id]);
+      PREFETCH(&graph->offsets[entry.id]);
+      query->stage = STAGE_LOAD;
+      return true;
+    }
+
+    case STAGE_LOAD: {
+      int u = query->vertex;
+      if (query->distance > distances[u]) {
+        query->stage = STAGE_POP;  // a stale entry
+        return true;
+      }
+      if (query->preds[u] != NOTHING) {
+        Edge* edge = &query->tree[query->numTreeEdges++];
+        edge->fromVertex = query->preds[u];
+        edge->toVertex = u;
+      }
+
+      query->next = graph->offsets[u];
+      query->last = graph->offsets[u + 1];
+      int end = query->last < query->next + CHUNK_EDGES
+                    ? query->last
+                    : query->next + CHUNK_EDGES;
+      prefetchRange(graph->heads, query->next, end);
+      prefetchRange(graph->weights, query->next, end);
+      query->stage = query->next < query->last ? STAGE_SCAN : STAGE_POP;
+      return true;
+    }
+
+    case STAGE_SCAN: {
+      int* heads = graph->heads;
+      int end = query->last < query->next + CHUNK_EDGES
+                    ? query->last
+                    : query->next + CHUNK_EDGES;
+      for (int i = query->next; i < end; i++) PREFETCH(&distances[heads[i]]);
+      query->chunkEnd = end;
+
+      int after = query->last < end + CHUNK_EDGES ? query->last
+                                                  : end + CHUNK_EDGES;
+      prefetchRange(heads, end, after);
+      prefetchRange(graph->weights, end, after);
+      query->stage = STAGE_RELAX;
+      return true;
+    }
+
+    case STAGE_RELAX: {
+      int u = query->vertex;
+      int distance = query->distance;
+      int* heads = graph->heads;
+      int* weights = graph->weights;
+      for (int i = query->next; i < query->chunkEnd; i++) {
+        int v = heads[i];
+        int weight = weights[i];
+        if (weight > INT_MAX - 1 - distance) continue;
+
+        int candidate = distance + weight;
+        if (candidate < distances[v]) {
+          distances[v] = candidate;
+          query->preds[v] = u;
+          pushEntry(query, v, candidate);
+        }
+      }
+      query->next = query->chunkEnd;
+      query->stage = query->next < query->last ? STAGE_SCAN : STAGE_POP;
+      return true;
+    }
+
+    case STAGE_DONE:
+      break;
+  }
+  return false;
+}
+
+/*************************************************************************
+ ** Batches
+ *************************************************************************/
+
+Edge** getDistanceTreesBatch(CompactGraph* graph, const int* sources,
+                             int numSources, int groupSize,
+                             int* numTreeEdges) {
+  if (numSources < 1 || groupSize < 1) return NULL;
+  if (groupSize > numSources) groupSize = numSources;
+
+  int numVertices = graph->numVertices;
+  BatchState state = {graph, sources, numSources, 0, NULL, numTreeEdges};
+  state.trees = (Edge**)malloc(sizeof(Edge*) * numSources);
+  BatchQuery* queries = (BatchQuery*)malloc(sizeof(BatchQuery) * groupSize);
+  if (state.trees == NULL || queries == NULL) {
+    printf("Error: Memory allocation failed for query batch\n");
+    exit(1);
+  }
+
+  int active = 0;
+  for (int s = 0; s < groupSize; s++) {
+    BatchQuery* query = &queries[s];
+    // huge pages spare the TLB, and the first touch by this thread keeps
+    // the workspace on its node
+    bool mapped = allocateLarge(&query->workspace,
+                                2 * sizeof(int) * (numVertices + 1),
+                                PAGES_TRANSPARENT, ANY_NODE);
+    query->buckets = (RadixBucket*)calloc(NUM_BUCKETS, sizeof(RadixBucket));
+    if (!mapped || query->buckets == NULL) {
+      printf("Error: Memory allocation failed for query batch\n");
+      exit(1);
+    }
+    query->distances = (int*)query->workspace.data;
+    query->preds = query->distances + numVertices + 1;
+    if (startQuery(&state, query)) active++;
+  }
+
+  // round robin over the slots, refilling each one as its query finishes
+  while (active > 0) {
+    for (int s = 0; s < groupSize; s++) {
+      BatchQuery* query = &queries[s];
+      if (query->stage == STAGE_DONE || stepQuery(graph, query)) continue;
+
+      finishQuery(&state, query);
+      if (!startQuery(&state, query)) active--;
+    }
+  }
+
+  for (int s = 0; s < groupSize; s++) {
+    freeLarge(&queries[s].workspace);
+    for (int b = 0; b < NUM_BUCKETS; b++) free(queries[s].buckets[b].entries);
+    free(queries[s].buckets);
+  }
+  free(queries);
+  return state.trees;
+}
+
+void deleteDistanceTrees(Edge** trees, int numTrees) {
+  if (trees == NULL) return;
+
+  for (int i = 0; i < numTrees; i++) free(trees[i]);
+  free(trees);
+}
@@ -0,0 +1,47 @@
+/*
+ * Header file for batched shortest path queries.
+ *
+ * A single Dijkstra search spends most of its time waiting for memory: the
+ * offsets of the settled vertex, its edges, and the distance of every head
+ * are all likely cache misses, and each one depends on the one before. The
+ * batched search runs a group of independent queries on one thread as small
+ * state machines. Every step of a query issues prefetches for the data its
+ * next step needs and then yields to the next query in the group, so the
+ * misses of one query overlap with the work of the others. When a query
+ * finishes, the next source takes its place in the group.
+ *
+ * Every query in a group holds two ints per vertex, on transparent huge
+ * pages where the system allows, so a group of 8 queries on a graph with a
+ * million vertices uses 64 MB. Groups help most when single queries wait
+ * on one miss at a time; when the edge scans already keep the memory
+ * system busy, larger groups only add cache pressure.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+#include "graph_build.h"
+
+#ifndef __Graph_Batch_header
+#define __Graph_Batch_header
+
+#define DEFAULT_GROUP_SIZE 8  // queries in flight at a time
+
+/* Runs Dijkstra's algorithm on 'graph' from each of the 'numSources'
+ * vertices in 'sources', interleaving up to 'groupSize' queries at a time,
+ * and returns an array with one distance tree per source, in the format
+ * produced by getDistanceTreeDijkstra. Stores the number of edges of tree i
+ * in numTreeEdges[i] (if 'numTreeEdges' is not NULL). The tree of a source
+ * that is not valid in 'graph' is NULL. Edge weights must not be negative.
+ * Returns NULL if 'numSources' < 1 or 'groupSize' < 1.
+ */
+Edge** getDistanceTreesBatch(CompactGraph* graph, const int* sources,
+                             int numSources, int groupSize,
+                             int* numTreeEdges);
+
+/* Frees the 'numTrees' trees in 'trees' and the array itself. */
+void deleteDistanceTrees(Edge** trees, int numTrees);
+
+#endif
@@ -0,0 +1,208 @@
+/*
+ *  Benchmark of the batched shortest path queries of graph_batch.h.
+ *
+ *  Builds a random graph too large for the caches, runs Dijkstra's
+ *  algorithm from the same random sources back to back with
+ *  getDistanceTreeDijkstra and with getDistanceTreesBatch for several group
+ *  sizes, then once more on a copy of the graph placed on huge pages (see
+ *  graph_memory.h), checks that all runs agree, and prints the query
+ *  throughput.
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O3 -Wall -Werror -pthread graph.c minheap.c graph_algos.c \
+ *       graph_build.c graph_memory.c graph_batch.c graph_batch_bench.c \
+ *       -o graph_batch_bench
+ *
+ *   Run:
+ *   ./graph_batch_bench [numVertices] [numSources]
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "graph.h"
+#include "graph_algos.h"
+#include "graph_batch.h"
+#include "graph_build.h"
+#include "graph_memory.h"
+
+#define DEFAULT_VERTICES 1000000
+#define DEFAULT_SOURCES 32
+#define AVERAGE_DEGREE 8
+#define MAX_WEIGHT 1000
+
+/* graphs */
+CompactGraph* randomGraph(int numVertices, uint64_t* state);
+uint64_t nextRandom(uint64_t* state);
+
+/* measuring */
+double timeBatch(CompactGraph* graph, const int* sources, int numSources,
+                 int groupSize, long long expected);
+long long distanceSum(Edge* tree, int numTreeEdges, int numVertices);
+double nowSeconds(void);
+
+int main(int argc, char* argv[]) {
+  int numVertices = argc > 1 ? atoi(argv[1]) : DEFAULT_VERTICES;
+  int numSources = argc > 2 ? atoi(argv[2]) : DEFAULT_SOURCES;
+  if (numVertices < 2 || numSources < 1) {
+    printf("Usage: %s [numVertices >= 2] [numSources]\n", argv[0]);
+    return 1;
+  }
+
+  uint64_t state = 88172645463325252ULL;
+  CompactGraph* compact = randomGraph(numVertices, &state);
+  Graph* graph = newGraphFromCompact(compact);
+  int sources[numSources];
+  for (int s = 0; s < numSources; s++) {
+    sources[s] = (int)(nextRandom(&state) % numVertices);
+  }
+  printf("%d vertices, %d edges, %d sources\n\n", numVertices,
+         compact->numEdges, numSources);
+
+  // the sum over all sources of the distances to all vertices
+  long long expected = 0;
+  double start = nowSeconds();
+  for (int s = 0; s < numSources; s++) {
+    Edge* tree = getDistanceTreeDijkstra(graph, sources[s]);
+    expected += distanceSum(tree, numVertices - 1, numVertices);
+    free(tree);
+  }
+  double baseTime = nowSeconds() - start;
+  printf("%-22s %10.2f queries/s\n", "getDistanceTreeDijkstra",
+         numSources / baseTime);
+
+  int groupSizes[] = {1, 4, 8, 16, 32};
+  int numGroupSizes = sizeof(groupSizes) / sizeof(groupSizes[0]);
+  for (int g = 0; g < numGroupSizes; g++) {
+    double time =
+        timeBatch(compact, sources, numSources, groupSizes[g], expected);
+    if (time < 0) return 1;
+    printf("batch, group size %-4d %10.2f queries/s  %5.2fx\n",
+           groupSizes[g], numSources / time, baseTime / time);
+  }
+
+  PlacedGraph* placed =
+      newPlacedGraph(compact, PAGES_EXPLICIT, NUMA_INTERLEAVE);
+  if (placed == NULL) {
+    printf("Could not place the graph\n");
+    return 1;
+  }
+  double time = timeBatch(getLocalReplica(placed), sources, numSources,
+                          DEFAULT_GROUP_SIZE, expected);
+  if (time < 0) return 1;
+  printf("placed, group size %-3d %10.2f queries/s  %5.2fx\n",
+         DEFAULT_GROUP_SIZE, numSources / time, baseTime / time);
+  printf("  graph on %s, %s placement over %d node(s)\n",
+         getPageKindName(placed->pages), getPlacementName(placed->placement),
+         getNumaNodeCount());
+  deletePlacedGraph(placed);
+
+  deleteGraph(graph);
+  deleteCompactGraph(compact);
+  return 0;
+}
+
+/* Returns a random connected undirected graph on 'numVertices' vertices
+ * with average degree AVERAGE_DEGREE and weights in [1, MAX_WEIGHT]: a
+ * cycle through all vertices in random order, plus random edges.
+ */
+CompactGraph* randomGraph(int numVertices, uint64_t* state) {
+  int numEdges = numVertices / 2 * AVERAGE_DEGREE;
+  int* from = (int*)malloc(sizeof(int) * numEdges);
+  int* to = (int*)malloc(sizeof(int) * numEdges);
+  int* weights = (int*)malloc(sizeof(int) * numEdges);
+  if (from == NULL || to == NULL || weights == NULL) {
+    printf("Error: Memory allocation failed for random edges\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) to[i] = i;
+  for (int i = numVertices - 1; i > 0; i--) {
+    int j = (int)(nextRandom(state) % (i + 1));
+    int swap = to[i];
+    to[i] = to[j];
+    to[j] = swap;
+  }
+  for (int i = 0; i < numEdges; i++) {
+    if (i < numVertices) {
+      from[i] = to[(i + 1) % numVertices];
+    } else {
+      from[i] = (int)(nextRandom(state) % numVertices);
+      to[i] = (int)(nextRandom(state) % numVertices);
+    }
+    weights[i] = 1 + (int)(nextRandom(state) % MAX_WEIGHT);
+  }
+
+  // without parallel edges, so that every tree edge has a unique weight
+  int options = BUILD_SYMMETRIZE | BUILD_DEDUPLICATE | BUILD_DROP_SELF_LOOPS;
+  CompactGraph* graph = buildCompactGraph(numVertices, numEdges, from, to,
+                                          weights, options, 1);
+  free(from);
+  free(to);
+  free(weights);
+  return graph;
+}
+
+/* Runs getDistanceTreesBatch on 'graph' from the 'numSources' vertices in
+ * 'sources' with group size 'groupSize' and returns the time it took, or
+ * -1 if its distances do not sum to 'expected'.
+ */
+double timeBatch(CompactGraph* graph, const int* sources, int numSources,
+                 int groupSize, long long expected) {
+  int numTreeEdges[numSources];
+  double start = nowSeconds();
+  Edge** trees = getDistanceTreesBatch(graph, sources, numSources, groupSize,
+                                       numTreeEdges);
+  double time = nowSeconds() - start;
+
+  long long total = 0;
+  for (int s = 0; s < numSources; s++) {
+    total += distanceSum(trees[s], numTreeEdges[s], graph->numVertices);
+  }
+  deleteDistanceTrees(trees, numSources);
+  if (total != expected) {
+    printf("Batch of group size %d disagrees: %lld, expected %lld\n",
+           groupSize, total, expected);
+    return -1;
+  }
+  return time;
+}
+
+/* Returns the next value of the xorshift generator with state 'state'. */
+uint64_t nextRandom(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/* Returns the sum of the distances from the root of the tree 'tree', with
+ * 'numTreeEdges' edges in the order their heads were settled, to all
+ * vertices of a graph with 'numVertices' vertices.
+ */
+long long distanceSum(Edge* tree, int numTreeEdges, int numVertices) {
+  long long* distance = (long long*)calloc(numVertices, sizeof(long long));
+  if (distance == NULL) {
+    printf("Error: Memory allocation failed for distances\n");
+    exit(1);
+  }
+  long long total = 0;
+  for (int i = 0; i < numTreeEdges; i++) {
+    distance[tree[i].toVertex] = distance[tree[i].fromVertex] + tree[i].weight;
+    total += distance[tree[i].toVertex];
+  }
+  free(distance);
+  return total;
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,372 @@
+/*
+ * Direction-optimizing parallel breadth-first search.
+ *
+ * All threads run the same loop of levels, separated by barriers. Between
+ * levels the first thread alone collects the vertices found by every
+ * thread into the next frontier, appends their tree edges, and picks the
+ * direction of the next level with the usual edge-count heuristics:
+ * bottom-up once the frontier's edges exceed 1/BFS_ALPHA of the edges of
+ * unvisited vertices, and top-down again once the frontier shrinks below
+ * 1/BFS_BETA of the vertices.
+ */
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "graph_bfs.h"
+
+#define NOTHING -1
+#define BFS_ALPHA 15
+#define BFS_BETA 18
+#define WORD_BITS 64
+
+typedef struct bfs_state {  // state shared by the threads of one search
+  BfsGraph* graph;            // graph being searched
+  BfsResult* result;          // hops and parents being filled in
+  int* parentWeights;         // parentWeights[id] is the weight of the
+                              //   edge from parents[id] to id
+  _Atomic uint64_t* visited;  // bit id is set iff id has been reached
+  uint64_t* frontierBits;     // bit id is set iff id is in the frontier;
+                              //   only kept up to date for bottom-up
+  int numWords;               // number of words in each bitmap
+  int* frontier;              // vertices of the current level
+  int frontierSize;           // number of vertices in 'frontier'
+  bool bottomUp;              // direction of the current level
+  int level;                  // hops of the vertices in 'frontier'
+  int maxHops;                // last level to reach, or INT_MAX
+  bool done;                  // set when no level is left to expand
+  long long unexploredEdges;  // edges leaving vertices not yet reached
+  int numThreads;             // number of threads in the search
+  pthread_barrier_t barrier;  // separates the phases of each level
+} BfsState;
+
+typedef struct bfs_task {  // one thread of a search
+  BfsState* state;  // the shared state
+  int index;        // 0 .. numThreads-1
+  int* found;       // vertices this thread reached in the current level
+  int numFound;     // number of vertices in 'found'
+} BfsTask;
+
+/*************************************************************************
+ ** Adjacency arrays
+ *************************************************************************/
+
+BfsGraph* newBfsGraph(Graph* graph) {
+  BfsGraph* bfs = (BfsGraph*)malloc(sizeof(BfsGraph));
+  if (bfs == NULL) {
+    printf("Error: Memory allocation failed for BFS graph\n");
+    exit(1);
+  }
+
+  int numVertices = graph->numVertices;
+  bfs->numVertices = numVertices;
+  bfs->offsets = (int*)calloc(numVertices + 1, sizeof(int));
+  bfs->inOffsets = (int*)calloc(numVertices + 1, sizeof(int));
+  if (bfs->offsets == NULL || bfs->inOffsets == NULL) {
+    printf("Error: Memory allocation failed for BFS offsets\n");
+    exit(1);
+  }
+
+  int numEdges = 0;
+  for (int v = 0; v < numVertices; v++) {
+    bfs->offsets[v] = numEdges;
+    if (graph->vertices[v] == NULL) continue;
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      bfs->inOffsets[e->edge->toVertex + 1]++;
+      numEdges++;
+    }
+  }
+  bfs->offsets[numVertices] = numEdges;
+  bfs->numEdges = numEdges;
+  for (int v = 0; v < numVertices; v++) {
+    bfs->inOffsets[v + 1] += bfs->inOffsets[v];
+  }
+
+  bfs->heads = (int*)malloc(sizeof(int) * (numEdges + 1));
+  bfs->weights = (int*)malloc(sizeof(int) * (numEdges + 1));
+  bfs->inTails = (int*)malloc(sizeof(int) * (numEdges + 1));
+  bfs->inWeights = (int*)malloc(sizeof(int) * (numEdges + 1));
+  int* next = (int*)malloc(sizeof(int) * (numVertices + 1));
+  if (bfs->heads == NULL || bfs->weights == NULL || bfs->inTails == NULL ||
+      bfs->inWeights == NULL || next == NULL) {
+    printf("Error: Memory allocation failed for BFS edges\n");
+    exit(1);
+  }
+  memcpy(next, bfs->inOffsets, sizeof(int) * (numVertices + 1));
+
+  for (int v = 0; v < numVertices; v++) {
+    if (graph->vertices[v] == NULL) continue;
+    int i = bfs->offsets[v];
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      int to = e->edge->toVertex;
+      bfs->heads[i] = to;
+      bfs->weights[i] = e->edge->weight;
+      bfs->inTails[next[to]] = v;
+      bfs->inWeights[next[to]] = e->edge->weight;
+      next[to]++;
+      i++;
+    }
+  }
+  free(next);
+
+  return bfs;
+}
+
+void deleteBfsGraph(BfsGraph* graph) {
+  if (graph == NULL) return;
+
+  free(graph->offsets);
+  free(graph->heads);
+  free(graph->weights);
+  free(graph->inOffsets);
+  free(graph->inTails);
+  free(graph->inWeights);
+  free(graph);
+}
+
+/*************************************************************************
+ ** Levels
+ *************************************************************************/
+
+/* Marks vertex 'to' as reached by 'task' from 'from' over an edge of
+ * weight 'weight', unless another thread reached it first.
+ */
+static void reachBfsVertex(BfsTask* task, int from, int to, int weight) {
+  BfsState* state = task->state;
+  uint64_t bit = (uint64_t)1 << (to % WORD_BITS);
+  _Atomic uint64_t* word = &state->visited[to / WORD_BITS];
+  if ((atomic_load_explicit(word, memory_order_relaxed) & bit) != 0 ||
+      (atomic_fetch_or_explicit(word, bit, memory_order_relaxed) & bit) !=
+          0) {
+    return;
+  }
+  state->result->parents[to] = from;
+  state->result->hops[to] = state->level + 1;
+  state->parentWeights[to] = weight;
+  task->found[task->numFound++] = to;
+}
+
+/* Expands this thread's share of the frontier along outgoing edges. */
+static void expandTopDown(BfsTask* task) {
+  BfsState* state = task->state;
+  BfsGraph* graph = state->graph;
+  int first = (int)((long long)state->frontierSize * task->index /
+                    state->numThreads);
+  int last = (int)((long long)state->frontierSize * (task->index + 1) /
+                   state->numThreads);
+
+  for (int k = first; k < last; k++) {
+    int v = state->frontier[k];
+    for (int i = graph->offsets[v]; i < graph->offsets[v + 1]; i++) {
+      reachBfsVertex(task, v, graph->heads[i], graph->weights[i]);
+    }
+  }
+}
+
+/* Finds a frontier parent for every unvisited vertex in this thread's
+ * share of the bitmap words.
+ */
+static void expandBottomUp(BfsTask* task) {
+  BfsState* state = task->state;
+  BfsGraph* graph = state->graph;
+  int firstWord =
+      (int)((long long)state->numWords * task->index / state->numThreads);
+  int lastWord =
+      (int)((long long)state->numWords * (task->index + 1) / state->numThreads);
+  int first = firstWord * WORD_BITS;
+  int last = lastWord * WORD_BITS;
+  if (last > graph->numVertices) last = graph->numVertices;
+
+  for (int v = first; v < last; v++) {
+    uint64_t visited =
+        atomic_load_explicit(&state->visited[v / WORD_BITS],
+                             memory_order_relaxed);
+    if ((visited >> (v % WORD_BITS)) & 1) continue;
+
+    for (int i = graph->inOffsets[v]; i < graph->inOffsets[v + 1]; i++) {
+      int from = graph->inTails[i];
+      if ((state->frontierBits[from / WORD_BITS] >> (from % WORD_BITS)) & 1) {
+        reachBfsVertex(task, from, v, graph->inWeights[i]);
+        break;
+      }
+    }
+  }
+}
+
+/* Collects the vertices found by all 'tasks' into the next frontier and
+ * the tree, and decides how the next level is expanded. Run by one thread
+ * while the others wait.
+ */
+static void finishBfsLevel(BfsState* state, BfsTask* tasks) {
+  BfsGraph* graph = state->graph;
+  BfsResult* result = state->result;
+
+  state->frontierSize = 0;
+  long long frontierEdges = 0;
+  for (int t = 0; t < state->numThreads; t++) {
+    for (int i = 0; i < tasks[t].numFound; i++) {
+      int v = tasks[t].found[i];
+      state->frontier[state->frontierSize++] = v;
+      frontierEdges += graph->offsets[v + 1] - graph->offsets[v];
+
+      Edge* edge = &result->tree[result->numTreeEdges++];
+      edge->fromVertex = result->parents[v];
+      edge->toVertex = v;
+      edge->weight = state->parentWeights[v];
+    }
+    tasks[t].numFound = 0;
+  }
+  state->unexploredEdges -= frontierEdges;
+  state->level++;
+
+  if (state->frontierSize == 0 || state->level >= state->maxHops) {
+    state->done = true;
+    return;
+  }
+
+  if (!state->bottomUp &&
+      frontierEdges > state->unexploredEdges / BFS_ALPHA) {
+    state->bottomUp = true;
+  } else if (state->bottomUp &&
+             state->frontierSize < graph->numVertices / BFS_BETA) {
+    state->bottomUp = false;
+  }
+
+  if (state->bottomUp) {
+    memset(state->frontierBits, 0, sizeof(uint64_t) * state->numWords);
+    for (int k = 0; k < state->frontierSize; k++) {
+      int v = state->frontier[k];
+      state->frontierBits[v / WORD_BITS] |= (uint64_t)1 << (v % WORD_BITS);
+    }
+  }
+}
+
+/* Runs every level of the search of 'arg' as one of its threads. */
+static void* runBfsTask(void* arg) {
+  BfsTask* task = (BfsTask*)arg;
+  BfsState* state = task->state;
+  BfsTask* tasks = task - task->index;
+
+  while (true) {
+    pthread_barrier_wait(&state->barrier);
+    if (state->done) break;
+
+    if (state->bottomUp) {
+      expandBottomUp(task);
+      if (task->index == 0) state->result->numBottomUp++;
+    } else {
+      expandTopDown(task);
+    }
+    if (task->index == 0) state->result->numLevels++;
+
+    pthread_barrier_wait(&state->barrier);
+    if (task->index == 0) finishBfsLevel(state, tasks);
+  }
+  return NULL;
+}
+
+/*************************************************************************
+ ** Searches
+ *************************************************************************/
+
+BfsResult* getBfsTree(BfsGraph* graph, int startVertex, int maxHops,
+                      int numThreads) {
+  if (startVertex < 0 || startVertex >= graph->numVertices ||
+      numThreads < 1) {
+    return NULL;
+  }
+
+  int numVertices = graph->numVertices;
+  BfsResult* result = (BfsResult*)malloc(sizeof(BfsResult));
+  if (result == NULL) {
+    printf("Error: Memory allocation failed for BFS result\n");
+    exit(1);
+  }
+  result->source = startVertex;
+  result->numVertices = numVertices;
+  result->hops = (int*)malloc(sizeof(int) * numVertices);
+  result->parents = (int*)malloc(sizeof(int) * numVertices);
+  result->tree = (Edge*)malloc(sizeof(Edge) * numVertices);
+  if (result->hops == NULL || result->parents == NULL ||
+      result->tree == NULL) {
+    printf("Error: Memory allocation failed for BFS result arrays\n");
+    exit(1);
+  }
+  for (int v = 0; v < numVertices; v++) {
+    result->hops[v] = INT_MAX;
+    result->parents[v] = NOTHING;
+  }
+  result->hops[startVertex] = 0;
+  result->numTreeEdges = 0;
+  result->numLevels = 0;
+  result->numBottomUp = 0;
+
+  BfsState state;
+  state.graph = graph;
+  state.result = result;
+  state.numWords = (numVertices + WORD_BITS - 1) / WORD_BITS;
+  state.parentWeights = (int*)malloc(sizeof(int) * numVertices);
+  state.visited =
+      (_Atomic uint64_t*)calloc(state.numWords + 1, sizeof(uint64_t));
+  state.frontierBits = (uint64_t*)calloc(state.numWords + 1, sizeof(uint64_t));
+  state.frontier = (int*)malloc(sizeof(int) * numVertices);
+  if (state.parentWeights == NULL || state.visited == NULL ||
+      state.frontierBits == NULL || state.frontier == NULL) {
+    printf("Error: Memory allocation failed for BFS state\n");
+    exit(1);
+  }
+  atomic_store(&state.visited[startVertex / WORD_BITS],
+               (uint64_t)1 << (startVertex % WORD_BITS));
+  state.frontier[0] = startVertex;
+  state.frontierSize = 1;
+  state.bottomUp = false;
+  state.level = 0;
+  state.maxHops = maxHops > 0 ? maxHops : INT_MAX;
+  state.done = false;
+  state.unexploredEdges = graph->numEdges - (graph->offsets[startVertex + 1] -
+                                             graph->offsets[startVertex]);
+  state.numThreads = numThreads;
+  pthread_barrier_init(&state.barrier, NULL, numThreads);
+
+  BfsTask tasks[numThreads];
+  pthread_t threads[numThreads];
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t].state = &state;
+    tasks[t].index = t;
+    tasks[t].found = (int*)malloc(sizeof(int) * numVertices);
+    tasks[t].numFound = 0;
+    if (tasks[t].found == NULL) {
+      printf("Error: Memory allocation failed for BFS thread queue\n");
+      exit(1);
+    }
+  }
+  for (int t = 1; t < numThreads; t++) {
+    if (pthread_create(&threads[t], NULL, runBfsTask, &tasks[t]) != 0) {
+      printf("Error: Could not create BFS worker thread\n");
+      exit(1);
+    }
+  }
+  runBfsTask(&tasks[0]);
+  for (int t = 1; t < numThreads; t++) pthread_join(threads[t], NULL);
+
+  for (int t = 0; t < numThreads; t++) free(tasks[t].found);
+  pthread_barrier_destroy(&state.barrier);
+  free(state.parentWeights);
+  free((void*)state.visited);
+  free(state.frontierBits);
+  free(state.frontier);
+
+  return result;
+}
+
+void deleteBfsResult(BfsResult* result) {
+  if (result == NULL) return;
+
+  free(result->hops);
+  free(result->parents);
+  free(result->tree);
+  free(result);
+}
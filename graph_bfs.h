@@ -0,0 +1,67 @@
+/*
+ * Header file for breadth-first search.
+ *
+ * BFS answers hop-count, reachability and unit-weight queries without a
+ * priority queue. Each level is expanded either top-down (the frontier
+ * scans its outgoing edges) or bottom-up (every unvisited vertex looks for
+ * a parent in the frontier, kept as a bitmap), whichever is expected to
+ * check fewer edges, and the work of each level is split across threads.
+ *
+ * Compile with -pthread.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Bfs_header
+#define __Graph_Bfs_header
+
+typedef struct bfs_graph {  // compact adjacency arrays in both directions
+  int numVertices;  // total number of vertices
+  int numEdges;     // total number of edges
+  int* offsets;     // edges leaving id are at [offsets[id], offsets[id+1])
+  int* heads;       // heads[i] is the head of outgoing edge i
+  int* weights;     // weights[i] is the weight of outgoing edge i
+  int* inOffsets;   // edges entering id are at
+                    //   [inOffsets[id], inOffsets[id+1])
+  int* inTails;     // inTails[i] is the tail of incoming edge i
+  int* inWeights;   // inWeights[i] is the weight of incoming edge i
+} BfsGraph;
+
+typedef struct bfs_result {
+  int source;        // ID of the start vertex
+  int numVertices;   // total number of vertices
+  int* hops;         // hops[id] is the number of edges on a shortest path
+                     //   from the source to id, or INT_MAX if not reached
+  int* parents;      // parents[id] is the vertex before id on that path,
+                     //   or -1 for the source and unreached vertices
+  Edge* tree;        // BFS tree in the format produced by
+                     //   getDistanceTreeDijkstra, in order of hops
+  int numTreeEdges;  // number of edges in 'tree'
+  int numLevels;     // number of levels expanded
+  int numBottomUp;   // number of those levels expanded bottom-up
+} BfsResult;
+
+/* Returns the compact adjacency arrays of Graph 'graph'. */
+BfsGraph* newBfsGraph(Graph* graph);
+
+/* Runs BFS on 'graph' from vertex with ID 'startVertex', visiting only
+ * vertices at most 'maxHops' edges away (or all reachable vertices, if
+ * 'maxHops' <= 0), with each level split across 'numThreads' threads.
+ * Hop counts do not depend on 'numThreads'; with more than one thread,
+ * which of several equally close parents a vertex gets may vary.
+ * Returns NULL if 'startVertex' is not valid in 'graph' or 'numThreads' < 1.
+ */
+BfsResult* getBfsTree(BfsGraph* graph, int startVertex, int maxHops,
+                      int numThreads);
+
+/* Frees all memory allocated for 'graph'. */
+void deleteBfsGraph(BfsGraph* graph);
+
+/* Frees all memory allocated for 'result'. */
+void deleteBfsResult(BfsResult* result);
+
+#endif
@@ -0,0 +1,413 @@
+/*
+ * Building graphs from edge lists.
+ *
+ * Thread t owns the t-th slice of the input edges and the t-th block of
+ * vertices. counts[t * numVertices + id] first holds the number of edges
+ * leaving id in slice t, and after the prefix sums the position where
+ * thread t writes the next of them. Deduplication sorts every adjacency in
+ * place by (head, weight), keeps the first edge of every head, and copies
+ * the survivors into arrays of the new size.
+ */
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "graph_build.h"
+
+#define INSERTION_SORT_MAX 16  // adjacencies up to this long are sorted by
+                               //   insertion
+
+typedef struct build_state {  // everything the threads share
+  int numVertices;          // total number of vertices
+  int numEdges;             // number of input edges
+  int numThreads;           // number of threads in the build
+  const int* fromVertices;  // input tails
+  const int* toVertices;    // input heads
+  const int* inWeights;     // input weights, or NULL for all 1
+  int options;              // BuildOptions of this build
+  int* counts;              // per thread degrees, then write positions
+  int* degrees;             // degrees[id] after deduplication
+  CompactGraph* graph;      // graph being built
+  int* newOffsets;          // offsets after deduplication
+  int* newHeads;            // heads after deduplication
+  int* newWeights;          // weights after deduplication
+} BuildState;
+
+typedef struct build_task {  // one thread's share of the build
+  BuildState* state;     // shared state
+  int index;             // 0 .. numThreads-1
+  int firstEdge;         // this thread handles input edges
+  int lastEdge;          //   firstEdge .. lastEdge-1
+  int firstVertex;       // and vertices
+  int lastVertex;        //   firstVertex .. lastVertex-1
+  long long blockTotal;  // number of edges leaving those vertices
+  long long blockStart;  // position of the first of them
+  bool invalid;          // true iff an input edge has an invalid ID
+  uint64_t* scratch;     // one adjacency packed for sorting
+  int scratchSize;       // number of entries that fit in 'scratch'
+} BuildTask;
+
+/*************************************************************************
+ ** Counting sort
+ *************************************************************************/
+
+/* Counts the edges leaving each vertex in this thread's slice. */
+static void* countEdges(void* arg) {
+  BuildTask* task = (BuildTask*)arg;
+  BuildState* state = task->state;
+  int numVertices = state->numVertices;
+  int* counts = &state->counts[(size_t)task->index * numVertices];
+  bool symmetrize = state->options & BUILD_SYMMETRIZE;
+  bool dropSelfLoops = state->options & BUILD_DROP_SELF_LOOPS;
+
+  for (int e = task->firstEdge; e < task->lastEdge; e++) {
+    int u = state->fromVertices[e];
+    int v = state->toVertices[e];
+    if (u < 0 || u >= numVertices || v < 0 || v >= numVertices) {
+      task->invalid = true;
+      return NULL;
+    }
+    if (u == v && dropSelfLoops) continue;
+    counts[u]++;
+    if (symmetrize && u != v) counts[v]++;
+  }
+  return NULL;
+}
+
+/* Adds up the degrees of this thread's vertices over all slices. */
+static void* sumCounts(void* arg) {
+  BuildTask* task = (BuildTask*)arg;
+  BuildState* state = task->state;
+  size_t numVertices = state->numVertices;
+
+  long long total = 0;
+  for (int v = task->firstVertex; v < task->lastVertex; v++) {
+    for (int t = 0; t < state->numThreads; t++) {
+      total += state->counts[t * numVertices + v];
+    }
+  }
+  task->blockTotal = total;
+  return NULL;
+}
+
+/* Turns the counts of this thread's vertices into write positions, and
+ * sets their offsets.
+ */
+static void* placeCounts(void* arg) {
+  BuildTask* task = (BuildTask*)arg;
+  BuildState* state = task->state;
+  size_t numVertices = state->numVertices;
+
+  int position = (int)task->blockStart;
+  for (int v = task->firstVertex; v < task->lastVertex; v++) {
+    state->graph->offsets[v] = position;
+    for (int t = 0; t < state->numThreads; t++) {
+      int count = state->counts[t * numVertices + v];
+      state->counts[t * numVertices + v] = position;
+      position += count;
+    }
+  }
+  return NULL;
+}
+
+/* Writes the edges of this thread's slice to their positions. */
+static void* scatterEdges(void* arg) {
+  BuildTask* task = (BuildTask*)arg;
+  BuildState* state = task->state;
+  int* next = &state->counts[(size_t)task->index * state->numVertices];
+  int* heads = state->graph->heads;
+  int* weights = state->graph->weights;
+  bool symmetrize = state->options & BUILD_SYMMETRIZE;
+  bool dropSelfLoops = state->options & BUILD_DROP_SELF_LOOPS;
+
+  for (int e = task->firstEdge; e < task->lastEdge; e++) {
+    int u = state->fromVertices[e];
+    int v = state->toVertices[e];
+    int weight = state->inWeights != NULL ? state->inWeights[e] : 1;
+    if (u == v && dropSelfLoops) continue;
+    heads[next[u]] = v;
+    weights[next[u]++] = weight;
+    if (symmetrize && u != v) {
+      heads[next[v]] = u;
+      weights[next[v]++] = weight;
+    }
+  }
+  return NULL;
+}
+
+/*************************************************************************
+ ** Deduplication
+ *************************************************************************/
+
+/* Compares packed edges 'a' and 'b' for qsort. */
+static int comparePacked(const void* a, const void* b) {
+  uint64_t x = *(const uint64_t*)a;
+  uint64_t y = *(const uint64_t*)b;
+  return (x > y) - (x < y);
+}
+
+/* Sorts the adjacency of every vertex of this thread by (head, weight),
+ * keeps the first edge of every head at the front, and records how many
+ * were kept.
+ */
+static void* deduplicateBlock(void* arg) {
+  BuildTask* task = (BuildTask*)arg;
+  BuildState* state = task->state;
+  CompactGraph* graph = state->graph;
+
+  long long total = 0;
+  for (int v = task->firstVertex; v < task->lastVertex; v++) {
+    int first = graph->offsets[v];
+    int degree = graph->offsets[v + 1] - first;
+    if (degree > task->scratchSize) {
+      free(task->scratch);
+      task->scratchSize = degree;
+      task->scratch = (uint64_t*)malloc(sizeof(uint64_t) * degree);
+      if (task->scratch == NULL) {
+        printf("Error: Memory allocation failed for build scratch\n");
+        exit(1);
+      }
+    }
+
+    // heads in the high half and weights, sign bit flipped, in the low half
+    // make packed order (head, weight) order
+    uint64_t* packed = task->scratch;
+    for (int i = 0; i < degree; i++) {
+      packed[i] = (uint64_t)(uint32_t)graph->heads[first + i] << 32 |
+                  ((uint32_t)graph->weights[first + i] ^ 0x80000000u);
+    }
+    if (degree <= INSERTION_SORT_MAX) {
+      for (int i = 1; i < degree; i++) {
+        uint64_t key = packed[i];
+        int j = i - 1;
+        for (; j >= 0 && packed[j] > key; j--) packed[j + 1] = packed[j];
+        packed[j + 1] = key;
+      }
+    } else {
+      qsort(packed, degree, sizeof(uint64_t), comparePacked);
+    }
+
+    int kept = 0;
+    for (int i = 0; i < degree; i++) {
+      if (i > 0 && packed[i] >> 32 == packed[i - 1] >> 32) continue;
+      graph->heads[first + kept] = (int)(packed[i] >> 32);
+      graph->weights[first + kept] = (int)((uint32_t)packed[i] ^ 0x80000000u);
+      kept++;
+    }
+    state->degrees[v] = kept;
+    total += kept;
+  }
+  task->blockTotal = total;
+  return NULL;
+}
+
+/* Copies the kept edges of this thread's vertices to the new arrays. */
+static void* compactBlock(void* arg) {
+  BuildTask* task = (BuildTask*)arg;
+  BuildState* state = task->state;
+  CompactGraph* graph = state->graph;
+
+  int position = (int)task->blockStart;
+  for (int v = task->firstVertex; v < task->lastVertex; v++) {
+    int degree = state->degrees[v];
+    state->newOffsets[v] = position;
+    memcpy(&state->newHeads[position], &graph->heads[graph->offsets[v]],
+           sizeof(int) * degree);
+    memcpy(&state->newWeights[position], &graph->weights[graph->offsets[v]],
+           sizeof(int) * degree);
+    position += degree;
+  }
+  return NULL;
+}
+
+/*************************************************************************
+ ** Building
+ *************************************************************************/
+
+/* Runs 'run' on each of the 'numThreads' tasks in 'tasks', one per
+ * thread.
+ */
+static void runBuildPhase(BuildTask* tasks, int numThreads,
+                          void* (*run)(void*)) {
+  pthread_t threads[numThreads];
+  for (int t = 1; t < numThreads; t++) {
+    if (pthread_create(&threads[t], NULL, run, &tasks[t]) != 0) {
+      printf("Error: Could not create build worker thread\n");
+      exit(1);
+    }
+  }
+  run(&tasks[0]);
+  for (int t = 1; t < numThreads; t++) pthread_join(threads[t], NULL);
+}
+
+/* Sets the block start of every task to the total of the blocks before
+ * it, and returns the total of all blocks.
+ */
+static long long prefixBlocks(BuildTask* tasks, int numThreads) {
+  long long total = 0;
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t].blockStart = total;
+    total += tasks[t].blockTotal;
+  }
+  return total;
+}
+
+/* Allocates 'count' ints for the build, exiting if that fails. */
+static int* allocateInts(long long count) {
+  int* array = (int*)malloc(sizeof(int) * (count + 1));
+  if (array == NULL) {
+    printf("Error: Memory allocation failed for compact graph\n");
+    exit(1);
+  }
+  return array;
+}
+
+CompactGraph* buildCompactGraph(int numVertices, int numEdges,
+                                const int* fromVertices,
+                                const int* toVertices, const int* weights,
+                                int options, int numThreads) {
+  if (numVertices < 0 || numEdges < 0 || numThreads < 1 ||
+      ((options & BUILD_SYMMETRIZE) && numEdges > INT_MAX / 2)) {
+    return NULL;
+  }
+
+  BuildState state;
+  state.numVertices = numVertices;
+  state.numEdges = numEdges;
+  state.numThreads = numThreads;
+  state.fromVertices = fromVertices;
+  state.toVertices = toVertices;
+  state.inWeights = weights;
+  state.options = options;
+  state.counts =
+      (int*)calloc((size_t)numThreads * numVertices + 1, sizeof(int));
+  if (state.counts == NULL) {
+    printf("Error: Memory allocation failed for build counts\n");
+    exit(1);
+  }
+
+  BuildTask tasks[numThreads];
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t].state = &state;
+    tasks[t].index = t;
+    tasks[t].firstEdge = (int)((long long)numEdges * t / numThreads);
+    tasks[t].lastEdge = (int)((long long)numEdges * (t + 1) / numThreads);
+    tasks[t].firstVertex = (int)((long long)numVertices * t / numThreads);
+    tasks[t].lastVertex = (int)((long long)numVertices * (t + 1) / numThreads);
+    tasks[t].invalid = false;
+    tasks[t].scratch = NULL;
+    tasks[t].scratchSize = 0;
+  }
+
+  runBuildPhase(tasks, numThreads, countEdges);
+  bool invalid = false;
+  for (int t = 0; t < numThreads; t++) invalid = invalid || tasks[t].invalid;
+  runBuildPhase(tasks, numThreads, sumCounts);
+  long long total = prefixBlocks(tasks, numThreads);
+  if (invalid) {
+    free(state.counts);
+    return NULL;
+  }
+
+  CompactGraph* graph = (CompactGraph*)malloc(sizeof(CompactGraph));
+  if (graph == NULL) {
+    printf("Error: Memory allocation failed for compact graph\n");
+    exit(1);
+  }
+  graph->numVertices = numVertices;
+  graph->numEdges = (int)total;
+  graph->offsets = allocateInts(numVertices);
+  graph->heads = allocateInts(total);
+  graph->weights = allocateInts(total);
+  graph->offsets[numVertices] = (int)total;
+  state.graph = graph;
+
+  runBuildPhase(tasks, numThreads, placeCounts);
+  runBuildPhase(tasks, numThreads, scatterEdges);
+  free(state.counts);
+
+  if (options & BUILD_DEDUPLICATE) {
+    state.degrees = allocateInts(numVertices);
+    runBuildPhase(tasks, numThreads, deduplicateBlock);
+    total = prefixBlocks(tasks, numThreads);
+
+    state.newOffsets = allocateInts(numVertices);
+    state.newHeads = allocateInts(total);
+    state.newWeights = allocateInts(total);
+    state.newOffsets[numVertices] = (int)total;
+    runBuildPhase(tasks, numThreads, compactBlock);
+
+    free(graph->offsets);
+    free(graph->heads);
+    free(graph->weights);
+    free(state.degrees);
+    graph->numEdges = (int)total;
+    graph->offsets = state.newOffsets;
+    graph->heads = state.newHeads;
+    graph->weights = state.newWeights;
+    for (int t = 0; t < numThreads; t++) free(tasks[t].scratch);
+  }
+
+  return graph;
+}
+
+Graph* newGraphFromCompact(CompactGraph* graph) {
+  Graph* result = newGraph(graph->numVertices);
+  for (int v = 0; v < graph->numVertices; v++) {
+    // build each list back to front to keep the order of 'graph'
+    EdgeList* adjList = NULL;
+    for (int i = graph->offsets[v + 1] - 1; i >= graph->offsets[v]; i--) {
+      adjList = newEdgeList(newEdge(v, graph->heads[i], graph->weights[i]),
+                            adjList);
+    }
+    result->vertices[v] = newVertex(v, NULL, adjList);
+  }
+  result->numEdges = graph->numEdges;
+  return result;
+}
+
+CompactGraph* newCompactGraphFromGraph(Graph* graph) {
+  int numVertices = graph->numVertices;
+  CompactGraph* result = (CompactGraph*)malloc(sizeof(CompactGraph));
+  if (result == NULL) {
+    printf("Error: Memory allocation failed for compact graph\n");
+    exit(1);
+  }
+  result->numVertices = numVertices;
+  result->offsets = allocateInts(numVertices);
+
+  int numEdges = 0;
+  for (int v = 0; v < numVertices; v++) {
+    result->offsets[v] = numEdges;
+    if (graph->vertices[v] == NULL) continue;
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      numEdges++;
+    }
+  }
+  result->offsets[numVertices] = numEdges;
+  result->numEdges = numEdges;
+
+  result->heads = allocateInts(numEdges);
+  result->weights = allocateInts(numEdges);
+  for (int v = 0; v < numVertices; v++) {
+    if (graph->vertices[v] == NULL) continue;
+    int i = result->offsets[v];
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      result->heads[i] = e->edge->toVertex;
+      result->weights[i] = e->edge->weight;
+      i++;
+    }
+  }
+  return result;
+}
+
+void deleteCompactGraph(CompactGraph* graph) {
+  if (graph == NULL) return;
+
+  free(graph->offsets);
+  free(graph->heads);
+  free(graph->weights);
+  free(graph);
+}
@@ -0,0 +1,65 @@
+/*
+ * Header file for building graphs from edge lists.
+ *
+ * Edges given as flat (from, to, weight) arrays are bucketed by tail with a
+ * parallel counting sort: every thread counts the degrees of its share of
+ * the edges, prefix sums over (vertex, thread) give each thread its own
+ * write position in every bucket, and every thread then scatters its edges
+ * without synchronization. Within a vertex, edges keep their input order
+ * whatever the number of threads.
+ *
+ * Compile with -pthread.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Build_header
+#define __Graph_Build_header
+
+typedef enum build_option {  // options of buildCompactGraph, combined with |
+  BUILD_SYMMETRIZE = 1,      // also add every edge in the other direction
+  BUILD_DEDUPLICATE = 2,     // keep only the cheapest of parallel edges,
+                             //   and sort every adjacency by head
+  BUILD_DROP_SELF_LOOPS = 4  // leave out edges from a vertex to itself
+} BuildOption;
+
+typedef struct compact_graph {  // compact adjacency arrays
+  int numVertices;  // total number of vertices
+  int numEdges;     // total number of edges
+  int* offsets;     // edges leaving id are at [offsets[id], offsets[id+1])
+  int* heads;       // heads[i] is the head of edge i
+  int* weights;     // weights[i] is the weight of edge i
+} CompactGraph;
+
+/* Returns the graph on 'numVertices' vertices with the 'numEdges' edges
+ * (fromVertices[i], toVertices[i], weights[i]), or weight 1 each if
+ * 'weights' is NULL, changed as 'options' (a combination of BuildOptions)
+ * say, with the work split across 'numThreads' threads. A symmetrized
+ * self-loop is added once. Needs 'numThreads' * 'numVertices' ints of
+ * scratch space.
+ * Returns NULL if an ID is not in [0, numVertices), if symmetrizing more
+ * than INT_MAX / 2 edges, or if 'numThreads' < 1.
+ */
+CompactGraph* buildCompactGraph(int numVertices, int numEdges,
+                                const int* fromVertices,
+                                const int* toVertices, const int* weights,
+                                int options, int numThreads);
+
+/* Returns a Graph with the vertices and edges of 'graph', with every
+ * adjacency list in the order of 'graph'.
+ */
+Graph* newGraphFromCompact(CompactGraph* graph);
+
+/* Returns a CompactGraph with the vertices and edges of Graph 'graph', with
+ * every adjacency in the order of its list in 'graph'.
+ */
+CompactGraph* newCompactGraphFromGraph(Graph* graph);
+
+/* Frees all memory allocated for 'graph'. */
+void deleteCompactGraph(CompactGraph* graph);
+
+#endif
@@ -0,0 +1,224 @@
+/*
+ *  Benchmark of the parallel graph construction of graph_build.h.
+ *
+ *  Generates random (from, to, weight) edge arrays, with self-loops and
+ *  parallel edges, and times buildCompactGraph on them with every option on
+ *  its own and all together, for 1, 2, 4, ... threads, printing the
+ *  throughput in input edges per second. Checks that every number of
+ *  threads builds the same arrays, that symmetrizing and dropping
+ *  self-loops give the expected number of edges, and that deduplicating
+ *  leaves every adjacency sorted without repeated heads.
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O3 -Wall -Werror -pthread graph.c graph_build.c \
+ *       graph_build_bench.c -o graph_build_bench
+ *
+ *   Run:
+ *   ./graph_build_bench [numVertices] [edgesPerVertex] [maxThreads]
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "graph.h"
+#include "graph_build.h"
+
+#define DEFAULT_VERTICES 1000000
+#define DEFAULT_DEGREE 8
+#define DEFAULT_THREADS 8
+#define MAX_WEIGHT 1000
+#define NUM_OPTION_SETS 5
+
+typedef struct edge_arrays {  // flat input of buildCompactGraph
+  int numVertices;  // total number of vertices
+  int numEdges;     // number of edges
+  int* from;        // tails of the edges
+  int* to;          // heads of the edges
+  int* weights;     // weights of the edges
+  int numLoops;     // number of self-loops among them
+} EdgeArrays;
+
+/* graphs */
+EdgeArrays* randomEdges(int numVertices, int numEdges, uint64_t* state);
+void deleteEdgeArrays(EdgeArrays* edges);
+uint64_t nextRandom(uint64_t* state);
+
+/* checking */
+bool sameCompactGraph(CompactGraph* a, CompactGraph* b);
+int expectedEdges(EdgeArrays* edges, int options);
+bool isDeduplicated(CompactGraph* graph);
+
+/* measuring */
+bool timeBuild(EdgeArrays* edges, const char* name, int options,
+               int maxThreads);
+double nowSeconds(void);
+
+int main(int argc, char* argv[]) {
+  int numVertices = argc > 1 ? atoi(argv[1]) : DEFAULT_VERTICES;
+  int degree = argc > 2 ? atoi(argv[2]) : DEFAULT_DEGREE;
+  int maxThreads = argc > 3 ? atoi(argv[3]) : DEFAULT_THREADS;
+  if (numVertices < 1 || degree < 1 || maxThreads < 1 ||
+      (long long)numVertices * degree > INT_MAX / 2) {
+    printf("Usage: %s [numVertices >= 1] [edgesPerVertex >= 1] "
+           "[maxThreads >= 1]\n", argv[0]);
+    return 1;
+  }
+
+  uint64_t state = 88172645463325252ULL;
+  EdgeArrays* edges = randomEdges(numVertices, numVertices * degree, &state);
+  printf("%d vertices, %d edges, %d self-loops\n\n", numVertices,
+         edges->numEdges, edges->numLoops);
+
+  const char* names[NUM_OPTION_SETS] = {"plain", "symmetrize", "deduplicate",
+                                        "drop self-loops", "all"};
+  int optionSets[NUM_OPTION_SETS] = {
+      0, BUILD_SYMMETRIZE, BUILD_DEDUPLICATE, BUILD_DROP_SELF_LOOPS,
+      BUILD_SYMMETRIZE | BUILD_DEDUPLICATE | BUILD_DROP_SELF_LOOPS};
+  printf("%-16s %8s %11s %14s %8s\n", "options", "threads", "time",
+         "input edges/s", "speedup");
+  bool agree = true;
+  for (int o = 0; o < NUM_OPTION_SETS; o++) {
+    agree &= timeBuild(edges, names[o], optionSets[o], maxThreads);
+  }
+
+  deleteEdgeArrays(edges);
+  return agree ? 0 : 1;
+}
+
+/* Returns 'numEdges' random edges on 'numVertices' vertices with weights
+ * in [1, MAX_WEIGHT]. Ends are drawn independently, so there are
+ * self-loops and, on few vertices, parallel edges.
+ */
+EdgeArrays* randomEdges(int numVertices, int numEdges, uint64_t* state) {
+  EdgeArrays* edges = (EdgeArrays*)malloc(sizeof(EdgeArrays));
+  if (edges == NULL) {
+    printf("Error: Memory allocation failed for random edges\n");
+    exit(1);
+  }
+  edges->numVertices = numVertices;
+  edges->numEdges = numEdges;
+  edges->from = (int*)malloc(sizeof(int) * numEdges);
+  edges->to = (int*)malloc(sizeof(int) * numEdges);
+  edges->weights = (int*)malloc(sizeof(int) * numEdges);
+  if (edges->from == NULL || edges->to == NULL || edges->weights == NULL) {
+    printf("Error: Memory allocation failed for random edges\n");
+    exit(1);
+  }
+  edges->numLoops = 0;
+  for (int i = 0; i < numEdges; i++) {
+    edges->from[i] = (int)(nextRandom(state) % numVertices);
+    edges->to[i] = (int)(nextRandom(state) % numVertices);
+    edges->weights[i] = 1 + (int)(nextRandom(state) % MAX_WEIGHT);
+    if (edges->from[i] == edges->to[i]) edges->numLoops++;
+  }
+  return edges;
+}
+
+/* Frees all memory allocated for 'edges'. */
+void deleteEdgeArrays(EdgeArrays* edges) {
+  free(edges->from);
+  free(edges->to);
+  free(edges->weights);
+  free(edges);
+}
+
+/* Returns true iff 'a' and 'b' have the same offsets, heads and weights. */
+bool sameCompactGraph(CompactGraph* a, CompactGraph* b) {
+  return a->numVertices == b->numVertices && a->numEdges == b->numEdges &&
+         memcmp(a->offsets, b->offsets,
+                sizeof(int) * (a->numVertices + 1)) == 0 &&
+         memcmp(a->heads, b->heads, sizeof(int) * a->numEdges) == 0 &&
+         memcmp(a->weights, b->weights, sizeof(int) * a->numEdges) == 0;
+}
+
+/* Returns the number of edges buildCompactGraph must build from 'edges'
+ * with 'options', or -1 if that depends on the parallel edges.
+ */
+int expectedEdges(EdgeArrays* edges, int options) {
+  if (options & BUILD_DEDUPLICATE) return -1;
+
+  int numEdges = edges->numEdges;
+  if (options & BUILD_DROP_SELF_LOOPS) {
+    numEdges -= edges->numLoops;
+    if (options & BUILD_SYMMETRIZE) numEdges *= 2;
+  } else if (options & BUILD_SYMMETRIZE) {
+    // a symmetrized self-loop is added once
+    numEdges = 2 * numEdges - edges->numLoops;
+  }
+  return numEdges;
+}
+
+/* Returns true iff every adjacency of 'graph' has strictly increasing
+ * heads.
+ */
+bool isDeduplicated(CompactGraph* graph) {
+  for (int v = 0; v < graph->numVertices; v++) {
+    for (int i = graph->offsets[v] + 1; i < graph->offsets[v + 1]; i++) {
+      if (graph->heads[i - 1] >= graph->heads[i]) return false;
+    }
+  }
+  return true;
+}
+
+/* Builds 'edges' with 'options' on 1, 2, 4, ... up to 'maxThreads'
+ * threads, and prints the time and throughput of each under 'name'.
+ * Returns false if two builds differ or the first is not as expected.
+ */
+bool timeBuild(EdgeArrays* edges, const char* name, int options,
+               int maxThreads) {
+  CompactGraph* first = NULL;
+  double baseTime = 0;
+  bool agree = true;
+  for (int threads = 1; threads <= maxThreads; threads *= 2) {
+    double start = nowSeconds();
+    CompactGraph* graph =
+        buildCompactGraph(edges->numVertices, edges->numEdges, edges->from,
+                          edges->to, edges->weights, options, threads);
+    double seconds = nowSeconds() - start;
+    if (graph == NULL) {
+      printf("Building with options %s failed\n", name);
+      return false;
+    }
+
+    bool same;
+    if (first == NULL) {
+      int expected = expectedEdges(edges, options);
+      same = expected == -1 ? isDeduplicated(graph)
+                            : graph->numEdges == expected;
+      first = graph;
+      baseTime = seconds;
+    } else {
+      same = sameCompactGraph(first, graph);
+      deleteCompactGraph(graph);
+    }
+    agree &= same;
+    printf("%-16s %8d %9.1f ms %12.1f M %7.2fx%s\n", name, threads,
+           1000 * seconds, edges->numEdges / seconds / 1e6,
+           baseTime / seconds, same ? "" : "  (disagrees)");
+  }
+  deleteCompactGraph(first);
+  return agree;
+}
+
+/* Returns the next value of the xorshift generator with state 'state'. */
+uint64_t nextRandom(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,295 @@
+/*
+ * A shared cache of shortest path trees.
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#include "graph_cache.h"
+#include "graph_queue.h"
+
+#define NOTHING -1
+#define NUM_BUCKETS 1024  // hash buckets; a cache holds few large trees
+
+/*************************************************************************
+ ** Bookkeeping, with the cache lock held
+ *************************************************************************/
+
+/* Returns the bucket of the tree from 'source' of version 'version'. */
+static int bucketOf(TreeCache* cache, unsigned long version, int source) {
+  unsigned long long hash =
+      ((unsigned long long)version * 0x9E3779B97F4A7C15ULL) ^
+      ((unsigned)source * 0xC2B2AE3D27D4EB4FULL);
+  return (int)((hash >> 32) % cache->numBuckets);
+}
+
+/* Frees all memory allocated for 'tree'. */
+static void freeTree(CachedTree* tree) {
+  free(tree->distances);
+  free(tree->parents);
+  free(tree);
+}
+
+/* Takes 'tree' out of the order of use of 'cache'. */
+static void unlinkTree(TreeCache* cache, CachedTree* tree) {
+  if (tree->newer == NULL) {
+    cache->newest = tree->older;
+  } else {
+    tree->newer->older = tree->older;
+  }
+  if (tree->older == NULL) {
+    cache->oldest = tree->newer;
+  } else {
+    tree->older->newer = tree->newer;
+  }
+  tree->newer = NULL;
+  tree->older = NULL;
+}
+
+/* Puts 'tree' first in the order of use of 'cache'. */
+static void pushNewest(TreeCache* cache, CachedTree* tree) {
+  tree->older = cache->newest;
+  tree->newer = NULL;
+  if (cache->newest == NULL) {
+    cache->oldest = tree;
+  } else {
+    cache->newest->newer = tree;
+  }
+  cache->newest = tree;
+}
+
+/* Removes 'tree' from 'cache', and frees it unless it is still pinned. */
+static void evictTree(TreeCache* cache, CachedTree* tree) {
+  CachedTree** link =
+      &cache->buckets[bucketOf(cache, tree->version, tree->source)];
+  while (*link != tree) link = &(*link)->next;
+  *link = tree->next;
+  unlinkTree(cache, tree);
+
+  tree->evicted = true;
+  cache->stats.numTrees--;
+  cache->stats.bytesUsed -= tree->bytes;
+  cache->stats.numEvictions++;
+  if (tree->numUsers == 0) freeTree(tree);
+}
+
+/* Returns the tree 'cache' should evict next, other than 'keep', or NULL
+ * if every tree is still being computed. Trees are looked at from the
+ * least recently used, so ties under CACHE_LFU go to the least recent.
+ */
+static CachedTree* findVictim(TreeCache* cache, CachedTree* keep) {
+  CachedTree* victim = NULL;
+  for (CachedTree* tree = cache->oldest; tree != NULL; tree = tree->newer) {
+    if (!tree->ready || tree == keep) continue;
+    if (cache->policy == CACHE_LRU) return tree;
+    if (victim == NULL || tree->numUses < victim->numUses) victim = tree;
+  }
+  return victim;
+}
+
+/*************************************************************************
+ ** Searching
+ *************************************************************************/
+
+/* Fills in the distances and parents of 'tree' by running Dijkstra's
+ * algorithm on 'graph' from its source.
+ */
+static void computeTree(CachedTree* tree, Graph* graph) {
+  int numVertices = tree->numVertices;
+  int numTreeEdges;
+  Edge* edges = getDistanceTreeQueue(graph, tree->source, QUEUE_LAZY_HEAP,
+                                     &numTreeEdges);
+
+  for (int id = 0; id < numVertices; id++) {
+    tree->distances[id] = INT_MAX;
+    tree->parents[id] = NOTHING;
+  }
+  tree->distances[tree->source] = 0;
+  // tree edges come in the order their heads were settled
+  for (int i = 0; i < numTreeEdges; i++) {
+    int to = edges[i].toVertex;
+    tree->parents[to] = edges[i].fromVertex;
+    tree->distances[to] = tree->distances[edges[i].fromVertex] +
+                          edges[i].weight;
+  }
+  free(edges);
+}
+
+/*************************************************************************
+ ** Cache
+ *************************************************************************/
+
+TreeCache* newTreeCache(size_t budget, CachePolicy policy) {
+  TreeCache* cache = (TreeCache*)malloc(sizeof(TreeCache));
+  if (cache == NULL) {
+    printf("Error: Memory allocation failed for tree cache\n");
+    exit(1);
+  }
+  cache->policy = policy;
+  cache->budget = budget;
+  cache->numBuckets = NUM_BUCKETS;
+  cache->buckets = (CachedTree**)calloc(NUM_BUCKETS, sizeof(CachedTree*));
+  if (cache->buckets == NULL) {
+    printf("Error: Memory allocation failed for tree cache\n");
+    exit(1);
+  }
+  cache->newest = NULL;
+  cache->oldest = NULL;
+  pthread_mutex_init(&cache->lock, NULL);
+  pthread_cond_init(&cache->ready, NULL);
+  memset(&cache->stats, 0, sizeof(CacheStats));
+  return cache;
+}
+
+CachedTree* getCachedTree(TreeCache* cache, Graph* graph,
+                          unsigned long version, int source) {
+  if (source < 0 || source >= graph->numVertices ||
+      graph->vertices[source] == NULL) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&cache->lock);
+  int bucket = bucketOf(cache, version, source);
+  CachedTree* tree = cache->buckets[bucket];
+  while (tree != NULL && (tree->source != source || tree->version != version)) {
+    tree = tree->next;
+  }
+  if (tree != NULL) {
+    tree->numUsers++;
+    tree->numUses++;
+    cache->stats.numHits++;
+    while (!tree->ready) pthread_cond_wait(&cache->ready, &cache->lock);
+    if (!tree->evicted) {
+      unlinkTree(cache, tree);
+      pushNewest(cache, tree);
+    }
+    pthread_mutex_unlock(&cache->lock);
+    return tree;
+  }
+
+  // a miss: claim the tree, so that others wait for it, and compute it
+  // without the lock
+  int numVertices = graph->numVertices;
+  tree = (CachedTree*)malloc(sizeof(CachedTree));
+  if (tree == NULL) {
+    printf("Error: Memory allocation failed for cached tree\n");
+    exit(1);
+  }
+  tree->source = source;
+  tree->version = version;
+  tree->numVertices = numVertices;
+  tree->bytes = sizeof(CachedTree) + 2 * sizeof(int) * (size_t)numVertices;
+  tree->ready = false;
+  tree->evicted = false;
+  tree->numUsers = 1;
+  tree->numUses = 1;
+  tree->next = cache->buckets[bucket];
+  cache->buckets[bucket] = tree;
+  pushNewest(cache, tree);
+  cache->stats.numTrees++;
+  cache->stats.bytesUsed += tree->bytes;
+  cache->stats.numMisses++;
+  pthread_mutex_unlock(&cache->lock);
+
+  tree->distances = (int*)malloc(sizeof(int) * numVertices);
+  tree->parents = (int*)malloc(sizeof(int) * numVertices);
+  if (tree->distances == NULL || tree->parents == NULL) {
+    printf("Error: Memory allocation failed for cached tree\n");
+    exit(1);
+  }
+  computeTree(tree, graph);
+
+  pthread_mutex_lock(&cache->lock);
+  tree->ready = true;
+  while (cache->stats.bytesUsed > cache->budget && !tree->evicted) {
+    CachedTree* victim = findVictim(cache, tree);
+    if (victim == NULL) victim = tree;  // too large to keep
+    evictTree(cache, victim);
+  }
+  pthread_cond_broadcast(&cache->ready);
+  pthread_mutex_unlock(&cache->lock);
+  return tree;
+}
+
+void releaseCachedTree(TreeCache* cache, CachedTree* tree) {
+  pthread_mutex_lock(&cache->lock);
+  tree->numUsers--;
+  if (tree->evicted && tree->numUsers == 0) freeTree(tree);
+  pthread_mutex_unlock(&cache->lock);
+}
+
+int getCachedDistance(CachedTree* tree, int target) {
+  if (target < 0 || target >= tree->numVertices) return INT_MAX;
+  return tree->distances[target];
+}
+
+EdgeList* getCachedPath(CachedTree* tree, int target) {
+  if (target < 0 || target >= tree->numVertices ||
+      tree->parents[target] == NOTHING) {
+    return NULL;
+  }
+
+  // built from the source end, so the list starts at 'target'
+  int length = 0;
+  for (int id = target; id != tree->source; id = tree->parents[id]) length++;
+  int* path = (int*)malloc(sizeof(int) * (length + 1));
+  if (path == NULL) {
+    printf("Error: Memory allocation failed for path\n");
+    exit(1);
+  }
+  int id = target;
+  for (int i = 0; i <= length; i++) {
+    path[i] = id;
+    id = tree->parents[id];
+  }
+  EdgeList* head = NULL;
+  for (int i = length - 1; i >= 0; i--) {
+    int from = path[i + 1];
+    int to = path[i];
+    int weight = tree->distances[to] - tree->distances[from];
+    head = newEdgeList(newEdge(from, to, weight), head);
+  }
+  free(path);
+  return head;
+}
+
+int evictOldVersions(TreeCache* cache, unsigned long version) {
+  pthread_mutex_lock(&cache->lock);
+  int numEvicted = 0;
+  CachedTree* tree = cache->oldest;
+  while (tree != NULL) {
+    CachedTree* newer = tree->newer;
+    if (tree->ready && tree->version < version) {
+      evictTree(cache, tree);
+      numEvicted++;
+    }
+    tree = newer;
+  }
+  pthread_mutex_unlock(&cache->lock);
+  return numEvicted;
+}
+
+CacheStats getCacheStats(TreeCache* cache) {
+  pthread_mutex_lock(&cache->lock);
+  CacheStats stats = cache->stats;
+  pthread_mutex_unlock(&cache->lock);
+
+  long long numLookups = stats.numHits + stats.numMisses;
+  stats.hitRate = numLookups > 0 ? (double)stats.numHits / numLookups : 0;
+  return stats;
+}
+
+void deleteTreeCache(TreeCache* cache) {
+  if (cache == NULL) return;
+
+  CachedTree* tree = cache->oldest;
+  while (tree != NULL) {
+    CachedTree* newer = tree->newer;
+    freeTree(tree);
+    tree = newer;
+  }
+  pthread_mutex_destroy(&cache->lock);
+  pthread_cond_destroy(&cache->ready);
+  free(cache->buckets);
+  free(cache);
+}
@@ -0,0 +1,118 @@
+/*
+ * Header file for a shared cache of shortest path trees.
+ *
+ * A TreeCache keeps the shortest path trees of recently requested sources,
+ * each as two ints per vertex (the distance and the parent), keyed by the
+ * source and by a version number of the graph, such as the version of a
+ * GraphSnapshot, so that trees of an old version are never served for a new
+ * one. The trees together stay within a byte budget: when a new tree does
+ * not fit, trees are evicted, either the least recently used (CACHE_LRU) or
+ * the least often used (CACHE_LFU), ties going to the least recently used.
+ *
+ * Any number of threads may look trees up at once. A lookup takes the cache
+ * lock only to find the tree and pin it; distance and path queries on a
+ * pinned tree take no lock, since a tree never changes once computed, and a
+ * tree evicted while pinned is freed when its last user releases it. On a
+ * miss the tree is computed outside the lock, and other threads asking for
+ * the same tree meanwhile wait for it rather than computing it again.
+ *
+ * Compile with -pthread.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Cache_header
+#define __Graph_Cache_header
+
+typedef enum cache_policy {
+  CACHE_LRU,  // evict the least recently used tree
+  CACHE_LFU   // evict the least often used tree
+} CachePolicy;
+
+typedef struct cached_tree {
+  int source;                 // start vertex of the search
+  unsigned long version;      // version of the graph searched
+  int numVertices;            // total number of vertices
+  int* distances;             // distances[id] is the distance to id, or
+                              //   INT_MAX if id is not reachable
+  int* parents;               // parents[id] is the vertex before id on a
+                              //   shortest path, or -1
+  size_t bytes;               // memory held by the tree
+  bool ready;                 // false while the tree is being computed
+  bool evicted;               // true once removed from the cache
+  int numUsers;               // number of lookups not yet released
+  long long numUses;          // number of lookups, for CACHE_LFU
+  struct cached_tree* newer;  // neighbours in the order of use, most
+  struct cached_tree* older;  //   recent first
+  struct cached_tree* next;   // next tree in the same hash bucket
+} CachedTree;
+
+typedef struct cache_stats {
+  long long numHits;       // lookups served from the cache
+  long long numMisses;     // lookups that computed their tree
+  long long numEvictions;  // trees evicted
+  int numTrees;            // trees in the cache
+  size_t bytesUsed;        // memory held by the trees in the cache
+  double hitRate;          // numHits / (numHits + numMisses), or 0
+} CacheStats;
+
+typedef struct tree_cache {
+  CachePolicy policy;    // which tree to evict
+  size_t budget;         // bytes the trees may hold together
+  int numBuckets;        // number of hash buckets
+  CachedTree** buckets;  // trees by hash of source and version
+  CachedTree* newest;    // the most recently used tree
+  CachedTree* oldest;    // the least recently used tree
+  pthread_mutex_t lock;  // guards everything but the trees' contents
+  pthread_cond_t ready;  // signalled when a tree has been computed
+  CacheStats stats;      // lookups and memory so far
+} TreeCache;
+
+/* Returns a new empty TreeCache whose trees hold at most 'budget' bytes
+ * together, evicting by policy 'policy'.
+ */
+TreeCache* newTreeCache(size_t budget, CachePolicy policy);
+
+/* Returns the shortest path tree from vertex with ID 'source' of Graph
+ * 'graph', which is version 'version' of its graph, from 'cache' if it is
+ * there and computed by Dijkstra's algorithm otherwise. The tree is pinned
+ * until releaseCachedTree is called. A tree larger than the whole budget
+ * is returned but not kept.
+ * Returns NULL if 'source' is not valid in 'graph'.
+ * Precondition: no edge weight is negative, and every version number is
+ *   used for one graph only
+ */
+CachedTree* getCachedTree(TreeCache* cache, Graph* graph,
+                          unsigned long version, int source);
+
+/* Unpins 'tree', which was returned by getCachedTree on 'cache'. */
+void releaseCachedTree(TreeCache* cache, CachedTree* tree);
+
+/* Returns the distance from the source of 'tree' to vertex with ID
+ * 'target', or INT_MAX if 'target' is not reachable or not valid.
+ */
+int getCachedDistance(CachedTree* tree, int target);
+
+/* Returns a shortest path from vertex with ID 'target' back to the source
+ * of 'tree', in the format of the paths of getShortestPaths.
+ * Returns NULL if 'target' is the source, not reachable, or not valid.
+ */
+EdgeList* getCachedPath(CachedTree* tree, int target);
+
+/* Evicts from 'cache' every tree of a version older than 'version', and
+ * returns their number.
+ */
+int evictOldVersions(TreeCache* cache, unsigned long version);
+
+/* Returns the lookups, evictions and memory of 'cache' so far. */
+CacheStats getCacheStats(TreeCache* cache);
+
+/* Frees all memory allocated for 'cache'. No tree may still be pinned. */
+void deleteTreeCache(TreeCache* cache);
+
+#endif
@@ -0,0 +1,289 @@
+/*
+ *  Benchmark of the shortest path tree cache of graph_cache.h.
+ *
+ *  Builds a random graph and a stream of distance queries whose sources
+ *  follow a Zipf distribution over a set of candidate sources, as hubs are
+ *  asked for far more often than other vertices. Times the queries without
+ *  a cache, with getDistanceTreeDijkstra each, and then with a TreeCache
+ *  under both eviction policies and several numbers of threads, and prints
+ *  the throughput and hit rate. Checks the cached distances of the first
+ *  queries against the searches, and that all runs agree.
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O3 -Wall -Werror -pthread graph.c minheap.c graph_algos.c \
+ *       graph_build.c graph_queue.c graph_cache.c graph_cache_bench.c \
+ *       -o graph_cache_bench
+ *
+ *   Run:
+ *   ./graph_cache_bench [numVertices] [cachedTrees]
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "graph.h"
+#include "graph_algos.h"
+#include "graph_build.h"
+#include "graph_cache.h"
+
+#define NOTHING -1
+#define DEFAULT_VERTICES 20000
+#define DEFAULT_TREES 32
+#define AVERAGE_DEGREE 8
+#define MAX_WEIGHT 1000
+#define NUM_CANDIDATES 200   // vertices that may be asked for as sources
+#define NUM_QUERIES 2000     // queries in the stream
+#define UNCACHED_QUERIES 20  // queries timed without a cache
+#define MAX_THREADS 4
+
+typedef struct query {
+  int source;  // start vertex
+  int target;  // vertex whose distance is asked for
+} Query;
+
+typedef struct query_task {  // one thread's share of the stream
+  TreeCache* cache;      // the cache shared by all threads
+  Graph* graph;          // the graph queried
+  const Query* queries;  // the whole stream
+  int first;             // this thread answers queries
+  int last;              //   first .. last-1
+  long long total;       // sum of the distances it found
+} QueryTask;
+
+/* graphs */
+Graph* randomGraph(int numVertices, uint64_t* state);
+Query* zipfQueries(int numVertices, uint64_t* state);
+uint64_t nextRandom(uint64_t* state);
+
+/* measuring */
+void* runQueryTask(void* arg);
+bool timeCache(Graph* graph, const Query* queries, CachePolicy policy,
+               size_t budget, int numThreads, long long* expected,
+               double baseTime);
+double nowSeconds(void);
+
+int main(int argc, char* argv[]) {
+  int numVertices = argc > 1 ? atoi(argv[1]) : DEFAULT_VERTICES;
+  int numTrees = argc > 2 ? atoi(argv[2]) : DEFAULT_TREES;
+  if (numVertices < NUM_CANDIDATES || numTrees < 1) {
+    printf("Usage: %s [numVertices >= %d] [cachedTrees >= 1]\n", argv[0],
+           NUM_CANDIDATES);
+    return 1;
+  }
+
+  uint64_t state = 88172645463325252ULL;
+  Graph* graph = randomGraph(numVertices, &state);
+  Query* queries = zipfQueries(numVertices, &state);
+  size_t budget =
+      numTrees * (sizeof(CachedTree) + 2 * sizeof(int) * (size_t)numVertices);
+  printf("%d vertices, %d edges, %d queries, budget %d trees (%.1f MB)\n\n",
+         numVertices, graph->numEdges, NUM_QUERIES, numTrees, budget / 1e6);
+
+  // without a cache every query runs a search; a few are enough to time
+  long long searched = 0;
+  int* distances = (int*)malloc(sizeof(int) * numVertices);
+  if (distances == NULL) {
+    printf("Error: Memory allocation failed for distances\n");
+    exit(1);
+  }
+  double start = nowSeconds();
+  for (int q = 0; q < UNCACHED_QUERIES; q++) {
+    Edge* tree = getDistanceTreeDijkstra(graph, queries[q].source);
+    distances[queries[q].source] = 0;
+    for (int i = 0; i < numVertices - 1; i++) {
+      distances[tree[i].toVertex] =
+          distances[tree[i].fromVertex] + tree[i].weight;
+    }
+    searched += distances[queries[q].target];
+    free(tree);
+  }
+  double baseTime = (nowSeconds() - start) / UNCACHED_QUERIES;
+  free(distances);
+  printf("%-26s %10.0f queries/s\n", "getDistanceTreeDijkstra", 1 / baseTime);
+
+  TreeCache* check = newTreeCache(budget, CACHE_LRU);
+  QueryTask task = {check, graph, queries, 0, UNCACHED_QUERIES, 0};
+  runQueryTask(&task);
+  deleteTreeCache(check);
+  if (task.total != searched) {
+    printf("Cached distances disagree: %lld, expected %lld\n", task.total,
+           searched);
+    return 1;
+  }
+
+  CachePolicy policies[] = {CACHE_LRU, CACHE_LFU};
+  bool agree = true;
+  long long expected = NOTHING;  // the sum of the first run
+  for (int p = 0; p < 2; p++) {
+    for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+      agree &= timeCache(graph, queries, policies[p], budget, threads,
+                         &expected, baseTime);
+    }
+  }
+
+  free(queries);
+  deleteGraph(graph);
+  return agree ? 0 : 1;
+}
+
+/* Returns a random connected undirected graph on 'numVertices' vertices
+ * with average degree AVERAGE_DEGREE and weights in [1, MAX_WEIGHT]: a
+ * cycle through all vertices in random order, plus random edges.
+ */
+Graph* randomGraph(int numVertices, uint64_t* state) {
+  int numEdges = numVertices / 2 * AVERAGE_DEGREE;
+  int* from = (int*)malloc(sizeof(int) * numEdges);
+  int* to = (int*)malloc(sizeof(int) * numEdges);
+  int* weights = (int*)malloc(sizeof(int) * numEdges);
+  if (from == NULL || to == NULL || weights == NULL) {
+    printf("Error: Memory allocation failed for random edges\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) to[i] = i;
+  for (int i = numVertices - 1; i > 0; i--) {
+    int j = (int)(nextRandom(state) % (i + 1));
+    int swap = to[i];
+    to[i] = to[j];
+    to[j] = swap;
+  }
+  for (int i = 0; i < numEdges; i++) {
+    if (i < numVertices) {
+      from[i] = to[(i + 1) % numVertices];
+    } else {
+      from[i] = (int)(nextRandom(state) % numVertices);
+      to[i] = (int)(nextRandom(state) % numVertices);
+    }
+    weights[i] = 1 + (int)(nextRandom(state) % MAX_WEIGHT);
+  }
+
+  int options = BUILD_SYMMETRIZE | BUILD_DEDUPLICATE | BUILD_DROP_SELF_LOOPS;
+  CompactGraph* compact = buildCompactGraph(numVertices, numEdges, from, to,
+                                            weights, options, 1);
+  Graph* graph = newGraphFromCompact(compact);
+  deleteCompactGraph(compact);
+  free(from);
+  free(to);
+  free(weights);
+  return graph;
+}
+
+/* Returns NUM_QUERIES queries on a graph of 'numVertices' vertices, each
+ * to a random target from one of NUM_CANDIDATES random sources, the one of
+ * rank r with probability proportional to 1 / r.
+ */
+Query* zipfQueries(int numVertices, uint64_t* state) {
+  int candidates[NUM_CANDIDATES];
+  double cumulative[NUM_CANDIDATES];
+  double sum = 0;
+  for (int r = 0; r < NUM_CANDIDATES; r++) {
+    candidates[r] = (int)(nextRandom(state) % numVertices);
+    sum += 1.0 / (r + 1);
+    cumulative[r] = sum;
+  }
+
+  Query* queries = (Query*)malloc(sizeof(Query) * NUM_QUERIES);
+  if (queries == NULL) {
+    printf("Error: Memory allocation failed for queries\n");
+    exit(1);
+  }
+  for (int q = 0; q < NUM_QUERIES; q++) {
+    double x = (nextRandom(state) >> 11) * 0x1.0p-53 * sum;
+    int low = 0;
+    int high = NUM_CANDIDATES - 1;
+    while (low < high) {
+      int middle = (low + high) / 2;
+      if (cumulative[middle] < x) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    queries[q].source = candidates[low];
+    queries[q].target = (int)(nextRandom(state) % numVertices);
+  }
+  return queries;
+}
+
+/* Answers the queries of one QueryTask through its cache, building the
+ * path of every query as a client would.
+ */
+void* runQueryTask(void* arg) {
+  QueryTask* task = (QueryTask*)arg;
+  task->total = 0;
+  for (int q = task->first; q < task->last; q++) {
+    CachedTree* tree = getCachedTree(task->cache, task->graph, 0,
+                                     task->queries[q].source);
+    int target = task->queries[q].target;
+    task->total += getCachedDistance(tree, target);
+    EdgeList* path = getCachedPath(tree, target);
+    deleteEdgeList(path);
+    releaseCachedTree(task->cache, tree);
+  }
+  return NULL;
+}
+
+/* Answers all 'queries' on 'graph' with 'numThreads' threads sharing a
+ * TreeCache of 'budget' bytes with policy 'policy', and prints the
+ * throughput against one search per query taking 'baseTime', and the hit
+ * rate. Returns false if the distances do not sum to 'expected', or stores
+ * their sum there if it is NOTHING.
+ */
+bool timeCache(Graph* graph, const Query* queries, CachePolicy policy,
+               size_t budget, int numThreads, long long* expected,
+               double baseTime) {
+  TreeCache* cache = newTreeCache(budget, policy);
+  QueryTask tasks[numThreads];
+  pthread_t threads[numThreads];
+  double start = nowSeconds();
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t] = (QueryTask){cache, graph, queries,
+                           (int)((long long)NUM_QUERIES * t / numThreads),
+                           (int)((long long)NUM_QUERIES * (t + 1) /
+                                 numThreads),
+                           0};
+    if (pthread_create(&threads[t], NULL, runQueryTask, &tasks[t]) != 0) {
+      printf("Error: Could not create query thread\n");
+      exit(1);
+    }
+  }
+  long long total = 0;
+  for (int t = 0; t < numThreads; t++) {
+    pthread_join(threads[t], NULL);
+    total += tasks[t].total;
+  }
+  double seconds = nowSeconds() - start;
+  CacheStats stats = getCacheStats(cache);
+  deleteTreeCache(cache);
+  if (*expected == NOTHING) *expected = total;
+
+  char name[32];
+  snprintf(name, sizeof(name), "%s, %d threads",
+           policy == CACHE_LRU ? "LRU" : "LFU", numThreads);
+  printf("%-26s %10.0f queries/s  %6.1fx  hit rate %5.1f%%  %6lld "
+         "evictions%s\n", name, NUM_QUERIES / seconds,
+         baseTime * NUM_QUERIES / seconds, 100 * stats.hitRate,
+         stats.numEvictions, total == *expected ? "" : "  (disagrees)");
+  return total == *expected;
+}
+
+/* Returns the next value of the xorshift generator with state 'state'. */
+uint64_t nextRandom(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,346 @@
+/*
+ * Parallel betweenness centrality (Brandes' algorithm).
+ *
+ * The graph is copied into forward and reverse CSR arrays first. Instead of
+ * keeping a list of shortest-path predecessors per vertex, accumulation
+ * scans the reverse arcs of each vertex and keeps those that are tight and
+ * come from a vertex settled earlier, which are exactly the arcs the
+ * forward search counted paths along.
+ */
+
+#include <limits.h>
+#include <pthread.h>
+#include <string.h>
+
+#include "graph_centrality.h"
+#include "minheap.h"
+
+#define NOTHING -1
+
+typedef struct reverse_arc {
+  int tail;    // ID of the tail of this arc
+  int weight;  // weight of this arc
+  int index;   // position of this arc in the forward arrays
+} ReverseArc;
+
+typedef struct brandes_graph {  // CSR copy of the graph
+  int numVertices;     // total number of vertices
+  int* offsets;        // arcs leaving id are at positions
+                       //   offsets[id] .. offsets[id+1] of the two arrays
+  int* heads;          // heads[i] is the head of forward arc i
+  int* weights;        // weights[i] is the weight of forward arc i
+  int* inOffsets;      // arcs entering id are at positions
+                       //   inOffsets[id] .. inOffsets[id+1] of 'inArcs'
+  ReverseArc* inArcs;  // arcs grouped by head
+} BrandesGraph;
+
+typedef struct brandes_task {  // one thread's share of the sources
+  BrandesGraph* graph;   // graph being scored
+  int* sources;          // all sources
+  int numSources;        // number of sources
+  int first;             // this thread handles source 'first',
+  int stride;            //   then every 'stride'-th one after it
+  MinHeap* heap;         // priority queue of reached, unfinished vertices
+  int* distances;        // distances[id] from the current source
+  double* numPaths;      // numPaths[id] is the number of shortest paths
+                         //   from the current source to id
+  double* dependencies;  // dependencies[id] accumulated for the source
+  int* order;            // vertices in the order they were settled
+  int* positions;        // positions[id] is the index of id in 'order',
+                         //   or -1 if not settled
+  double* vertexScores;  // this thread's partial vertex scores
+  double* edgeScores;    // this thread's partial edge scores
+} BrandesTask;
+
+/*************************************************************************
+ ** Brandes searches
+ *************************************************************************/
+
+/* Adds the dependencies of every vertex on source 's' to the partial
+ * scores of 'task'.
+ */
+static void runBrandesSource(BrandesTask* task, int s) {
+  BrandesGraph* graph = task->graph;
+  MinHeap* heap = task->heap;
+  int* distances = task->distances;
+  double* numPaths = task->numPaths;
+
+  int numSettled = 0;
+  distances[s] = 0;
+  numPaths[s] = 1;
+  insert(heap, 0, s);
+
+  while (heap->size > 0) {
+    HeapNode minNode = extractMin(heap);
+    int v = minNode.id;
+    int currDis = minNode.priority;
+    task->positions[v] = numSettled;
+    task->order[numSettled++] = v;
+
+    for (int i = graph->offsets[v]; i < graph->offsets[v + 1]; i++) {
+      int to = graph->heads[i];
+      int weight = graph->weights[i];
+      if (task->positions[to] != NOTHING || weight > INT_MAX - 1 - currDis ||
+          currDis + weight > distances[to]) {
+        continue;
+      }
+      if (currDis + weight == distances[to]) {
+        numPaths[to] += numPaths[v];
+        continue;
+      }
+      if (distances[to] == INT_MAX) {
+        insert(heap, currDis + weight, to);
+      } else {
+        decreasePriority(heap, to, currDis + weight);
+      }
+      distances[to] = currDis + weight;
+      numPaths[to] = numPaths[v];
+    }
+  }
+
+  // accumulate dependencies, farthest vertices first
+  double* dependencies = task->dependencies;
+  for (int k = numSettled - 1; k >= 0; k--) {
+    int w = task->order[k];
+    double factor = (1 + dependencies[w]) / numPaths[w];
+    for (int i = graph->inOffsets[w]; i < graph->inOffsets[w + 1]; i++) {
+      ReverseArc* arc = &graph->inArcs[i];
+      int v = arc->tail;
+      if (task->positions[v] == NOTHING || task->positions[v] >= k ||
+          arc->weight > INT_MAX - 1 - distances[v] ||
+          distances[v] + arc->weight != distances[w]) {
+        continue;
+      }
+      double share = numPaths[v] * factor;
+      task->edgeScores[arc->index] += share;
+      dependencies[v] += share;
+    }
+    if (w != s) task->vertexScores[w] += dependencies[w];
+  }
+
+  for (int k = 0; k < numSettled; k++) {
+    int id = task->order[k];
+    distances[id] = INT_MAX;
+    numPaths[id] = 0;
+    dependencies[id] = 0;
+    task->positions[id] = NOTHING;
+    heap->indexMap[id] = NOTHING;
+  }
+}
+
+/* Runs the searches of this thread's share of the sources. */
+static void* runBrandesTask(void* arg) {
+  BrandesTask* task = (BrandesTask*)arg;
+  for (int i = task->first; i < task->numSources; i += task->stride) {
+    runBrandesSource(task, task->sources[i]);
+  }
+  return NULL;
+}
+
+/*************************************************************************
+ ** Setup
+ *************************************************************************/
+
+/* Copies the edges of 'graph' into 'brandes' and 'edges'. */
+static void buildBrandesGraph(Graph* graph, BrandesGraph* brandes,
+                              Edge* edges) {
+  int numVertices = graph->numVertices;
+  brandes->numVertices = numVertices;
+  brandes->offsets = (int*)calloc(numVertices + 1, sizeof(int));
+  brandes->inOffsets = (int*)calloc(numVertices + 1, sizeof(int));
+  if (brandes->offsets == NULL || brandes->inOffsets == NULL) {
+    printf("Error: Memory allocation failed for centrality offsets\n");
+    exit(1);
+  }
+
+  int numArcs = 0;
+  for (int v = 0; v < numVertices; v++) {
+    brandes->offsets[v] = numArcs;
+    if (graph->vertices[v] == NULL) continue;
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      edges[numArcs].fromVertex = v;
+      edges[numArcs].toVertex = e->edge->toVertex;
+      edges[numArcs].weight = e->edge->weight;
+      brandes->inOffsets[e->edge->toVertex + 1]++;
+      numArcs++;
+    }
+  }
+  brandes->offsets[numVertices] = numArcs;
+  for (int v = 0; v < numVertices; v++) {
+    brandes->inOffsets[v + 1] += brandes->inOffsets[v];
+  }
+
+  brandes->heads = (int*)malloc(sizeof(int) * (numArcs + 1));
+  brandes->weights = (int*)malloc(sizeof(int) * (numArcs + 1));
+  brandes->inArcs = (ReverseArc*)malloc(sizeof(ReverseArc) * (numArcs + 1));
+  int* next = (int*)malloc(sizeof(int) * (numVertices + 1));
+  if (brandes->heads == NULL || brandes->weights == NULL ||
+      brandes->inArcs == NULL || next == NULL) {
+    printf("Error: Memory allocation failed for centrality arcs\n");
+    exit(1);
+  }
+  memcpy(next, brandes->inOffsets, sizeof(int) * (numVertices + 1));
+  for (int i = 0; i < numArcs; i++) {
+    brandes->heads[i] = edges[i].toVertex;
+    brandes->weights[i] = edges[i].weight;
+    ReverseArc* arc = &brandes->inArcs[next[edges[i].toVertex]++];
+    arc->tail = edges[i].fromVertex;
+    arc->weight = edges[i].weight;
+    arc->index = i;
+  }
+  free(next);
+}
+
+/* Returns 'numSamples' distinct vertex IDs below 'numVertices' drawn with
+ * 'seed', or all of them if 'numSamples' is not in 1 .. numVertices-1, and
+ * stores how many in 'numSources'.
+ */
+static int* pickSources(int numVertices, int numSamples, unsigned int seed,
+                        int* numSources) {
+  int* sources = (int*)malloc(sizeof(int) * (numVertices + 1));
+  if (sources == NULL) {
+    printf("Error: Memory allocation failed for centrality sources\n");
+    exit(1);
+  }
+  for (int v = 0; v < numVertices; v++) sources[v] = v;
+
+  if (numSamples <= 0 || numSamples >= numVertices) {
+    *numSources = numVertices;
+    return sources;
+  }
+
+  // partial Fisher-Yates shuffle with a xorshift generator
+  unsigned int x = seed != 0 ? seed : 2463534242u;
+  for (int i = 0; i < numSamples; i++) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    int j = i + (int)(x % (unsigned int)(numVertices - i));
+    int tmp = sources[i];
+    sources[i] = sources[j];
+    sources[j] = tmp;
+  }
+  *numSources = numSamples;
+  return sources;
+}
+
+CentralityScores* getBetweenness(Graph* graph, int numSamples,
+                                 unsigned int seed, int numThreads) {
+  if (numThreads < 1) return NULL;
+
+  CentralityScores* scores =
+      (CentralityScores*)malloc(sizeof(CentralityScores));
+  if (scores == NULL) {
+    printf("Error: Memory allocation failed for centrality scores\n");
+    exit(1);
+  }
+
+  int numVertices = graph->numVertices;
+  int numEdges = 0;
+  for (int v = 0; v < numVertices; v++) {
+    if (graph->vertices[v] == NULL) continue;
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      numEdges++;
+    }
+  }
+
+  scores->numVertices = numVertices;
+  scores->numEdges = numEdges;
+  scores->edges = (Edge*)malloc(sizeof(Edge) * (numEdges + 1));
+  if (scores->edges == NULL) {
+    printf("Error: Memory allocation failed for centrality edges\n");
+    exit(1);
+  }
+
+  BrandesGraph brandes;
+  buildBrandesGraph(graph, &brandes, scores->edges);
+  int numSources = 0;
+  int* sources = pickSources(numVertices, numSamples, seed, &numSources);
+  scores->numSources = numSources;
+
+  BrandesTask tasks[numThreads];
+  pthread_t threads[numThreads];
+  for (int t = 0; t < numThreads; t++) {
+    BrandesTask* task = &tasks[t];
+    task->graph = &brandes;
+    task->sources = sources;
+    task->numSources = numSources;
+    task->first = t;
+    task->stride = numThreads;
+    task->heap = newHeap(numVertices);
+    task->distances = (int*)malloc(sizeof(int) * (numVertices + 1));
+    task->numPaths = (double*)calloc(numVertices + 1, sizeof(double));
+    task->dependencies = (double*)calloc(numVertices + 1, sizeof(double));
+    task->order = (int*)malloc(sizeof(int) * (numVertices + 1));
+    task->positions = (int*)malloc(sizeof(int) * (numVertices + 1));
+    task->vertexScores = (double*)calloc(numVertices + 1, sizeof(double));
+    task->edgeScores = (double*)calloc(numEdges + 1, sizeof(double));
+    if (task->distances == NULL || task->numPaths == NULL ||
+        task->dependencies == NULL || task->order == NULL ||
+        task->positions == NULL || task->vertexScores == NULL ||
+        task->edgeScores == NULL) {
+      printf("Error: Memory allocation failed for centrality workspace\n");
+      exit(1);
+    }
+    for (int v = 0; v < numVertices; v++) {
+      task->distances[v] = INT_MAX;
+      task->positions[v] = NOTHING;
+    }
+  }
+
+  for (int t = 1; t < numThreads; t++) {
+    if (pthread_create(&threads[t], NULL, runBrandesTask, &tasks[t]) != 0) {
+      printf("Error: Could not create centrality worker thread\n");
+      exit(1);
+    }
+  }
+  runBrandesTask(&tasks[0]);
+  for (int t = 1; t < numThreads; t++) pthread_join(threads[t], NULL);
+
+  // sum the partial scores into those of the first thread
+  double scale = numSources < numVertices && numSources > 0
+                     ? (double)numVertices / numSources
+                     : 1.0;
+  scores->vertexScores = tasks[0].vertexScores;
+  scores->edgeScores = tasks[0].edgeScores;
+  for (int t = 1; t < numThreads; t++) {
+    for (int v = 0; v < numVertices; v++) {
+      scores->vertexScores[v] += tasks[t].vertexScores[v];
+    }
+    for (int i = 0; i < numEdges; i++) {
+      scores->edgeScores[i] += tasks[t].edgeScores[i];
+    }
+    free(tasks[t].vertexScores);
+    free(tasks[t].edgeScores);
+  }
+  if (scale != 1.0) {
+    for (int v = 0; v < numVertices; v++) scores->vertexScores[v] *= scale;
+    for (int i = 0; i < numEdges; i++) scores->edgeScores[i] *= scale;
+  }
+
+  for (int t = 0; t < numThreads; t++) {
+    deleteHeap(tasks[t].heap);
+    free(tasks[t].distances);
+    free(tasks[t].numPaths);
+    free(tasks[t].dependencies);
+    free(tasks[t].order);
+    free(tasks[t].positions);
+  }
+  free(sources);
+  free(brandes.offsets);
+  free(brandes.heads);
+  free(brandes.weights);
+  free(brandes.inOffsets);
+  free(brandes.inArcs);
+
+  return scores;
+}
+
+void deleteCentralityScores(CentralityScores* scores) {
+  if (scores == NULL) return;
+
+  free(scores->vertexScores);
+  free(scores->edgeScores);
+  free(scores->edges);
+  free(scores);
+}
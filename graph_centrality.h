@@ -0,0 +1,51 @@
+/*
+ * Header file for betweenness centrality.
+ *
+ * Scores are computed with Brandes' algorithm for weighted graphs: one
+ * Dijkstra search per source that also counts shortest paths, followed by
+ * accumulation of dependencies in reverse settle order. Sources are split
+ * across threads, each with its own workspace and partial scores, and the
+ * partial scores are summed at the end.
+ *
+ * Compile with -pthread.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Centrality_header
+#define __Graph_Centrality_header
+
+typedef struct centrality_scores {
+  int numVertices;       // total number of vertices
+  int numEdges;          // total number of edges
+  int numSources;        // number of sources the scores were computed from
+  double* vertexScores;  // vertexScores[id] is the betweenness of vertex id
+  Edge* edges;           // every edge of the graph, by 'fromVertex' and
+                         //   then in adjacency list order
+  double* edgeScores;    // edgeScores[i] is the betweenness of edges[i]
+} CentralityScores;
+
+/* Returns the betweenness centrality of every vertex and edge of Graph
+ * 'graph': the sum, over ordered pairs of distinct vertices (s, t), of the
+ * fraction of shortest s-t paths through it. Each direction of an
+ * undirected edge counts as its own pair, so undirected scores are twice
+ * the usual ones.
+ * If 0 < 'numSamples' < numVertices, only 'numSamples' sources drawn at
+ * random with 'seed' are searched and the scores are scaled up to estimate
+ * the exact ones; otherwise every vertex is a source.
+ * Sources are split across 'numThreads' threads.
+ * Returns NULL if 'numThreads' < 1.
+ * Precondition: every edge weight is positive; shortest paths that use
+ *   zero-weight edges may not all be counted
+ */
+CentralityScores* getBetweenness(Graph* graph, int numSamples,
+                                 unsigned int seed, int numThreads);
+
+/* Frees all memory allocated for 'scores'. */
+void deleteCentralityScores(CentralityScores* scores);
+
+#endif
@@ -0,0 +1,1072 @@
+/*
+ * Contraction Hierarchies.
+ *
+ * Preprocessing works on a mutable copy of the graph with in- and out-arc
+ * lists per vertex. Each round contracts an independent set of vertices
+ * whose priority is smaller than that of all their neighbours, so the
+ * witness searches of one round only read the graph and can run on several
+ * threads. Witnesses must be strictly shorter than the path through the
+ * contracted vertex; with ties, two vertices of the same round could
+ * otherwise each rely on a path through the other.
+ */
+
+#include <limits.h>
+#include <pthread.h>
+#include <string.h>
+
+#include "graph_ch.h"
+#include "minheap.h"
+
+#define NOTHING -1
+#define CH_MAGIC "GRCH"
+#define CH_VERSION 1
+#define WITNESS_SETTLE_LIMIT 500
+
+typedef struct ch_arc_list {  // growable array of arcs
+  int size;      // number of arcs in this list
+  int capacity;  // number of arcs that fit in 'arcs'
+  ChArc* arcs;   // the arcs of this list
+} ChArcList;
+
+typedef struct ch_shortcut {  // shortcut found while contracting a vertex
+  int fromVertex;  // ID of the tail of this shortcut
+  int toVertex;    // ID of the head of this shortcut
+  int weight;      // weight of this shortcut
+} ChShortcut;
+
+typedef struct ch_shortcut_list {  // growable array of shortcuts
+  int size;               // number of shortcuts in this list
+  int capacity;           // number of shortcuts that fit in 'shortcuts'
+  ChShortcut* shortcuts;  // the shortcuts of this list
+} ChShortcutList;
+
+typedef struct ch_witness {  // per-thread state for witness searches
+  MinHeap* heap;   // priority queue of reached, unfinished vertices
+  int* distances;  // distances[id] is the tentative distance of vertex id
+  int* touched;    // ids of all vertices reached by the current search
+  int numTouched;  // number of vertices in 'touched'
+} ChWitness;
+
+typedef struct ch_builder {
+  int numVertices;          // total number of vertices in the graph
+  ChArcList* out;           // out[id] holds arcs (id -> head) among the
+                            //   vertices not yet contracted
+  ChArcList* in;            // in[id] holds arcs (head -> id) among the
+                            //   vertices not yet contracted
+  ChArcList* up;            // up[id] holds the out-arcs of id when it was
+                            //   contracted
+  ChArcList* down;          // down[id] holds the in-arcs of id when it was
+                            //   contracted
+  bool* contracted;         // contracted[id] is true iff id is contracted
+  int* priorities;          // priorities[id] is the contraction priority
+  int* deletedNeighbors;    // number of contracted neighbours of id
+  int* ranks;               // ranks[id] is the contraction order of id
+  ChShortcutList* pending;  // pending[i] holds the shortcuts of the i-th
+                            //   vertex contracted in the current round
+} ChBuilder;
+
+typedef struct ch_task {  // one thread's share of a contraction round
+  ChBuilder* builder;  // hierarchy under construction
+  ChWitness* witness;  // witness search state owned by this thread
+  int* vertices;       // vertices processed in this round
+  int numVertices;     // number of vertices in 'vertices'
+  int first;           // this thread handles vertices[first], then every
+  int stride;          //   'stride'-th vertex after it
+  bool store;          // true to contract, false to update priorities
+} ChTask;
+
+struct ch_search {
+  int numVertices;       // total number of vertices in the hierarchy
+  MinHeap* heaps[2];     // forward and backward priority queues
+  int* distances[2];     // tentative distances of both searches
+  int* predecessors[2];  // previous vertex towards each search's start
+  int* predArcs[2];      // index of the arc used to reach each vertex
+  int* touched[2];       // vertices reached by each search
+  int numTouched[2];     // number of vertices in 'touched'
+};
+
+/*************************************************************************
+ ** Arc lists
+ *************************************************************************/
+
+/* Appends arc ('head', 'weight', 'middle') to 'list'. */
+static void appendArc(ChArcList* list, int head, int weight, int middle) {
+  if (list->size == list->capacity) {
+    list->capacity = list->capacity == 0 ? 4 : list->capacity * 2;
+    list->arcs = (ChArc*)realloc(list->arcs, sizeof(ChArc) * list->capacity);
+    if (list->arcs == NULL) {
+      printf("Error: Memory allocation failed for arc list\n");
+      exit(1);
+    }
+  }
+  list->arcs[list->size].head = head;
+  list->arcs[list->size].weight = weight;
+  list->arcs[list->size].middle = middle;
+  list->size++;
+}
+
+/* Adds arc ('head', 'weight', 'middle') to 'list', or lowers the weight of
+ * the arc to 'head' already in 'list'. Returns true iff a new arc was
+ * added.
+ */
+static bool setArc(ChArcList* list, int head, int weight, int middle) {
+  for (int i = 0; i < list->size; i++) {
+    if (list->arcs[i].head == head) {
+      if (weight < list->arcs[i].weight) {
+        list->arcs[i].weight = weight;
+        list->arcs[i].middle = middle;
+      }
+      return false;
+    }
+  }
+  appendArc(list, head, weight, middle);
+  return true;
+}
+
+/* Removes the arc to 'head' from 'list', if there is one. */
+static void removeArc(ChArcList* list, int head) {
+  for (int i = 0; i < list->size; i++) {
+    if (list->arcs[i].head == head) {
+      list->arcs[i] = list->arcs[list->size - 1];
+      list->size--;
+      return;
+    }
+  }
+}
+
+/* Appends shortcut ('fromVertex' -> 'toVertex', 'weight') to 'list'. */
+static void appendShortcut(ChShortcutList* list, int fromVertex, int toVertex,
+                           int weight) {
+  if (list->size == list->capacity) {
+    list->capacity = list->capacity == 0 ? 4 : list->capacity * 2;
+    list->shortcuts = (ChShortcut*)realloc(
+        list->shortcuts, sizeof(ChShortcut) * list->capacity);
+    if (list->shortcuts == NULL) {
+      printf("Error: Memory allocation failed for shortcut list\n");
+      exit(1);
+    }
+  }
+  list->shortcuts[list->size].fromVertex = fromVertex;
+  list->shortcuts[list->size].toVertex = toVertex;
+  list->shortcuts[list->size].weight = weight;
+  list->size++;
+}
+
+/* Returns 'count' newly created, empty lists of 'size' bytes each. */
+static void* newLists(int count, size_t size) {
+  void* lists = calloc(count + 1, size);
+  if (lists == NULL) {
+    printf("Error: Memory allocation failed for arc lists\n");
+    exit(1);
+  }
+  return lists;
+}
+
+/*************************************************************************
+ ** Witness searches
+ *************************************************************************/
+
+/* Returns newly created witness search state for 'numVertices' vertices. */
+static ChWitness* newChWitness(int numVertices) {
+  ChWitness* witness = (ChWitness*)malloc(sizeof(ChWitness));
+  if (witness == NULL) {
+    printf("Error: Memory allocation failed for witness search\n");
+    exit(1);
+  }
+
+  witness->heap = newHeap(numVertices);
+  witness->distances = (int*)malloc(sizeof(int) * numVertices);
+  witness->touched = (int*)malloc(sizeof(int) * numVertices);
+  if (witness->distances == NULL || witness->touched == NULL) {
+    printf("Error: Memory allocation failed for witness arrays\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) witness->distances[i] = INT_MAX;
+  witness->numTouched = 0;
+
+  return witness;
+}
+
+/* Frees all memory allocated for 'witness'. */
+static void deleteChWitness(ChWitness* witness) {
+  deleteHeap(witness->heap);
+  free(witness->distances);
+  free(witness->touched);
+  free(witness);
+}
+
+/* Restores every vertex touched by the last search on 'witness'. */
+static void resetChWitness(ChWitness* witness) {
+  for (int i = 0; i < witness->numTouched; i++) {
+    int id = witness->touched[i];
+    witness->distances[id] = INT_MAX;
+    witness->heap->indexMap[id] = NOTHING;
+  }
+  witness->heap->size = 0;
+  witness->numTouched = 0;
+}
+
+/* Runs Dijkstra's algorithm from 'source' over the vertices not yet
+ * contracted, except 'skip', until every remaining vertex is farther than
+ * 'maxDist' or WITNESS_SETTLE_LIMIT vertices are finished. Distances are
+ * left in witness->distances; unfinished ones are upper bounds.
+ */
+static void runWitnessSearch(ChBuilder* builder, ChWitness* witness,
+                             int source, int skip, int maxDist) {
+  witness->distances[source] = 0;
+  witness->touched[witness->numTouched++] = source;
+  insert(witness->heap, 0, source);
+
+  int numSettled = 0;
+  while (witness->heap->size > 0 && numSettled < WITNESS_SETTLE_LIMIT) {
+    HeapNode minNode = extractMin(witness->heap);
+    int v = minNode.id;
+    int currDis = minNode.priority;
+    if (currDis > maxDist) break;
+    numSettled++;
+
+    ChArcList* arcs = &builder->out[v];
+    for (int i = 0; i < arcs->size; i++) {
+      int to = arcs->arcs[i].head;
+      int weight = arcs->arcs[i].weight;
+      if (to == skip || weight > INT_MAX - 1 - currDis ||
+          currDis + weight >= witness->distances[to]) {
+        continue;
+      }
+      if (witness->distances[to] == INT_MAX) {
+        witness->touched[witness->numTouched++] = to;
+        insert(witness->heap, currDis + weight, to);
+      } else {
+        decreasePriority(witness->heap, to, currDis + weight);
+      }
+      witness->distances[to] = currDis + weight;
+    }
+  }
+}
+
+/* Simulates contracting vertex 'v' and returns the number of shortcuts it
+ * needs. If 'shortcuts' is not NULL, the shortcuts are appended to it.
+ */
+static int contractVertex(ChBuilder* builder, ChWitness* witness, int v,
+                          ChShortcutList* shortcuts) {
+  ChArcList* in = &builder->in[v];
+  ChArcList* out = &builder->out[v];
+
+  int maxOut = 0;
+  for (int j = 0; j < out->size; j++) {
+    if (out->arcs[j].weight > maxOut) maxOut = out->arcs[j].weight;
+  }
+
+  int numShortcuts = 0;
+  for (int i = 0; i < in->size; i++) {
+    int u = in->arcs[i].head;
+    int toV = in->arcs[i].weight;
+
+    long long maxDist = (long long)toV + maxOut;
+    runWitnessSearch(builder, witness, u, v,
+                     maxDist >= INT_MAX ? INT_MAX - 1 : (int)maxDist);
+
+    for (int j = 0; j < out->size; j++) {
+      int w = out->arcs[j].head;
+      long long weight = (long long)toV + out->arcs[j].weight;
+      if (w == u || weight >= INT_MAX) continue;
+      if (witness->distances[w] < weight) continue;
+
+      numShortcuts++;
+      if (shortcuts != NULL) appendShortcut(shortcuts, u, w, (int)weight);
+    }
+    resetChWitness(witness);
+  }
+
+  return numShortcuts;
+}
+
+/*************************************************************************
+ ** Contraction
+ *************************************************************************/
+
+/* Returns a newly created builder holding the edges of Graph 'graph'.
+ * Self-loops are dropped and parallel edges keep their minimum weight.
+ */
+static ChBuilder* newChBuilder(Graph* graph) {
+  ChBuilder* builder = (ChBuilder*)malloc(sizeof(ChBuilder));
+  if (builder == NULL) {
+    printf("Error: Memory allocation failed for CH builder\n");
+    exit(1);
+  }
+
+  int numVertices = graph->numVertices;
+  builder->numVertices = numVertices;
+  builder->out = (ChArcList*)newLists(numVertices, sizeof(ChArcList));
+  builder->in = (ChArcList*)newLists(numVertices, sizeof(ChArcList));
+  builder->up = (ChArcList*)newLists(numVertices, sizeof(ChArcList));
+  builder->down = (ChArcList*)newLists(numVertices, sizeof(ChArcList));
+  builder->pending =
+      (ChShortcutList*)newLists(numVertices, sizeof(ChShortcutList));
+  builder->contracted = (bool*)calloc(numVertices + 1, sizeof(bool));
+  builder->priorities = (int*)calloc(numVertices + 1, sizeof(int));
+  builder->deletedNeighbors = (int*)calloc(numVertices + 1, sizeof(int));
+  builder->ranks = (int*)calloc(numVertices + 1, sizeof(int));
+  if (builder->contracted == NULL || builder->priorities == NULL ||
+      builder->deletedNeighbors == NULL || builder->ranks == NULL) {
+    printf("Error: Memory allocation failed for CH builder arrays\n");
+    exit(1);
+  }
+
+  for (int i = 0; i < numVertices; i++) {
+    if (graph->vertices[i] == NULL) continue;
+    for (EdgeList* e = graph->vertices[i]->adjList; e != NULL; e = e->next) {
+      int from = e->edge->fromVertex;
+      int to = e->edge->toVertex;
+      if (from == to) continue;
+      setArc(&builder->out[from], to, e->edge->weight, NOTHING);
+      setArc(&builder->in[to], from, e->edge->weight, NOTHING);
+    }
+  }
+
+  return builder;
+}
+
+/* Frees all memory allocated for 'builder'. */
+static void deleteChBuilder(ChBuilder* builder) {
+  for (int i = 0; i < builder->numVertices; i++) {
+    free(builder->out[i].arcs);
+    free(builder->in[i].arcs);
+    free(builder->up[i].arcs);
+    free(builder->down[i].arcs);
+    free(builder->pending[i].shortcuts);
+  }
+  free(builder->out);
+  free(builder->in);
+  free(builder->up);
+  free(builder->down);
+  free(builder->pending);
+  free(builder->contracted);
+  free(builder->priorities);
+  free(builder->deletedNeighbors);
+  free(builder->ranks);
+  free(builder);
+}
+
+/* Processes this thread's share of 'task': either contracts its vertices
+ * into builder->pending, or recomputes their priorities.
+ */
+static void* runChTask(void* arg) {
+  ChTask* task = (ChTask*)arg;
+  ChBuilder* builder = task->builder;
+
+  for (int i = task->first; i < task->numVertices; i += task->stride) {
+    int v = task->vertices[i];
+    if (task->store) {
+      builder->pending[i].size = 0;
+      contractVertex(builder, task->witness, v, &builder->pending[i]);
+    } else {
+      int numShortcuts = contractVertex(builder, task->witness, v, NULL);
+      int edgeDifference =
+          numShortcuts - builder->in[v].size - builder->out[v].size;
+      builder->priorities[v] = edgeDifference + builder->deletedNeighbors[v];
+    }
+  }
+  return NULL;
+}
+
+/* Runs 'store' tasks (see runChTask) on the 'numVertices' vertices in
+ * 'vertices' using 'numThreads' threads, each with its own witness state.
+ */
+static void runChRound(ChBuilder* builder, ChWitness** witnesses,
+                       int numThreads, int* vertices, int numVertices,
+                       bool store) {
+  ChTask tasks[numThreads];
+  pthread_t threads[numThreads];
+
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t].builder = builder;
+    tasks[t].witness = witnesses[t];
+    tasks[t].vertices = vertices;
+    tasks[t].numVertices = numVertices;
+    tasks[t].first = t;
+    tasks[t].stride = numThreads;
+    tasks[t].store = store;
+  }
+
+  if (numThreads == 1 || numVertices < numThreads) {
+    tasks[0].stride = 1;
+    runChTask(&tasks[0]);
+    return;
+  }
+
+  for (int t = 1; t < numThreads; t++) {
+    if (pthread_create(&threads[t], NULL, runChTask, &tasks[t]) != 0) {
+      printf("Error: Could not create CH worker thread\n");
+      exit(1);
+    }
+  }
+  runChTask(&tasks[0]);
+  for (int t = 1; t < numThreads; t++) pthread_join(threads[t], NULL);
+}
+
+/* Returns true iff 'a' comes before 'b' in the contraction order. */
+static bool contractsBefore(ChBuilder* builder, int a, int b) {
+  int pa = builder->priorities[a];
+  int pb = builder->priorities[b];
+  return pa < pb || (pa == pb && a < b);
+}
+
+/* Returns true iff 'v' comes before all of its remaining neighbours. */
+static bool isLocalMinimum(ChBuilder* builder, int v) {
+  ChArcList* lists[2] = {&builder->in[v], &builder->out[v]};
+  for (int l = 0; l < 2; l++) {
+    for (int i = 0; i < lists[l]->size; i++) {
+      if (!contractsBefore(builder, v, lists[l]->arcs[i].head)) return false;
+    }
+  }
+  return true;
+}
+
+/* Contracts vertex 'v', whose shortcuts are in 'shortcuts', giving it rank
+ * 'rank'. Neighbours of 'v' are appended to 'dirty' unless already marked
+ * in 'isDirty'; returns the new number of dirty vertices.
+ */
+static int applyContraction(ChBuilder* builder, int v, int rank,
+                            ChShortcutList* shortcuts, int* dirty,
+                            int numDirty, bool* isDirty) {
+  ChArcList* in = &builder->in[v];
+  ChArcList* out = &builder->out[v];
+
+  builder->contracted[v] = true;
+  builder->ranks[v] = rank;
+
+  // every remaining neighbour is contracted later, so these arcs are final
+  for (int i = 0; i < out->size; i++) {
+    ChArc* arc = &out->arcs[i];
+    appendArc(&builder->up[v], arc->head, arc->weight, arc->middle);
+    removeArc(&builder->in[arc->head], v);
+  }
+  for (int i = 0; i < in->size; i++) {
+    ChArc* arc = &in->arcs[i];
+    appendArc(&builder->down[v], arc->head, arc->weight, arc->middle);
+    removeArc(&builder->out[arc->head], v);
+  }
+
+  ChArcList* lists[2] = {in, out};
+  for (int l = 0; l < 2; l++) {
+    for (int i = 0; i < lists[l]->size; i++) {
+      int neighbor = lists[l]->arcs[i].head;
+      builder->deletedNeighbors[neighbor]++;
+      if (!isDirty[neighbor]) {
+        isDirty[neighbor] = true;
+        dirty[numDirty++] = neighbor;
+      }
+    }
+  }
+
+  for (int i = 0; i < shortcuts->size; i++) {
+    ChShortcut* s = &shortcuts->shortcuts[i];
+    setArc(&builder->out[s->fromVertex], s->toVertex, s->weight, v);
+    setArc(&builder->in[s->toVertex], s->fromVertex, s->weight, v);
+  }
+
+  free(in->arcs);
+  free(out->arcs);
+  in->arcs = out->arcs = NULL;
+  in->size = out->size = in->capacity = out->capacity = 0;
+
+  return numDirty;
+}
+
+/* Packs the arc lists 'lists' of 'numVertices' vertices into one array, and
+ * stores the start of each vertex's arcs in 'offsets'.
+ */
+static ChArc* packArcs(ChArcList* lists, int numVertices, int* offsets) {
+  offsets[0] = 0;
+  for (int i = 0; i < numVertices; i++) {
+    offsets[i + 1] = offsets[i] + lists[i].size;
+  }
+
+  ChArc* arcs = (ChArc*)malloc(sizeof(ChArc) * (offsets[numVertices] + 1));
+  if (arcs == NULL) {
+    printf("Error: Memory allocation failed for hierarchy arcs\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) {
+    if (lists[i].size == 0) continue;
+    memcpy(&arcs[offsets[i]], lists[i].arcs, sizeof(ChArc) * lists[i].size);
+  }
+  return arcs;
+}
+
+/* Returns a newly created, empty hierarchy for 'numVertices' vertices. */
+static ContractionHierarchy* allocContractionHierarchy(int numVertices) {
+  ContractionHierarchy* ch =
+      (ContractionHierarchy*)malloc(sizeof(ContractionHierarchy));
+  if (ch == NULL) {
+    printf("Error: Memory allocation failed for contraction hierarchy\n");
+    exit(1);
+  }
+
+  ch->numVertices = numVertices;
+  ch->numEdges = 0;
+  ch->numShortcuts = 0;
+  ch->ranks = (int*)malloc(sizeof(int) * (numVertices + 1));
+  ch->upOffsets = (int*)malloc(sizeof(int) * (numVertices + 1));
+  ch->downOffsets = (int*)malloc(sizeof(int) * (numVertices + 1));
+  if (ch->ranks == NULL || ch->upOffsets == NULL || ch->downOffsets == NULL) {
+    printf("Error: Memory allocation failed for hierarchy arrays\n");
+    exit(1);
+  }
+  ch->upArcs = NULL;
+  ch->downArcs = NULL;
+
+  return ch;
+}
+
+ContractionHierarchy* newContractionHierarchy(Graph* graph, int numThreads) {
+  if (graph == NULL || numThreads < 1) return NULL;
+
+  int numVertices = graph->numVertices;
+  ChBuilder* builder = newChBuilder(graph);
+  ChWitness* witnesses[numThreads];
+  for (int t = 0; t < numThreads; t++) {
+    witnesses[t] = newChWitness(numVertices);
+  }
+
+  int* remaining = (int*)malloc(sizeof(int) * (numVertices + 1));
+  int* round = (int*)malloc(sizeof(int) * (numVertices + 1));
+  int* dirty = (int*)malloc(sizeof(int) * (numVertices + 1));
+  bool* isDirty = (bool*)calloc(numVertices + 1, sizeof(bool));
+  if (remaining == NULL || round == NULL || dirty == NULL ||
+      isDirty == NULL) {
+    printf("Error: Memory allocation failed for contraction order\n");
+    exit(1);
+  }
+
+  int numRemaining = numVertices;
+  for (int i = 0; i < numVertices; i++) remaining[i] = i;
+  runChRound(builder, witnesses, numThreads, remaining, numRemaining, false);
+
+  int rank = 0;
+  while (numRemaining > 0) {
+    int numRound = 0;
+    int numKept = 0;
+    for (int i = 0; i < numRemaining; i++) {
+      int v = remaining[i];
+      if (isLocalMinimum(builder, v)) {
+        round[numRound++] = v;
+      } else {
+        remaining[numKept++] = v;
+      }
+    }
+    numRemaining = numKept;
+
+    runChRound(builder, witnesses, numThreads, round, numRound, true);
+
+    int numDirty = 0;
+    for (int i = 0; i < numRound; i++) {
+      numDirty = applyContraction(builder, round[i], rank++,
+                                  &builder->pending[i], dirty, numDirty,
+                                  isDirty);
+    }
+    for (int i = 0; i < numDirty; i++) isDirty[dirty[i]] = false;
+
+    runChRound(builder, witnesses, numThreads, dirty, numDirty, false);
+  }
+
+  ContractionHierarchy* ch = allocContractionHierarchy(numVertices);
+  ch->numEdges = graph->numEdges;
+  memcpy(ch->ranks, builder->ranks, sizeof(int) * numVertices);
+  ch->upArcs = packArcs(builder->up, numVertices, ch->upOffsets);
+  ch->downArcs = packArcs(builder->down, numVertices, ch->downOffsets);
+  for (int i = 0; i < ch->upOffsets[numVertices]; i++) {
+    if (ch->upArcs[i].middle != NOTHING) ch->numShortcuts++;
+  }
+  for (int i = 0; i < ch->downOffsets[numVertices]; i++) {
+    if (ch->downArcs[i].middle != NOTHING) ch->numShortcuts++;
+  }
+
+  free(remaining);
+  free(round);
+  free(dirty);
+  free(isDirty);
+  for (int t = 0; t < numThreads; t++) deleteChWitness(witnesses[t]);
+  deleteChBuilder(builder);
+
+  return ch;
+}
+
+/*************************************************************************
+ ** Queries
+ *************************************************************************/
+
+ChSearch* newChSearch(ContractionHierarchy* ch) {
+  if (ch == NULL) return NULL;
+
+  ChSearch* search = (ChSearch*)malloc(sizeof(ChSearch));
+  if (search == NULL) {
+    printf("Error: Memory allocation failed for CH search\n");
+    exit(1);
+  }
+
+  int numVertices = ch->numVertices;
+  search->numVertices = numVertices;
+  for (int side = 0; side < 2; side++) {
+    search->heaps[side] = newHeap(numVertices);
+    search->distances[side] = (int*)malloc(sizeof(int) * numVertices);
+    search->predecessors[side] = (int*)malloc(sizeof(int) * numVertices);
+    search->predArcs[side] = (int*)malloc(sizeof(int) * numVertices);
+    search->touched[side] = (int*)malloc(sizeof(int) * numVertices);
+    if (search->distances[side] == NULL ||
+        search->predecessors[side] == NULL ||
+        search->predArcs[side] == NULL || search->touched[side] == NULL) {
+      printf("Error: Memory allocation failed for CH search arrays\n");
+      exit(1);
+    }
+    for (int i = 0; i < numVertices; i++) {
+      search->distances[side][i] = INT_MAX;
+    }
+    search->numTouched[side] = 0;
+  }
+
+  return search;
+}
+
+/* Restores every vertex touched by the last query on 'search'. */
+static void resetChSearch(ChSearch* search) {
+  for (int side = 0; side < 2; side++) {
+    for (int i = 0; i < search->numTouched[side]; i++) {
+      int id = search->touched[side][i];
+      search->distances[side][id] = INT_MAX;
+      search->heaps[side]->indexMap[id] = NOTHING;
+    }
+    search->heaps[side]->size = 0;
+    search->numTouched[side] = 0;
+  }
+}
+
+/* Runs the bidirectional upward search from 'source' to 'target' on 'ch'
+ * using 'search', which must be in the reset state. Returns the distance
+ * and stores the vertex where the two searches meet in 'meet' and the
+ * number of finished vertices in 'numSettled'.
+ */
+static int runChQuery(ContractionHierarchy* ch, ChSearch* search, int source,
+                      int target, int* meet, int* numSettled) {
+  int ends[2] = {source, target};
+  for (int side = 0; side < 2; side++) {
+    search->distances[side][ends[side]] = 0;
+    search->predecessors[side][ends[side]] = NOTHING;
+    search->touched[side][search->numTouched[side]++] = ends[side];
+    insert(search->heaps[side], 0, ends[side]);
+  }
+
+  int best = INT_MAX;
+  *meet = NOTHING;
+  *numSettled = 0;
+
+  while (search->heaps[0]->size > 0 || search->heaps[1]->size > 0) {
+    int side;
+    if (search->heaps[0]->size == 0) {
+      side = 1;
+    } else if (search->heaps[1]->size == 0) {
+      side = 0;
+    } else {
+      side = getMin(search->heaps[0]).priority <=
+                     getMin(search->heaps[1]).priority
+                 ? 0
+                 : 1;
+    }
+
+    MinHeap* heap = search->heaps[side];
+    if (getMin(heap).priority >= best) {
+      heap->size = 0;  // nothing left on this side can improve 'best'
+      continue;
+    }
+
+    HeapNode minNode = extractMin(heap);
+    int v = minNode.id;
+    int currDis = minNode.priority;
+    (*numSettled)++;
+
+    int otherDis = search->distances[1 - side][v];
+    if (otherDis != INT_MAX && (long long)currDis + otherDis < best) {
+      best = currDis + otherDis;
+      *meet = v;
+    }
+
+    int* offsets = side == 0 ? ch->upOffsets : ch->downOffsets;
+    ChArc* arcs = side == 0 ? ch->upArcs : ch->downArcs;
+    int* distances = search->distances[side];
+    for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+      int to = arcs[i].head;
+      int weight = arcs[i].weight;
+      if (weight > INT_MAX - 1 - currDis ||
+          currDis + weight >= distances[to]) {
+        continue;
+      }
+      if (distances[to] == INT_MAX) {
+        search->touched[side][search->numTouched[side]++] = to;
+        insert(heap, currDis + weight, to);
+      } else {
+        decreasePriority(heap, to, currDis + weight);
+      }
+      distances[to] = currDis + weight;
+      search->predecessors[side][to] = v;
+      search->predArcs[side][to] = i;
+    }
+  }
+
+  return best;
+}
+
+/* Returns the arc ('fromVertex' -> 'toVertex') stored at 'middle', which
+ * was contracted before both of them: in its down arcs if 'down' is true,
+ * in its up arcs otherwise.
+ */
+static ChArc* findChArc(ContractionHierarchy* ch, int middle, int head,
+                        bool down) {
+  int* offsets = down ? ch->downOffsets : ch->upOffsets;
+  ChArc* arcs = down ? ch->downArcs : ch->upArcs;
+
+  ChArc* found = NULL;
+  for (int i = offsets[middle]; i < offsets[middle + 1]; i++) {
+    if (arcs[i].head == head &&
+        (found == NULL || arcs[i].weight < found->weight)) {
+      found = &arcs[i];
+    }
+  }
+  return found;
+}
+
+/* Unpacks arc ('fromVertex' -> 'toVertex', 'weight', 'middle') into
+ * original edges and prepends them, in order, to the path '*head'; the edge
+ * nearest the target ends up first.
+ */
+static void unpackChArc(ContractionHierarchy* ch, int fromVertex,
+                        int toVertex, int weight, int middle,
+                        EdgeList** head) {
+  // explicit stack of arcs still to unpack, first arc on top
+  int capacity = 16;
+  int size = 0;
+  ChShortcut* stack = (ChShortcut*)malloc(sizeof(ChShortcut) * capacity);
+  int* middles = (int*)malloc(sizeof(int) * capacity);
+  if (stack == NULL || middles == NULL) {
+    printf("Error: Memory allocation failed for unpacking stack\n");
+    exit(1);
+  }
+
+  stack[0].fromVertex = fromVertex;
+  stack[0].toVertex = toVertex;
+  stack[0].weight = weight;
+  middles[0] = middle;
+  size = 1;
+
+  while (size > 0) {
+    size--;
+    ChShortcut arc = stack[size];
+    int m = middles[size];
+    if (m == NOTHING) {
+      *head = newEdgeList(newEdge(arc.fromVertex, arc.toVertex, arc.weight),
+                          *head);
+      continue;
+    }
+
+    if (size + 2 > capacity) {
+      capacity *= 2;
+      stack = (ChShortcut*)realloc(stack, sizeof(ChShortcut) * capacity);
+      middles = (int*)realloc(middles, sizeof(int) * capacity);
+      if (stack == NULL || middles == NULL) {
+        printf("Error: Memory allocation failed for unpacking stack\n");
+        exit(1);
+      }
+    }
+
+    // (from -> m) is a down arc of m, (m -> to) an up arc of m
+    ChArc* first = findChArc(ch, m, arc.fromVertex, true);
+    ChArc* second = findChArc(ch, m, arc.toVertex, false);
+    stack[size].fromVertex = m;
+    stack[size].toVertex = arc.toVertex;
+    stack[size].weight = second->weight;
+    middles[size] = second->middle;
+    size++;
+    stack[size].fromVertex = arc.fromVertex;
+    stack[size].toVertex = m;
+    stack[size].weight = first->weight;
+    middles[size] = first->middle;
+    size++;
+  }
+
+  free(stack);
+  free(middles);
+}
+
+/* Creates and returns the unpacked path of the last query on 'search',
+ * which met at 'meet', in the format produced by getShortestPaths.
+ */
+static EdgeList* makeChPath(ContractionHierarchy* ch, ChSearch* search,
+                            int meet) {
+  // collect the forward arcs from the source up to 'meet'
+  int numArcs = 0;
+  for (int v = meet; search->predecessors[0][v] != NOTHING;
+       v = search->predecessors[0][v]) {
+    numArcs++;
+  }
+  int* forward = (int*)malloc(sizeof(int) * (numArcs + 1));
+  if (forward == NULL) {
+    printf("Error: Memory allocation failed for path arcs\n");
+    exit(1);
+  }
+  int n = numArcs;
+  for (int v = meet; search->predecessors[0][v] != NOTHING;
+       v = search->predecessors[0][v]) {
+    forward[--n] = v;
+  }
+
+  EdgeList* head = NULL;
+  for (int i = 0; i < numArcs; i++) {
+    int v = forward[i];
+    ChArc* arc = &ch->upArcs[search->predArcs[0][v]];
+    unpackChArc(ch, search->predecessors[0][v], v, arc->weight, arc->middle,
+                &head);
+  }
+  free(forward);
+
+  // the backward search reaches 'meet' from the target over down arcs
+  for (int v = meet; search->predecessors[1][v] != NOTHING;
+       v = search->predecessors[1][v]) {
+    ChArc* arc = &ch->downArcs[search->predArcs[1][v]];
+    unpackChArc(ch, v, search->predecessors[1][v], arc->weight, arc->middle,
+                &head);
+  }
+
+  return head;
+}
+
+/* Returns a newly created result for a query from 'source' to 'target'. */
+static ChResult* newChResult(int source, int target) {
+  ChResult* result = (ChResult*)malloc(sizeof(ChResult));
+  if (result == NULL) {
+    printf("Error: Memory allocation failed for CH result\n");
+    exit(1);
+  }
+
+  result->source = source;
+  result->target = target;
+  result->distance = INT_MAX;
+  result->path = NULL;
+  result->numSettled = 0;
+
+  return result;
+}
+
+/* Returns true iff 'id' is a valid vertex ID in 'ch'. */
+static bool isValidChVertex(ContractionHierarchy* ch, int id) {
+  return id >= 0 && id < ch->numVertices;
+}
+
+ChResult* getShortestPathCH(ContractionHierarchy* ch, ChSearch* search,
+                            int source, int target) {
+  if (ch == NULL || !isValidChVertex(ch, source) ||
+      !isValidChVertex(ch, target)) {
+    return NULL;
+  }
+
+  ChSearch* state = search != NULL ? search : newChSearch(ch);
+  ChResult* result = newChResult(source, target);
+
+  int meet;
+  result->distance =
+      runChQuery(ch, state, source, target, &meet, &result->numSettled);
+  if (result->distance != INT_MAX) {
+    result->path = makeChPath(ch, state, meet);
+  }
+
+  if (search == NULL) {
+    deleteChSearch(state);
+  } else {
+    resetChSearch(state);
+  }
+  return result;
+}
+
+int getDistanceCH(ContractionHierarchy* ch, ChSearch* search, int source,
+                  int target) {
+  if (ch == NULL || !isValidChVertex(ch, source) ||
+      !isValidChVertex(ch, target)) {
+    return -1;
+  }
+
+  ChSearch* state = search != NULL ? search : newChSearch(ch);
+  int meet;
+  int numSettled;
+  int distance = runChQuery(ch, state, source, target, &meet, &numSettled);
+
+  if (search == NULL) {
+    deleteChSearch(state);
+  } else {
+    resetChSearch(state);
+  }
+  return distance;
+}
+
+/* Runs the upward search of direction 'side' on 'ch' from 'start' until
+ * 'stop' is finished, and returns the distance between them, or INT_MAX if
+ * 'stop' is not above 'start' in the hierarchy. Adds the number of finished
+ * vertices to 'numSettled'.
+ */
+static int runChSearchTo(ContractionHierarchy* ch, ChSearch* search, int side,
+                         int start, int stop, int* numSettled) {
+  MinHeap* heap = search->heaps[side];
+  int* distances = search->distances[side];
+  int* offsets = side == 0 ? ch->upOffsets : ch->downOffsets;
+  ChArc* arcs = side == 0 ? ch->upArcs : ch->downArcs;
+
+  distances[start] = 0;
+  search->predecessors[side][start] = NOTHING;
+  search->touched[side][search->numTouched[side]++] = start;
+  insert(heap, 0, start);
+
+  while (heap->size > 0) {
+    HeapNode minNode = extractMin(heap);
+    int v = minNode.id;
+    int currDis = minNode.priority;
+    (*numSettled)++;
+    if (v == stop) return currDis;
+
+    for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+      int to = arcs[i].head;
+      int weight = arcs[i].weight;
+      if (weight > INT_MAX - 1 - currDis ||
+          currDis + weight >= distances[to]) {
+        continue;
+      }
+      if (distances[to] == INT_MAX) {
+        search->touched[side][search->numTouched[side]++] = to;
+        insert(heap, currDis + weight, to);
+      } else {
+        decreasePriority(heap, to, currDis + weight);
+      }
+      distances[to] = currDis + weight;
+      search->predecessors[side][to] = v;
+      search->predArcs[side][to] = i;
+    }
+  }
+  return INT_MAX;
+}
+
+ChResult* getShortestPathViaCH(ContractionHierarchy* ch, ChSearch* search,
+                               int source, int target, int meet) {
+  if (ch == NULL || !isValidChVertex(ch, source) ||
+      !isValidChVertex(ch, target) || !isValidChVertex(ch, meet)) {
+    return NULL;
+  }
+
+  ChSearch* state = search != NULL ? search : newChSearch(ch);
+  ChResult* result = newChResult(source, target);
+
+  int toMeet =
+      runChSearchTo(ch, state, 0, source, meet, &result->numSettled);
+  int fromMeet =
+      runChSearchTo(ch, state, 1, target, meet, &result->numSettled);
+  if (toMeet != INT_MAX && fromMeet != INT_MAX &&
+      (long long)toMeet + fromMeet < INT_MAX) {
+    result->distance = toMeet + fromMeet;
+    result->path = makeChPath(ch, state, meet);
+  }
+
+  if (search == NULL) {
+    deleteChSearch(state);
+  } else {
+    resetChSearch(state);
+  }
+  return result;
+}
+
+/*************************************************************************
+ ** Serialization
+ *************************************************************************/
+
+bool saveContractionHierarchy(ContractionHierarchy* ch, FILE* f) {
+  if (ch == NULL || f == NULL) return false;
+
+  int n = ch->numVertices;
+  int numUp = ch->upOffsets[n];
+  int numDown = ch->downOffsets[n];
+  int header[6] = {CH_VERSION, n, ch->numEdges, ch->numShortcuts, numUp,
+                   numDown};
+
+  return fwrite(CH_MAGIC, 1, 4, f) == 4 &&
+         fwrite(header, sizeof(int), 6, f) == 6 &&
+         fwrite(ch->ranks, sizeof(int), n, f) == (size_t)n &&
+         fwrite(ch->upOffsets, sizeof(int), n + 1, f) == (size_t)n + 1 &&
+         fwrite(ch->upArcs, sizeof(ChArc), numUp, f) == (size_t)numUp &&
+         fwrite(ch->downOffsets, sizeof(int), n + 1, f) == (size_t)n + 1 &&
+         fwrite(ch->downArcs, sizeof(ChArc), numDown, f) == (size_t)numDown;
+}
+
+ContractionHierarchy* loadContractionHierarchy(FILE* f) {
+  if (f == NULL) return NULL;
+
+  char magic[4];
+  int header[6];
+  if (fread(magic, 1, 4, f) != 4 || memcmp(magic, CH_MAGIC, 4) != 0 ||
+      fread(header, sizeof(int), 6, f) != 6 || header[0] != CH_VERSION ||
+      header[1] < 0 || header[4] < 0 || header[5] < 0) {
+    printf("Not a contraction hierarchy file. Giving up.\n");
+    return NULL;
+  }
+
+  int n = header[1];
+  int numUp = header[4];
+  int numDown = header[5];
+  ContractionHierarchy* ch = allocContractionHierarchy(n);
+  ch->numEdges = header[2];
+  ch->numShortcuts = header[3];
+  ch->upArcs = (ChArc*)malloc(sizeof(ChArc) * (numUp + 1));
+  ch->downArcs = (ChArc*)malloc(sizeof(ChArc) * (numDown + 1));
+  if (ch->upArcs == NULL || ch->downArcs == NULL) {
+    printf("Error: Memory allocation failed for hierarchy arcs\n");
+    exit(1);
+  }
+
+  if (fread(ch->ranks, sizeof(int), n, f) != (size_t)n ||
+      fread(ch->upOffsets, sizeof(int), n + 1, f) != (size_t)n + 1 ||
+      fread(ch->upArcs, sizeof(ChArc), numUp, f) != (size_t)numUp ||
+      fread(ch->downOffsets, sizeof(int), n + 1, f) != (size_t)n + 1 ||
+      fread(ch->downArcs, sizeof(ChArc), numDown, f) != (size_t)numDown ||
+      ch->upOffsets[n] != numUp || ch->downOffsets[n] != numDown) {
+    printf("Contraction hierarchy file is truncated. Giving up.\n");
+    deleteContractionHierarchy(ch);
+    return NULL;
+  }
+
+  return ch;
+}
+
+void deleteContractionHierarchy(ContractionHierarchy* ch) {
+  if (ch == NULL) return;
+
+  free(ch->ranks);
+  free(ch->upOffsets);
+  free(ch->upArcs);
+  free(ch->downOffsets);
+  free(ch->downArcs);
+  free(ch);
+}
+
+void deleteChSearch(ChSearch* search) {
+  if (search == NULL) return;
+
+  for (int side = 0; side < 2; side++) {
+    deleteHeap(search->heaps[side]);
+    free(search->distances[side]);
+    free(search->predecessors[side]);
+    free(search->predArcs[side]);
+    free(search->touched[side]);
+  }
+  free(search);
+}
+
+void deleteChResult(ChResult* result) {
+  if (result == NULL) return;
+
+  deleteEdgeList(result->path);
+  free(result);
+}
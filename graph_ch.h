@@ -0,0 +1,108 @@
+/*
+ * Header file for Contraction Hierarchies.
+ *
+ * Vertices are contracted one independent set at a time, in order of edge
+ * difference. Contracting a vertex adds a shortcut between two of its
+ * neighbours unless a witness path shows the shortcut is not needed.
+ * Queries run a bidirectional Dijkstra that only climbs the hierarchy.
+ *
+ * Compile with -pthread.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Ch_header
+#define __Graph_Ch_header
+
+typedef struct ch_arc {
+  int head;    // ID of the other endpoint of this arc
+  int weight;  // weight of this arc
+  int middle;  // ID of the vertex this shortcut bypasses, or -1 if this arc
+               //   is an edge of the original graph
+} ChArc;
+
+typedef struct contraction_hierarchy {
+  int numVertices;   // total number of vertices in the graph
+  int numEdges;      // total number of edges in the original graph
+  int numShortcuts;  // number of shortcuts added by contraction
+  int* ranks;        // ranks[id] is the position of id in the contraction
+                     //   order; higher ranks were contracted later
+  int* upOffsets;    // arcs (id -> head) with ranks[head] > ranks[id] are at
+                     //   upArcs[upOffsets[id] .. upOffsets[id+1])
+  ChArc* upArcs;     // upward arcs, grouped by tail
+  int* downOffsets;  // arcs (head -> id) with ranks[head] > ranks[id] are at
+                     //   downArcs[downOffsets[id] .. downOffsets[id+1])
+  ChArc* downArcs;   // downward arcs, reversed and grouped by their head
+} ContractionHierarchy;
+
+typedef struct ch_search ChSearch;  // reusable state for CH queries
+
+typedef struct ch_result {
+  int source;      // ID of the source vertex of this query
+  int target;      // ID of the target vertex of this query
+  int distance;    // distance from source to target, INT_MAX if unreachable
+  EdgeList* path;  // path from target to source in the format produced by
+                   //   getShortestPaths, using original edges only; NULL if
+                   //   unreachable or source == target
+  int numSettled;  // number of vertices settled by the search
+} ChResult;
+
+/* Contracts every vertex of Graph 'graph' and returns the resulting
+ * hierarchy. Witness searches and priority updates are split across
+ * 'numThreads' threads; the result does not depend on 'numThreads'.
+ * Returns NULL if 'numThreads' < 1.
+ */
+ContractionHierarchy* newContractionHierarchy(Graph* graph, int numThreads);
+
+/* Returns newly created query state for hierarchy 'ch'. A ChSearch may be
+ * reused for any number of queries, but only by one thread at a time;
+ * after the first query, each query costs only what it touches.
+ */
+ChSearch* newChSearch(ContractionHierarchy* ch);
+
+/* Runs a bidirectional upward search on hierarchy 'ch' from vertex with ID
+ * 'source' to vertex with ID 'target', using 'search' (or temporary state,
+ * if 'search' is NULL), and returns the shortest path with all shortcuts
+ * unpacked. Returns NULL if 'source' or 'target' is not valid in 'ch'.
+ */
+ChResult* getShortestPathCH(ContractionHierarchy* ch, ChSearch* search,
+                            int source, int target);
+
+/* Returns the distance from vertex with ID 'source' to vertex with ID
+ * 'target' in hierarchy 'ch', or INT_MAX if there is no path, without
+ * building the path. Returns -1 if 'source' or 'target' is not valid.
+ */
+int getDistanceCH(ContractionHierarchy* ch, ChSearch* search, int source,
+                  int target);
+
+/* Returns the path from vertex with ID 'source' to vertex with ID 'target'
+ * in hierarchy 'ch' that climbs from both ends to vertex with ID 'meet',
+ * e.g. a meeting vertex recorded by an earlier query, with all shortcuts
+ * unpacked. The distance is INT_MAX if 'meet' is not above both ends.
+ * Returns NULL if 'source', 'target' or 'meet' is not valid in 'ch'.
+ */
+ChResult* getShortestPathViaCH(ContractionHierarchy* ch, ChSearch* search,
+                               int source, int target, int meet);
+
+/* Writes 'ch' to the binary stream 'f'. Returns true iff successful. */
+bool saveContractionHierarchy(ContractionHierarchy* ch, FILE* f);
+
+/* Reads a hierarchy previously written by saveContractionHierarchy from the
+ * binary stream 'f'. Returns NULL if 'f' does not contain a hierarchy.
+ */
+ContractionHierarchy* loadContractionHierarchy(FILE* f);
+
+/* Frees all memory allocated for 'ch'. */
+void deleteContractionHierarchy(ContractionHierarchy* ch);
+
+/* Frees all memory allocated for 'search'. */
+void deleteChSearch(ChSearch* search);
+
+/* Frees all memory allocated for 'result', including its path. */
+void deleteChResult(ChResult* result);
+
+#endif
@@ -0,0 +1,204 @@
+/*
+ *  Load generator for graph_server: sends requests over a Unix domain
+ *  socket, keeping up to 'window' of them in flight, and reports latency
+ *  percentiles and throughput.
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O2 -Wall -Werror graph_protocol.c graph_client.c -o graph_client
+ *
+ *   Run:
+ *   ./graph_client /tmp/graph.sock numRequests window type [limit]
+ *   where type is one of path, tree, isochrone, mst, mix
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "graph_protocol.h"
+
+#define DEFAULT_LIMIT 100
+
+/* requests */
+int parseType(char* name);
+void fillRequest(Request* request, uint32_t id, int type, int numVertices,
+                 int limit, uint64_t* seed);
+bool readResponse(int fd, ResponseHeader* header, int32_t** items,
+                  int* capacity);
+
+/* reporting */
+double nowSeconds(void);
+int compareDoubles(const void* a, const void* b);
+double percentile(double* sorted, int count, double p);
+
+int main(int argc, char* argv[]) {
+  if (argc < 5) {
+    printf("Usage: %s socket_path numRequests window type [limit]\n",
+           argv[0]);
+    return 1;
+  }
+  int numRequests = atoi(argv[2]);
+  int window = atoi(argv[3]);
+  int type = parseType(argv[4]);
+  int limit = argc > 5 ? atoi(argv[5]) : DEFAULT_LIMIT;
+  if (numRequests < 1 || window < 1 || type == -1) {
+    printf("Invalid arguments. Giving up.\n");
+    return 1;
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, argv[1], sizeof(addr.sun_path) - 1);
+  if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    fprintf(stderr, "Unable to connect to socket: %s\n", argv[1]);
+    return 1;
+  }
+
+  int32_t* items = NULL;
+  int capacity = 0;
+  ResponseHeader header;
+
+  // ask for the graph size so random vertices are valid
+  Request info = {0, REQUEST_INFO, 0, 0, 0};
+  if (!writeFully(fd, &info, sizeof(Request)) ||
+      !readResponse(fd, &header, &items, &capacity)) {
+    fprintf(stderr, "Server did not answer. Giving up.\n");
+    return 1;
+  }
+  int numVertices = header.value;
+  if (numVertices < 1) {
+    printf("Server graph has no vertices. Giving up.\n");
+    return 1;
+  }
+
+  double* sentAt = (double*)malloc(sizeof(double) * numRequests);
+  double* latencies = (double*)malloc(sizeof(double) * numRequests);
+  Request* batch = (Request*)malloc(sizeof(Request) * window);
+  if (sentAt == NULL || latencies == NULL || batch == NULL) {
+    printf("Error: Memory allocation failed for client buffers\n");
+    exit(1);
+  }
+
+  uint64_t seed = 88172645463325252ULL;
+  int numSent = 0;
+  int numReceived = 0;
+  int numFailed = 0;
+  double start = nowSeconds();
+
+  while (numReceived < numRequests) {
+    // top the window up with one write
+    int numBatch = 0;
+    double now = nowSeconds();
+    while (numSent < numRequests && numSent - numReceived < window) {
+      fillRequest(&batch[numBatch++], numSent, type, numVertices, limit,
+                  &seed);
+      sentAt[numSent++] = now;
+    }
+    if (numBatch > 0 &&
+        !writeFully(fd, batch, sizeof(Request) * numBatch)) {
+      fprintf(stderr, "Lost connection to server. Giving up.\n");
+      return 1;
+    }
+
+    if (!readResponse(fd, &header, &items, &capacity)) {
+      fprintf(stderr, "Lost connection to server. Giving up.\n");
+      return 1;
+    }
+    latencies[numReceived++] = nowSeconds() - sentAt[header.requestId];
+    if (header.status == RESPONSE_BAD_REQUEST) numFailed++;
+  }
+
+  double elapsed = nowSeconds() - start;
+  qsort(latencies, numRequests, sizeof(double), compareDoubles);
+
+  printf("Requests: %d (%d rejected), window: %d\n", numRequests, numFailed,
+         window);
+  printf("Throughput: %.0f requests/s\n", numRequests / elapsed);
+  printf("Latency p50: %.1f us, p99: %.1f us, max: %.1f us\n",
+         percentile(latencies, numRequests, 0.50) * 1e6,
+         percentile(latencies, numRequests, 0.99) * 1e6,
+         latencies[numRequests - 1] * 1e6);
+
+  close(fd);
+  free(items);
+  free(sentAt);
+  free(latencies);
+  free(batch);
+  return 0;
+}
+
+/* Returns the RequestType named 'name', 0 for "mix", or -1 if unknown. */
+int parseType(char* name) {
+  if (strcmp(name, "path") == 0) return REQUEST_PATH;
+  if (strcmp(name, "tree") == 0) return REQUEST_TREE;
+  if (strcmp(name, "isochrone") == 0) return REQUEST_ISOCHRONE;
+  if (strcmp(name, "mst") == 0) return REQUEST_MST_WEIGHT;
+  if (strcmp(name, "mix") == 0) return 0;
+  return -1;
+}
+
+/* Fills 'request' with ID 'id' and type 'type' (or a random type, if 'type'
+ * is 0) between random vertices, drawn with xorshift state 'seed'.
+ */
+void fillRequest(Request* request, uint32_t id, int type, int numVertices,
+                 int limit, uint64_t* seed) {
+  uint64_t x = *seed;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *seed = x;
+
+  request->requestId = id;
+  request->type = type != 0 ? type : REQUEST_PATH + (int)(x % 4);
+  request->source = (int32_t)((x >> 8) % numVertices);
+  request->target = (int32_t)((x >> 32) % numVertices);
+  request->limit = limit;
+}
+
+/* Reads one response from 'fd' into 'header', and its items into '*items',
+ * growing it (and '*capacity') as needed. Returns false on error.
+ */
+bool readResponse(int fd, ResponseHeader* header, int32_t** items,
+                  int* capacity) {
+  if (!readFully(fd, header, sizeof(ResponseHeader))) return false;
+
+  int numValues = header->numItems * header->itemSize;
+  if (numValues > *capacity) {
+    *capacity = numValues;
+    *items = (int32_t*)realloc(*items, sizeof(int32_t) * numValues);
+    if (*items == NULL) {
+      printf("Error: Memory allocation failed for response items\n");
+      exit(1);
+    }
+  }
+  return readFully(fd, *items, sizeof(int32_t) * numValues);
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Compares two doubles for qsort. */
+int compareDoubles(const void* a, const void* b) {
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+/* Returns the 'p'-th quantile of the 'count' sorted values in 'sorted'. */
+double percentile(double* sorted, int count, double p) {
+  int index = (int)(p * (count - 1) + 0.5);
+  return sorted[index];
+}
@@ -0,0 +1,365 @@
+/*
+ * Parallel connected components and minimum spanning forests.
+ *
+ * Every parent pointer of the union-find points to a smaller vertex, so
+ * roots are component minima and the dense component numbering can be
+ * assigned in one pass over the vertices in order.
+ */
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "graph_components.h"
+#include "minheap.h"
+
+#define NOTHING -1
+
+typedef struct union_task {  // one thread's share of the union-find
+  Graph* graph;          // graph whose components are found
+  _Atomic int* parents;  // union-find parent of every vertex
+  int* rootOf;           // rootOf[id] is the root of id, once linked
+  int first;             // this thread handles vertices
+  int last;              //   first .. last-1
+} UnionTask;
+
+typedef struct sized_component {  // a component to schedule
+  int id;    // component number
+  int size;  // number of vertices in it
+} SizedComponent;
+
+typedef struct prim_task {  // one thread of the spanning forest
+  Graph* graph;            // graph being spanned
+  Components* components;  // its components
+  SpanningForest* forest;  // forest being built
+  SizedComponent* order;   // components, largest first
+  atomic_int* next;        // index in 'order' of the next component
+  MinHeap* heap;           // priority queue of reached, unfinished
+                           //   vertices, by weight of cheapest edge
+  int* keys;               // keys[id] is that weight, or INT_MAX
+  int* predecessors;       // predecessors[id] is the other end of it
+  bool* finished;          // finished[id] is true iff id is in the tree
+  int* touched;            // vertices reached in the current component
+} PrimTask;
+
+/*************************************************************************
+ ** Connected components
+ *************************************************************************/
+
+/* Returns the root of vertex 'v', halving its path on the way. */
+static int findRoot(_Atomic int* parents, int v) {
+  while (true) {
+    int parent = atomic_load(&parents[v]);
+    if (parent == v) return v;
+    int grandparent = atomic_load(&parents[parent]);
+    if (grandparent != parent) {
+      atomic_compare_exchange_weak(&parents[v], &parent, grandparent);
+    }
+    v = grandparent;
+  }
+}
+
+/* Merges the sets of vertices 'u' and 'v', hanging the larger root under
+ * the smaller one.
+ */
+static void unionVertices(_Atomic int* parents, int u, int v) {
+  while (true) {
+    u = findRoot(parents, u);
+    v = findRoot(parents, v);
+    if (u == v) return;
+
+    int high = u > v ? u : v;
+    int low = u > v ? v : u;
+    int expected = high;
+    if (atomic_compare_exchange_strong(&parents[high], &expected, low)) {
+      return;
+    }
+  }
+}
+
+/* Links the edges leaving this thread's vertices. */
+static void* runUnionTask(void* arg) {
+  UnionTask* task = (UnionTask*)arg;
+  for (int v = task->first; v < task->last; v++) {
+    if (task->graph->vertices[v] == NULL) continue;
+    for (EdgeList* e = task->graph->vertices[v]->adjList; e != NULL;
+         e = e->next) {
+      unionVertices(task->parents, v, e->edge->toVertex);
+    }
+  }
+  return NULL;
+}
+
+/* Finds the final root of this thread's vertices. */
+static void* runRootTask(void* arg) {
+  UnionTask* task = (UnionTask*)arg;
+  for (int v = task->first; v < task->last; v++) {
+    task->rootOf[v] = findRoot(task->parents, v);
+  }
+  return NULL;
+}
+
+/* Runs 'run' on each of the 'numThreads' tasks in 'tasks', one per
+ * thread.
+ */
+static void runUnionPhase(UnionTask* tasks, int numThreads,
+                          void* (*run)(void*)) {
+  pthread_t threads[numThreads];
+  for (int t = 1; t < numThreads; t++) {
+    if (pthread_create(&threads[t], NULL, run, &tasks[t]) != 0) {
+      printf("Error: Could not create components worker thread\n");
+      exit(1);
+    }
+  }
+  run(&tasks[0]);
+  for (int t = 1; t < numThreads; t++) pthread_join(threads[t], NULL);
+}
+
+Components* getConnectedComponents(Graph* graph, int numThreads) {
+  if (numThreads < 1) return NULL;
+
+  int numVertices = graph->numVertices;
+  Components* components = (Components*)malloc(sizeof(Components));
+  _Atomic int* parents =
+      (_Atomic int*)malloc(sizeof(_Atomic int) * (numVertices + 1));
+  int* rootOf = (int*)malloc(sizeof(int) * (numVertices + 1));
+  if (components == NULL || parents == NULL || rootOf == NULL) {
+    printf("Error: Memory allocation failed for components\n");
+    exit(1);
+  }
+  for (int v = 0; v < numVertices; v++) atomic_init(&parents[v], v);
+
+  UnionTask tasks[numThreads];
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t].graph = graph;
+    tasks[t].parents = parents;
+    tasks[t].rootOf = rootOf;
+    tasks[t].first = (int)((long long)numVertices * t / numThreads);
+    tasks[t].last = (int)((long long)numVertices * (t + 1) / numThreads);
+  }
+  runUnionPhase(tasks, numThreads, runUnionTask);
+  runUnionPhase(tasks, numThreads, runRootTask);
+  free((void*)parents);
+
+  // roots are component minima, so each root is seen before its members
+  components->numVertices = numVertices;
+  components->labels = (int*)malloc(sizeof(int) * (numVertices + 1));
+  if (components->labels == NULL) {
+    printf("Error: Memory allocation failed for component labels\n");
+    exit(1);
+  }
+  int numComponents = 0;
+  for (int v = 0; v < numVertices; v++) {
+    if (rootOf[v] == v) {
+      components->labels[v] = numComponents++;
+    } else {
+      components->labels[v] = components->labels[rootOf[v]];
+    }
+  }
+  free(rootOf);
+
+  components->numComponents = numComponents;
+  components->sizes = (int*)calloc(numComponents + 1, sizeof(int));
+  components->roots = (int*)malloc(sizeof(int) * (numComponents + 1));
+  if (components->sizes == NULL || components->roots == NULL) {
+    printf("Error: Memory allocation failed for component sizes\n");
+    exit(1);
+  }
+  for (int v = 0; v < numVertices; v++) {
+    int c = components->labels[v];
+    if (components->sizes[c]++ == 0) components->roots[c] = v;
+  }
+
+  return components;
+}
+
+bool areConnected(Components* components, int u, int v) {
+  if (u < 0 || u >= components->numVertices || v < 0 ||
+      v >= components->numVertices) {
+    return false;
+  }
+  return components->labels[u] == components->labels[v];
+}
+
+/*************************************************************************
+ ** Minimum spanning forest
+ *************************************************************************/
+
+/* Runs Prim's algorithm on component 'c' from its root, writing its tree
+ * edges to the component's slots in the forest of 'task'.
+ */
+static void spanComponent(PrimTask* task, int c) {
+  Graph* graph = task->graph;
+  MinHeap* heap = task->heap;
+  int root = task->components->roots[c];
+  Edge* edges = &task->forest->edges[task->forest->offsets[c]];
+
+  int numTouched = 0;
+  int numEdges = 0;
+  task->keys[root] = 0;
+  task->touched[numTouched++] = root;
+  insert(heap, 0, root);
+
+  while (heap->size > 0) {
+    HeapNode minNode = extractMin(heap);
+    int v = minNode.id;
+    task->finished[v] = true;
+    if (task->predecessors[v] != NOTHING) {
+      edges[numEdges].fromVertex = task->predecessors[v];
+      edges[numEdges].toVertex = v;
+      edges[numEdges].weight = minNode.priority;
+      numEdges++;
+    }
+
+    if (graph->vertices[v] == NULL) continue;
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      int to = e->edge->toVertex;
+      int weight = e->edge->weight;
+      if (task->finished[to]) continue;
+      // reached is told by the predecessor, not the key, so that an edge
+      // of weight INT_MAX still spans its head
+      if (task->predecessors[to] == NOTHING) {
+        task->touched[numTouched++] = to;
+        insert(heap, weight, to);
+      } else if (weight < task->keys[to]) {
+        decreasePriority(heap, to, weight);
+      } else {
+        continue;
+      }
+      task->keys[to] = weight;
+      task->predecessors[to] = v;
+    }
+  }
+
+  for (int i = 0; i < numTouched; i++) {
+    int id = task->touched[i];
+    task->keys[id] = INT_MAX;
+    task->predecessors[id] = NOTHING;
+    task->finished[id] = false;
+    heap->indexMap[id] = NOTHING;
+  }
+}
+
+/* Spans components taken from the shared schedule until none are left. */
+static void* runPrimTask(void* arg) {
+  PrimTask* task = (PrimTask*)arg;
+  int numComponents = task->components->numComponents;
+
+  while (true) {
+    int index = atomic_fetch_add(task->next, 1);
+    if (index >= numComponents) break;
+    if (task->order[index].size > 1) {
+      spanComponent(task, task->order[index].id);
+    }
+  }
+  return NULL;
+}
+
+/* Orders components by decreasing size, then by number. */
+static int compareComponents(const void* a, const void* b) {
+  const SizedComponent* x = (const SizedComponent*)a;
+  const SizedComponent* y = (const SizedComponent*)b;
+  if (x->size != y->size) return y->size - x->size;
+  return x->id - y->id;
+}
+
+SpanningForest* getMinimumSpanningForest(Graph* graph, Components* components,
+                                         int numThreads) {
+  if (numThreads < 1) return NULL;
+
+  int numVertices = graph->numVertices;
+  int numComponents = components->numComponents;
+  SpanningForest* forest = (SpanningForest*)malloc(sizeof(SpanningForest));
+  if (forest == NULL) {
+    printf("Error: Memory allocation failed for spanning forest\n");
+    exit(1);
+  }
+  forest->numVertices = numVertices;
+  forest->numComponents = numComponents;
+  forest->numEdges = numVertices - numComponents;
+  forest->edges = (Edge*)calloc(forest->numEdges + 1, sizeof(Edge));
+  forest->offsets = (int*)malloc(sizeof(int) * (numComponents + 1));
+  SizedComponent* order =
+      (SizedComponent*)malloc(sizeof(SizedComponent) * (numComponents + 1));
+  if (forest->edges == NULL || forest->offsets == NULL || order == NULL) {
+    printf("Error: Memory allocation failed for spanning forest edges\n");
+    exit(1);
+  }
+
+  forest->offsets[0] = 0;
+  for (int c = 0; c < numComponents; c++) {
+    forest->offsets[c + 1] = forest->offsets[c] + components->sizes[c] - 1;
+    order[c].id = c;
+    order[c].size = components->sizes[c];
+  }
+  qsort(order, numComponents, sizeof(SizedComponent), compareComponents);
+
+  atomic_int next;
+  atomic_init(&next, 0);
+  PrimTask tasks[numThreads];
+  pthread_t threads[numThreads];
+  for (int t = 0; t < numThreads; t++) {
+    PrimTask* task = &tasks[t];
+    task->graph = graph;
+    task->components = components;
+    task->forest = forest;
+    task->order = order;
+    task->next = &next;
+    task->heap = newHeap(numVertices);
+    task->keys = (int*)malloc(sizeof(int) * (numVertices + 1));
+    task->predecessors = (int*)malloc(sizeof(int) * (numVertices + 1));
+    task->finished = (bool*)calloc(numVertices + 1, sizeof(bool));
+    task->touched = (int*)malloc(sizeof(int) * (numVertices + 1));
+    if (task->keys == NULL || task->predecessors == NULL ||
+        task->finished == NULL || task->touched == NULL) {
+      printf("Error: Memory allocation failed for spanning forest search\n");
+      exit(1);
+    }
+    for (int v = 0; v < numVertices; v++) {
+      task->keys[v] = INT_MAX;
+      task->predecessors[v] = NOTHING;
+    }
+  }
+
+  for (int t = 1; t < numThreads; t++) {
+    if (pthread_create(&threads[t], NULL, runPrimTask, &tasks[t]) != 0) {
+      printf("Error: Could not create spanning forest worker thread\n");
+      exit(1);
+    }
+  }
+  runPrimTask(&tasks[0]);
+  for (int t = 1; t < numThreads; t++) pthread_join(threads[t], NULL);
+
+  for (int t = 0; t < numThreads; t++) {
+    deleteHeap(tasks[t].heap);
+    free(tasks[t].keys);
+    free(tasks[t].predecessors);
+    free(tasks[t].finished);
+    free(tasks[t].touched);
+  }
+  free(order);
+
+  forest->totalWeight = 0;
+  for (int i = 0; i < forest->numEdges; i++) {
+    forest->totalWeight += forest->edges[i].weight;
+  }
+  return forest;
+}
+
+void deleteComponents(Components* components) {
+  if (components == NULL) return;
+
+  free(components->labels);
+  free(components->sizes);
+  free(components->roots);
+  free(components);
+}
+
+void deleteSpanningForest(SpanningForest* forest) {
+  if (forest == NULL) return;
+
+  free(forest->edges);
+  free(forest->offsets);
+  free(forest);
+}
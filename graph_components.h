@@ -0,0 +1,70 @@
+/*
+ * Header file for connected components and minimum spanning forests.
+ *
+ * Components are found with a concurrent union-find: threads link the ends
+ * of their share of the edges with compare-and-swap, always hanging the
+ * larger root under the smaller, so every component ends up rooted at its
+ * smallest vertex. The spanning forest runs Prim's algorithm once per
+ * component, with components shared out among threads.
+ *
+ * Compile with -pthread.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Components_header
+#define __Graph_Components_header
+
+typedef struct components {
+  int numVertices;    // total number of vertices
+  int numComponents;  // number of connected components
+  int* labels;        // labels[id] is the component of vertex id; components
+                      //   are numbered 0, 1, ... by their smallest vertex
+  int* sizes;         // sizes[c] is the number of vertices in component c
+  int* roots;         // roots[c] is the smallest vertex in component c
+} Components;
+
+typedef struct spanning_forest {
+  int numVertices;        // total number of vertices
+  int numComponents;      // number of trees in the forest
+  int numEdges;           // total number of edges: numVertices minus
+                          //   numComponents
+  Edge* edges;            // the tree of component c is at
+  int* offsets;           //   edges[offsets[c] .. offsets[c+1]), in the
+                          //   order Prim's algorithm from roots[c] adds them
+  long long totalWeight;  // sum of the weights of all edges
+} SpanningForest;
+
+/* Returns the connected components of Graph 'graph', ignoring edge
+ * directions, with the edges split across 'numThreads' threads.
+ * Returns NULL if 'numThreads' < 1.
+ */
+Components* getConnectedComponents(Graph* graph, int numThreads);
+
+/* Returns true iff vertices with IDs 'u' and 'v' are in the same component
+ * of 'components'. Invalid IDs are in no component.
+ */
+bool areConnected(Components* components, int u, int v);
+
+/* Returns a minimum spanning forest of Graph 'graph' with components
+ * 'components': one minimum spanning tree per component, built by Prim's
+ * algorithm from the component's smallest vertex. Components are shared
+ * out among 'numThreads' threads, largest first.
+ * Returns NULL if 'numThreads' < 1.
+ * Precondition: 'graph' is undirected, i.e. has every edge in both
+ *   directions with the same weight
+ */
+SpanningForest* getMinimumSpanningForest(Graph* graph, Components* components,
+                                         int numThreads);
+
+/* Frees all memory allocated for 'components'. */
+void deleteComponents(Components* components);
+
+/* Frees all memory allocated for 'forest'. */
+void deleteSpanningForest(SpanningForest* forest);
+
+#endif
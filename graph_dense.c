@@ -0,0 +1,257 @@
+/*
+ * Dense graphs.
+ *
+ * Both algorithms grow a tree one vertex at a time. Every unfinished vertex
+ * has a key (the cheapest edge into the tree for Prim, the shortest known
+ * distance for Dijkstra) and a predecessor; finished vertices have key
+ * INT_MAX and are masked out of updates. Settling vertex u relaxes the
+ * keys with row u of the matrix and finds the smallest key in the same
+ * pass, then a second pass finds the first vertex with that key.
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "graph_algos.h"
+#include "graph_dense.h"
+
+#define NOTHING -1
+#define VECTOR_LANES 4       // 32-bit lanes in one SSE2 register
+#define HEAP_COST_FACTOR 4   // measured cost of one heap edge relaxation,
+                             //   per log2(V), in dense matrix entries
+
+/*************************************************************************
+ ** Building
+ *************************************************************************/
+
+DenseGraph* newDenseGraph(int numVertices) {
+  if (numVertices < 0) return NULL;
+
+  DenseGraph* graph = (DenseGraph*)malloc(sizeof(DenseGraph));
+  int stride = (numVertices + VECTOR_LANES - 1) / VECTOR_LANES * VECTOR_LANES;
+  size_t numEntries = (size_t)numVertices * stride;
+  int* weights = (int*)malloc(sizeof(int) * (numEntries + 1));
+  if (graph == NULL || weights == NULL) {
+    printf("Error: Memory allocation failed for dense graph\n");
+    exit(1);
+  }
+  for (size_t i = 0; i < numEntries; i++) weights[i] = INT_MAX;
+
+  graph->numVertices = numVertices;
+  graph->numEdges = 0;
+  graph->stride = stride;
+  graph->weights = weights;
+  return graph;
+}
+
+DenseGraph* newDenseGraphFromGraph(Graph* graph) {
+  DenseGraph* dense = newDenseGraph(graph->numVertices);
+  for (int v = 0; v < graph->numVertices; v++) {
+    if (graph->vertices[v] == NULL) continue;
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      addDenseEdge(dense, v, e->edge->toVertex, e->edge->weight);
+    }
+  }
+  return dense;
+}
+
+bool addDenseEdge(DenseGraph* graph, int fromVertex, int toVertex,
+                  int weight) {
+  if (fromVertex < 0 || fromVertex >= graph->numVertices || toVertex < 0 ||
+      toVertex >= graph->numVertices || fromVertex == toVertex ||
+      weight == INT_MAX) {
+    return false;
+  }
+
+  int* entry = &graph->weights[(size_t)fromVertex * graph->stride + toVertex];
+  if (*entry == INT_MAX) graph->numEdges++;
+  if (weight < *entry) *entry = weight;
+  return true;
+}
+
+bool preferDenseGraph(Graph* graph) {
+  long long numVertices = graph->numVertices;
+  int logVertices = 1;
+  while ((1LL << logVertices) < numVertices) logVertices++;
+  return numVertices > 1 &&
+         (long long)graph->numEdges * logVertices * HEAP_COST_FACTOR >=
+             numVertices * numVertices;
+}
+
+/*************************************************************************
+ ** Row kernels
+ *************************************************************************/
+
+/* Lowers keys[v] to 'base' + row[v] for every unfinished v (done[v] == 0)
+ * with an edge from 'u' that makes it smaller, making 'u' its predecessor,
+ * and returns the smallest key over all 'stride' entries afterwards.
+ */
+static int relaxRow(const int* row, int base, int u, int* keys, int* preds,
+                    const int* done, int stride) {
+#ifdef __SSE2__
+  __m128i limit = _mm_set1_epi32(INT_MAX - base);  // row[v] must be below
+  __m128i offset = _mm_set1_epi32(base);
+  __m128i pred = _mm_set1_epi32(u);
+  __m128i best = _mm_set1_epi32(INT_MAX);
+  for (int i = 0; i < stride; i += VECTOR_LANES) {
+    __m128i weight = _mm_loadu_si128((const __m128i*)&row[i]);
+    __m128i key = _mm_loadu_si128((const __m128i*)&keys[i]);
+    __m128i candidate = _mm_add_epi32(weight, offset);
+    __m128i better = _mm_and_si128(_mm_cmplt_epi32(weight, limit),
+                                   _mm_cmplt_epi32(candidate, key));
+    better = _mm_andnot_si128(_mm_loadu_si128((const __m128i*)&done[i]),
+                              better);
+    key = _mm_or_si128(_mm_and_si128(better, candidate),
+                       _mm_andnot_si128(better, key));
+    _mm_storeu_si128((__m128i*)&keys[i], key);
+    __m128i oldPred = _mm_loadu_si128((const __m128i*)&preds[i]);
+    _mm_storeu_si128((__m128i*)&preds[i],
+                     _mm_or_si128(_mm_and_si128(better, pred),
+                                  _mm_andnot_si128(better, oldPred)));
+
+    __m128i lower = _mm_cmplt_epi32(key, best);
+    best = _mm_or_si128(_mm_and_si128(lower, key),
+                        _mm_andnot_si128(lower, best));
+  }
+
+  int lanes[VECTOR_LANES];
+  _mm_storeu_si128((__m128i*)lanes, best);
+  int minKey = INT_MAX;
+  for (int i = 0; i < VECTOR_LANES; i++) {
+    if (lanes[i] < minKey) minKey = lanes[i];
+  }
+  return minKey;
+#else
+  int minKey = INT_MAX;
+  for (int i = 0; i < stride; i++) {
+    if (!done[i] && row[i] < INT_MAX - base && base + row[i] < keys[i]) {
+      keys[i] = base + row[i];
+      preds[i] = u;
+    }
+    if (keys[i] < minKey) minKey = keys[i];
+  }
+  return minKey;
+#endif
+}
+
+/* Returns the first index of 'key' in the 'stride' entries of 'keys'. */
+static int findKey(const int* keys, int key, int stride) {
+#ifdef __SSE2__
+  __m128i target = _mm_set1_epi32(key);
+  for (int i = 0; i < stride; i += VECTOR_LANES) {
+    __m128i equal =
+        _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)&keys[i]), target);
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(equal));
+    if (mask != 0) return i + __builtin_ctz(mask);
+  }
+#else
+  for (int i = 0; i < stride; i++) {
+    if (keys[i] == key) return i;
+  }
+#endif
+  return NOTHING;
+}
+
+/*************************************************************************
+ ** Algorithms
+ *************************************************************************/
+
+/* Grows a tree in 'graph' from 'startVertex' and returns its edges in the
+ * order their heads are settled, with their number in 'numTreeEdges' (if
+ * not NULL): a shortest path tree if 'shortestPaths', or else a minimum
+ * spanning tree.
+ */
+static Edge* growTree(DenseGraph* graph, int startVertex, bool shortestPaths,
+                      int* numTreeEdges) {
+  if (startVertex < 0 || startVertex >= graph->numVertices) return NULL;
+
+  int stride = graph->stride;
+  int* keys = (int*)malloc(sizeof(int) * stride);
+  int* preds = (int*)malloc(sizeof(int) * stride);
+  int* done = (int*)malloc(sizeof(int) * stride);
+  Edge* tree = (Edge*)malloc(sizeof(Edge) * graph->numVertices);
+  if (keys == NULL || preds == NULL || done == NULL || tree == NULL) {
+    printf("Error: Memory allocation failed for dense tree\n");
+    exit(1);
+  }
+  for (int v = 0; v < stride; v++) {
+    keys[v] = INT_MAX;
+    preds[v] = NOTHING;
+    done[v] = v < graph->numVertices ? 0 : -1;  // padding is never settled
+  }
+
+  int numEdges = 0;
+  int u = startVertex;
+  int key = 0;
+  while (true) {
+    int* row = &graph->weights[(size_t)u * stride];
+    done[u] = -1;
+    keys[u] = INT_MAX;
+    if (preds[u] != NOTHING) {
+      tree[numEdges].fromVertex = preds[u];
+      tree[numEdges].toVertex = u;
+      tree[numEdges].weight = graph->weights[(size_t)preds[u] * stride + u];
+      numEdges++;
+    }
+
+    int minKey = relaxRow(row, shortestPaths ? key : 0, u, keys, preds, done,
+                          stride);
+    if (minKey == INT_MAX) break;  // the rest is not reachable
+    u = findKey(keys, minKey, stride);
+    key = minKey;
+  }
+
+  free(keys);
+  free(preds);
+  free(done);
+  if (numTreeEdges != NULL) *numTreeEdges = numEdges;
+  return tree;
+}
+
+Edge* getMSTprimDense(DenseGraph* graph, int startVertex, int* numTreeEdges) {
+  return growTree(graph, startVertex, false, numTreeEdges);
+}
+
+Edge* getDistanceTreeDense(DenseGraph* graph, int startVertex,
+                           int* numTreeEdges) {
+  return growTree(graph, startVertex, true, numTreeEdges);
+}
+
+Edge* getMSTprimAuto(Graph* graph, int startVertex) {
+  if (!preferDenseGraph(graph)) return getMSTprim(graph, startVertex);
+  if (startVertex < 0 || startVertex >= graph->numVertices ||
+      graph->vertices[startVertex] == NULL) {
+    return NULL;
+  }
+
+  DenseGraph* dense = newDenseGraphFromGraph(graph);
+  Edge* tree = getMSTprimDense(dense, startVertex, NULL);
+  deleteDenseGraph(dense);
+  return tree;
+}
+
+Edge* getDistanceTreeAuto(Graph* graph, int startVertex) {
+  if (!preferDenseGraph(graph)) {
+    return getDistanceTreeDijkstra(graph, startVertex);
+  }
+  if (startVertex < 0 || startVertex >= graph->numVertices ||
+      graph->vertices[startVertex] == NULL) {
+    return NULL;
+  }
+
+  DenseGraph* dense = newDenseGraphFromGraph(graph);
+  Edge* tree = getDistanceTreeDense(dense, startVertex, NULL);
+  deleteDenseGraph(dense);
+  return tree;
+}
+
+void deleteDenseGraph(DenseGraph* graph) {
+  if (graph == NULL) return;
+
+  free(graph->weights);
+  free(graph);
+}
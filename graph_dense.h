@@ -0,0 +1,86 @@
+/*
+ * Header file for dense graphs.
+ *
+ * A DenseGraph keeps the weight of every ordered pair of vertices in one
+ * matrix. Prim's and Dijkstra's algorithms then need no priority queue:
+ * each step scans one row to update the keys of all unfinished vertices
+ * and picks the smallest key in the same pass, four vertices at a time with
+ * SSE2. That is O(V^2) in total, which beats the O(E log V) heap versions
+ * in graph_algos.c once most pairs of vertices are joined by an edge.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Dense_header
+#define __Graph_Dense_header
+
+typedef struct dense_graph {
+  int numVertices;  // total number of vertices
+  int numEdges;     // number of pairs (from, to) with an edge
+  int stride;       // length of each row: numVertices rounded up to a
+                    //   multiple of 4
+  int* weights;     // weights[from * stride + to] is the weight of the
+                    //   cheapest edge from 'from' to 'to', or INT_MAX
+} DenseGraph;
+
+/* Returns a DenseGraph with 'numVertices' vertices and no edges, or NULL
+ * if 'numVertices' < 0.
+ */
+DenseGraph* newDenseGraph(int numVertices);
+
+/* Returns a DenseGraph with the vertices and edges of Graph 'graph'. Of
+ * several parallel edges only the cheapest is kept; self-loops are
+ * dropped.
+ */
+DenseGraph* newDenseGraphFromGraph(Graph* graph);
+
+/* Adds an edge from vertex 'fromVertex' to vertex 'toVertex' of weight
+ * 'weight' to 'graph', unless there already is one at most as heavy.
+ * Returns false if either ID is not valid in 'graph' or they are equal,
+ * or if 'weight' is INT_MAX.
+ */
+bool addDenseEdge(DenseGraph* graph, int fromVertex, int toVertex,
+                  int weight);
+
+/* Returns true iff 'graph' is dense enough for the O(V^2) algorithms to
+ * beat the heap versions, i.e. when E log V is within a constant factor of
+ * V^2 (a few percent of all pairs for a few thousand vertices).
+ */
+bool preferDenseGraph(Graph* graph);
+
+/* Runs Prim's algorithm on 'graph' from vertex with ID 'startVertex' and
+ * returns the MST in the format produced by getMSTprim, with the number of
+ * its edges in 'numTreeEdges' (if not NULL). Only the component of
+ * 'startVertex' is spanned.
+ * Returns NULL if 'startVertex' is not valid in 'graph'.
+ * Precondition: 'graph' is undirected
+ */
+Edge* getMSTprimDense(DenseGraph* graph, int startVertex, int* numTreeEdges);
+
+/* Runs Dijkstra's algorithm on 'graph' from vertex with ID 'startVertex'
+ * and returns the distance tree in the format produced by
+ * getDistanceTreeDijkstra, with the number of its edges in 'numTreeEdges'
+ * (if not NULL).
+ * Returns NULL if 'startVertex' is not valid in 'graph'.
+ */
+Edge* getDistanceTreeDense(DenseGraph* graph, int startVertex,
+                           int* numTreeEdges);
+
+/* Same as getMSTprim, but runs getMSTprimDense on a dense copy of 'graph'
+ * if preferDenseGraph says so.
+ */
+Edge* getMSTprimAuto(Graph* graph, int startVertex);
+
+/* Same as getDistanceTreeDijkstra, but runs getDistanceTreeDense on a
+ * dense copy of 'graph' if preferDenseGraph says so.
+ */
+Edge* getDistanceTreeAuto(Graph* graph, int startVertex);
+
+/* Frees all memory allocated for 'graph'. */
+void deleteDenseGraph(DenseGraph* graph);
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ *  Benchmark of the dense O(V^2) Prim and Dijkstra against the heap
+ *  versions in graph_algos.c.
+ *
+ *  For several edge densities, builds a random connected undirected graph
+ *  on the given number of vertices, checks that both versions agree on the
+ *  MST weight and on all distances, and times each of them.
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O3 -march=native -Wall -Werror graph.c minheap.c graph_algos.c \
+ *       graph_dense.c graph_dense_bench.c -o graph_dense_bench
+ *
+ *   Run:
+ *   ./graph_dense_bench [numVertices] [numSources]
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "graph.h"
+#include "graph_algos.h"
+#include "graph_dense.h"
+
+#define DEFAULT_VERTICES 2000
+#define DEFAULT_SOURCES 5
+#define MAX_WEIGHT 1000
+
+/* graphs */
+Graph* randomGraph(int numVertices, int percent, uint64_t* state);
+void addUndirectedEdge(Graph* graph, int u, int v, int weight);
+uint64_t nextRandom(uint64_t* state);
+
+/* measuring */
+long long treeWeight(Edge* tree, int numTreeEdges);
+long long distanceSum(Edge* tree, int numTreeEdges, int numVertices);
+double nowSeconds(void);
+
+int main(int argc, char* argv[]) {
+  int numVertices = argc > 1 ? atoi(argv[1]) : DEFAULT_VERTICES;
+  int numSources = argc > 2 ? atoi(argv[2]) : DEFAULT_SOURCES;
+  if (numVertices < 2 || numSources < 1) {
+    printf("Usage: %s [numVertices] [numSources]\n", argv[0]);
+    return 1;
+  }
+
+  printf("%d vertices, %d sources\n", numVertices, numSources);
+  printf("%8s %10s %6s %12s %12s %12s %12s\n", "density", "edges", "dense?",
+         "heap prim", "dense prim", "heap dijk", "dense dijk");
+
+  uint64_t state = 88172645463325252ULL;
+  int percents[] = {1, 5, 10, 25, 50, 100};
+  for (int p = 0; p < 6; p++) {
+    Graph* graph = randomGraph(numVertices, percents[p], &state);
+    DenseGraph* dense = newDenseGraphFromGraph(graph);
+    int numTreeEdges = numVertices - 1;
+    int denseTreeEdges;
+
+    double start = nowSeconds();
+    Edge* heapTree = getMSTprim(graph, 0);
+    double heapPrim = nowSeconds() - start;
+    start = nowSeconds();
+    Edge* denseTree = getMSTprimDense(dense, 0, &denseTreeEdges);
+    double densePrim = nowSeconds() - start;
+    if (denseTreeEdges != numTreeEdges ||
+        treeWeight(heapTree, numTreeEdges) !=
+            treeWeight(denseTree, numTreeEdges)) {
+      printf("MST weights differ at %d%% density\n", percents[p]);
+      return 1;
+    }
+    free(heapTree);
+    free(denseTree);
+
+    double heapDijkstra = 0;
+    double denseDijkstra = 0;
+    for (int s = 0; s < numSources; s++) {
+      int source = (int)(nextRandom(&state) % numVertices);
+      start = nowSeconds();
+      heapTree = getDistanceTreeDijkstra(graph, source);
+      heapDijkstra += nowSeconds() - start;
+      start = nowSeconds();
+      denseTree = getDistanceTreeDense(dense, source, &denseTreeEdges);
+      denseDijkstra += nowSeconds() - start;
+      if (denseTreeEdges != numTreeEdges ||
+          distanceSum(heapTree, numTreeEdges, numVertices) !=
+              distanceSum(denseTree, numTreeEdges, numVertices)) {
+        printf("Distances from %d differ at %d%% density\n", source,
+               percents[p]);
+        return 1;
+      }
+      free(heapTree);
+      free(denseTree);
+    }
+
+    printf("%7d%% %10d %6s %10.2fms %10.2fms %10.2fms %10.2fms\n",
+           percents[p], graph->numEdges, preferDenseGraph(graph) ? "yes" : "no",
+           1000 * heapPrim, 1000 * densePrim,
+           1000 * heapDijkstra / numSources, 1000 * denseDijkstra / numSources);
+    deleteDenseGraph(dense);
+    deleteGraph(graph);
+  }
+  return 0;
+}
+
+/* Returns a random connected undirected graph on 'numVertices' vertices:
+ * a path through all of them, plus each other pair with probability
+ * 'percent' / 100.
+ */
+Graph* randomGraph(int numVertices, int percent, uint64_t* state) {
+  Graph* graph = newGraph(numVertices);
+  for (int v = 0; v < numVertices; v++) {
+    graph->vertices[v] = newVertex(v, NULL, NULL);
+  }
+  for (int u = 0; u < numVertices; u++) {
+    for (int v = u + 1; v < numVertices; v++) {
+      if (v != u + 1 && (int)(nextRandom(state) % 100) >= percent) continue;
+      addUndirectedEdge(graph, u, v,
+                        1 + (int)(nextRandom(state) % MAX_WEIGHT));
+    }
+  }
+  return graph;
+}
+
+/* Adds edges between 'u' and 'v' of weight 'weight' in both directions. */
+void addUndirectedEdge(Graph* graph, int u, int v, int weight) {
+  graph->vertices[u]->adjList =
+      newEdgeList(newEdge(u, v, weight), graph->vertices[u]->adjList);
+  graph->vertices[v]->adjList =
+      newEdgeList(newEdge(v, u, weight), graph->vertices[v]->adjList);
+  graph->numEdges += 2;
+}
+
+/* Returns the next value of the xorshift generator with state 'state'. */
+uint64_t nextRandom(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/* Returns the total weight of the 'numTreeEdges' edges of 'tree'. */
+long long treeWeight(Edge* tree, int numTreeEdges) {
+  long long total = 0;
+  for (int i = 0; i < numTreeEdges; i++) total += tree[i].weight;
+  return total;
+}
+
+/* Returns the sum of the distances from the root of distance tree 'tree',
+ * with 'numTreeEdges' edges in the order their heads were settled, to all
+ * 'numVertices' vertices.
+ */
+long long distanceSum(Edge* tree, int numTreeEdges, int numVertices) {
+  long long* distances = (long long*)calloc(numVertices, sizeof(long long));
+  if (distances == NULL) {
+    printf("Error: Memory allocation failed for distances\n");
+    exit(1);
+  }
+
+  long long total = 0;
+  for (int i = 0; i < numTreeEdges; i++) {
+    distances[tree[i].toVertex] =
+        distances[tree[i].fromVertex] + tree[i].weight;
+    total += distances[tree[i].toVertex];
+  }
+  free(distances);
+  return total;
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,409 @@
+/*
+ * Mutable graphs: a CSR base plus per-vertex deltas.
+ *
+ * Deleting a base arc only marks it, and inserting an arc only appends it
+ * to the delta of its tail, so a batch costs time proportional to the
+ * degrees it touches. Updates and compactions take turns on the write
+ * lock. Compaction builds the next base while holding only the read lock,
+ * so readers keep going and only updates wait for it.
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#include "graph_dynamic.h"
+#include "minheap.h"
+
+#define NOTHING -1
+
+/*************************************************************************
+ ** Building and compacting the base
+ *************************************************************************/
+
+/* Allocates the base arrays of 'graph' for 'numArcs' arcs, with every arc
+ * live. 'baseOffsets' must already be allocated.
+ */
+static void allocateBase(DynamicGraph* graph, int numArcs) {
+  graph->baseHeads = (int*)malloc(sizeof(int) * (numArcs + 1));
+  graph->baseWeights = (int*)malloc(sizeof(int) * (numArcs + 1));
+  graph->baseRemoved = (bool*)calloc(numArcs + 1, sizeof(bool));
+  if (graph->baseHeads == NULL || graph->baseWeights == NULL ||
+      graph->baseRemoved == NULL) {
+    printf("Error: Memory allocation failed for dynamic graph base\n");
+    exit(1);
+  }
+}
+
+/* Waits for compaction requests on the graph in 'arg' and serves them
+ * until the graph is deleted.
+ */
+static void* runCompactor(void* arg) {
+  DynamicGraph* graph = (DynamicGraph*)arg;
+
+  while (true) {
+    pthread_mutex_lock(&graph->wakeLock);
+    while (!graph->requested && !graph->stopping) {
+      pthread_cond_wait(&graph->wake, &graph->wakeLock);
+    }
+    bool stopping = graph->stopping;
+    graph->requested = false;
+    pthread_mutex_unlock(&graph->wakeLock);
+    if (stopping) break;
+
+    compactDynamicGraph(graph);
+  }
+  return NULL;
+}
+
+DynamicGraph* newDynamicGraph(Graph* graph, int compactThreshold) {
+  DynamicGraph* dynamic = (DynamicGraph*)malloc(sizeof(DynamicGraph));
+  if (dynamic == NULL) {
+    printf("Error: Memory allocation failed for dynamic graph\n");
+    exit(1);
+  }
+
+  int numVertices = graph->numVertices;
+  dynamic->numVertices = numVertices;
+  dynamic->baseOffsets = (int*)calloc(numVertices + 1, sizeof(int));
+  dynamic->deltas = (VertexDelta*)calloc(numVertices + 1, sizeof(VertexDelta));
+  if (dynamic->baseOffsets == NULL || dynamic->deltas == NULL) {
+    printf("Error: Memory allocation failed for dynamic graph vertices\n");
+    exit(1);
+  }
+
+  for (int v = 0; v < numVertices; v++) {
+    int degree = 0;
+    if (graph->vertices[v] != NULL) {
+      for (EdgeList* e = graph->vertices[v]->adjList; e != NULL;
+           e = e->next) {
+        degree++;
+      }
+    }
+    dynamic->baseOffsets[v + 1] = dynamic->baseOffsets[v] + degree;
+  }
+
+  int numArcs = dynamic->baseOffsets[numVertices];
+  allocateBase(dynamic, numArcs);
+  for (int v = 0; v < numVertices; v++) {
+    if (graph->vertices[v] == NULL) continue;
+    int i = dynamic->baseOffsets[v];
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      dynamic->baseHeads[i] = e->edge->toVertex;
+      dynamic->baseWeights[i] = e->edge->weight;
+      i++;
+    }
+  }
+
+  dynamic->numEdges = numArcs;
+  dynamic->numPending = 0;
+  dynamic->compactThreshold = compactThreshold > 0 ? compactThreshold : 0;
+  dynamic->version = 0;
+  pthread_rwlock_init(&dynamic->lock, NULL);
+  pthread_mutex_init(&dynamic->writeLock, NULL);
+  pthread_mutex_init(&dynamic->wakeLock, NULL);
+  pthread_cond_init(&dynamic->wake, NULL);
+  dynamic->requested = false;
+  dynamic->stopping = false;
+  dynamic->hasCompactor = false;
+
+  if (dynamic->compactThreshold > 0) {
+    if (pthread_create(&dynamic->compactor, NULL, runCompactor, dynamic) !=
+        0) {
+      printf("Error: Could not create compaction thread\n");
+      exit(1);
+    }
+    dynamic->hasCompactor = true;
+  }
+
+  return dynamic;
+}
+
+void compactDynamicGraph(DynamicGraph* graph) {
+  // no update can get in until the new base is installed
+  pthread_mutex_lock(&graph->writeLock);
+
+  // build the new base from what readers currently see
+  pthread_rwlock_rdlock(&graph->lock);
+  int numVertices = graph->numVertices;
+  int* offsets = (int*)malloc(sizeof(int) * (numVertices + 1));
+  int* heads = (int*)malloc(sizeof(int) * (graph->numEdges + 1));
+  int* weights = (int*)malloc(sizeof(int) * (graph->numEdges + 1));
+  bool* removed = (bool*)calloc(graph->numEdges + 1, sizeof(bool));
+  if (offsets == NULL || heads == NULL || weights == NULL ||
+      removed == NULL) {
+    printf("Error: Memory allocation failed for dynamic graph base\n");
+    exit(1);
+  }
+
+  int numArcs = 0;
+  for (int v = 0; v < numVertices; v++) {
+    offsets[v] = numArcs;
+    DynamicEdgeIterator it;
+    beginDynamicEdges(graph, v, &it);
+    while (nextDynamicEdge(&it, &heads[numArcs], &weights[numArcs])) {
+      numArcs++;
+    }
+  }
+  offsets[numVertices] = numArcs;
+  pthread_rwlock_unlock(&graph->lock);
+
+  pthread_rwlock_wrlock(&graph->lock);
+  free(graph->baseOffsets);
+  free(graph->baseHeads);
+  free(graph->baseWeights);
+  free(graph->baseRemoved);
+  graph->baseOffsets = offsets;
+  graph->baseHeads = heads;
+  graph->baseWeights = weights;
+  graph->baseRemoved = removed;
+  for (int v = 0; v < numVertices; v++) {
+    free(graph->deltas[v].arcs);
+    memset(&graph->deltas[v], 0, sizeof(VertexDelta));
+  }
+  graph->numPending = 0;
+  pthread_rwlock_unlock(&graph->lock);
+
+  pthread_mutex_unlock(&graph->writeLock);
+}
+
+/*************************************************************************
+ ** Updates
+ *************************************************************************/
+
+/* Appends arc ('from' -> 'to', 'weight') to the delta of 'from'. */
+static void insertArc(DynamicGraph* graph, int from, int to, int weight) {
+  VertexDelta* delta = &graph->deltas[from];
+  if (delta->numArcs == delta->capacity) {
+    delta->capacity = delta->capacity == 0 ? 4 : delta->capacity * 2;
+    delta->arcs =
+        (DeltaArc*)realloc(delta->arcs, sizeof(DeltaArc) * delta->capacity);
+    if (delta->arcs == NULL) {
+      printf("Error: Memory allocation failed for inserted arcs\n");
+      exit(1);
+    }
+  }
+  delta->arcs[delta->numArcs].head = to;
+  delta->arcs[delta->numArcs].weight = weight;
+  delta->numArcs++;
+  graph->numEdges++;
+  graph->numPending++;
+}
+
+/* Removes every live arc ('from' -> 'to'), base or delta. */
+static void deleteArcs(DynamicGraph* graph, int from, int to) {
+  VertexDelta* delta = &graph->deltas[from];
+  for (int i = graph->baseOffsets[from]; i < graph->baseOffsets[from + 1];
+       i++) {
+    if (graph->baseHeads[i] == to && !graph->baseRemoved[i]) {
+      graph->baseRemoved[i] = true;
+      delta->numRemoved++;
+      graph->numEdges--;
+      graph->numPending++;
+    }
+  }
+
+  int i = 0;
+  while (i < delta->numArcs) {
+    if (delta->arcs[i].head == to) {
+      delta->arcs[i] = delta->arcs[--delta->numArcs];
+      graph->numEdges--;
+      graph->numPending--;
+    } else {
+      i++;
+    }
+  }
+}
+
+bool applyEdgeUpdates(DynamicGraph* graph, EdgeUpdate* updates,
+                      int numUpdates) {
+  for (int i = 0; i < numUpdates; i++) {
+    EdgeUpdate* update = &updates[i];
+    if (update->fromVertex < 0 || update->fromVertex >= graph->numVertices ||
+        update->toVertex < 0 || update->toVertex >= graph->numVertices ||
+        (update->type == EDGE_INSERT && update->weight < 0)) {
+      return false;
+    }
+  }
+
+  pthread_mutex_lock(&graph->writeLock);
+  pthread_rwlock_wrlock(&graph->lock);
+  for (int i = 0; i < numUpdates; i++) {
+    EdgeUpdate* update = &updates[i];
+    if (update->type == EDGE_INSERT) {
+      insertArc(graph, update->fromVertex, update->toVertex, update->weight);
+    } else {
+      deleteArcs(graph, update->fromVertex, update->toVertex);
+    }
+  }
+  graph->version++;
+  bool due = graph->compactThreshold > 0 &&
+             graph->numPending >= graph->compactThreshold;
+  pthread_rwlock_unlock(&graph->lock);
+  pthread_mutex_unlock(&graph->writeLock);
+
+  if (due) {
+    pthread_mutex_lock(&graph->wakeLock);
+    graph->requested = true;
+    pthread_cond_signal(&graph->wake);
+    pthread_mutex_unlock(&graph->wakeLock);
+  }
+  return true;
+}
+
+/*************************************************************************
+ ** Reading
+ *************************************************************************/
+
+void beginDynamicRead(DynamicGraph* graph) {
+  pthread_rwlock_rdlock(&graph->lock);
+}
+
+void endDynamicRead(DynamicGraph* graph) {
+  pthread_rwlock_unlock(&graph->lock);
+}
+
+void beginDynamicEdges(DynamicGraph* graph, int vertex,
+                       DynamicEdgeIterator* it) {
+  it->graph = graph;
+  it->vertex = vertex;
+  it->position = graph->baseOffsets[vertex];
+  it->deltaPosition = 0;
+}
+
+bool nextDynamicEdge(DynamicEdgeIterator* it, int* toVertex, int* weight) {
+  DynamicGraph* graph = it->graph;
+  VertexDelta* delta = &graph->deltas[it->vertex];
+  int end = graph->baseOffsets[it->vertex + 1];
+
+  // base arcs of a vertex with none deleted need no check
+  while (it->position < end) {
+    int i = it->position++;
+    if (delta->numRemoved == 0 || !graph->baseRemoved[i]) {
+      *toVertex = graph->baseHeads[i];
+      *weight = graph->baseWeights[i];
+      return true;
+    }
+  }
+
+  if (it->deltaPosition < delta->numArcs) {
+    DeltaArc* arc = &delta->arcs[it->deltaPosition++];
+    *toVertex = arc->head;
+    *weight = arc->weight;
+    return true;
+  }
+  return false;
+}
+
+Edge* getDistanceTreeDynamic(DynamicGraph* graph, int startVertex,
+                             int* numTreeEdges) {
+  if (startVertex < 0 || startVertex >= graph->numVertices) return NULL;
+
+  int numVertices = graph->numVertices;
+  MinHeap* heap = newHeap(numVertices);
+  int* distances = (int*)malloc(sizeof(int) * numVertices);
+  int* predecessors = (int*)malloc(sizeof(int) * numVertices);
+  int* predWeights = (int*)malloc(sizeof(int) * numVertices);
+  Edge* tree = (Edge*)malloc(sizeof(Edge) * numVertices);
+  if (distances == NULL || predecessors == NULL || predWeights == NULL ||
+      tree == NULL) {
+    printf("Error: Memory allocation failed for dynamic distance tree\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) {
+    distances[i] = INT_MAX;
+    predecessors[i] = NOTHING;
+  }
+
+  int numEdges = 0;
+  distances[startVertex] = 0;
+  insert(heap, 0, startVertex);
+
+  beginDynamicRead(graph);
+  while (heap->size > 0) {
+    HeapNode minNode = extractMin(heap);
+    int v = minNode.id;
+    int currDis = minNode.priority;
+
+    if (predecessors[v] != NOTHING) {
+      tree[numEdges].fromVertex = predecessors[v];
+      tree[numEdges].toVertex = v;
+      tree[numEdges].weight = predWeights[v];
+      numEdges++;
+    }
+
+    DynamicEdgeIterator it;
+    int to = 0;
+    int weight = 0;
+    beginDynamicEdges(graph, v, &it);
+    while (nextDynamicEdge(&it, &to, &weight)) {
+      if (weight > INT_MAX - 1 - currDis ||
+          currDis + weight >= distances[to]) {
+        continue;
+      }
+      if (distances[to] == INT_MAX) {
+        insert(heap, currDis + weight, to);
+      } else {
+        decreasePriority(heap, to, currDis + weight);
+      }
+      distances[to] = currDis + weight;
+      predecessors[to] = v;
+      predWeights[to] = weight;
+    }
+  }
+  endDynamicRead(graph);
+
+  deleteHeap(heap);
+  free(distances);
+  free(predecessors);
+  free(predWeights);
+
+  if (numTreeEdges != NULL) *numTreeEdges = numEdges;
+  return tree;
+}
+
+Graph* newGraphFromDynamic(DynamicGraph* graph) {
+  Graph* copy = newGraph(graph->numVertices);
+
+  beginDynamicRead(graph);
+  for (int v = 0; v < graph->numVertices; v++) {
+    EdgeList* head = NULL;
+    EdgeList** tail = &head;  // append so the list keeps iteration order
+    DynamicEdgeIterator it;
+    int to = 0;
+    int weight = 0;
+    beginDynamicEdges(graph, v, &it);
+    while (nextDynamicEdge(&it, &to, &weight)) {
+      *tail = newEdgeList(newEdge(v, to, weight), NULL);
+      tail = &(*tail)->next;
+    }
+    copy->vertices[v] = newVertex(v, NULL, head);
+  }
+  copy->numEdges = graph->numEdges;
+  endDynamicRead(graph);
+
+  return copy;
+}
+
+void deleteDynamicGraph(DynamicGraph* graph) {
+  if (graph == NULL) return;
+
+  if (graph->hasCompactor) {
+    pthread_mutex_lock(&graph->wakeLock);
+    graph->stopping = true;
+    pthread_cond_signal(&graph->wake);
+    pthread_mutex_unlock(&graph->wakeLock);
+    pthread_join(graph->compactor, NULL);
+  }
+
+  for (int v = 0; v < graph->numVertices; v++) free(graph->deltas[v].arcs);
+  free(graph->deltas);
+  free(graph->baseOffsets);
+  free(graph->baseHeads);
+  free(graph->baseWeights);
+  free(graph->baseRemoved);
+  pthread_rwlock_destroy(&graph->lock);
+  pthread_mutex_destroy(&graph->writeLock);
+  pthread_mutex_destroy(&graph->wakeLock);
+  pthread_cond_destroy(&graph->wake);
+  free(graph);
+}
@@ -0,0 +1,138 @@
+/*
+ * Header file for mutable graphs.
+ *
+ * A DynamicGraph keeps its edges in an immutable CSR base plus a delta per
+ * vertex: arcs inserted since the base was built, and marks on base arcs
+ * deleted since then. Readers see base and delta as one adjacency list.
+ * Once enough updates have piled up, a background thread compacts base and
+ * deltas into a new base.
+ *
+ * Compile with -pthread.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Dynamic_header
+#define __Graph_Dynamic_header
+
+typedef enum edge_update_type {
+  EDGE_INSERT,  // add an arc, even if one with the same ends exists
+  EDGE_DELETE   // remove every arc with the same ends; weight is ignored
+} EdgeUpdateType;
+
+typedef struct edge_update {
+  EdgeUpdateType type;  // what to do
+  int fromVertex;       // ID of the tail of the arc
+  int toVertex;         // ID of the head of the arc
+  int weight;           // weight of an inserted arc; weight >= 0
+} EdgeUpdate;
+
+typedef struct delta_arc {
+  int head;    // ID of the head of this inserted arc
+  int weight;  // weight of this inserted arc
+} DeltaArc;
+
+typedef struct vertex_delta {  // changes to one vertex since the base
+  DeltaArc* arcs;  // arcs inserted since the base was built
+  int numArcs;     // number of arcs in 'arcs'
+  int capacity;    // number of arcs that fit in 'arcs'
+  int numRemoved;  // number of this vertex's base arcs deleted; if 0,
+                   //   readers skip 'baseRemoved'
+} VertexDelta;
+
+typedef struct dynamic_graph {
+  int numVertices;            // total number of vertices
+  int numEdges;               // number of live arcs, base and delta
+  int* baseOffsets;           // base arcs of id are at positions
+                              //   baseOffsets[id] .. baseOffsets[id+1]
+  int* baseHeads;             // baseHeads[i] is the head of base arc i
+  int* baseWeights;           // baseWeights[i] is the weight of base arc i
+  bool* baseRemoved;          // baseRemoved[i] is true iff base arc i has
+                              //   been deleted
+  VertexDelta* deltas;        // deltas[id] holds the changes to id
+  int numPending;             // inserted arcs plus deleted base arcs
+                              //   not yet folded into the base
+  int compactThreshold;       // compact once 'numPending' reaches this;
+                              //   0 if compaction is manual only
+  unsigned long version;      // incremented by every applied batch
+  pthread_rwlock_t lock;      // readers share it, updates own it
+  pthread_mutex_t writeLock;  // serializes updates and compactions
+  pthread_mutex_t wakeLock;   // protects 'requested' and 'stopping'
+  pthread_cond_t wake;        // signals the compaction thread
+  bool requested;             // set when a compaction is due
+  bool stopping;              // set when the graph is being deleted
+  bool hasCompactor;          // true iff 'compactor' was started
+  pthread_t compactor;        // background compaction thread
+} DynamicGraph;
+
+typedef struct dynamic_edge_iterator {  // position in one adjacency list
+  DynamicGraph* graph;  // graph being read
+  int vertex;           // ID of the vertex whose arcs are listed
+  int position;         // next base arc to look at
+  int deltaPosition;    // next delta arc to look at
+} DynamicEdgeIterator;
+
+/* Returns a new DynamicGraph whose base holds the edges of Graph 'graph',
+ * which is not modified. If 'compactThreshold' > 0, a background thread
+ * compacts the graph whenever that many updates are pending.
+ */
+DynamicGraph* newDynamicGraph(Graph* graph, int compactThreshold);
+
+/* Applies the 'numUpdates' updates in 'updates' to 'graph' in order, as one
+ * batch that readers see either entirely or not at all.
+ * Returns false, and applies nothing, if any update names an invalid vertex
+ * or inserts an arc with negative weight.
+ */
+bool applyEdgeUpdates(DynamicGraph* graph, EdgeUpdate* updates,
+                      int numUpdates);
+
+/* Folds all pending updates of 'graph' into a new base. Updates wait while
+ * it is built, so no build is wasted; readers wait only while it is
+ * installed.
+ */
+void compactDynamicGraph(DynamicGraph* graph);
+
+/* Starts reading 'graph': no batch is applied until the matching
+ * endDynamicRead. Any number of readers may read at the same time.
+ */
+void beginDynamicRead(DynamicGraph* graph);
+
+/* Ends a read started by beginDynamicRead. */
+void endDynamicRead(DynamicGraph* graph);
+
+/* Positions 'it' before the first live arc of vertex with ID 'vertex' in
+ * 'graph'. Must be called between beginDynamicRead and endDynamicRead.
+ */
+void beginDynamicEdges(DynamicGraph* graph, int vertex,
+                       DynamicEdgeIterator* it);
+
+/* Moves 'it' to the next live arc, base arcs first, and stores its head and
+ * weight in 'toVertex' and 'weight'. Returns false if there are no more.
+ */
+bool nextDynamicEdge(DynamicEdgeIterator* it, int* toVertex, int* weight);
+
+/* Runs Dijkstra's algorithm on the current edges of 'graph' from vertex
+ * with ID 'startVertex' and returns the distance tree in the format
+ * produced by getDistanceTreeDijkstra, with the number of its edges in
+ * 'numTreeEdges' (if not NULL).
+ * Returns NULL if 'startVertex' is not valid in 'graph'.
+ */
+Edge* getDistanceTreeDynamic(DynamicGraph* graph, int startVertex,
+                             int* numTreeEdges);
+
+/* Returns a new Graph with the current edges of 'graph', for use with the
+ * algorithms that take a Graph. Vertex values are NULL.
+ */
+Graph* newGraphFromDynamic(DynamicGraph* graph);
+
+/* Stops the compaction thread of 'graph' and frees all memory allocated
+ * for it. No other thread may be using 'graph'.
+ */
+void deleteDynamicGraph(DynamicGraph* graph);
+
+#endif
@@ -0,0 +1,792 @@
+/*
+ * Graphs larger than memory.
+ *
+ * A graph file starts with a FileHeader and the table of its blocks,
+ * followed by the blocks themselves. Block b holds, as ints, the
+ * numVertices + 1 offsets of its vertices, then the heads and then the
+ * weights of their edges, so a block is read in one piece and used in place.
+ *
+ * The builder splits the vertices into buckets of verticesPerBucket
+ * consecutive IDs and keeps a buffer of CHUNK_EDGES edges per bucket. A
+ * full buffer is appended to the temporary file as one chunk. Blocks are
+ * cut from the degrees so that the per vertex arrays of the algorithms and
+ * at least one block fit in the budget; a block is then assembled by
+ * reading back only the chunks of the buckets it overlaps, which keeps the
+ * order in which the edges of each vertex were added.
+ */
+
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+
+#include "graph_external.h"
+#include "graph_io.h"
+#include "graph_queue.h"
+
+#define NOTHING -1
+#define MAGIC "GRAPHEXT"
+#define MAGIC_SIZE 8
+#define CHUNK_EDGES 4096           // edges per bucket buffer
+#define EDGE_INTS 3                // a spilled edge is (from, to, weight)
+#define MAX_BLOCK_BYTES (1 << 30)  // keeps edge offsets within an int
+#define INITIAL_CHUNKS 64          // chunks a new builder has room for
+#define SEPARATORS " \t\r\n"
+
+typedef struct file_header {  // start of a graph file
+  char magic[MAGIC_SIZE];  // MAGIC
+  int numVertices;         // total number of vertices
+  int numBlocks;           // number of blocks in the table after this
+  long long numEdges;      // total number of edges
+} FileHeader;
+
+/*************************************************************************
+ ** Input and output
+ *************************************************************************/
+
+/* Returns the current time in seconds on a monotonic clock. */
+static double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Reads 'size' bytes at offset 'position' of 'f' into 'data', counting
+ * them in 'stats'. Returns false if they could not all be read.
+ */
+static bool readAt(FILE* f, long long position, void* data, size_t size,
+                   IoStats* stats) {
+  double start = nowSeconds();
+  bool done = fseek(f, (long)position, SEEK_SET) == 0 &&
+              fread(data, 1, size, f) == size;
+  stats->seconds += nowSeconds() - start;
+  stats->bytesRead += size;
+  stats->numReads++;
+  return done;
+}
+
+/* Appends 'size' bytes from 'data' at the current offset of 'f', counting
+ * them in 'stats'. Returns false if they could not all be written.
+ */
+static bool writeAll(FILE* f, const void* data, size_t size, IoStats* stats) {
+  double start = nowSeconds();
+  bool done = fwrite(data, 1, size, f) == size;
+  stats->seconds += nowSeconds() - start;
+  stats->bytesWritten += size;
+  stats->numWrites++;
+  return done;
+}
+
+/* Returns the number of bytes of a block with 'numVertices' vertices and
+ * 'numEdges' edges.
+ */
+static size_t blockBytes(int numVertices, long long numEdges) {
+  return sizeof(int) * ((size_t)numVertices + 1 + 2 * (size_t)numEdges);
+}
+
+/*************************************************************************
+ ** Building
+ *************************************************************************/
+
+ExternalBuilder* newExternalBuilder(const char* path, int numVertices,
+                                    size_t memoryBudget) {
+  if (numVertices < 1) return NULL;
+
+  size_t chunkBytes = sizeof(int) * EDGE_INTS * CHUNK_EDGES;
+  size_t vertexBytes = sizeof(int) * (size_t)numVertices;
+  if (memoryBudget < 2 * vertexBytes + 2 * chunkBytes) {
+    printf("Memory budget of %zu bytes is too small for %d vertices. "
+           "Giving up.\n", memoryBudget, numVertices);
+    return NULL;
+  }
+
+  ExternalBuilder* builder =
+      (ExternalBuilder*)calloc(1, sizeof(ExternalBuilder));
+  if (builder == NULL) {
+    printf("Error: Memory allocation failed for external builder\n");
+    exit(1);
+  }
+  builder->spill = tmpfile();
+  if (builder->spill == NULL) {
+    printf("Could not create a temporary file. Giving up.\n");
+    free(builder);
+    return NULL;
+  }
+  builder->numVertices = numVertices;
+  builder->memoryBudget = memoryBudget;
+
+  // the buffers get half of what the degrees leave
+  size_t numBuckets = (memoryBudget - vertexBytes) / 2 / chunkBytes;
+  if (numBuckets > (size_t)numVertices) numBuckets = numVertices;
+  builder->verticesPerBucket =
+      (numVertices + (int)numBuckets - 1) / (int)numBuckets;
+  builder->numBuckets = (numVertices + builder->verticesPerBucket - 1) /
+                        builder->verticesPerBucket;
+
+  builder->path = (char*)malloc(strlen(path) + 1);
+  builder->degrees = (int*)calloc(numVertices, sizeof(int));
+  builder->buffers = (int*)malloc(chunkBytes * builder->numBuckets);
+  builder->bufferSizes = (int*)calloc(builder->numBuckets, sizeof(int));
+  builder->chunks = (SpillChunk*)malloc(sizeof(SpillChunk) * INITIAL_CHUNKS);
+  if (builder->path == NULL || builder->degrees == NULL ||
+      builder->buffers == NULL || builder->bufferSizes == NULL ||
+      builder->chunks == NULL) {
+    printf("Error: Memory allocation failed for external builder\n");
+    exit(1);
+  }
+  strcpy(builder->path, path);
+  builder->chunkCapacity = INITIAL_CHUNKS;
+  return builder;
+}
+
+/* Appends the buffer of bucket 'bucket' of 'builder' to its temporary file
+ * as a new chunk and empties it. Returns false if it could not be written.
+ */
+static bool spillBucket(ExternalBuilder* builder, int bucket) {
+  if (builder->numChunks == builder->chunkCapacity) {
+    builder->chunkCapacity *= 2;
+    builder->chunks = (SpillChunk*)realloc(
+        builder->chunks, sizeof(SpillChunk) * builder->chunkCapacity);
+    if (builder->chunks == NULL) {
+      printf("Error: Memory allocation failed for spilled chunks\n");
+      exit(1);
+    }
+  }
+
+  SpillChunk* chunk = &builder->chunks[builder->numChunks++];
+  chunk->bucket = bucket;
+  chunk->numEdges = builder->bufferSizes[bucket];
+  chunk->position = ftell(builder->spill);
+  builder->bufferSizes[bucket] = 0;
+
+  int* buffer = builder->buffers + (size_t)bucket * EDGE_INTS * CHUNK_EDGES;
+  return chunk->position >= 0 &&
+         writeAll(builder->spill, buffer,
+                  sizeof(int) * EDGE_INTS * chunk->numEdges, &builder->stats);
+}
+
+bool addExternalEdge(ExternalBuilder* builder, int fromVertex, int toVertex,
+                     int weight) {
+  if (fromVertex < 0 || fromVertex >= builder->numVertices || toVertex < 0 ||
+      toVertex >= builder->numVertices || weight < 0 ||
+      builder->degrees[fromVertex] == INT_MAX) {
+    return false;
+  }
+
+  int bucket = fromVertex / builder->verticesPerBucket;
+  int* edge = builder->buffers + ((size_t)bucket * CHUNK_EDGES +
+                                  builder->bufferSizes[bucket]) * EDGE_INTS;
+  edge[0] = fromVertex;
+  edge[1] = toVertex;
+  edge[2] = weight;
+  builder->degrees[fromVertex]++;
+  builder->numEdges++;
+  if (++builder->bufferSizes[bucket] == CHUNK_EDGES) {
+    return spillBucket(builder, bucket);
+  }
+  return true;
+}
+
+void deleteExternalBuilder(ExternalBuilder* builder) {
+  if (builder == NULL) return;
+
+  fclose(builder->spill);  // removes the temporary file
+  free(builder->path);
+  free(builder->degrees);
+  free(builder->buffers);
+  free(builder->bufferSizes);
+  free(builder->chunks);
+  free(builder);
+}
+
+/* Returns the blocks of the vertices of 'builder', each at most 'limit'
+ * bytes unless it has a single vertex, with their positions in a file that
+ * starts with a header and the table, and stores their number in
+ * 'numBlocks'.
+ */
+static ExternalBlock* cutBlocks(ExternalBuilder* builder, size_t limit,
+                                int* numBlocks) {
+  int capacity = INITIAL_CHUNKS;
+  ExternalBlock* blocks =
+      (ExternalBlock*)malloc(sizeof(ExternalBlock) * capacity);
+  if (blocks == NULL) {
+    printf("Error: Memory allocation failed for block table\n");
+    exit(1);
+  }
+
+  int count = 0;
+  int first = 0;
+  long long numEdges = 0;
+  for (int id = 0; id <= builder->numVertices; id++) {
+    bool last = id == builder->numVertices;
+    if (!last && (id == first || blockBytes(id + 1 - first, numEdges +
+                                 builder->degrees[id]) <= limit)) {
+      numEdges += builder->degrees[id];
+      continue;
+    }
+
+    if (count == capacity) {
+      capacity *= 2;
+      blocks = (ExternalBlock*)realloc(blocks,
+                                       sizeof(ExternalBlock) * capacity);
+      if (blocks == NULL) {
+        printf("Error: Memory allocation failed for block table\n");
+        exit(1);
+      }
+    }
+    blocks[count].firstVertex = first;
+    blocks[count].numVertices = id - first;
+    blocks[count].numEdges = numEdges;
+    count++;
+    first = id;
+    numEdges = last ? 0 : builder->degrees[id];
+  }
+
+  long long position = sizeof(FileHeader) + sizeof(ExternalBlock) * count;
+  for (int b = 0; b < count; b++) {
+    blocks[b].position = position;
+    position += blockBytes(blocks[b].numVertices, blocks[b].numEdges);
+  }
+  *numBlocks = count;
+  return blocks;
+}
+
+/* Fills 'data' with block 'block' of 'builder', reading the chunks of the
+ * buckets it overlaps into 'chunk'. Returns false if a chunk could not be
+ * read.
+ */
+static bool assembleBlock(ExternalBuilder* builder, ExternalBlock* block,
+                          int* data, int* chunk) {
+  int first = block->firstVertex;
+  int end = first + block->numVertices;
+  int* offsets = data;
+  int* heads = data + block->numVertices + 1;
+  int* weights = heads + block->numEdges;
+
+  // offsets[i] starts at the first edge of vertex i and counts up to its end
+  offsets[0] = 0;
+  for (int i = 0; i < block->numVertices; i++) {
+    offsets[i + 1] = offsets[i] + builder->degrees[first + i];
+  }
+  memmove(offsets + 1, offsets, sizeof(int) * block->numVertices);
+
+  int firstBucket = first / builder->verticesPerBucket;
+  int lastBucket = (end - 1) / builder->verticesPerBucket;
+  for (int c = 0; c < builder->numChunks; c++) {
+    SpillChunk* spilled = &builder->chunks[c];
+    if (spilled->bucket < firstBucket || spilled->bucket > lastBucket) {
+      continue;
+    }
+    if (!readAt(builder->spill, spilled->position, chunk,
+                sizeof(int) * EDGE_INTS * spilled->numEdges,
+                &builder->stats)) {
+      return false;
+    }
+    for (int e = 0; e < spilled->numEdges; e++) {
+      int* edge = chunk + e * EDGE_INTS;
+      if (edge[0] < first || edge[0] >= end) continue;
+      int slot = offsets[edge[0] - first + 1]++;
+      heads[slot] = edge[1];
+      weights[slot] = edge[2];
+    }
+  }
+  return true;
+}
+
+bool finishExternalGraph(ExternalBuilder* builder, IoStats* stats) {
+  bool done = true;
+  for (int b = 0; b < builder->numBuckets && done; b++) {
+    if (builder->bufferSizes[b] > 0) done = spillBucket(builder, b);
+  }
+  // the buffers are no longer needed, which leaves room for the blocks
+  free(builder->buffers);
+  builder->buffers = NULL;
+
+  // a block leaves room for the seven ints per vertex of the spanning
+  // forest, or for two blocks and the arrays of the shortest paths
+  size_t vertexBytes = sizeof(int) * (size_t)builder->numVertices;
+  size_t limit = builder->memoryBudget > 8 * vertexBytes
+                     ? (builder->memoryBudget - 7 * vertexBytes) / 2
+                     : (builder->memoryBudget - vertexBytes) / 4;
+  if (limit > MAX_BLOCK_BYTES) limit = MAX_BLOCK_BYTES;
+  int numBlocks = 0;
+  ExternalBlock* blocks = cutBlocks(builder, limit, &numBlocks);
+
+  FILE* f = done ? fopen(builder->path, "wb") : NULL;
+  if (f == NULL) {
+    printf("Could not write graph file %s. Giving up.\n", builder->path);
+    free(blocks);
+    deleteExternalBuilder(builder);
+    return false;
+  }
+
+  FileHeader header;
+  memcpy(header.magic, MAGIC, MAGIC_SIZE);
+  header.numVertices = builder->numVertices;
+  header.numBlocks = numBlocks;
+  header.numEdges = builder->numEdges;
+  done = writeAll(f, &header, sizeof(header), &builder->stats) &&
+         writeAll(f, blocks, sizeof(ExternalBlock) * numBlocks,
+                  &builder->stats);
+
+  size_t largest = 0;
+  for (int b = 0; b < numBlocks; b++) {
+    size_t size = blockBytes(blocks[b].numVertices, blocks[b].numEdges);
+    if (size > largest) largest = size;
+  }
+  int* data = (int*)malloc(largest);
+  int* chunk = (int*)malloc(sizeof(int) * EDGE_INTS * CHUNK_EDGES);
+  if (data == NULL || chunk == NULL) {
+    printf("Error: Memory allocation failed for graph block\n");
+    exit(1);
+  }
+  for (int b = 0; b < numBlocks && done; b++) {
+    done = assembleBlock(builder, &blocks[b], data, chunk) &&
+           writeAll(f, data,
+                    blockBytes(blocks[b].numVertices, blocks[b].numEdges),
+                    &builder->stats);
+  }
+  if (fclose(f) != 0) done = false;
+  if (!done) {
+    printf("Could not write graph file %s. Giving up.\n", builder->path);
+  }
+
+  if (stats != NULL) *stats = builder->stats;
+  free(data);
+  free(chunk);
+  free(blocks);
+  deleteExternalBuilder(builder);
+  return done;
+}
+
+bool convertToExternalGraph(FILE* f, const char* path, size_t memoryBudget,
+                            IoStats* stats) {
+  char* line = NULL;
+  size_t capacity = 0;
+  if (getline(&line, &capacity, f) < 0) {
+    printf("Could not read number of vertices from input file. "
+           "Giving up.\n");
+    free(line);
+    return false;
+  }
+  int numVertices = atoi(line);
+  if (numVertices <= 0) {
+    printf("Invalid number of vertices (%d). Giving up.\n", numVertices);
+    free(line);
+    return false;
+  }
+
+  ExternalBuilder* builder = newExternalBuilder(path, numVertices,
+                                                memoryBudget);
+  if (builder == NULL) {
+    free(line);
+    return false;
+  }
+
+  while (getline(&line, &capacity, f) >= 0) {
+    char* token = strtok(line, SEPARATORS);
+    if (token == NULL) continue;  // a blank line
+
+    int id = readVertexID(token, numVertices);
+    bool valid = id != NOTHING;
+    while (valid && (token = strtok(NULL, SEPARATORS)) != NULL) {
+      int toVertex = readVertexID(token, numVertices);
+      token = strtok(NULL, SEPARATORS);
+      int weight = token == NULL ? NOTHING : readWeight(token);
+      valid = toVertex != NOTHING && weight != NOTHING &&
+              addExternalEdge(builder, id, toVertex, weight);
+    }
+    if (!valid) {
+      printf("Could not get vertex info from a line. Giving up.\n");
+      free(line);
+      deleteExternalBuilder(builder);
+      return false;
+    }
+  }
+  free(line);
+  return finishExternalGraph(builder, stats);
+}
+
+/*************************************************************************
+ ** Opening and caching
+ *************************************************************************/
+
+ExternalGraph* openExternalGraph(const char* path, size_t memoryBudget) {
+  FILE* f = fopen(path, "rb");
+  if (f == NULL) {
+    printf("Could not open graph file %s. Giving up.\n", path);
+    return NULL;
+  }
+
+  ExternalGraph* graph = (ExternalGraph*)calloc(1, sizeof(ExternalGraph));
+  if (graph == NULL) {
+    printf("Error: Memory allocation failed for external graph\n");
+    exit(1);
+  }
+  graph->file = f;
+  graph->memoryBudget = memoryBudget;
+
+  FileHeader header;
+  if (!readAt(f, 0, &header, sizeof(header), &graph->stats) ||
+      memcmp(header.magic, MAGIC, MAGIC_SIZE) != 0 ||
+      header.numVertices < 1 || header.numBlocks < 1 ||
+      header.numBlocks > header.numVertices) {
+    printf("%s is not a graph file. Giving up.\n", path);
+    closeExternalGraph(graph);
+    return NULL;
+  }
+  graph->numVertices = header.numVertices;
+  graph->numEdges = header.numEdges;
+  graph->numBlocks = header.numBlocks;
+  graph->blocks =
+      (ExternalBlock*)malloc(sizeof(ExternalBlock) * graph->numBlocks);
+  if (graph->blocks == NULL) {
+    printf("Error: Memory allocation failed for block table\n");
+    exit(1);
+  }
+  if (!readAt(f, sizeof(header), graph->blocks,
+              sizeof(ExternalBlock) * graph->numBlocks, &graph->stats)) {
+    printf("%s is not a graph file. Giving up.\n", path);
+    closeExternalGraph(graph);
+    return NULL;
+  }
+
+  int nextVertex = 0;
+  for (int b = 0; b < graph->numBlocks; b++) {
+    ExternalBlock* block = &graph->blocks[b];
+    if (block->firstVertex != nextVertex || block->numVertices < 1 ||
+        block->numEdges < 0 || block->numEdges > INT_MAX) {
+      printf("%s is not a graph file. Giving up.\n", path);
+      closeExternalGraph(graph);
+      return NULL;
+    }
+    nextVertex += block->numVertices;
+    size_t size = blockBytes(block->numVertices, block->numEdges);
+    if (size > graph->largestBlock) graph->largestBlock = size;
+  }
+  if (nextVertex != graph->numVertices) {
+    printf("%s is not a graph file. Giving up.\n", path);
+    closeExternalGraph(graph);
+    return NULL;
+  }
+  if (graph->largestBlock > memoryBudget) {
+    printf("Memory budget of %zu bytes is too small for blocks of %zu "
+           "bytes. Giving up.\n", memoryBudget, graph->largestBlock);
+    closeExternalGraph(graph);
+    return NULL;
+  }
+  return graph;
+}
+
+/* Empties the cache of 'graph' and gives it as many slots as fit in the
+ * budget after 'reserved' bytes, up to one per block. Returns false if not
+ * even one block fits.
+ */
+static bool prepareCache(ExternalGraph* graph, size_t reserved) {
+  if (reserved >= graph->memoryBudget ||
+      graph->memoryBudget - reserved < graph->largestBlock) {
+    printf("Memory budget of %zu bytes is too small for %d vertices. "
+           "Giving up.\n", graph->memoryBudget, graph->numVertices);
+    return false;
+  }
+
+  size_t numSlots = (graph->memoryBudget - reserved) / graph->largestBlock;
+  if (numSlots > (size_t)graph->numBlocks) numSlots = graph->numBlocks;
+  for (int s = 0; s < graph->cacheSlots; s++) free(graph->cache[s].data);
+  free(graph->cache);
+
+  graph->cacheSlots = (int)numSlots;
+  graph->cache = (LoadedBlock*)calloc(numSlots, sizeof(LoadedBlock));
+  if (graph->cache == NULL) {
+    printf("Error: Memory allocation failed for block cache\n");
+    exit(1);
+  }
+  for (int s = 0; s < graph->cacheSlots; s++) graph->cache[s].index = NOTHING;
+  return true;
+}
+
+/* Returns block 'index' of 'graph', reading it into the least recently
+ * used slot of the cache unless it is already there. Exits if the block
+ * cannot be read, since the file was valid when it was opened.
+ */
+static LoadedBlock* loadBlock(ExternalGraph* graph, int index) {
+  graph->clock++;
+  LoadedBlock* slot = &graph->cache[0];
+  for (int s = 0; s < graph->cacheSlots; s++) {
+    LoadedBlock* candidate = &graph->cache[s];
+    if (candidate->index == index) {
+      candidate->used = graph->clock;
+      return candidate;
+    }
+    if (candidate->used < slot->used) slot = candidate;
+  }
+
+  ExternalBlock* block = &graph->blocks[index];
+  if (slot->data == NULL) {
+    slot->data = (int*)malloc(graph->largestBlock);
+    if (slot->data == NULL) {
+      printf("Error: Memory allocation failed for graph block\n");
+      exit(1);
+    }
+  }
+  slot->index = NOTHING;
+  slot->size = blockBytes(block->numVertices, block->numEdges);
+  if (!readAt(graph->file, block->position, slot->data, slot->size,
+              &graph->stats)) {
+    printf("Error: Could not read block %d of graph file\n", index);
+    exit(1);
+  }
+  slot->index = index;
+  slot->used = graph->clock;
+  slot->offsets = slot->data;
+  slot->heads = slot->data + block->numVertices + 1;
+  slot->weights = slot->heads + block->numEdges;
+  return slot;
+}
+
+/* Returns the index of the block of 'graph' that holds vertex 'id'. */
+static int blockOf(ExternalGraph* graph, int id) {
+  int low = 0;
+  int high = graph->numBlocks - 1;
+  while (low < high) {
+    int middle = (low + high + 1) / 2;
+    if (graph->blocks[middle].firstVertex <= id) {
+      low = middle;
+    } else {
+      high = middle - 1;
+    }
+  }
+  return low;
+}
+
+void closeExternalGraph(ExternalGraph* graph) {
+  if (graph == NULL) return;
+
+  fclose(graph->file);
+  for (int s = 0; s < graph->cacheSlots; s++) free(graph->cache[s].data);
+  free(graph->cache);
+  free(graph->blocks);
+  free(graph);
+}
+
+/*************************************************************************
+ ** Shortest paths
+ *************************************************************************/
+
+/* Runs Dijkstra's algorithm inside block 'index' of 'graph' from its
+ * pending vertices. Edges into other blocks mark their heads pending and
+ * lower the smallest pending distance 'blockMins' of their block.
+ */
+static void relaxBlock(ExternalGraph* graph, int index, ExternalPaths* paths,
+                       bool* pending, int* blockMins) {
+  LoadedBlock* loaded = loadBlock(graph, index);
+  ExternalBlock* block = &graph->blocks[index];
+  int first = block->firstVertex;
+  int* distances = paths->distances;
+
+  PriorityQueue* queue =
+      newPriorityQueue(QUEUE_LAZY_HEAP, block->numVertices);
+  for (int i = 0; i < block->numVertices; i++) {
+    if (!pending[first + i]) continue;
+    pending[first + i] = false;
+    pushQueue(queue, i, distances[first + i]);
+  }
+
+  int i, distance;
+  while (popQueue(queue, &i, &distance)) {
+    if (distance > distances[first + i]) continue;  // stale
+
+    for (int e = loaded->offsets[i]; e < loaded->offsets[i + 1]; e++) {
+      int head = loaded->heads[e];
+      int weight = loaded->weights[e];
+      if (weight >= INT_MAX - distance) continue;  // would overflow
+      int newDistance = distance + weight;
+      if (newDistance >= distances[head]) continue;
+
+      distances[head] = newDistance;
+      paths->parents[head] = first + i;
+      if (head >= first && head < first + block->numVertices) {
+        pushQueue(queue, head - first, newDistance);
+      } else {
+        pending[head] = true;
+        int headBlock = blockOf(graph, head);
+        if (newDistance < blockMins[headBlock]) {
+          blockMins[headBlock] = newDistance;
+        }
+      }
+    }
+  }
+  deletePriorityQueue(queue);
+  paths->blockLoads++;
+}
+
+ExternalPaths* getShortestPathsExternal(ExternalGraph* graph,
+                                        int startVertex) {
+  if (startVertex < 0 || startVertex >= graph->numVertices) return NULL;
+
+  // distances, parents, pending flags, and a queue of up to one block
+  size_t reserved = (2 * sizeof(int) + sizeof(bool)) * graph->numVertices +
+                    sizeof(int) * graph->numBlocks + graph->largestBlock;
+  if (!prepareCache(graph, reserved)) return NULL;
+
+  ExternalPaths* paths = (ExternalPaths*)malloc(sizeof(ExternalPaths));
+  if (paths == NULL) {
+    printf("Error: Memory allocation failed for external paths\n");
+    exit(1);
+  }
+  int numVertices = graph->numVertices;
+  paths->source = startVertex;
+  paths->numVertices = numVertices;
+  paths->blockLoads = 0;
+  paths->distances = (int*)malloc(sizeof(int) * numVertices);
+  paths->parents = (int*)malloc(sizeof(int) * numVertices);
+  bool* pending = (bool*)calloc(numVertices, sizeof(bool));
+  int* blockMins = (int*)malloc(sizeof(int) * graph->numBlocks);
+  if (paths->distances == NULL || paths->parents == NULL || pending == NULL ||
+      blockMins == NULL) {
+    printf("Error: Memory allocation failed for external paths\n");
+    exit(1);
+  }
+  for (int id = 0; id < numVertices; id++) {
+    paths->distances[id] = INT_MAX;
+    paths->parents[id] = NOTHING;
+  }
+  for (int b = 0; b < graph->numBlocks; b++) blockMins[b] = INT_MAX;
+
+  paths->distances[startVertex] = 0;
+  pending[startVertex] = true;
+  blockMins[blockOf(graph, startVertex)] = 0;
+  while (true) {
+    // the block with the closest pending vertex goes next
+    int next = NOTHING;
+    for (int b = 0; b < graph->numBlocks; b++) {
+      if (blockMins[b] < INT_MAX &&
+          (next == NOTHING || blockMins[b] < blockMins[next])) {
+        next = b;
+      }
+    }
+    if (next == NOTHING) break;
+
+    blockMins[next] = INT_MAX;
+    relaxBlock(graph, next, paths, pending, blockMins);
+  }
+
+  free(pending);
+  free(blockMins);
+  return paths;
+}
+
+void deleteExternalPaths(ExternalPaths* paths) {
+  if (paths == NULL) return;
+
+  free(paths->distances);
+  free(paths->parents);
+  free(paths);
+}
+
+/*************************************************************************
+ ** Minimum spanning forest
+ *************************************************************************/
+
+/* Returns the root of the component of 'id' in union-find 'parents',
+ * halving the path on the way.
+ */
+static int findRoot(int* parents, int id) {
+  while (parents[id] != id) {
+    parents[id] = parents[parents[id]];
+    id = parents[id];
+  }
+  return id;
+}
+
+/* Returns true iff edge ('from', 'to', 'weight') is lighter than edge
+ * ('otherFrom', 'otherTo', 'otherWeight'), breaking ties by endpoints so
+ * that all components agree on one order and no cycle is formed.
+ */
+static bool isLighter(int from, int to, int weight, int otherFrom,
+                      int otherTo, int otherWeight) {
+  if (weight != otherWeight) return weight < otherWeight;
+  int low = from < to ? from : to;
+  int otherLow = otherFrom < otherTo ? otherFrom : otherTo;
+  if (low != otherLow) return low < otherLow;
+  int high = from < to ? to : from;
+  int otherHigh = otherFrom < otherTo ? otherTo : otherFrom;
+  return high < otherHigh;
+}
+
+Edge* getSpanningForestExternal(ExternalGraph* graph, int* numForestEdges,
+                                long long* totalWeight) {
+  // union-find, the cheapest edge of every component, and the forest
+  int numVertices = graph->numVertices;
+  size_t reserved = (4 * sizeof(int) + sizeof(Edge)) * numVertices;
+  if (!prepareCache(graph, reserved)) return NULL;
+
+  int* parents = (int*)malloc(sizeof(int) * numVertices);
+  int* cheapFrom = (int*)malloc(sizeof(int) * numVertices);
+  int* cheapTo = (int*)malloc(sizeof(int) * numVertices);
+  int* cheapWeight = (int*)malloc(sizeof(int) * numVertices);
+  Edge* forest = (Edge*)malloc(sizeof(Edge) * numVertices);
+  if (parents == NULL || cheapFrom == NULL || cheapTo == NULL ||
+      cheapWeight == NULL || forest == NULL) {
+    printf("Error: Memory allocation failed for spanning forest\n");
+    exit(1);
+  }
+  for (int id = 0; id < numVertices; id++) parents[id] = id;
+
+  int numEdges = 0;
+  long long total = 0;
+  bool merged = true;
+  while (merged) {
+    for (int id = 0; id < numVertices; id++) cheapFrom[id] = NOTHING;
+
+    // one sequential scan finds the cheapest edge leaving every component
+    for (int b = 0; b < graph->numBlocks; b++) {
+      LoadedBlock* loaded = loadBlock(graph, b);
+      int first = graph->blocks[b].firstVertex;
+      for (int i = 0; i < graph->blocks[b].numVertices; i++) {
+        int from = first + i;
+        int root = findRoot(parents, from);
+        for (int e = loaded->offsets[i]; e < loaded->offsets[i + 1]; e++) {
+          int to = loaded->heads[e];
+          int weight = loaded->weights[e];
+          if (findRoot(parents, to) == root) continue;
+          if (cheapFrom[root] == NOTHING ||
+              isLighter(from, to, weight, cheapFrom[root], cheapTo[root],
+                        cheapWeight[root])) {
+            cheapFrom[root] = from;
+            cheapTo[root] = to;
+            cheapWeight[root] = weight;
+          }
+        }
+      }
+    }
+
+    merged = false;
+    for (int id = 0; id < numVertices; id++) {
+      if (cheapFrom[id] == NOTHING) continue;
+      int fromRoot = findRoot(parents, cheapFrom[id]);
+      int toRoot = findRoot(parents, cheapTo[id]);
+      if (fromRoot == toRoot) continue;  // chosen from both sides
+
+      // the smaller root wins, which keeps the trees shallow enough
+      if (fromRoot < toRoot) {
+        parents[toRoot] = fromRoot;
+      } else {
+        parents[fromRoot] = toRoot;
+      }
+      forest[numEdges].fromVertex = cheapFrom[id];
+      forest[numEdges].toVertex = cheapTo[id];
+      forest[numEdges].weight = cheapWeight[id];
+      total += cheapWeight[id];
+      numEdges++;
+      merged = true;
+    }
+  }
+
+  free(parents);
+  free(cheapFrom);
+  free(cheapTo);
+  free(cheapWeight);
+  if (numForestEdges != NULL) *numForestEdges = numEdges;
+  if (totalWeight != NULL) *totalWeight = total;
+  return forest;
+}
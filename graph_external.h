@@ -0,0 +1,171 @@
+/*
+ * Header file for graphs larger than memory.
+ *
+ * An ExternalGraph lives in a file of blocks, each the compact adjacency
+ * arrays of a range of consecutive vertices, sized so that one block fits
+ * well within the memory budget. Algorithms keep a few ints per vertex in
+ * memory, read whole blocks with single large reads, and keep as many
+ * recently used blocks as the budget allows:
+ *   - shortest paths run Dijkstra's algorithm inside one block at a time,
+ *     always the block with the closest pending vertex; relaxing an edge
+ *     into another block marks its head pending there. A block is read
+ *     again only if a shorter path into it turns up later.
+ *   - the minimum spanning forest is found by Boruvka's algorithm, where
+ *     every round is one sequential scan of all blocks.
+ *
+ * Graph files are written by an ExternalBuilder, which takes edges in any
+ * order, spills them to a temporary file in chunks per range of tails, and
+ * then gathers every block from its chunks. Only the degrees of all
+ * vertices and the chunk buffers are held in memory.
+ *
+ * All I/O is counted in the IoStats of the builder or graph.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_External_header
+#define __Graph_External_header
+
+typedef struct io_stats {
+  long long bytesRead;     // bytes read from files
+  long long bytesWritten;  // bytes written to files
+  long long numReads;      // number of reads
+  long long numWrites;     // number of writes
+  double seconds;          // time spent reading and writing
+} IoStats;
+
+typedef struct spill_chunk {  // edges of one bucket in the temporary file
+  int bucket;          // bucket the edges belong to
+  int numEdges;        // number of edges in the chunk
+  long long position;  // offset of the chunk in the temporary file
+} SpillChunk;
+
+typedef struct external_builder {
+  char* path;             // name of the graph file to write
+  FILE* spill;            // temporary file of edge chunks
+  int numVertices;        // total number of vertices
+  long long numEdges;     // number of edges added so far
+  size_t memoryBudget;    // bytes the builder may use
+  int* degrees;           // degrees[id] is the number of edges leaving id
+  int numBuckets;         // number of ranges of tails
+  int verticesPerBucket;  // number of vertices in every range but the last
+  int* buffers;           // (from, to, weight) triples of every bucket
+  int* bufferSizes;       // number of edges in the buffer of every bucket
+  SpillChunk* chunks;     // chunks written to 'spill'
+  int numChunks;          // number of chunks in 'chunks'
+  int chunkCapacity;      // number of chunks 'chunks' has room for
+  IoStats stats;          // I/O done so far
+} ExternalBuilder;
+
+typedef struct external_block {
+  int firstVertex;     // ID of the first vertex of this block
+  int numVertices;     // number of vertices in this block
+  long long numEdges;  // number of edges leaving them
+  long long position;  // offset of the block in the graph file
+} ExternalBlock;
+
+typedef struct loaded_block {  // a block in memory
+  int index;       // index of the block, or -1 for an empty slot
+  long long used;  // time of the last use, for replacement
+  size_t size;     // number of bytes of 'data'
+  int* data;       // offsets, then heads, then weights
+  int* offsets;    // edges leaving firstVertex + i are at
+                   //   [offsets[i], offsets[i+1])
+  int* heads;      // heads[j] is the head of edge j
+  int* weights;    // weights[j] is the weight of edge j
+} LoadedBlock;
+
+typedef struct external_graph {
+  FILE* file;             // the graph file
+  int numVertices;        // total number of vertices
+  long long numEdges;     // total number of edges
+  int numBlocks;          // number of blocks
+  ExternalBlock* blocks;  // the block table
+  size_t largestBlock;    // number of bytes of the largest block
+  size_t memoryBudget;    // bytes the algorithms may use
+  LoadedBlock* cache;     // blocks kept in memory
+  int cacheSlots;         // number of slots in 'cache'
+  long long clock;        // counts block uses
+  IoStats stats;          // I/O done on this graph so far
+} ExternalGraph;
+
+typedef struct external_paths {
+  int source;       // ID of the start vertex
+  int numVertices;  // total number of vertices
+  int* distances;   // distances[id] from the source, INT_MAX if unreachable
+  int* parents;     // parents[id] is the vertex before id on a shortest
+                    //   path, or -1
+  int blockLoads;   // number of times a block was processed
+} ExternalPaths;
+
+/* Returns a new builder of a graph file named 'path' with 'numVertices'
+ * vertices, which uses at most about 'memoryBudget' bytes.
+ * Returns NULL if the budget is too small for the vertices, or if the
+ * temporary file cannot be created.
+ */
+ExternalBuilder* newExternalBuilder(const char* path, int numVertices,
+                                    size_t memoryBudget);
+
+/* Adds an edge from 'fromVertex' to 'toVertex' with weight 'weight' to
+ * 'builder'. Returns false if an ID is not valid, the weight is negative,
+ * or the edge could not be written.
+ */
+bool addExternalEdge(ExternalBuilder* builder, int fromVertex, int toVertex,
+                     int weight);
+
+/* Frees 'builder' without writing a graph file. */
+void deleteExternalBuilder(ExternalBuilder* builder);
+
+/* Writes the graph file of 'builder', stores the I/O of the whole build in
+ * 'stats' (if not NULL), and frees 'builder'. Returns false if the file
+ * could not be written.
+ */
+bool finishExternalGraph(ExternalBuilder* builder, IoStats* stats);
+
+/* Writes a graph file named 'path' from the file 'f' in the format read by
+ * createGraph, using at most about 'memoryBudget' bytes, and stores the
+ * I/O in 'stats' (if not NULL). Lines may be of any length.
+ * Returns false if 'f' is not a valid graph file or the graph file could
+ * not be written.
+ */
+bool convertToExternalGraph(FILE* f, const char* path, size_t memoryBudget,
+                            IoStats* stats);
+
+/* Opens the graph file named 'path' for algorithms that use at most about
+ * 'memoryBudget' bytes.
+ * Returns NULL if the file is not a valid graph file, or if the budget
+ * cannot hold the largest block.
+ */
+ExternalGraph* openExternalGraph(const char* path, size_t memoryBudget);
+
+/* Finds the shortest paths from vertex with ID 'startVertex' to all
+ * vertices of 'graph'.
+ * Returns NULL if 'startVertex' is not valid in 'graph', or if the budget
+ * cannot hold the per vertex arrays and one block.
+ * Precondition: no edge weight is negative
+ */
+ExternalPaths* getShortestPathsExternal(ExternalGraph* graph,
+                                        int startVertex);
+
+/* Returns the edges of a minimum spanning forest of 'graph', with their
+ * number in 'numForestEdges' and their total weight in 'totalWeight' (if
+ * not NULL).
+ * Returns NULL if the budget cannot hold the per vertex arrays and one
+ * block.
+ * Precondition: 'graph' is undirected, i.e. has every edge in both
+ *   directions with the same weight
+ */
+Edge* getSpanningForestExternal(ExternalGraph* graph, int* numForestEdges,
+                                long long* totalWeight);
+
+/* Closes 'graph' and frees all memory allocated for it. */
+void closeExternalGraph(ExternalGraph* graph);
+
+/* Frees all memory allocated for 'paths'. */
+void deleteExternalPaths(ExternalPaths* paths);
+
+#endif
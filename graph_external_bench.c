@@ -0,0 +1,185 @@
+/*
+ *  Benchmark of the graphs larger than memory of graph_external.h.
+ *
+ *  Writes a random connected undirected graph to a graph file through an
+ *  ExternalBuilder, then opens it with the same memory budget, finds the
+ *  shortest paths from a few random sources and a minimum spanning forest,
+ *  and prints the time and the I/O of every step.
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O3 -Wall -Werror graph.c graph_io.c graph_queue.c minheap.c \
+ *       graph_external.c graph_external_bench.c -o graph_external_bench
+ *
+ *   Run:
+ *   ./graph_external_bench [numVertices] [budgetMB] [path]
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "graph_external.h"
+
+#define DEFAULT_VERTICES 1000000
+#define DEFAULT_BUDGET_MB 64
+#define DEFAULT_PATH "graph_external_bench.ext"
+#define NUM_SOURCES 4
+#define AVERAGE_DEGREE 8
+#define MAX_WEIGHT 1000
+
+/* graphs */
+bool writeRandomGraph(const char* path, int numVertices, size_t budget,
+                      uint64_t* state);
+uint64_t nextRandom(uint64_t* state);
+
+/* measuring */
+void printStats(const char* step, double seconds, IoStats* stats);
+double nowSeconds(void);
+
+int main(int argc, char* argv[]) {
+  int numVertices = argc > 1 ? atoi(argv[1]) : DEFAULT_VERTICES;
+  int budgetMB = argc > 2 ? atoi(argv[2]) : DEFAULT_BUDGET_MB;
+  const char* path = argc > 3 ? argv[3] : DEFAULT_PATH;
+  if (numVertices < 2 || budgetMB < 1) {
+    printf("Usage: %s [numVertices >= 2] [budgetMB >= 1] [path]\n", argv[0]);
+    return 1;
+  }
+  size_t budget = (size_t)budgetMB * 1024 * 1024;
+
+  uint64_t state = 88172645463325252ULL;
+  double start = nowSeconds();
+  if (!writeRandomGraph(path, numVertices, budget, &state)) return 1;
+
+  ExternalGraph* graph = openExternalGraph(path, budget);
+  if (graph == NULL) return 1;
+  printf("%d vertices, %lld edges, %d blocks of at most %zu bytes, "
+         "budget %d MB\n\n", graph->numVertices, graph->numEdges,
+         graph->numBlocks, graph->largestBlock, budgetMB);
+
+  for (int s = 0; s < NUM_SOURCES; s++) {
+    int source = (int)(nextRandom(&state) % numVertices);
+    IoStats before = graph->stats;
+    start = nowSeconds();
+    ExternalPaths* paths = getShortestPathsExternal(graph, source);
+    if (paths == NULL) return 1;
+    double seconds = nowSeconds() - start;
+
+    long long total = 0;
+    int reached = 0;
+    for (int id = 0; id < numVertices; id++) {
+      if (paths->distances[id] == INT_MAX) continue;
+      total += paths->distances[id];
+      reached++;
+    }
+    IoStats used = graph->stats;
+    used.bytesRead -= before.bytesRead;
+    used.numReads -= before.numReads;
+    used.seconds -= before.seconds;
+    printStats("shortest paths", seconds, &used);
+    printf("  from %d: %d reached, distance sum %lld, %d block loads\n",
+           source, reached, total, paths->blockLoads);
+    deleteExternalPaths(paths);
+  }
+
+  IoStats before = graph->stats;
+  start = nowSeconds();
+  int numForestEdges;
+  long long totalWeight;
+  Edge* forest = getSpanningForestExternal(graph, &numForestEdges,
+                                           &totalWeight);
+  if (forest == NULL) return 1;
+  double seconds = nowSeconds() - start;
+  IoStats used = graph->stats;
+  used.bytesRead -= before.bytesRead;
+  used.numReads -= before.numReads;
+  used.seconds -= before.seconds;
+  printStats("spanning forest", seconds, &used);
+  printf("  %d edges, total weight %lld\n", numForestEdges, totalWeight);
+  free(forest);
+
+  closeExternalGraph(graph);
+  remove(path);
+  return 0;
+}
+
+/* Writes a random connected undirected graph on 'numVertices' vertices
+ * with average degree AVERAGE_DEGREE and weights in [1, MAX_WEIGHT] to the
+ * graph file 'path' within 'budget' bytes: a cycle through all vertices in
+ * random order, plus random edges. Returns false if it could not be
+ * written.
+ */
+bool writeRandomGraph(const char* path, int numVertices, size_t budget,
+                      uint64_t* state) {
+  double start = nowSeconds();
+  ExternalBuilder* builder = newExternalBuilder(path, numVertices, budget);
+  if (builder == NULL) return false;
+
+  int* order = (int*)malloc(sizeof(int) * numVertices);
+  if (order == NULL) {
+    printf("Error: Memory allocation failed for vertex order\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) order[i] = i;
+  for (int i = numVertices - 1; i > 0; i--) {
+    int j = (int)(nextRandom(state) % (i + 1));
+    int swap = order[i];
+    order[i] = order[j];
+    order[j] = swap;
+  }
+
+  long long numEdges = (long long)numVertices / 2 * AVERAGE_DEGREE;
+  bool added = true;
+  for (long long i = 0; i < numEdges && added; i++) {
+    int from, to;
+    if (i < numVertices) {
+      from = order[i];
+      to = order[(i + 1) % numVertices];
+    } else {
+      from = (int)(nextRandom(state) % numVertices);
+      to = (int)(nextRandom(state) % numVertices);
+    }
+    int weight = 1 + (int)(nextRandom(state) % MAX_WEIGHT);
+    added = addExternalEdge(builder, from, to, weight) &&
+            addExternalEdge(builder, to, from, weight);
+  }
+  free(order);
+  if (!added) {
+    printf("Could not add an edge\n");
+    deleteExternalBuilder(builder);
+    return false;
+  }
+
+  IoStats stats;
+  if (!finishExternalGraph(builder, &stats)) return false;
+  printStats("build", nowSeconds() - start, &stats);
+  return true;
+}
+
+/* Prints the time 'seconds' taken by step 'step' and its I/O 'stats'. */
+void printStats(const char* step, double seconds, IoStats* stats) {
+  printf("%-16s %8.2f s, %8.1f MB read in %lld reads, %8.1f MB written "
+         "in %lld writes, %.2f s of I/O\n", step, seconds,
+         stats->bytesRead / 1e6, stats->numReads, stats->bytesWritten / 1e6,
+         stats->numWrites, stats->seconds);
+}
+
+/* Returns the next value of the xorshift generator with state 'state'. */
+uint64_t nextRandom(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
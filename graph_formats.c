@@ -0,0 +1,480 @@
+/*
+ * Reading graphs in standard benchmark formats.
+ *
+ * A TokenReader refills a large buffer with fread and hands out integers,
+ * words and line ends without copying lines; each loader walks the lines of
+ * its format with it and appends edges to an EdgeBuffer.
+ */
+
+#include <limits.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include "graph_formats.h"
+
+#define BUFFER_SIZE (1 << 20)  // bytes read from the file at a time
+#define MAX_WORD 64            // longest word read, including the '\0'
+#define MAX_PARSED 1000000000000LL  // larger numbers are rejected
+#define MAX_RESERVED (1 << 22)      // edges reserved up front from a header
+
+typedef struct token_reader {
+  FILE* f;               // file being read
+  char* buffer;          // the current block of the file
+  int length;            // number of bytes in 'buffer'
+  int position;          // index in 'buffer' of the next byte
+  long long numBytes;    // number of bytes read so far
+  long long lineNumber;  // number of the current line, from 1
+} TokenReader;
+
+typedef struct edge_buffer {  // growing flat edge arrays
+  int* fromVertices;  // tails of the edges read so far
+  int* toVertices;    // heads of the edges read so far
+  int* weights;       // weights of the edges read so far
+  int numEdges;       // number of edges read so far
+  int capacity;       // number of edges that fit in the arrays
+} EdgeBuffer;
+
+/*************************************************************************
+ ** Tokens
+ *************************************************************************/
+
+/* Returns the next byte of 'reader' without consuming it, or EOF. */
+static inline int peekChar(TokenReader* reader) {
+  if (reader->position == reader->length) {
+    reader->length = (int)fread(reader->buffer, 1, BUFFER_SIZE, reader->f);
+    reader->position = 0;
+    reader->numBytes += reader->length;
+    if (reader->length == 0) return EOF;
+  }
+  return (unsigned char)reader->buffer[reader->position];
+}
+
+/* Skips spaces, tabs and carriage returns, but not line ends. */
+static inline void skipBlanks(TokenReader* reader) {
+  int c = peekChar(reader);
+  while (c == ' ' || c == '\t' || c == '\r') {
+    reader->position++;
+    c = peekChar(reader);
+  }
+}
+
+/* Returns true iff only blanks are left on the current line. */
+static bool atLineEnd(TokenReader* reader) {
+  skipBlanks(reader);
+  int c = peekChar(reader);
+  return c == '\n' || c == EOF;
+}
+
+/* Skips the rest of the current line, including its line end. */
+static void skipLine(TokenReader* reader) {
+  int c = peekChar(reader);
+  while (c != EOF) {
+    reader->position++;
+    if (c == '\n') {
+      reader->lineNumber++;
+      return;
+    }
+    c = peekChar(reader);
+  }
+}
+
+/* Skips empty lines and lines starting with 'comment'. Returns false if
+ * the end of the file is reached.
+ */
+static bool skipCommentLines(TokenReader* reader, char comment) {
+  while (true) {
+    skipBlanks(reader);
+    int c = peekChar(reader);
+    if (c == EOF) return false;
+    if (c != comment && c != '\n') return true;
+    skipLine(reader);
+  }
+}
+
+/* Reads an integer on the current line into 'value'. Returns false if
+ * there is none, or if it is larger than MAX_PARSED.
+ */
+static inline bool readInt(TokenReader* reader, long long* value) {
+  skipBlanks(reader);
+  bool negative = peekChar(reader) == '-';
+  if (negative) reader->position++;
+
+  int c = peekChar(reader);
+  if (c < '0' || c > '9') return false;
+  long long result = 0;
+  while (c >= '0' && c <= '9') {
+    result = result * 10 + (c - '0');
+    if (result > MAX_PARSED) return false;
+    reader->position++;
+    c = peekChar(reader);
+  }
+  *value = negative ? -result : result;
+  return true;
+}
+
+/* Reads a word of non-blank characters on the current line into 'word',
+ * which has room for MAX_WORD characters. Returns false if there is none.
+ */
+static bool readWord(TokenReader* reader, char* word) {
+  skipBlanks(reader);
+  int length = 0;
+  int c = peekChar(reader);
+  while (c != EOF && c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+    if (length == MAX_WORD - 1) return false;
+    word[length++] = (char)c;
+    reader->position++;
+    c = peekChar(reader);
+  }
+  word[length] = '\0';
+  return length > 0;
+}
+
+/* Prints that 'what' on the current line of 'reader' is not valid, and
+ * returns false.
+ */
+static bool failLoad(TokenReader* reader, const char* what) {
+  printf("Invalid %s on line %lld of input file. Giving up.\n", what,
+         reader->lineNumber);
+  return false;
+}
+
+/*************************************************************************
+ ** Edges
+ *************************************************************************/
+
+/* Makes room for at least 'capacity' edges in 'edges'. */
+static void reserveEdges(EdgeBuffer* edges, long long capacity) {
+  if (capacity <= edges->capacity) return;
+  if (capacity > INT_MAX) capacity = INT_MAX;
+
+  edges->capacity = (int)capacity;
+  edges->fromVertices = (int*)realloc(edges->fromVertices,
+                                      sizeof(int) * edges->capacity);
+  edges->toVertices =
+      (int*)realloc(edges->toVertices, sizeof(int) * edges->capacity);
+  edges->weights = (int*)realloc(edges->weights, sizeof(int) * edges->capacity);
+  if (edges->fromVertices == NULL || edges->toVertices == NULL ||
+      edges->weights == NULL) {
+    printf("Error: Memory allocation failed for loaded edges\n");
+    exit(1);
+  }
+}
+
+/* Makes room in 'edges' for the 'numClaimed' edges a file header claims,
+ * but for at most MAX_RESERVED, so that a header cannot make the loader
+ * allocate more than the file holds; pushEdge grows the arrays beyond.
+ */
+static void reserveClaimedEdges(EdgeBuffer* edges, long long numClaimed) {
+  reserveEdges(edges, numClaimed < MAX_RESERVED ? numClaimed : MAX_RESERVED);
+}
+
+/* Appends the edge ('fromVertex', 'toVertex', 'weight') to 'edges', after
+ * checking that the IDs are in [0, 'numVertices') and the weight in
+ * [0, INT_MAX]. Returns false if they are not.
+ */
+static bool pushEdge(TokenReader* reader, EdgeBuffer* edges,
+                     long long fromVertex, long long toVertex,
+                     long long weight, long long numVertices) {
+  if (fromVertex < 0 || fromVertex >= numVertices || toVertex < 0 ||
+      toVertex >= numVertices) {
+    return failLoad(reader, "vertex ID");
+  }
+  if (weight < 0 || weight > INT_MAX) return failLoad(reader, "edge weight");
+  if (edges->numEdges == INT_MAX) return failLoad(reader, "number of edges");
+
+  if (edges->numEdges == edges->capacity) {
+    reserveEdges(edges, 2LL * edges->capacity + 1024);
+  }
+  edges->fromVertices[edges->numEdges] = (int)fromVertex;
+  edges->toVertices[edges->numEdges] = (int)toVertex;
+  edges->weights[edges->numEdges] = (int)weight;
+  edges->numEdges++;
+  return true;
+}
+
+/*************************************************************************
+ ** Formats
+ *************************************************************************/
+
+/* Reads a DIMACS shortest path file into 'edges' and 'numVertices'. */
+static bool readDimacs(TokenReader* reader, EdgeBuffer* edges,
+                       int* numVertices) {
+  char word[MAX_WORD];
+  long long n = -1;
+  long long m, u, v, w;
+
+  while (skipCommentLines(reader, 'c')) {
+    int c = peekChar(reader);
+    reader->position++;
+    if (c == 'p') {
+      if (n >= 0 || !readWord(reader, word) || strcmp(word, "sp") != 0 ||
+          !readInt(reader, &n) || !readInt(reader, &m) || n < 0 ||
+          n > INT_MAX || m < 0 || m > INT_MAX) {
+        return failLoad(reader, "problem line");
+      }
+      reserveClaimedEdges(edges, m);
+    } else if (c == 'a') {
+      if (n < 0) return failLoad(reader, "arc before the problem line");
+      if (!readInt(reader, &u) || !readInt(reader, &v) ||
+          !readInt(reader, &w)) {
+        return failLoad(reader, "arc line");
+      }
+      if (!pushEdge(reader, edges, u - 1, v - 1, w, n)) return false;
+    } else {
+      return failLoad(reader, "line type");
+    }
+    if (!atLineEnd(reader)) return failLoad(reader, "line end");
+    skipLine(reader);
+  }
+
+  if (n < 0) return failLoad(reader, "file without a problem line");
+  *numVertices = (int)n;
+  return true;
+}
+
+/* Reads a METIS file into 'edges' and 'numVertices'. */
+static bool readMetis(TokenReader* reader, EdgeBuffer* edges,
+                      int* numVertices) {
+  long long n, m, u, w;
+  long long format = 0;
+  long long numConstraints = 1;
+
+  if (!skipCommentLines(reader, '%') || !readInt(reader, &n) ||
+      !readInt(reader, &m) || n < 0 || n > INT_MAX || m < 0 ||
+      m > INT_MAX / 2) {
+    return failLoad(reader, "header");
+  }
+  if (!atLineEnd(reader) && !readInt(reader, &format)) {
+    return failLoad(reader, "format");
+  }
+  if (!atLineEnd(reader) && !readInt(reader, &numConstraints)) {
+    return failLoad(reader, "number of vertex weights");
+  }
+  bool hasSizes = format / 100 % 10 == 1;
+  bool hasVertexWeights = format / 10 % 10 == 1;
+  bool hasEdgeWeights = format % 10 == 1;
+  skipLine(reader);
+  reserveClaimedEdges(edges, 2 * m);
+
+  for (long long v = 0; v < n; v++) {
+    // a vertex without neighbours has an empty line, so only skip comments
+    skipBlanks(reader);
+    while (peekChar(reader) == '%') {
+      skipLine(reader);
+      skipBlanks(reader);
+    }
+    if (peekChar(reader) == EOF) return failLoad(reader, "end of file");
+
+    int numSkipped = (hasSizes ? 1 : 0) +
+                     (hasVertexWeights ? (int)numConstraints : 0);
+    for (int i = 0; i < numSkipped; i++) {
+      if (!readInt(reader, &w)) return failLoad(reader, "vertex weight");
+    }
+    while (!atLineEnd(reader)) {
+      w = 1;
+      if (!readInt(reader, &u) || (hasEdgeWeights && !readInt(reader, &w))) {
+        return failLoad(reader, "adjacency line");
+      }
+      if (!pushEdge(reader, edges, v, u - 1, w, n)) return false;
+    }
+    skipLine(reader);
+  }
+
+  if (edges->numEdges != 2 * m) return failLoad(reader, "number of edges");
+  *numVertices = (int)n;
+  return true;
+}
+
+/* Reads a Matrix Market coordinate file into 'edges' and 'numVertices',
+ * and adds BUILD_SYMMETRIZE to 'options' for a symmetric matrix.
+ */
+static bool readMatrixMarket(TokenReader* reader, EdgeBuffer* edges,
+                             int* numVertices, int* options) {
+  char banner[MAX_WORD], object[MAX_WORD], layout[MAX_WORD];
+  char field[MAX_WORD], symmetry[MAX_WORD];
+  if (!readWord(reader, banner) || !readWord(reader, object) ||
+      !readWord(reader, layout) || !readWord(reader, field) ||
+      !readWord(reader, symmetry) ||
+      strcasecmp(banner, "%%MatrixMarket") != 0 ||
+      strcasecmp(object, "matrix") != 0 ||
+      strcasecmp(layout, "coordinate") != 0) {
+    return failLoad(reader, "banner");
+  }
+  bool pattern = strcasecmp(field, "pattern") == 0;
+  bool real = strcasecmp(field, "real") == 0;
+  if (!pattern && !real && strcasecmp(field, "integer") != 0) {
+    return failLoad(reader, "field (only real, integer and pattern)");
+  }
+  if (strcasecmp(symmetry, "symmetric") == 0) {
+    *options |= BUILD_SYMMETRIZE;
+  } else if (strcasecmp(symmetry, "general") != 0) {
+    return failLoad(reader, "symmetry (only general and symmetric)");
+  }
+  skipLine(reader);
+
+  long long rows, columns, numEntries, i, j;
+  long long w = 1;
+  if (!skipCommentLines(reader, '%') || !readInt(reader, &rows) ||
+      !readInt(reader, &columns) || !readInt(reader, &numEntries) ||
+      rows < 0 || columns < 0 || rows > INT_MAX || columns > INT_MAX ||
+      numEntries < 0 || numEntries > INT_MAX) {
+    return failLoad(reader, "size line");
+  }
+  long long n = rows > columns ? rows : columns;
+  skipLine(reader);
+  reserveClaimedEdges(edges, numEntries);
+
+  char value[MAX_WORD];
+  for (long long e = 0; e < numEntries; e++) {
+    if (!skipCommentLines(reader, '%') || !readInt(reader, &i) ||
+        !readInt(reader, &j)) {
+      return failLoad(reader, "entry");
+    }
+    if (real) {
+      // weights are integers, so real values are rounded
+      char* end;
+      if (!readWord(reader, value)) return failLoad(reader, "entry value");
+      double d = strtod(value, &end);
+      if (*end != '\0' || d < 0 || d > INT_MAX) {
+        return failLoad(reader, "entry value");
+      }
+      w = (long long)(d + 0.5);
+    } else if (!pattern && !readInt(reader, &w)) {
+      return failLoad(reader, "entry value");
+    }
+    if (!pushEdge(reader, edges, i - 1, j - 1, w, n)) return false;
+    skipLine(reader);
+  }
+
+  *numVertices = (int)n;
+  return true;
+}
+
+/* Reads a SNAP edge list into 'edges' and 'numVertices'. */
+static bool readSnap(TokenReader* reader, EdgeBuffer* edges,
+                     int* numVertices) {
+  long long u, v, w;
+  long long maxVertex = -1;
+
+  while (skipCommentLines(reader, '#')) {
+    w = 1;
+    if (!readInt(reader, &u) || !readInt(reader, &v) ||
+        (!atLineEnd(reader) && !readInt(reader, &w))) {
+      return failLoad(reader, "edge line");
+    }
+    if (!pushEdge(reader, edges, u, v, w, INT_MAX)) return false;
+    if (u > maxVertex) maxVertex = u;
+    if (v > maxVertex) maxVertex = v;
+    skipLine(reader);
+  }
+
+  *numVertices = (int)(maxVertex + 1);
+  return true;
+}
+
+/*************************************************************************
+ ** Loading
+ *************************************************************************/
+
+bool guessGraphFormat(const char* path, GraphFormat* format) {
+  const char* extension = strrchr(path, '.');
+  if (extension == NULL) return false;
+
+  if (strcmp(extension, ".gr") == 0) {
+    *format = FORMAT_DIMACS;
+  } else if (strcmp(extension, ".graph") == 0 ||
+             strcmp(extension, ".metis") == 0) {
+    *format = FORMAT_METIS;
+  } else if (strcmp(extension, ".mtx") == 0) {
+    *format = FORMAT_MATRIX_MARKET;
+  } else if (strcmp(extension, ".txt") == 0 ||
+             strcmp(extension, ".edges") == 0) {
+    *format = FORMAT_SNAP;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+static double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Returns a new CompactGraph from the file 'f' in format 'format', built
+ * with BuildOptions 'options' and 'numThreads' threads, and stores load
+ * statistics in 'stats' (if not NULL), or NULL if 'f' is not valid.
+ */
+static CompactGraph* loadCompactGraph(FILE* f, GraphFormat format,
+                                      int options, int numThreads,
+                                      LoadStats* stats) {
+  double start = nowSeconds();
+  TokenReader reader = {f, (char*)malloc(BUFFER_SIZE), 0, 0, 0, 1};
+  EdgeBuffer edges = {NULL, NULL, NULL, 0, 0};
+  if (reader.buffer == NULL) {
+    printf("Error: Memory allocation failed for input buffer\n");
+    exit(1);
+  }
+
+  int numVertices = 0;
+  bool valid = false;
+  switch (format) {
+    case FORMAT_DIMACS:
+      valid = readDimacs(&reader, &edges, &numVertices);
+      break;
+    case FORMAT_METIS:
+      valid = readMetis(&reader, &edges, &numVertices);
+      break;
+    case FORMAT_MATRIX_MARKET:
+      valid = readMatrixMarket(&reader, &edges, &numVertices, &options);
+      break;
+    case FORMAT_SNAP:
+      valid = readSnap(&reader, &edges, &numVertices);
+      break;
+  }
+
+  CompactGraph* compact = NULL;
+  if (valid) {
+    compact = buildCompactGraph(numVertices, edges.numEdges,
+                                edges.fromVertices, edges.toVertices,
+                                edges.weights, options, numThreads);
+    if (compact == NULL) printf("Could not build the graph. Giving up.\n");
+  }
+
+  if (stats != NULL) {
+    stats->numBytes = reader.numBytes;
+    stats->numEdges = edges.numEdges;
+    stats->seconds = nowSeconds() - start;
+  }
+  free(reader.buffer);
+  free(edges.fromVertices);
+  free(edges.toVertices);
+  free(edges.weights);
+  return compact;
+}
+
+Graph* loadGraph(FILE* f, GraphFormat format, int options, int numThreads,
+                 LoadStats* stats) {
+  CompactGraph* compact =
+      loadCompactGraph(f, format, options, numThreads, stats);
+  if (compact == NULL) return NULL;
+
+  Graph* graph = newGraphFromCompact(compact);
+  deleteCompactGraph(compact);
+  return graph;
+}
+
+NarrowGraph* loadNarrowGraph(FILE* f, GraphFormat format, int options,
+                             int numThreads, LoadStats* stats) {
+  CompactGraph* compact =
+      loadCompactGraph(f, format, options, numThreads, stats);
+  if (compact == NULL) return NULL;
+
+  NarrowGraph* graph = newNarrowGraphFromCompact(compact);
+  if (graph == NULL) printf("Negative edge weights. Giving up.\n");
+  deleteCompactGraph(compact);
+  return graph;
+}
@@ -0,0 +1,63 @@
+/*
+ * Header file for reading graphs in standard benchmark formats.
+ *
+ * Supported are DIMACS shortest path (.gr), METIS, Matrix Market coordinate
+ * (.mtx) and SNAP edge lists. All loaders stream the file through one
+ * buffered integer parser, collect flat edge arrays, and build the Graph
+ * with buildCompactGraph. Vertex IDs are shifted to start at 0 where the
+ * format counts from 1. loadNarrowGraph builds a NarrowGraph instead,
+ * choosing the narrowest weight type that fits the file.
+ *
+ * Compile with -pthread.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+#include "graph_build.h"
+#include "graph_narrow.h"
+
+#ifndef __Graph_Formats_header
+#define __Graph_Formats_header
+
+typedef enum graph_format {
+  FORMAT_DIMACS,         // "p sp n m" and "a u v w" lines, IDs from 1
+  FORMAT_METIS,          // "n m [fmt [ncon]]", then one adjacency line per
+                         //   vertex, IDs from 1
+  FORMAT_MATRIX_MARKET,  // coordinate matrix, entry (i, j) is an edge from
+                         //   i to j, IDs from 1; symmetric matrices are
+                         //   symmetrized, pattern matrices get weight 1
+  FORMAT_SNAP            // "u v [w]" lines, '#' comments, IDs from 0,
+                         //   weight 1 if missing
+} GraphFormat;
+
+typedef struct load_stats {
+  long long numBytes;  // number of bytes read from the file
+  long long numEdges;  // number of edges read from the file
+  double seconds;      // wall clock time to read and build the graph
+} LoadStats;
+
+/* Stores in 'format' the format of the file named 'path', guessed from its
+ * extension: .gr, .graph or .metis, .mtx, and .txt or .edges. Returns false
+ * if the extension is none of those.
+ */
+bool guessGraphFormat(const char* path, GraphFormat* format);
+
+/* Creates and returns a new Graph from the file 'f' in format 'format',
+ * built with BuildOptions 'options' and 'numThreads' threads, and stores
+ * load statistics in 'stats' (if not NULL).
+ * Returns NULL if 'f' is not a valid file of that format.
+ */
+Graph* loadGraph(FILE* f, GraphFormat format, int options, int numThreads,
+                 LoadStats* stats);
+
+/* Like loadGraph, but returns a NarrowGraph, whose weights take the
+ * narrowest type that fits them. Also returns NULL if a weight is
+ * negative.
+ */
+NarrowGraph* loadNarrowGraph(FILE* f, GraphFormat format, int options,
+                             int numThreads, LoadStats* stats);
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * Header file for reading graphs from files.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Io_header
+#define __Graph_Io_header
+
+/* Creates and returns a new Graph from the information in the file 'f'.
+ * Returns NULL if 'f' is not a valid graph file.
+ */
+Graph* createGraph(FILE* f);
+
+/* Updates / populates the corresponding vertex in 'graph' using information
+ * from the line 'line' in an input file. Returns true iff update was
+ * successful.
+ */
+bool updateVertex(Graph* graph, char* line);
+
+/* Prepends a new Edge from vertex 'fromVertex' to vertex 'toVertex' with
+ * weight 'weight', to the edge list 'head' and returns the result.
+ */
+EdgeList* addEdge(EdgeList* head, int fromVertex, int toVertex, int weight);
+
+/* Parses and validates a vertex ID for a graph with 'numVertices' vertices,
+ * from 'token'. Returns the ID if validation is successful, and -1 if it is
+ * not.
+ */
+int readVertexID(char* token, int numVertices);
+
+/* Parses and validates an edge weight from 'token'. Returns the weight if
+ * validation is successful, and -1 if it not.
+ */
+int readWeight(char* token);
+
+#endif
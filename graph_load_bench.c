@@ -0,0 +1,82 @@
+/*
+ *  Loads a graph in a standard benchmark format, reports the load
+ *  throughput, and times Dijkstra's and Prim's algorithms on it.
+ *
+ *  The format is guessed from the file extension: .gr (DIMACS), .graph or
+ *  .metis (METIS), .mtx (Matrix Market), .txt or .edges (SNAP).
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O3 -Wall -Werror -pthread graph.c minheap.c graph_algos.c \
+ *       graph_build.c graph_narrow.c graph_formats.c graph_load_bench.c \
+ *       -o graph_load_bench
+ *
+ *   Run:
+ *   ./graph_load_bench USA-road-d.NY.gr [numThreads] [startVertex]
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "graph.h"
+#include "graph_algos.h"
+#include "graph_formats.h"
+
+double nowSeconds(void);
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    printf("Usage: %s graph_file [numThreads] [startVertex]\n", argv[0]);
+    return 1;
+  }
+  int numThreads = argc > 2 ? atoi(argv[2]) : 1;
+  int startVertex = argc > 3 ? atoi(argv[3]) : 0;
+
+  GraphFormat format;
+  if (!guessGraphFormat(argv[1], &format)) {
+    printf("Unknown format of input file: %s\n", argv[1]);
+    return 1;
+  }
+  FILE* f = fopen(argv[1], "r");
+  if (f == NULL) {
+    fprintf(stderr, "Unable to open the specified input file: %s\n", argv[1]);
+    return 1;
+  }
+  LoadStats stats;
+  Graph* graph = loadGraph(f, format, 0, numThreads, &stats);
+  fclose(f);
+  if (graph == NULL) return 1;
+
+  printf("Loaded %d vertices and %d edges in %.3f s\n", graph->numVertices,
+         graph->numEdges, stats.seconds);
+  printf("Throughput: %.1f MB/s, %.2f M edges/s\n",
+         stats.numBytes / 1e6 / stats.seconds,
+         stats.numEdges / 1e6 / stats.seconds);
+
+  double start = nowSeconds();
+  Edge* tree = getDistanceTreeDijkstra(graph, startVertex);
+  if (tree == NULL) {
+    printf("Invalid start vertex: %d\n", startVertex);
+    deleteGraph(graph);
+    return 1;
+  }
+  printf("Dijkstra's from %d: %.3f s\n", startVertex, nowSeconds() - start);
+  free(tree);
+
+  start = nowSeconds();
+  tree = getMSTprim(graph, startVertex);
+  printf("Prim's from %d: %.3f s\n", startVertex, nowSeconds() - start);
+  free(tree);
+
+  deleteGraph(graph);
+  return 0;
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
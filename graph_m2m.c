@@ -0,0 +1,342 @@
+/*
+ * Many-to-many distance tables on a Contraction Hierarchy.
+ *
+ * Both phases are split across threads: each thread owns a search state,
+ * and the backward phase collects its bucket entries in a private list that
+ * is merged into the shared buckets before the forward phase starts.
+ */
+
+#include <limits.h>
+#include <pthread.h>
+#include <string.h>
+
+#include "graph_m2m.h"
+#include "minheap.h"
+
+#define NOTHING -1
+
+typedef struct bucket_entry {  // a target reached by a backward search
+  int column;    // column of the target in the table
+  int distance;  // distance from the bucket's vertex to that target
+} BucketEntry;
+
+typedef struct m2m_entry {  // bucket entry before bucketing
+  int vertex;    // vertex whose bucket this entry belongs to
+  int column;    // column of the target in the table
+  int distance;  // distance from 'vertex' to that target
+} M2mEntry;
+
+typedef struct m2m_search {  // per-thread upward search state
+  MinHeap* heap;   // priority queue of reached, unfinished vertices
+  int* distances;  // distances[id] is the tentative distance of vertex id
+  int* touched;    // ids of all vertices reached by the current search
+  int numTouched;  // number of vertices in 'touched'
+} M2mSearch;
+
+typedef struct m2m_task {  // one thread's share of a phase
+  ContractionHierarchy* ch;  // hierarchy the table is computed on
+  DistanceTable* table;      // table being computed
+  M2mSearch* search;         // search state owned by this thread
+  int first;                 // this thread handles row or column 'first',
+  int stride;                //   then every 'stride'-th one after it
+  bool backward;             // true for the bucket-filling phase
+  M2mEntry* entries;         // entries found by this thread's backward
+  int numEntries;            //   searches, and their number
+  int capacity;              //   and how many fit in 'entries'
+  int* bucketOffsets;        // bucket of vertex id is at
+  BucketEntry* buckets;      //   buckets[bucketOffsets[id] .. [id+1])
+} M2mTask;
+
+/*************************************************************************
+ ** Upward searches
+ *************************************************************************/
+
+/* Returns newly created search state for 'numVertices' vertices. */
+static M2mSearch* newM2mSearch(int numVertices) {
+  M2mSearch* search = (M2mSearch*)malloc(sizeof(M2mSearch));
+  if (search == NULL) {
+    printf("Error: Memory allocation failed for table search\n");
+    exit(1);
+  }
+
+  search->heap = newHeap(numVertices);
+  search->distances = (int*)malloc(sizeof(int) * numVertices);
+  search->touched = (int*)malloc(sizeof(int) * numVertices);
+  if (search->distances == NULL || search->touched == NULL) {
+    printf("Error: Memory allocation failed for table search arrays\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) search->distances[i] = INT_MAX;
+  search->numTouched = 0;
+
+  return search;
+}
+
+/* Frees all memory allocated for 'search'. */
+static void deleteM2mSearch(M2mSearch* search) {
+  deleteHeap(search->heap);
+  free(search->distances);
+  free(search->touched);
+  free(search);
+}
+
+/* Appends entry ('vertex', 'column', 'distance') to the entries of 'task'. */
+static void appendM2mEntry(M2mTask* task, int vertex, int column,
+                           int distance) {
+  if (task->numEntries == task->capacity) {
+    task->capacity = task->capacity == 0 ? 64 : task->capacity * 2;
+    task->entries =
+        (M2mEntry*)realloc(task->entries, sizeof(M2mEntry) * task->capacity);
+    if (task->entries == NULL) {
+      printf("Error: Memory allocation failed for bucket entries\n");
+      exit(1);
+    }
+  }
+  task->entries[task->numEntries].vertex = vertex;
+  task->entries[task->numEntries].column = column;
+  task->entries[task->numEntries].distance = distance;
+  task->numEntries++;
+}
+
+/* Runs a complete upward search from vertex 'start', which is row or column
+ * 'index' of the table of 'task'. A backward search leaves an entry at
+ * every vertex it finishes; a forward search combines the buckets of every
+ * vertex it finishes into row 'index'.
+ */
+static void runUpwardSearch(M2mTask* task, int start, int index) {
+  ContractionHierarchy* ch = task->ch;
+  DistanceTable* table = task->table;
+  M2mSearch* search = task->search;
+  int* offsets = task->backward ? ch->downOffsets : ch->upOffsets;
+  ChArc* arcs = task->backward ? ch->downArcs : ch->upArcs;
+
+  int* row = NULL;
+  int* meets = NULL;
+  if (!task->backward) {
+    row = &table->distances[(size_t)index * table->numTargets];
+    if (table->meets != NULL) {
+      meets = &table->meets[(size_t)index * table->numTargets];
+    }
+  }
+
+  search->distances[start] = 0;
+  search->touched[search->numTouched++] = start;
+  insert(search->heap, 0, start);
+
+  while (search->heap->size > 0) {
+    HeapNode minNode = extractMin(search->heap);
+    int v = minNode.id;
+    int currDis = minNode.priority;
+
+    if (task->backward) {
+      appendM2mEntry(task, v, index, currDis);
+    } else {
+      for (int i = task->bucketOffsets[v]; i < task->bucketOffsets[v + 1];
+           i++) {
+        BucketEntry* entry = &task->buckets[i];
+        if ((long long)currDis + entry->distance < row[entry->column]) {
+          row[entry->column] = currDis + entry->distance;
+          if (meets != NULL) meets[entry->column] = v;
+        }
+      }
+    }
+
+    for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+      int to = arcs[i].head;
+      int weight = arcs[i].weight;
+      if (weight > INT_MAX - 1 - currDis ||
+          currDis + weight >= search->distances[to]) {
+        continue;
+      }
+      if (search->distances[to] == INT_MAX) {
+        search->touched[search->numTouched++] = to;
+        insert(search->heap, currDis + weight, to);
+      } else {
+        decreasePriority(search->heap, to, currDis + weight);
+      }
+      search->distances[to] = currDis + weight;
+    }
+  }
+
+  for (int i = 0; i < search->numTouched; i++) {
+    int id = search->touched[i];
+    search->distances[id] = INT_MAX;
+    search->heap->indexMap[id] = NOTHING;
+  }
+  search->numTouched = 0;
+}
+
+/* Runs this thread's share of the phase described by 'arg'. */
+static void* runM2mTask(void* arg) {
+  M2mTask* task = (M2mTask*)arg;
+  DistanceTable* table = task->table;
+
+  if (task->backward) {
+    for (int j = task->first; j < table->numTargets; j += task->stride) {
+      runUpwardSearch(task, table->targets[j], j);
+    }
+  } else {
+    for (int i = task->first; i < table->numSources; i += task->stride) {
+      runUpwardSearch(task, table->sources[i], i);
+    }
+  }
+  return NULL;
+}
+
+/* Runs the phase of all 'numThreads' tasks in 'tasks', one per thread. */
+static void runM2mPhase(M2mTask* tasks, int numThreads) {
+  pthread_t threads[numThreads];
+
+  for (int t = 1; t < numThreads; t++) {
+    if (pthread_create(&threads[t], NULL, runM2mTask, &tasks[t]) != 0) {
+      printf("Error: Could not create table worker thread\n");
+      exit(1);
+    }
+  }
+  runM2mTask(&tasks[0]);
+  for (int t = 1; t < numThreads; t++) pthread_join(threads[t], NULL);
+}
+
+/*************************************************************************
+ ** Distance tables
+ *************************************************************************/
+
+/* Returns a copy of the 'count' ints in 'values'. */
+static int* copyInts(int* values, int count) {
+  int* copy = (int*)malloc(sizeof(int) * (count + 1));
+  if (copy == NULL) {
+    printf("Error: Memory allocation failed for table vertices\n");
+    exit(1);
+  }
+  if (count > 0) memcpy(copy, values, sizeof(int) * count);
+  return copy;
+}
+
+/* Returns true iff all 'count' IDs in 'ids' are valid in 'ch'. */
+static bool areValidVertices(ContractionHierarchy* ch, int* ids, int count) {
+  for (int i = 0; i < count; i++) {
+    if (ids[i] < 0 || ids[i] >= ch->numVertices) return false;
+  }
+  return true;
+}
+
+DistanceTable* getDistanceTable(ContractionHierarchy* ch, int* sources,
+                                int numSources, int* targets, int numTargets,
+                                bool withMeets, int numThreads) {
+  if (ch == NULL || numThreads < 1 || numSources < 0 || numTargets < 0 ||
+      !areValidVertices(ch, sources, numSources) ||
+      !areValidVertices(ch, targets, numTargets)) {
+    return NULL;
+  }
+
+  DistanceTable* table = (DistanceTable*)malloc(sizeof(DistanceTable));
+  if (table == NULL) {
+    printf("Error: Memory allocation failed for distance table\n");
+    exit(1);
+  }
+
+  size_t numCells = (size_t)numSources * numTargets;
+  table->numSources = numSources;
+  table->numTargets = numTargets;
+  table->sources = copyInts(sources, numSources);
+  table->targets = copyInts(targets, numTargets);
+  table->distances = (int*)malloc(sizeof(int) * (numCells + 1));
+  table->meets = withMeets ? (int*)malloc(sizeof(int) * (numCells + 1)) : NULL;
+  if (table->distances == NULL || (withMeets && table->meets == NULL)) {
+    printf("Error: Memory allocation failed for distance table cells\n");
+    exit(1);
+  }
+  for (size_t i = 0; i < numCells; i++) {
+    table->distances[i] = INT_MAX;
+    if (withMeets) table->meets[i] = NOTHING;
+  }
+
+  int numVertices = ch->numVertices;
+  M2mTask tasks[numThreads];
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t].ch = ch;
+    tasks[t].table = table;
+    tasks[t].search = newM2mSearch(numVertices);
+    tasks[t].first = t;
+    tasks[t].stride = numThreads;
+    tasks[t].backward = true;
+    tasks[t].entries = NULL;
+    tasks[t].numEntries = 0;
+    tasks[t].capacity = 0;
+  }
+  runM2mPhase(tasks, numThreads);
+
+  // sort all entries into per-vertex buckets
+  int* bucketOffsets = (int*)calloc(numVertices + 1, sizeof(int));
+  if (bucketOffsets == NULL) {
+    printf("Error: Memory allocation failed for bucket offsets\n");
+    exit(1);
+  }
+  for (int t = 0; t < numThreads; t++) {
+    for (int i = 0; i < tasks[t].numEntries; i++) {
+      bucketOffsets[tasks[t].entries[i].vertex + 1]++;
+    }
+  }
+  for (int v = 0; v < numVertices; v++) {
+    bucketOffsets[v + 1] += bucketOffsets[v];
+  }
+
+  BucketEntry* buckets = (BucketEntry*)malloc(
+      sizeof(BucketEntry) * (bucketOffsets[numVertices] + 1));
+  int* next = copyInts(bucketOffsets, numVertices);
+  if (buckets == NULL) {
+    printf("Error: Memory allocation failed for buckets\n");
+    exit(1);
+  }
+  for (int t = 0; t < numThreads; t++) {
+    for (int i = 0; i < tasks[t].numEntries; i++) {
+      M2mEntry* entry = &tasks[t].entries[i];
+      BucketEntry* slot = &buckets[next[entry->vertex]++];
+      slot->column = entry->column;
+      slot->distance = entry->distance;
+    }
+    free(tasks[t].entries);
+    tasks[t].entries = NULL;
+  }
+  free(next);
+
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t].backward = false;
+    tasks[t].bucketOffsets = bucketOffsets;
+    tasks[t].buckets = buckets;
+  }
+  runM2mPhase(tasks, numThreads);
+
+  for (int t = 0; t < numThreads; t++) deleteM2mSearch(tasks[t].search);
+  free(bucketOffsets);
+  free(buckets);
+
+  return table;
+}
+
+ChResult* getDistanceTablePath(ContractionHierarchy* ch, ChSearch* search,
+                               DistanceTable* table, int row, int col) {
+  if (ch == NULL || table == NULL || table->meets == NULL || row < 0 ||
+      row >= table->numSources || col < 0 || col >= table->numTargets) {
+    return NULL;
+  }
+
+  int source = table->sources[row];
+  int target = table->targets[col];
+  int meet = table->meets[(size_t)row * table->numTargets + col];
+  if (meet == NOTHING) {
+    // unreachable: report it the way getShortestPathCH does
+    return getShortestPathCH(ch, search, source, target);
+  }
+  return getShortestPathViaCH(ch, search, source, target, meet);
+}
+
+void deleteDistanceTable(DistanceTable* table) {
+  if (table == NULL) return;
+
+  free(table->sources);
+  free(table->targets);
+  free(table->distances);
+  free(table->meets);
+  free(table);
+}
@@ -0,0 +1,60 @@
+/*
+ * Header file for many-to-many distance tables.
+ *
+ * Tables are computed on a Contraction Hierarchy with the bucket method:
+ * one backward upward search per target leaves (target, distance) entries
+ * in buckets at the vertices it finishes, and one forward upward search per
+ * source scans the buckets of the vertices it finishes.
+ *
+ * Compile with -pthread.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+#include "graph_ch.h"
+
+#ifndef __Graph_M2m_header
+#define __Graph_M2m_header
+
+typedef struct distance_table {
+  int numSources;  // number of rows
+  int numTargets;  // number of columns
+  int* sources;    // sources[i] is the vertex ID of row i
+  int* targets;    // targets[j] is the vertex ID of column j
+  int* distances;  // distances[i * numTargets + j] is the distance from
+                   //   sources[i] to targets[j], or INT_MAX if unreachable
+  int* meets;      // meets[i * numTargets + j] is the vertex where the two
+                   //   searches met, or -1 if unreachable; NULL if meeting
+                   //   vertices were not requested
+} DistanceTable;
+
+/* Returns the table of distances from each of the 'numSources' vertices in
+ * 'sources' to each of the 'numTargets' vertices in 'targets' in hierarchy
+ * 'ch'. If 'withMeets' is true, also records the meeting vertex of every
+ * entry so its path can be found later with getDistanceTablePath. Rows are
+ * split across 'numThreads' threads. Memory use is bounded by the table
+ * itself plus the search spaces of the targets, not by the graph size per
+ * source.
+ * Returns NULL if any vertex is not valid in 'ch' or 'numThreads' < 1.
+ */
+DistanceTable* getDistanceTable(ContractionHierarchy* ch, int* sources,
+                                int numSources, int* targets, int numTargets,
+                                bool withMeets, int numThreads);
+
+/* Returns the path of entry ('row', 'col') of 'table', computed on
+ * hierarchy 'ch', in the format produced by getShortestPaths. Only the two
+ * upward searches to the recorded meeting vertex are run, using 'search' as
+ * in getShortestPathCH.
+ * Returns NULL if 'table' has no meeting vertices, or 'row' or 'col' is out
+ * of range.
+ */
+ChResult* getDistanceTablePath(ContractionHierarchy* ch, ChSearch* search,
+                               DistanceTable* table, int row, int col);
+
+/* Frees all memory allocated for 'table'. */
+void deleteDistanceTable(DistanceTable* table);
+
+#endif
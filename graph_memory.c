@@ -0,0 +1,325 @@
+/*
+ * Placing large arrays in memory.
+ *
+ * Blocks are mapped with mmap rather than malloc so that each one can get
+ * its own page size and NUMA policy. Transparent huge pages need the block
+ * to start on a huge page boundary, so one huge page more is mapped and the
+ * ends are trimmed. NUMA policies are set with the mbind system call before
+ * the pages are touched, so no libnuma is needed.
+ */
+
+#define _GNU_SOURCE  // for CPU_SET, pthread_setaffinity_np and MAP_HUGETLB
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+#include "graph_memory.h"
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define MAX_NODES 64  // nodes a node mask can name
+#define NODE_FILE "/sys/devices/system/node/online"
+#define NODE_CPU_FILE "/sys/devices/system/node/node%d/cpulist"
+#define THP_FILE "/sys/kernel/mm/transparent_hugepage/enabled"
+
+/*************************************************************************
+ ** Nodes and threads
+ *************************************************************************/
+
+int getNumaNodeCount(void) {
+  FILE* f = fopen(NODE_FILE, "r");
+  if (f == NULL) return 1;
+
+  // a list such as "0" or "0-1,3"; the highest node counts
+  int numNodes = 1;
+  int node;
+  while (fscanf(f, "%d", &node) == 1) {
+    if (node + 1 > numNodes) numNodes = node + 1;
+    int separator = fgetc(f);
+    if (separator != '-' && separator != ',') break;
+  }
+  fclose(f);
+  return numNodes < MAX_NODES ? numNodes : MAX_NODES;
+}
+
+int getCurrentNumaNode(void) {
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned cpu, node;
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) return (int)node;
+#endif
+  return 0;
+}
+
+bool pinThreadToNode(int node) {
+#ifdef __linux__
+  char path[64];
+  snprintf(path, sizeof(path), NODE_CPU_FILE, node);
+  FILE* f = fopen(path, "r");
+  if (f == NULL) return false;
+
+  // a list such as "0-3,8-11"
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  bool found = false;
+  int first;
+  while (fscanf(f, "%d", &first) == 1) {
+    int last = first;
+    int separator = fgetc(f);
+    if (separator == '-') {
+      if (fscanf(f, "%d", &last) != 1) break;
+      separator = fgetc(f);
+    }
+    for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+      CPU_SET(cpu, &cpus);
+      found = true;
+    }
+    if (separator != ',') break;
+  }
+  fclose(f);
+  return found &&
+         pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+  (void)node;
+  return false;
+#endif
+}
+
+/*************************************************************************
+ ** Blocks
+ *************************************************************************/
+
+/* Returns 'size' rounded up to a multiple of 'unit'. */
+static size_t roundUp(size_t size, size_t unit) {
+  return (size + unit - 1) / unit * unit;
+}
+
+/* Returns true iff the kernel hands out transparent huge pages to memory
+ * marked with madvise.
+ */
+static bool transparentHugePagesEnabled(void) {
+  FILE* f = fopen(THP_FILE, "r");
+  if (f == NULL) return false;
+
+  char line[128];
+  bool enabled = fgets(line, sizeof(line), f) != NULL &&
+                 (strstr(line, "[always]") != NULL ||
+                  strstr(line, "[madvise]") != NULL);
+  fclose(f);
+  return enabled;
+}
+
+/* Maps at least 'size' bytes of pages of kind 'pages' and returns them,
+ * storing the number of bytes mapped in 'size', or returns NULL if such
+ * pages are not available.
+ */
+static void* mapPages(size_t* size, PageKind pages) {
+  int protection = PROT_READ | PROT_WRITE;
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  switch (pages) {
+    case PAGES_EXPLICIT: {
+#ifdef MAP_HUGETLB
+      // fails at once if the hugetlb pool cannot reserve enough pages
+      size_t rounded = roundUp(*size, HUGE_PAGE_SIZE);
+      void* data = mmap(NULL, rounded, protection, flags | MAP_HUGETLB, -1, 0);
+      if (data == MAP_FAILED) return NULL;
+      *size = rounded;
+      return data;
+#else
+      return NULL;
+#endif
+    }
+
+    case PAGES_TRANSPARENT: {
+#ifdef MADV_HUGEPAGE
+      if (!transparentHugePagesEnabled()) return NULL;
+      size_t rounded = roundUp(*size, HUGE_PAGE_SIZE);
+      char* raw = (char*)mmap(NULL, rounded + HUGE_PAGE_SIZE, protection,
+                              flags, -1, 0);
+      if (raw == MAP_FAILED) return NULL;
+
+      char* data = (char*)roundUp((uintptr_t)raw, HUGE_PAGE_SIZE);
+      size_t tail = raw + rounded + HUGE_PAGE_SIZE - (data + rounded);
+      if (data > raw) munmap(raw, data - raw);
+      if (tail > 0) munmap(data + rounded, tail);
+      if (madvise(data, rounded, MADV_HUGEPAGE) != 0) {
+        munmap(data, rounded);
+        return NULL;
+      }
+      *size = rounded;
+      return data;
+#else
+      return NULL;
+#endif
+    }
+
+    case PAGES_SMALL: {
+      size_t rounded = roundUp(*size, (size_t)sysconf(_SC_PAGESIZE));
+      void* data = mmap(NULL, rounded, protection, flags, -1, 0);
+      if (data == MAP_FAILED) return NULL;
+      *size = rounded;
+      return data;
+    }
+  }
+  return NULL;
+}
+
+/* Binds the 'size' bytes at 'data' to NUMA node 'node', or interleaves
+ * them if 'node' is ALL_NODES, and returns the node they end up bound to:
+ * 'node' on success, or ANY_NODE if nothing was bound.
+ */
+static int bindPages(void* data, size_t size, int node) {
+  int numNodes = getNumaNodeCount();
+  if (node == ANY_NODE || numNodes == 1 || node >= numNodes) return ANY_NODE;
+
+#if defined(__linux__) && defined(SYS_mbind)
+  unsigned long mask[MAX_NODES / (8 * sizeof(unsigned long))];
+  memset(mask, 0, sizeof(mask));
+  int bitsPerWord = 8 * sizeof(unsigned long);
+  int first = node == ALL_NODES ? 0 : node;
+  int last = node == ALL_NODES ? numNodes - 1 : node;
+  for (int n = first; n <= last; n++) {
+    mask[n / bitsPerWord] |= 1UL << (n % bitsPerWord);
+  }
+  int mode = node == ALL_NODES ? MPOL_INTERLEAVE : MPOL_BIND;
+  // the kernel reads one bit less than the number it is given
+  if (syscall(SYS_mbind, data, size, mode, mask, MAX_NODES + 1, 0) == 0) {
+    return node;
+  }
+#else
+  (void)data;
+  (void)size;
+#endif
+  return ANY_NODE;
+}
+
+bool allocateLarge(LargeBlock* block, size_t size, PageKind pages, int node) {
+  if (size == 0) size = 1;
+
+  block->data = NULL;
+  for (PageKind kind = pages; kind <= PAGES_SMALL && block->data == NULL;
+       kind = (PageKind)(kind + 1)) {
+    block->size = size;
+    block->data = mapPages(&block->size, kind);
+    block->pages = kind;
+  }
+  if (block->data == NULL) return false;
+
+  block->node = bindPages(block->data, block->size, node);
+  return true;
+}
+
+void freeLarge(LargeBlock* block) {
+  if (block->data == NULL) return;
+
+  munmap(block->data, block->size);
+  block->data = NULL;
+}
+
+/*************************************************************************
+ ** Graphs
+ *************************************************************************/
+
+PlacedGraph* newPlacedGraph(CompactGraph* graph, PageKind pages,
+                            NumaPlacement placement) {
+  int numNodes = getNumaNodeCount();
+  if (numNodes == 1) placement = NUMA_DEFAULT;  // nothing to place
+  int numReplicas = placement == NUMA_REPLICATE ? numNodes : 1;
+
+  PlacedGraph* result = (PlacedGraph*)malloc(sizeof(PlacedGraph));
+  if (result == NULL) {
+    printf("Error: Memory allocation failed for placed graph\n");
+    exit(1);
+  }
+  result->numVertices = graph->numVertices;
+  result->numEdges = graph->numEdges;
+  result->numReplicas = numReplicas;
+  result->replicas = (CompactGraph*)malloc(sizeof(CompactGraph) * numReplicas);
+  result->blocks = (LargeBlock*)calloc(3 * numReplicas, sizeof(LargeBlock));
+  if (result->replicas == NULL || result->blocks == NULL) {
+    printf("Error: Memory allocation failed for placed graph\n");
+    exit(1);
+  }
+  result->pages = pages;
+  result->placement = placement;
+
+  int localNode = getCurrentNumaNode();
+  int* arrays[3] = {graph->offsets, graph->heads, graph->weights};
+  size_t sizes[3] = {sizeof(int) * (graph->numVertices + 1),
+                     sizeof(int) * graph->numEdges,
+                     sizeof(int) * graph->numEdges};
+  for (int r = 0; r < numReplicas; r++) {
+    int node = ANY_NODE;
+    if (placement == NUMA_LOCAL) node = localNode;
+    if (placement == NUMA_INTERLEAVE) node = ALL_NODES;
+    if (placement == NUMA_REPLICATE) node = r;
+
+    LargeBlock* blocks = &result->blocks[3 * r];
+    for (int b = 0; b < 3; b++) {
+      if (!allocateLarge(&blocks[b], sizes[b], pages, node)) {
+        deletePlacedGraph(result);
+        return NULL;
+      }
+      memcpy(blocks[b].data, arrays[b], sizes[b]);
+      if (blocks[b].pages > result->pages) result->pages = blocks[b].pages;
+      if (blocks[b].node != node) result->placement = NUMA_DEFAULT;
+    }
+
+    CompactGraph* replica = &result->replicas[r];
+    replica->numVertices = graph->numVertices;
+    replica->numEdges = graph->numEdges;
+    replica->offsets = (int*)blocks[0].data;
+    replica->heads = (int*)blocks[1].data;
+    replica->weights = (int*)blocks[2].data;
+  }
+  return result;
+}
+
+CompactGraph* getLocalReplica(PlacedGraph* graph) {
+  if (graph->numReplicas == 1) return &graph->replicas[0];
+
+  int node = getCurrentNumaNode();
+  return &graph->replicas[node < graph->numReplicas ? node : 0];
+}
+
+void deletePlacedGraph(PlacedGraph* graph) {
+  if (graph == NULL) return;
+
+  for (int b = 0; b < 3 * graph->numReplicas; b++) freeLarge(&graph->blocks[b]);
+  free(graph->blocks);
+  free(graph->replicas);
+  free(graph);
+}
+
+const char* getPageKindName(PageKind pages) {
+  switch (pages) {
+    case PAGES_EXPLICIT:
+      return "explicit huge pages";
+    case PAGES_TRANSPARENT:
+      return "transparent huge pages";
+    case PAGES_SMALL:
+      return "small pages";
+  }
+  return "unknown pages";
+}
+
+const char* getPlacementName(NumaPlacement placement) {
+  switch (placement) {
+    case NUMA_DEFAULT:
+      return "default";
+    case NUMA_LOCAL:
+      return "local";
+    case NUMA_INTERLEAVE:
+      return "interleaved";
+    case NUMA_REPLICATE:
+      return "replicated";
+  }
+  return "unknown";
+}
@@ -0,0 +1,111 @@
+/*
+ * Header file for placing large arrays in memory.
+ *
+ * Random access to big graph and workspace arrays misses the TLB on almost
+ * every step with 4 KiB pages, and on machines with several NUMA nodes half
+ * of it also goes to the far socket. A LargeBlock is an array mapped with
+ * the largest pages available, trying in turn explicit huge pages from the
+ * hugetlb pool (MAP_HUGETLB), transparent huge pages (madvise), and
+ * ordinary pages, and optionally bound to one node or interleaved over all
+ * of them. A PlacedGraph copies a CompactGraph into LargeBlocks, either
+ * once (local or interleaved) or once per node (replicated), and worker
+ * threads pinned to a node read the copy on their node.
+ *
+ * Every request degrades to what the machine supports: on a single node
+ * no binding is done, and without huge pages ordinary pages are used. The
+ * structures record what was actually applied so callers can report it.
+ * NUMA placement and thread pinning need Linux; elsewhere every machine is
+ * treated as a single node.
+ *
+ * Compile with -pthread.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph_build.h"
+
+#ifndef __Graph_Memory_header
+#define __Graph_Memory_header
+
+#define ANY_NODE -1   // node argument for "wherever the kernel puts it"
+#define ALL_NODES -2  // node argument for "interleaved over all nodes"
+
+typedef enum page_kind {  // in order of preference
+  PAGES_EXPLICIT,     // huge pages from the hugetlb pool
+  PAGES_TRANSPARENT,  // transparent huge pages, requested with madvise
+  PAGES_SMALL         // ordinary pages
+} PageKind;
+
+typedef enum numa_placement {
+  NUMA_DEFAULT,     // no binding; pages go where they are first touched
+  NUMA_LOCAL,       // bound to the node of the calling thread
+  NUMA_INTERLEAVE,  // spread page by page over all nodes
+  NUMA_REPLICATE    // a full copy bound to every node
+} NumaPlacement;
+
+typedef struct large_block {
+  void* data;      // the array, or NULL if not allocated
+  size_t size;     // number of bytes mapped, at least the size asked for
+  PageKind pages;  // kind of pages actually obtained
+  int node;        // node the pages are bound to, ANY_NODE or ALL_NODES
+} LargeBlock;
+
+typedef struct placed_graph {
+  int numVertices;          // total number of vertices
+  int numEdges;             // total number of edges
+  int numReplicas;          // number of copies, one per node if replicated
+  CompactGraph* replicas;   // replicas[r] is copy r, with arrays in 'blocks'
+  LargeBlock* blocks;       // offsets, heads and weights of every copy
+  PageKind pages;           // smallest kind of pages obtained for any array
+  NumaPlacement placement;  // placement actually applied
+} PlacedGraph;
+
+/* Returns the number of NUMA nodes of this machine, at least 1. */
+int getNumaNodeCount(void);
+
+/* Returns the NUMA node the calling thread runs on, or 0 if unknown. */
+int getCurrentNumaNode(void);
+
+/* Pins the calling thread to the CPUs of NUMA node 'node'. Returns false,
+ * leaving the thread unpinned, if that is not possible.
+ */
+bool pinThreadToNode(int node);
+
+/* Maps at least 'size' bytes into 'block' with pages of kind 'pages', or
+ * the best kind after it that is available, bound to NUMA node 'node', or
+ * interleaved over all nodes if 'node' is ALL_NODES, or not bound if it is
+ * ANY_NODE or the machine has a single node. The memory is not touched, so
+ * it reads as zero and takes no physical pages until used.
+ * Returns false, with 'block->data' NULL, if no memory could be mapped.
+ */
+bool allocateLarge(LargeBlock* block, size_t size, PageKind pages, int node);
+
+/* Unmaps the memory of 'block', if any, and sets 'block->data' to NULL. */
+void freeLarge(LargeBlock* block);
+
+/* Returns a new PlacedGraph with a copy of the arrays of 'graph' on pages
+ * of kind 'pages' (or the best kind after it available) placed as
+ * 'placement' says. Its replicas must not be passed to deleteCompactGraph.
+ * Returns NULL if the memory could not be mapped.
+ */
+PlacedGraph* newPlacedGraph(CompactGraph* graph, PageKind pages,
+                            NumaPlacement placement);
+
+/* Returns the copy of 'graph' on the NUMA node of the calling thread, or
+ * its only copy if it is not replicated.
+ */
+CompactGraph* getLocalReplica(PlacedGraph* graph);
+
+/* Frees all memory allocated for 'graph'. */
+void deletePlacedGraph(PlacedGraph* graph);
+
+/* Returns the name of page kind 'pages'. */
+const char* getPageKindName(PageKind pages);
+
+/* Returns the name of placement 'placement'. */
+const char* getPlacementName(NumaPlacement placement);
+
+#endif
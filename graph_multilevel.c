@@ -0,0 +1,953 @@
+/*
+ * Multilevel graph partitioning.
+ *
+ * Every level of the hierarchy is a symmetric weighted graph in compact
+ * arrays: a vertex weighs the number of original vertices merged into it,
+ * and an edge weighs the number of original edges between them. The first
+ * level merges the two directions and any parallel edges of the input.
+ *
+ * Matching is done by all threads at once without locks: each thread
+ * proposes pairs for its own vertices by writing both ends, and a second
+ * pass keeps only the pairs whose ends point at each other, so a race can
+ * lose a pair but never make an inconsistent one. Two such rounds match
+ * most of what a sequential matching would. Label propagation likewise
+ * lets threads move their own vertices while reading the parts of their
+ * neighbours as they are; part sizes are kept with atomic counters, so the
+ * balance limit holds whatever the interleaving.
+ */
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "graph_build.h"
+#include "graph_multilevel.h"
+#include "graph_queue.h"
+
+#define NOTHING -1
+#define COARSEST_PER_PART 20   // vertices per part at which coarsening stops
+#define MIN_SHRINK 0.95        // coarsening stops when a level keeps more
+#define MATCHING_ROUNDS 2      // rounds of proposing and confirming pairs
+#define GROWING_TRIES 4        // seeds tried by every bisection
+#define PROPAGATION_ROUNDS 4   // label propagation rounds per level
+#define FM_PASSES 3            // FM passes per level at most
+#define FM_PATIENCE 100        // moves without a better cut before an FM
+                               //   pass gives up
+#define INITIAL_BUFFER 1024    // entries a new contraction buffer has
+
+typedef struct level {  // one graph of the hierarchy
+  int numVertices;     // number of vertices
+  int* offsets;        // the neighbours of v are
+  int* heads;          //   heads[offsets[v] .. offsets[v+1]),
+  int* weights;        //   with the weights of the edges to them
+  int* vertexWeights;  // number of original vertices in every vertex
+  int* coarseMap;      // coarseMap[v] is the vertex of the next level v
+                       //   is merged into, or NULL for the coarsest level
+} Level;
+
+typedef struct level_task {  // one thread's share of a phase
+  Level* level;              // the level worked on
+  Level* coarse;             // the level being contracted from it
+  _Atomic int* match;        // matching being built
+  const int* members;        // coarse vertex c merges fine vertices
+                             //   members[2c] and members[2c+1], or -1
+  int maxVertexWeight;       // heaviest vertex a match may create
+  _Atomic int* parts;        // parts[v] is the part of vertex v
+  _Atomic int* partWeights;  // total vertex weight of every part
+  int numParts;              // number of parts
+  int maxPartWeight;         // heaviest part allowed
+  int first;                 // this thread handles vertices
+  int last;                  //   first .. last-1
+  int* scratch;              // space for the thread's bookkeeping
+  int* bufferHeads;          // contracted edges of this thread's vertices
+  int* bufferWeights;        //   and their weights
+  int bufferSize;            // number of edges in the buffers
+  int bufferCapacity;        // number of edges the buffers have room for
+  int bufferStart;           // where the buffers go in the coarse level
+  int moves;                 // vertices moved in the last round
+} LevelTask;
+
+/*************************************************************************
+ ** Helpers
+ *************************************************************************/
+
+/* Allocates 'count' ints for the partitioner, exiting if that fails. */
+static int* allocateInts(long long count) {
+  int* array = (int*)malloc(sizeof(int) * (count + 1));
+  if (array == NULL) {
+    printf("Error: Memory allocation failed for partitioner\n");
+    exit(1);
+  }
+  return array;
+}
+
+/* Frees the arrays of 'level'. */
+static void freeLevel(Level* level) {
+  free(level->offsets);
+  free(level->heads);
+  free(level->weights);
+  free(level->vertexWeights);
+  free(level->coarseMap);
+}
+
+/* Runs 'run' on each of the 'numThreads' tasks in 'tasks', one per
+ * thread.
+ */
+static void runLevelPhase(LevelTask* tasks, int numThreads,
+                          void* (*run)(void*)) {
+  pthread_t threads[numThreads];
+  for (int t = 1; t < numThreads; t++) {
+    if (pthread_create(&threads[t], NULL, run, &tasks[t]) != 0) {
+      printf("Error: Could not create partitioner worker thread\n");
+      exit(1);
+    }
+  }
+  run(&tasks[0]);
+  for (int t = 1; t < numThreads; t++) pthread_join(threads[t], NULL);
+}
+
+/* Splits the 'numVertices' vertices into the ranges of the 'numThreads'
+ * tasks in 'tasks'.
+ */
+static void splitRanges(LevelTask* tasks, int numThreads, int numVertices) {
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t].first = (int)((long long)numVertices * t / numThreads);
+    tasks[t].last = (int)((long long)numVertices * (t + 1) / numThreads);
+  }
+}
+
+/*************************************************************************
+ ** Coarsening
+ *************************************************************************/
+
+/* Proposes a match to the heaviest unmatched neighbour of every unmatched
+ * vertex of this thread.
+ */
+static void* runProposeTask(void* arg) {
+  LevelTask* task = (LevelTask*)arg;
+  Level* level = task->level;
+  for (int v = task->first; v < task->last; v++) {
+    if (task->match[v] != NOTHING) continue;
+
+    int best = NOTHING;
+    int bestWeight = 0;
+    for (int e = level->offsets[v]; e < level->offsets[v + 1]; e++) {
+      int u = level->heads[e];
+      if (task->match[u] != NOTHING ||
+          level->vertexWeights[v] + level->vertexWeights[u] >
+              task->maxVertexWeight) {
+        continue;
+      }
+      if (level->weights[e] > bestWeight ||
+          (level->weights[e] == bestWeight &&
+           level->vertexWeights[u] < level->vertexWeights[best])) {
+        best = u;
+        bestWeight = level->weights[e];
+      }
+    }
+    if (best != NOTHING) {
+      task->match[v] = best;
+      task->match[best] = v;
+    }
+  }
+  return NULL;
+}
+
+/* Withdraws the proposals of this thread's vertices that were not
+ * returned.
+ */
+static void* runConfirmTask(void* arg) {
+  LevelTask* task = (LevelTask*)arg;
+  for (int v = task->first; v < task->last; v++) {
+    int u = task->match[v];
+    if (u != NOTHING && task->match[u] != v) task->match[v] = NOTHING;
+  }
+  return NULL;
+}
+
+/* Merges the neighbours of the members of this thread's coarse vertices
+ * into its buffers, and stores the degree of every coarse vertex in the
+ * offsets of the coarse level.
+ */
+static void* runContractTask(void* arg) {
+  LevelTask* task = (LevelTask*)arg;
+  Level* fine = task->level;
+  Level* coarse = task->coarse;
+  int* slots = task->scratch;  // slots[c] is the buffer index of c, or -1
+
+  task->bufferSize = 0;
+  for (int c = task->first; c < task->last; c++) {
+    int start = task->bufferSize;
+    int vertexWeight = 0;
+    for (int m = 0; m < 2; m++) {
+      int v = task->members[2 * c + m];
+      if (v == NOTHING) continue;
+      vertexWeight += fine->vertexWeights[v];
+
+      for (int e = fine->offsets[v]; e < fine->offsets[v + 1]; e++) {
+        int neighbour = fine->coarseMap[fine->heads[e]];
+        if (neighbour == c) continue;  // merged into a self-loop
+        if (slots[neighbour] != NOTHING) {
+          task->bufferWeights[slots[neighbour]] += fine->weights[e];
+          continue;
+        }
+        if (task->bufferSize == task->bufferCapacity) {
+          task->bufferCapacity *= 2;
+          task->bufferHeads = (int*)realloc(
+              task->bufferHeads, sizeof(int) * task->bufferCapacity);
+          task->bufferWeights = (int*)realloc(
+              task->bufferWeights, sizeof(int) * task->bufferCapacity);
+          if (task->bufferHeads == NULL || task->bufferWeights == NULL) {
+            printf("Error: Memory allocation failed for partitioner\n");
+            exit(1);
+          }
+        }
+        slots[neighbour] = task->bufferSize;
+        task->bufferHeads[task->bufferSize] = neighbour;
+        task->bufferWeights[task->bufferSize] = fine->weights[e];
+        task->bufferSize++;
+      }
+    }
+    for (int j = start; j < task->bufferSize; j++) {
+      slots[task->bufferHeads[j]] = NOTHING;
+    }
+    coarse->offsets[c] = task->bufferSize - start;
+    coarse->vertexWeights[c] = vertexWeight;
+  }
+  return NULL;
+}
+
+/* Copies the buffers of this thread into the coarse level. */
+static void* runCopyTask(void* arg) {
+  LevelTask* task = (LevelTask*)arg;
+  memcpy(&task->coarse->heads[task->bufferStart], task->bufferHeads,
+         sizeof(int) * task->bufferSize);
+  memcpy(&task->coarse->weights[task->bufferStart], task->bufferWeights,
+         sizeof(int) * task->bufferSize);
+  return NULL;
+}
+
+/* Contracts 'fine' into 'coarse' along 'fine->coarseMap', where coarse
+ * vertex c merges the fine vertices in 'members', using 'tasks'.
+ */
+static void contractLevel(Level* fine, Level* coarse, int numCoarse,
+                          const int* members, LevelTask* tasks,
+                          int numThreads) {
+  coarse->numVertices = numCoarse;
+  coarse->offsets = allocateInts(numCoarse + 1);
+  coarse->vertexWeights = allocateInts(numCoarse);
+  coarse->coarseMap = NULL;
+
+  splitRanges(tasks, numThreads, numCoarse);
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t].level = fine;
+    tasks[t].coarse = coarse;
+    tasks[t].members = members;
+    for (int c = 0; c < numCoarse; c++) tasks[t].scratch[c] = NOTHING;
+  }
+  runLevelPhase(tasks, numThreads, runContractTask);
+
+  int numEdges = 0;
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t].bufferStart = numEdges;
+    numEdges += tasks[t].bufferSize;
+  }
+  int offset = 0;
+  for (int c = 0; c < numCoarse; c++) {
+    int degree = coarse->offsets[c];
+    coarse->offsets[c] = offset;
+    offset += degree;
+  }
+  coarse->offsets[numCoarse] = offset;
+  coarse->heads = allocateInts(numEdges);
+  coarse->weights = allocateInts(numEdges);
+  runLevelPhase(tasks, numThreads, runCopyTask);
+}
+
+/* Matches the vertices of 'level' with 'tasks', sets its coarse map, and
+ * contracts it into 'coarse'. Returns false, leaving 'coarse' unset, if
+ * the coarse level would keep more than MIN_SHRINK of the vertices.
+ */
+static bool coarsenLevel(Level* level, Level* coarse, int maxVertexWeight,
+                         LevelTask* tasks, int numThreads) {
+  int numVertices = level->numVertices;
+  _Atomic int* match =
+      (_Atomic int*)malloc(sizeof(_Atomic int) * (numVertices + 1));
+  if (match == NULL) {
+    printf("Error: Memory allocation failed for partitioner\n");
+    exit(1);
+  }
+  for (int v = 0; v < numVertices; v++) match[v] = NOTHING;
+
+  splitRanges(tasks, numThreads, numVertices);
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t].level = level;
+    tasks[t].match = match;
+    tasks[t].maxVertexWeight = maxVertexWeight;
+  }
+  for (int round = 0; round < MATCHING_ROUNDS; round++) {
+    runLevelPhase(tasks, numThreads, runProposeTask);
+    runLevelPhase(tasks, numThreads, runConfirmTask);
+  }
+
+  // number the pairs and single vertices in the order of their smaller end
+  int* coarseMap = allocateInts(numVertices);
+  int* members = allocateInts(2 * (long long)numVertices);
+  int numCoarse = 0;
+  for (int v = 0; v < numVertices; v++) {
+    int u = match[v];
+    if (u != NOTHING && u < v) continue;  // numbered with u
+
+    coarseMap[v] = numCoarse;
+    members[2 * numCoarse] = v;
+    members[2 * numCoarse + 1] = u;
+    if (u != NOTHING) coarseMap[u] = numCoarse;
+    numCoarse++;
+  }
+  free(match);
+
+  if (numCoarse > MIN_SHRINK * numVertices) {
+    free(coarseMap);
+    free(members);
+    return false;
+  }
+  level->coarseMap = coarseMap;
+  contractLevel(level, coarse, numCoarse, members, tasks, numThreads);
+  free(members);
+  return true;
+}
+
+/* Returns the first level for 'graph': its edges in both directions, each
+ * pair of neighbours joined once with the number of edges between them.
+ * Returns NULL if the graph has too many edges.
+ */
+static Level* newFirstLevel(Graph* graph, LevelTask* tasks, int numThreads) {
+  CompactGraph* directed = newCompactGraphFromGraph(graph);
+  int numVertices = directed->numVertices;
+  int* from = allocateInts(directed->numEdges);
+  for (int v = 0; v < numVertices; v++) {
+    for (int i = directed->offsets[v]; i < directed->offsets[v + 1]; i++) {
+      from[i] = v;
+    }
+  }
+  CompactGraph* symmetric = buildCompactGraph(
+      numVertices, directed->numEdges, from, directed->heads, NULL,
+      BUILD_SYMMETRIZE | BUILD_DROP_SELF_LOOPS, numThreads);
+  free(from);
+  deleteCompactGraph(directed);
+  if (symmetric == NULL) return NULL;
+
+  // merging every vertex with itself sums the weights of parallel edges
+  Level raw;
+  raw.numVertices = numVertices;
+  raw.offsets = symmetric->offsets;
+  raw.heads = symmetric->heads;
+  raw.weights = symmetric->weights;
+  raw.vertexWeights = allocateInts(numVertices);
+  raw.coarseMap = allocateInts(numVertices);
+  int* members = allocateInts(2 * (long long)numVertices);
+  for (int v = 0; v < numVertices; v++) {
+    raw.vertexWeights[v] = 1;
+    raw.coarseMap[v] = v;
+    members[2 * v] = v;
+    members[2 * v + 1] = NOTHING;
+  }
+
+  Level* level = (Level*)malloc(sizeof(Level));
+  if (level == NULL) {
+    printf("Error: Memory allocation failed for partitioner\n");
+    exit(1);
+  }
+  contractLevel(&raw, level, numVertices, members, tasks, numThreads);
+  free(members);
+  free(raw.vertexWeights);
+  free(raw.coarseMap);
+  deleteCompactGraph(symmetric);
+  return level;
+}
+
+/*************************************************************************
+ ** Initial partitioning
+ *************************************************************************/
+
+typedef struct bisection {  // scratch space of the recursive bisection
+  Level* level;   // the coarsest level
+  int* parts;     // parts[v] is the part of vertex v
+  int* side;      // side[v] is 0 or 1 for vertices being split, else -1
+  int* gains;     // gains[v] is the change in cut if v moves to side 0
+  int* bestSide;  // side of every vertex in the best split so far
+  int* buffer;    // room for one list of vertices
+} Bisection;
+
+/* Grows side 0 of the vertices in 'vertices' from seed 'seed' to weight
+ * 'target', always adding the vertex whose move cuts the fewest edges,
+ * and returns the weight of the edges cut.
+ */
+static long long growRegion(Bisection* split, int* vertices, int count,
+                            int seed, long long target) {
+  Level* level = split->level;
+  for (int i = 0; i < count; i++) {
+    int v = vertices[i];
+    split->side[v] = 1;
+    split->gains[v] = 0;
+  }
+  for (int i = 0; i < count; i++) {
+    int v = vertices[i];
+    for (int e = level->offsets[v]; e < level->offsets[v + 1]; e++) {
+      if (split->side[level->heads[e]] != NOTHING) {
+        split->gains[v] -= level->weights[e];
+      }
+    }
+  }
+
+  PriorityQueue* queue = newPriorityQueue(QUEUE_LAZY_HEAP, level->numVertices);
+  long long weight = 0;
+  int nextUnused = 0;  // disconnected pieces are started in list order
+  pushQueue(queue, seed, -split->gains[seed]);
+  while (weight < target) {
+    int v, key;
+    if (!popQueue(queue, &v, &key)) {
+      while (nextUnused < count && split->side[vertices[nextUnused]] != 1) {
+        nextUnused++;
+      }
+      if (nextUnused == count) break;
+      v = vertices[nextUnused];
+    } else if (split->side[v] != 1 || key != -split->gains[v]) {
+      continue;  // stale
+    }
+
+    split->side[v] = 0;
+    weight += level->vertexWeights[v];
+    for (int e = level->offsets[v]; e < level->offsets[v + 1]; e++) {
+      int u = level->heads[e];
+      if (split->side[u] != 1) continue;
+      split->gains[u] += 2 * level->weights[e];
+      pushQueue(queue, u, -split->gains[u]);
+    }
+  }
+  deletePriorityQueue(queue);
+
+  long long cut = 0;
+  for (int i = 0; i < count; i++) {
+    int v = vertices[i];
+    if (split->side[v] != 0) continue;
+    for (int e = level->offsets[v]; e < level->offsets[v + 1]; e++) {
+      if (split->side[level->heads[e]] == 1) cut += level->weights[e];
+    }
+  }
+  return cut;
+}
+
+/* Assigns the 'count' vertices in 'vertices' to parts 'firstPart' ..
+ * firstPart + numParts - 1 by recursive bisection, reordering 'vertices'.
+ */
+static void splitParts(Bisection* split, int* vertices, int count,
+                       int firstPart, int numParts) {
+  if (numParts == 1 || count == 0) {
+    for (int i = 0; i < count; i++) split->parts[vertices[i]] = firstPart;
+    return;
+  }
+
+  Level* level = split->level;
+  int leftParts = numParts / 2;
+  long long total = 0;
+  for (int i = 0; i < count; i++) total += level->vertexWeights[vertices[i]];
+  long long target = total * leftParts / numParts;
+
+  long long bestCut = LLONG_MAX;
+  for (int t = 0; t < GROWING_TRIES && t < count; t++) {
+    int seed = vertices[(long long)count * t / GROWING_TRIES];
+    long long cut = growRegion(split, vertices, count, seed, target);
+    if (cut >= bestCut) continue;
+    bestCut = cut;
+    for (int i = 0; i < count; i++) {
+      split->bestSide[vertices[i]] = split->side[vertices[i]];
+    }
+  }
+
+  // side 0 first, keeping the order of each side
+  int numLeft = 0;
+  for (int i = 0; i < count; i++) {
+    if (split->bestSide[vertices[i]] == 0) {
+      split->buffer[numLeft++] = vertices[i];
+    }
+  }
+  int numRight = numLeft;
+  for (int i = 0; i < count; i++) {
+    if (split->bestSide[vertices[i]] != 0) {
+      split->buffer[numRight++] = vertices[i];
+    }
+    split->side[vertices[i]] = NOTHING;
+  }
+  for (int i = 0; i < count; i++) vertices[i] = split->buffer[i];
+
+  splitParts(split, vertices, numLeft, firstPart, leftParts);
+  splitParts(split, vertices + numLeft, count - numLeft,
+             firstPart + leftParts, numParts - leftParts);
+}
+
+/* Stores in 'parts' a partitioning of 'level' into 'numParts' parts by
+ * recursive bisection.
+ */
+static void partitionCoarsest(Level* level, _Atomic int* parts,
+                              int numParts) {
+  int numVertices = level->numVertices;
+  Bisection split;
+  split.level = level;
+  split.parts = allocateInts(numVertices);
+  split.side = allocateInts(numVertices);
+  split.gains = allocateInts(numVertices);
+  split.bestSide = allocateInts(numVertices);
+  split.buffer = allocateInts(numVertices);
+  int* vertices = allocateInts(numVertices);
+  for (int v = 0; v < numVertices; v++) {
+    split.side[v] = NOTHING;
+    vertices[v] = v;
+  }
+
+  splitParts(&split, vertices, numVertices, 0, numParts);
+  for (int v = 0; v < numVertices; v++) parts[v] = split.parts[v];
+
+  free(split.parts);
+  free(split.side);
+  free(split.gains);
+  free(split.bestSide);
+  free(split.buffer);
+  free(vertices);
+}
+
+/*************************************************************************
+ ** Refinement
+ *************************************************************************/
+
+/* Returns the change in cut weight if vertex 'v' of 'level' moves to its
+ * best part, and stores that part in 'target', or returns INT_MIN if no
+ * part can take it. Parts joined to 'v' by more edges are better, and a
+ * vertex of an overweight part may go to any part with room. 'connection'
+ * must hold 'numParts' zeros, and is left so; 'touched' needs room for
+ * 'numParts' entries.
+ */
+static int findBestMove(Level* level, _Atomic int* parts,
+                        _Atomic int* partWeights, int numParts,
+                        int maxPartWeight, int v, int* connection,
+                        int* touched, int* target) {
+  int own = parts[v];
+  int numTouched = 0;
+  for (int e = level->offsets[v]; e < level->offsets[v + 1]; e++) {
+    int p = parts[level->heads[e]];
+    if (connection[p] == 0) touched[numTouched++] = p;
+    connection[p] += level->weights[e];
+  }
+
+  int weight = level->vertexWeights[v];
+  bool overweight = partWeights[own] > maxPartWeight;
+  int best = NOTHING;
+  for (int i = 0; i < numTouched; i++) {
+    int p = touched[i];
+    if (p == own || partWeights[p] + weight > maxPartWeight) continue;
+    if (best == NOTHING || connection[p] > connection[best] ||
+        (connection[p] == connection[best] &&
+         partWeights[p] < partWeights[best])) {
+      best = p;
+    }
+  }
+  if (best == NOTHING && overweight) {
+    for (int p = 0; p < numParts; p++) {
+      if (p == own || partWeights[p] + weight > maxPartWeight) continue;
+      if (best == NOTHING || partWeights[p] < partWeights[best]) best = p;
+    }
+  }
+
+  int gain = INT_MIN;
+  if (best != NOTHING) gain = connection[best] - connection[own];
+  for (int i = 0; i < numTouched; i++) connection[touched[i]] = 0;
+  connection[own] = 0;
+  *target = best;
+  return gain;
+}
+
+/* Moves vertex 'v' of weight 'weight' from part 'from' to part 'to' if the
+ * target part still has room. Returns true if it moved.
+ */
+static bool moveVertex(_Atomic int* parts, _Atomic int* partWeights,
+                       int maxPartWeight, int v, int weight, int from,
+                       int to) {
+  if (atomic_fetch_add(&partWeights[to], weight) + weight > maxPartWeight) {
+    atomic_fetch_sub(&partWeights[to], weight);
+    return false;
+  }
+  atomic_fetch_sub(&partWeights[from], weight);
+  parts[v] = to;
+  return true;
+}
+
+/* Moves every vertex of this thread that gains from it to its best part,
+ * or that leaves an overweight part, or that keeps the cut and evens out
+ * the part sizes.
+ */
+static void* runPropagateTask(void* arg) {
+  LevelTask* task = (LevelTask*)arg;
+  Level* level = task->level;
+  int* connection = task->scratch;
+  int* touched = task->scratch + task->numParts;
+
+  task->moves = 0;
+  for (int v = task->first; v < task->last; v++) {
+    int target;
+    int gain = findBestMove(level, task->parts, task->partWeights,
+                            task->numParts, task->maxPartWeight, v,
+                            connection, touched, &target);
+    if (target == NOTHING) continue;
+
+    int own = task->parts[v];
+    int weight = level->vertexWeights[v];
+    bool overweight = task->partWeights[own] > task->maxPartWeight;
+    bool evens = gain == 0 &&
+                 task->partWeights[target] + weight < task->partWeights[own];
+    if (gain > 0 || overweight || evens) {
+      task->moves += moveVertex(task->parts, task->partWeights,
+                                task->maxPartWeight, v, weight, own, target);
+    }
+  }
+  return NULL;
+}
+
+/* Runs one Fiduccia-Mattheyses pass over 'level': moves boundary vertices
+ * one at a time, best gain first and each at most once, even when that
+ * makes the cut worse for a while, and then undoes the moves after the
+ * point where the cut was smallest. The gains of the neighbours of a moved
+ * vertex are only adjusted by the weight of the edge to it, and a gain is
+ * computed in full when its vertex comes first, so that a move costs the
+ * degree of one vertex rather than that of all its neighbours. Returns true
+ * if the cut got smaller. 'scratch' needs room for 2 * numVertices +
+ * 2 * numParts ints.
+ */
+static bool refineFm(Level* level, _Atomic int* parts,
+                     _Atomic int* partWeights, int numParts,
+                     int maxPartWeight, int* scratch) {
+  int numVertices = level->numVertices;
+  int* connection = scratch;
+  int* touched = scratch + numParts;
+  int* gains = scratch + 2 * numParts;  // queued gain of v, INT_MIN if v
+                                        //   is not queued, INT_MAX if moved
+  int* history = scratch + 2 * numParts + numVertices;  // vertices moved
+  int* fromParts = (int*)malloc(sizeof(int) * (numVertices + 1));
+  if (fromParts == NULL) {
+    printf("Error: Memory allocation failed for partitioner\n");
+    exit(1);
+  }
+  for (int p = 0; p < numParts; p++) connection[p] = 0;
+
+  PriorityQueue* queue = newPriorityQueue(QUEUE_LAZY_HEAP, numVertices);
+  for (int v = 0; v < numVertices; v++) {
+    gains[v] = INT_MIN;
+    for (int e = level->offsets[v]; e < level->offsets[v + 1]; e++) {
+      if (parts[level->heads[e]] == parts[v]) continue;
+      int target;
+      int gain = findBestMove(level, parts, partWeights, numParts,
+                              maxPartWeight, v, connection, touched, &target);
+      if (target != NOTHING) {
+        gains[v] = gain;
+        pushQueue(queue, v, -gain);
+      }
+      break;
+    }
+  }
+
+  long long change = 0;
+  long long bestChange = 0;
+  int numMoves = 0;
+  int bestMoves = 0;
+  int v, key;
+  while (numMoves - bestMoves < FM_PATIENCE && popQueue(queue, &v, &key)) {
+    if (gains[v] == INT_MIN || gains[v] == INT_MAX || key != -gains[v]) {
+      continue;  // stale
+    }
+    int target;
+    int gain = findBestMove(level, parts, partWeights, numParts,
+                            maxPartWeight, v, connection, touched, &target);
+    if (target == NOTHING) {
+      gains[v] = INT_MIN;
+      continue;
+    }
+    if (gain != gains[v]) {
+      gains[v] = gain;  // estimated; try again at its real gain
+      pushQueue(queue, v, -gain);
+      continue;
+    }
+
+    int from = parts[v];
+    if (!moveVertex(parts, partWeights, maxPartWeight, v,
+                    level->vertexWeights[v], from, target)) {
+      continue;
+    }
+    gains[v] = INT_MAX;
+    history[numMoves] = v;
+    fromParts[numMoves] = from;
+    numMoves++;
+    change -= gain;
+    if (change < bestChange) {
+      bestChange = change;
+      bestMoves = numMoves;
+    }
+
+    for (int e = level->offsets[v]; e < level->offsets[v + 1]; e++) {
+      int u = level->heads[e];
+      if (gains[u] == INT_MAX) continue;
+      bool queued = gains[u] != INT_MIN;
+      if (!queued && parts[u] != from) continue;  // not next to a new part
+      int uGain;
+      if (!queued) {
+        int uTarget;
+        uGain = findBestMove(level, parts, partWeights, numParts,
+                             maxPartWeight, u, connection, touched,
+                             &uTarget);
+        if (uTarget == NOTHING) continue;
+      } else if (parts[u] == target) {
+        uGain = gains[u] - level->weights[e];
+      } else {
+        uGain = gains[u] + level->weights[e];
+      }
+      gains[u] = uGain;
+      pushQueue(queue, u, -uGain);
+    }
+  }
+  deletePriorityQueue(queue);
+
+  // undo the moves after the best point, last first
+  while (numMoves > bestMoves) {
+    numMoves--;
+    int u = history[numMoves];
+    int weight = level->vertexWeights[u];
+    partWeights[parts[u]] -= weight;
+    partWeights[fromParts[numMoves]] += weight;
+    parts[u] = fromParts[numMoves];
+  }
+  free(fromParts);
+  return bestChange < 0;
+}
+
+/* Refines the partitioning 'parts' of 'level' with 'tasks': rounds of
+ * label propagation until no vertex moves, then FM passes until one
+ * finds nothing better.
+ */
+static void refineLevel(Level* level, _Atomic int* parts,
+                        _Atomic int* partWeights, int numParts,
+                        int maxPartWeight, LevelTask* tasks, int numThreads,
+                        int* scratch) {
+  splitRanges(tasks, numThreads, level->numVertices);
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t].level = level;
+    tasks[t].parts = parts;
+    tasks[t].partWeights = partWeights;
+    tasks[t].numParts = numParts;
+    tasks[t].maxPartWeight = maxPartWeight;
+    for (int p = 0; p < numParts; p++) tasks[t].scratch[p] = 0;
+  }
+  for (int round = 0; round < PROPAGATION_ROUNDS; round++) {
+    runLevelPhase(tasks, numThreads, runPropagateTask);
+    int moves = 0;
+    for (int t = 0; t < numThreads; t++) moves += tasks[t].moves;
+    if (moves == 0) break;
+  }
+  for (int pass = 0; pass < FM_PASSES; pass++) {
+    if (!refineFm(level, parts, partWeights, numParts, maxPartWeight,
+                  scratch)) {
+      break;
+    }
+  }
+}
+
+/*************************************************************************
+ ** Partitioning
+ *************************************************************************/
+
+Partitioning* partitionGraph(Graph* graph, int numParts, double imbalance,
+                             int numThreads) {
+  if (numParts < 1 || imbalance < 0 || numThreads < 1) return NULL;
+
+  int numVertices = graph->numVertices;
+  int scratchSize = numVertices > 2 * numParts ? numVertices : 2 * numParts;
+  LevelTask* tasks = (LevelTask*)calloc(numThreads, sizeof(LevelTask));
+  if (tasks == NULL) {
+    printf("Error: Memory allocation failed for partitioner\n");
+    exit(1);
+  }
+  for (int t = 0; t < numThreads; t++) {
+    tasks[t].scratch = allocateInts(scratchSize);
+    tasks[t].bufferCapacity = INITIAL_BUFFER;
+    tasks[t].bufferHeads = allocateInts(INITIAL_BUFFER);
+    tasks[t].bufferWeights = allocateInts(INITIAL_BUFFER);
+  }
+
+  Level* first = newFirstLevel(graph, tasks, numThreads);
+  if (first == NULL) {
+    for (int t = 0; t < numThreads; t++) {
+      free(tasks[t].scratch);
+      free(tasks[t].bufferHeads);
+      free(tasks[t].bufferWeights);
+    }
+    free(tasks);
+    return NULL;
+  }
+
+  // coarsen until a few vertices per part are left
+  int capacity = 8;
+  int numLevels = 1;
+  Level* levels = (Level*)malloc(sizeof(Level) * capacity);
+  if (levels == NULL) {
+    printf("Error: Memory allocation failed for partitioner\n");
+    exit(1);
+  }
+  levels[0] = *first;
+  free(first);
+  long long coarsest = (long long)COARSEST_PER_PART * numParts;
+  int maxVertexWeight = (int)(1.5 * numVertices / coarsest) + 1;
+  while (levels[numLevels - 1].numVertices > coarsest) {
+    if (numLevels == capacity) {
+      capacity *= 2;
+      levels = (Level*)realloc(levels, sizeof(Level) * capacity);
+      if (levels == NULL) {
+        printf("Error: Memory allocation failed for partitioner\n");
+        exit(1);
+      }
+    }
+    if (!coarsenLevel(&levels[numLevels - 1], &levels[numLevels],
+                      maxVertexWeight, tasks, numThreads)) {
+      break;
+    }
+    numLevels++;
+  }
+
+  // partition the coarsest level, then project and refine level by level
+  _Atomic int* parts =
+      (_Atomic int*)malloc(sizeof(_Atomic int) * (numVertices + 1));
+  _Atomic int* coarseParts =
+      (_Atomic int*)malloc(sizeof(_Atomic int) * (numVertices + 1));
+  _Atomic int* partWeights =
+      (_Atomic int*)calloc(numParts, sizeof(_Atomic int));
+  int* scratch = allocateInts(2 * (long long)numVertices + 2 * numParts);
+  if (parts == NULL || coarseParts == NULL || partWeights == NULL) {
+    printf("Error: Memory allocation failed for partitioner\n");
+    exit(1);
+  }
+  int maxPartWeight =
+      (int)((1.0 + imbalance) * numVertices / numParts + 0.999999);
+  if (maxPartWeight < 1) maxPartWeight = 1;
+
+  Level* coarsestLevel = &levels[numLevels - 1];
+  partitionCoarsest(coarsestLevel, coarseParts, numParts);
+  for (int v = 0; v < coarsestLevel->numVertices; v++) {
+    partWeights[coarseParts[v]] += coarsestLevel->vertexWeights[v];
+  }
+  refineLevel(coarsestLevel, coarseParts, partWeights, numParts,
+              maxPartWeight, tasks, numThreads, scratch);
+  for (int l = numLevels - 2; l >= 0; l--) {
+    Level* level = &levels[l];
+    for (int v = 0; v < level->numVertices; v++) {
+      parts[v] = coarseParts[level->coarseMap[v]];
+    }
+    refineLevel(level, parts, partWeights, numParts, maxPartWeight, tasks,
+                numThreads, scratch);
+    memcpy(coarseParts, parts, sizeof(_Atomic int) * level->numVertices);
+  }
+
+  Partitioning* result = (Partitioning*)malloc(sizeof(Partitioning));
+  if (result == NULL) {
+    printf("Error: Memory allocation failed for partitioning\n");
+    exit(1);
+  }
+  result->numVertices = numVertices;
+  result->numParts = numParts;
+  result->numLevels = numLevels;
+  result->parts = allocateInts(numVertices);
+  result->order = allocateInts(numVertices);
+  result->partOffsets = allocateInts(numParts + 1);
+  for (int v = 0; v < numVertices; v++) result->parts[v] = coarseParts[v];
+
+  // counting sort of the vertices by part
+  memset(result->partOffsets, 0, sizeof(int) * (numParts + 1));
+  for (int v = 0; v < numVertices; v++) {
+    result->partOffsets[result->parts[v] + 1]++;
+  }
+  for (int p = 0; p < numParts; p++) {
+    result->partOffsets[p + 1] += result->partOffsets[p];
+  }
+  int* next = scratch;
+  memcpy(next, result->partOffsets, sizeof(int) * numParts);
+  for (int v = 0; v < numVertices; v++) {
+    result->order[next[result->parts[v]]++] = v;
+  }
+
+  result->edgeCut = 0;
+  for (int v = 0; v < numVertices; v++) {
+    if (graph->vertices[v] == NULL) continue;
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      if (result->parts[e->edge->toVertex] != result->parts[v]) {
+        result->edgeCut++;
+      }
+    }
+  }
+
+  for (int l = 0; l < numLevels; l++) freeLevel(&levels[l]);
+  free(levels);
+  for (int t = 0; t < numThreads; t++) {
+    free(tasks[t].scratch);
+    free(tasks[t].bufferHeads);
+    free(tasks[t].bufferWeights);
+  }
+  free(tasks);
+  free(parts);
+  free(coarseParts);
+  free(partWeights);
+  free(scratch);
+  return result;
+}
+
+Graph* newGraphInOrder(Graph* graph, const int* order) {
+  int numVertices = graph->numVertices;
+  int* positions = allocateInts(numVertices);
+  for (int i = 0; i < numVertices; i++) positions[order[i]] = i;
+
+  Graph* result = newGraph(numVertices);
+  for (int i = 0; i < numVertices; i++) {
+    Vertex* vertex = graph->vertices[order[i]];
+    if (vertex == NULL) {
+      result->vertices[i] = NULL;
+      continue;
+    }
+    // build each list back to front to keep the order of 'graph'
+    int degree = 0;
+    for (EdgeList* e = vertex->adjList; e != NULL; e = e->next) degree++;
+    Edge** edges = (Edge**)malloc(sizeof(Edge*) * (degree + 1));
+    if (edges == NULL) {
+      printf("Error: Memory allocation failed for reordered graph\n");
+      exit(1);
+    }
+    int j = 0;
+    for (EdgeList* e = vertex->adjList; e != NULL; e = e->next) {
+      edges[j++] = e->edge;
+    }
+    EdgeList* adjList = NULL;
+    while (j > 0) {
+      Edge* edge = edges[--j];
+      adjList = newEdgeList(
+          newEdge(i, positions[edge->toVertex], edge->weight), adjList);
+    }
+    free(edges);
+    result->vertices[i] = newVertex(i, vertex->value, adjList);
+  }
+  result->numEdges = graph->numEdges;
+  free(positions);
+  return result;
+}
+
+void deletePartitioning(Partitioning* partitioning) {
+  if (partitioning == NULL) return;
+
+  free(partitioning->parts);
+  free(partitioning->order);
+  free(partitioning->partOffsets);
+  free(partitioning);
+}
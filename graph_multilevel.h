@@ -0,0 +1,65 @@
+/*
+ * Header file for multilevel graph partitioning.
+ *
+ * partitionGraph splits the vertices of a graph into parts of about equal
+ * size with few edges between them, for sharding across workers (see
+ * graph_partition.h) and for placing vertices that are used together close
+ * together in memory. Edge directions and weights are ignored: every edge
+ * counts once towards the cut. The partitioner works in three phases:
+ *   - coarsening: heavy edge matching merges pairs of neighbours, those
+ *     joined by the most edges first, into the vertices of a smaller graph,
+ *     again and again until the graph has a few vertices per part;
+ *   - initial partitioning: recursive bisection of the coarsest graph, each
+ *     half grown greedily from several seeds, keeping the smallest cut;
+ *   - uncoarsening: the parts are projected back level by level and
+ *     refined at each one, first by rounds of size constrained label
+ *     propagation, then by Fiduccia-Mattheyses passes that may take moves
+ *     of negative gain and keep the best prefix of their moves.
+ * Matching, contraction and label propagation are split across threads;
+ * the bisections and the Fiduccia-Mattheyses passes run on one thread.
+ *
+ * Compile with -pthread.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Multilevel_header
+#define __Graph_Multilevel_header
+
+#define DEFAULT_IMBALANCE 0.03  // parts may be 3% above the average size
+
+typedef struct partitioning {
+  int numVertices;   // total number of vertices
+  int numParts;      // number of parts
+  int* parts;        // parts[id] is the part of vertex id
+  int* order;        // all vertices, part by part, each part in ID order
+  int* partOffsets;  // the vertices of part p are order[partOffsets[p] ..
+                     //   partOffsets[p+1])
+  int edgeCut;       // number of edges whose ends are in different parts
+  int numLevels;     // number of graphs in the hierarchy
+} Partitioning;
+
+/* Returns a partitioning of the vertices of Graph 'graph' into 'numParts'
+ * parts, none more than a fraction 'imbalance' above the average size
+ * where the graph allows, with the work split across 'numThreads' threads.
+ * Returns NULL if 'numParts' < 1, 'imbalance' < 0 or 'numThreads' < 1, or
+ * if the graph has more than INT_MAX / 2 edges.
+ */
+Partitioning* partitionGraph(Graph* graph, int numParts, double imbalance,
+                             int numThreads);
+
+/* Returns a copy of Graph 'graph' in which vertex order[i] becomes vertex
+ * i, such as the vertices in the order of a Partitioning, so that every
+ * part is a range of consecutive IDs. Every adjacency list keeps its order.
+ * Precondition: 'order' holds every ID of 'graph' once
+ */
+Graph* newGraphInOrder(Graph* graph, const int* order);
+
+/* Frees all memory allocated for 'partitioning'. */
+void deletePartitioning(Partitioning* partitioning);
+
+#endif
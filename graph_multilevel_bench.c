@@ -0,0 +1,301 @@
+/*
+ *  Benchmark of the multilevel partitioner of graph_multilevel.h.
+ *
+ *  Partitions a grid whose vertex IDs are shuffled and a random graph into
+ *  several numbers of parts with several numbers of threads, and prints the
+ *  time, the edge cut against that of splitting the IDs into equal ranges,
+ *  and the size of the largest part. Then reorders the grid part by part
+ *  with newGraphInOrder and times getDistanceTreeDijkstra on both orders.
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O3 -Wall -Werror -pthread graph.c minheap.c graph_algos.c \
+ *       graph_build.c graph_queue.c graph_multilevel.c \
+ *       graph_multilevel_bench.c -o graph_multilevel_bench
+ *
+ *   Run:
+ *   ./graph_multilevel_bench [gridSide] [numSources]
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "graph.h"
+#include "graph_algos.h"
+#include "graph_build.h"
+#include "graph_multilevel.h"
+
+#define DEFAULT_SIDE 700
+#define DEFAULT_SOURCES 4
+#define AVERAGE_DEGREE 8
+#define MAX_WEIGHT 1000
+#define VERTICES_PER_BLOCK 1024  // part size when reordering for locality
+
+/* graphs */
+Graph* shuffledGrid(int side, uint64_t* state);
+Graph* randomGraph(int numVertices, uint64_t* state);
+Graph* graphFromEdges(int numVertices, int numEdges, int* from, int* to,
+                      uint64_t* state);
+uint64_t nextRandom(uint64_t* state);
+
+/* measuring */
+void timePartitioning(Graph* graph, int numParts, int numThreads);
+int rangeCut(Graph* graph, int numParts);
+double timeDijkstra(Graph* graph, const int* sources, int numSources,
+                    long long* total);
+long long distanceSum(Edge* tree, int numTreeEdges, int numVertices);
+double nowSeconds(void);
+
+int main(int argc, char* argv[]) {
+  int side = argc > 1 ? atoi(argv[1]) : DEFAULT_SIDE;
+  int numSources = argc > 2 ? atoi(argv[2]) : DEFAULT_SOURCES;
+  if (side < 2 || numSources < 1) {
+    printf("Usage: %s [gridSide >= 2] [numSources]\n", argv[0]);
+    return 1;
+  }
+
+  uint64_t state = 88172645463325252ULL;
+  Graph* graphs[2];
+  graphs[0] = shuffledGrid(side, &state);
+  graphs[1] = randomGraph(side * side, &state);
+  const char* names[2] = {"shuffled grid", "random graph"};
+
+  int partCounts[] = {2, 8, 64};
+  int threadCounts[] = {1, 2, 4};
+  for (int g = 0; g < 2; g++) {
+    printf("%s: %d vertices, %d edges\n", names[g], graphs[g]->numVertices,
+           graphs[g]->numEdges);
+    for (int p = 0; p < 3; p++) {
+      for (int t = 0; t < 3; t++) {
+        timePartitioning(graphs[g], partCounts[p], threadCounts[t]);
+      }
+    }
+    printf("\n");
+  }
+
+  // locality: the same grid with every part in consecutive IDs
+  Graph* grid = graphs[0];
+  int numVertices = grid->numVertices;
+  Partitioning* partitioning = partitionGraph(
+      grid, (numVertices + VERTICES_PER_BLOCK - 1) / VERTICES_PER_BLOCK,
+      DEFAULT_IMBALANCE, 1);
+  Graph* reordered = newGraphInOrder(grid, partitioning->order);
+  int* positions = (int*)malloc(sizeof(int) * numVertices);
+  if (positions == NULL) {
+    printf("Error: Memory allocation failed for positions\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) positions[partitioning->order[i]] = i;
+
+  int sources[numSources];
+  int reorderedSources[numSources];
+  for (int s = 0; s < numSources; s++) {
+    sources[s] = (int)(nextRandom(&state) % numVertices);
+    reorderedSources[s] = positions[sources[s]];
+  }
+  long long expected;
+  long long total;
+  double baseTime = timeDijkstra(grid, sources, numSources, &expected);
+  double time = timeDijkstra(reordered, reorderedSources, numSources, &total);
+  printf("Dijkstra on the shuffled grid   %9.1f ms/query\n", 1000 * baseTime);
+  printf("Dijkstra in partition order     %9.1f ms/query  %5.2fx%s\n",
+         1000 * time, baseTime / time,
+         total == expected ? "" : "  (distances disagree)");
+
+  free(positions);
+  deleteGraph(reordered);
+  deletePartitioning(partitioning);
+  deleteGraph(graphs[0]);
+  deleteGraph(graphs[1]);
+  return total == expected ? 0 : 1;
+}
+
+/* Returns an undirected 'side' by 'side' grid with random weights in
+ * [1, MAX_WEIGHT] whose vertex IDs are in random order.
+ */
+Graph* shuffledGrid(int side, uint64_t* state) {
+  int numVertices = side * side;
+  int numEdges = 2 * side * (side - 1);
+  int* ids = (int*)malloc(sizeof(int) * numVertices);
+  int* from = (int*)malloc(sizeof(int) * numEdges);
+  int* to = (int*)malloc(sizeof(int) * numEdges);
+  if (ids == NULL || from == NULL || to == NULL) {
+    printf("Error: Memory allocation failed for grid edges\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) ids[i] = i;
+  for (int i = numVertices - 1; i > 0; i--) {
+    int j = (int)(nextRandom(state) % (i + 1));
+    int swap = ids[i];
+    ids[i] = ids[j];
+    ids[j] = swap;
+  }
+  int numAdded = 0;
+  for (int row = 0; row < side; row++) {
+    for (int column = 0; column < side; column++) {
+      int v = row * side + column;
+      if (column + 1 < side) {
+        from[numAdded] = ids[v];
+        to[numAdded++] = ids[v + 1];
+      }
+      if (row + 1 < side) {
+        from[numAdded] = ids[v];
+        to[numAdded++] = ids[v + side];
+      }
+    }
+  }
+  free(ids);
+  return graphFromEdges(numVertices, numEdges, from, to, state);
+}
+
+/* Returns a random connected undirected graph on 'numVertices' vertices
+ * with average degree AVERAGE_DEGREE and weights in [1, MAX_WEIGHT]: a
+ * cycle through all vertices in random order, plus random edges.
+ */
+Graph* randomGraph(int numVertices, uint64_t* state) {
+  int numEdges = numVertices / 2 * AVERAGE_DEGREE;
+  int* from = (int*)malloc(sizeof(int) * numEdges);
+  int* to = (int*)malloc(sizeof(int) * numEdges);
+  if (from == NULL || to == NULL) {
+    printf("Error: Memory allocation failed for random edges\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) to[i] = i;
+  for (int i = numVertices - 1; i > 0; i--) {
+    int j = (int)(nextRandom(state) % (i + 1));
+    int swap = to[i];
+    to[i] = to[j];
+    to[j] = swap;
+  }
+  for (int i = 0; i < numEdges; i++) {
+    if (i < numVertices) {
+      from[i] = to[(i + 1) % numVertices];
+    } else {
+      from[i] = (int)(nextRandom(state) % numVertices);
+      to[i] = (int)(nextRandom(state) % numVertices);
+    }
+  }
+  return graphFromEdges(numVertices, numEdges, from, to, state);
+}
+
+/* Returns the undirected graph on 'numVertices' vertices with the
+ * 'numEdges' edges (from[i], to[i]), without parallel edges or self-loops,
+ * each given a random weight in [1, MAX_WEIGHT]. Frees 'from' and 'to'.
+ */
+Graph* graphFromEdges(int numVertices, int numEdges, int* from, int* to,
+                      uint64_t* state) {
+  int* weights = (int*)malloc(sizeof(int) * numEdges);
+  if (weights == NULL) {
+    printf("Error: Memory allocation failed for random weights\n");
+    exit(1);
+  }
+  for (int i = 0; i < numEdges; i++) {
+    weights[i] = 1 + (int)(nextRandom(state) % MAX_WEIGHT);
+  }
+  int options = BUILD_SYMMETRIZE | BUILD_DEDUPLICATE | BUILD_DROP_SELF_LOOPS;
+  CompactGraph* compact = buildCompactGraph(numVertices, numEdges, from, to,
+                                            weights, options, 1);
+  Graph* graph = newGraphFromCompact(compact);
+  deleteCompactGraph(compact);
+  free(from);
+  free(to);
+  free(weights);
+  return graph;
+}
+
+/* Partitions 'graph' into 'numParts' parts with 'numThreads' threads and
+ * prints the time, the edge cut against that of equal ranges of IDs, and
+ * the largest part against the average.
+ */
+void timePartitioning(Graph* graph, int numParts, int numThreads) {
+  double start = nowSeconds();
+  Partitioning* partitioning =
+      partitionGraph(graph, numParts, DEFAULT_IMBALANCE, numThreads);
+  double seconds = nowSeconds() - start;
+
+  int largest = 0;
+  for (int p = 0; p < numParts; p++) {
+    int size = partitioning->partOffsets[p + 1] - partitioning->partOffsets[p];
+    if (size > largest) largest = size;
+  }
+  int baseCut = rangeCut(graph, numParts);
+  printf("  %3d parts, %d threads %9.1f ms  cut %9d (ranges %9d, %5.1f%%)  "
+         "largest part %+.1f%%, %d levels\n", numParts, numThreads,
+         1000 * seconds, partitioning->edgeCut, baseCut,
+         100.0 * partitioning->edgeCut / baseCut,
+         100.0 * largest * numParts / graph->numVertices - 100,
+         partitioning->numLevels);
+  deletePartitioning(partitioning);
+}
+
+/* Returns the number of edges of 'graph' between different parts when its
+ * IDs are split into 'numParts' equal ranges.
+ */
+int rangeCut(Graph* graph, int numParts) {
+  long long numVertices = graph->numVertices;
+  int cut = 0;
+  for (int v = 0; v < numVertices; v++) {
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      if (v * numParts / numVertices !=
+          e->edge->toVertex * numParts / numVertices) {
+        cut++;
+      }
+    }
+  }
+  return cut;
+}
+
+/* Returns the mean time of getDistanceTreeDijkstra on 'graph' from the
+ * 'numSources' vertices in 'sources', and stores the sum of all their
+ * distances in 'total'.
+ */
+double timeDijkstra(Graph* graph, const int* sources, int numSources,
+                    long long* total) {
+  *total = 0;
+  double start = nowSeconds();
+  for (int s = 0; s < numSources; s++) {
+    Edge* tree = getDistanceTreeDijkstra(graph, sources[s]);
+    *total += distanceSum(tree, graph->numVertices - 1, graph->numVertices);
+    free(tree);
+  }
+  return (nowSeconds() - start) / numSources;
+}
+
+/* Returns the next value of the xorshift generator with state 'state'. */
+uint64_t nextRandom(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/* Returns the sum of the distances from the root of the tree 'tree', with
+ * 'numTreeEdges' edges in the order their heads were settled, to all
+ * vertices of a graph with 'numVertices' vertices.
+ */
+long long distanceSum(Edge* tree, int numTreeEdges, int numVertices) {
+  long long* distance = (long long*)calloc(numVertices, sizeof(long long));
+  if (distance == NULL) {
+    printf("Error: Memory allocation failed for distances\n");
+    exit(1);
+  }
+  long long total = 0;
+  for (int i = 0; i < numTreeEdges; i++) {
+    distance[tree[i].toVertex] = distance[tree[i].fromVertex] + tree[i].weight;
+    total += distance[tree[i].toVertex];
+  }
+  free(distance);
+  return total;
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
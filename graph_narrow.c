@@ -0,0 +1,416 @@
+/*
+ * Graphs with narrow edge weights.
+ *
+ * DEFINE_NARROW_HEAP, DEFINE_NARROW_DIJKSTRA and DEFINE_NARROW_PRIM stamp
+ * out an indexed binary heap per key type and a kernel per weight type
+ * (and, for Dijkstra, distance type), so every inner loop works on fixed
+ * width integers known at compile time. The public functions pick the
+ * instance that matches the graph.
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#include "graph_narrow.h"
+
+#define NOTHING -1
+
+/*************************************************************************
+ ** Heaps
+ *************************************************************************/
+
+/* Defines type NAME, an indexed binary min-heap of vertex IDs keyed by
+ * KEY, with functions initNAME, pushNAME (insert or decrease), popNAME
+ * and freeNAME.
+ */
+#define DEFINE_NARROW_HEAP(NAME, KEY)                                       \
+  typedef struct {                                                          \
+    KEY key;  /* priority of this entry */                                  \
+    int id;   /* vertex ID of this entry */                                 \
+  } NAME##Entry;                                                            \
+                                                                            \
+  typedef struct {                                                          \
+    NAME##Entry* entries;  /* the heap, root at index 0 */                  \
+    int* positions;        /* positions[id] is the index of id, or -1 */    \
+    int size;              /* number of entries */                          \
+  } NAME;                                                                   \
+                                                                            \
+  static void init##NAME(NAME* heap, int numVertices) {                     \
+    heap->entries =                                                         \
+        (NAME##Entry*)malloc(sizeof(NAME##Entry) * (numVertices + 1));      \
+    heap->positions = (int*)malloc(sizeof(int) * (numVertices + 1));        \
+    if (heap->entries == NULL || heap->positions == NULL) {                 \
+      printf("Error: Memory allocation failed for narrow heap\n");          \
+      exit(1);                                                              \
+    }                                                                       \
+    for (int v = 0; v < numVertices; v++) heap->positions[v] = NOTHING;     \
+    heap->size = 0;                                                         \
+  }                                                                         \
+                                                                            \
+  static void push##NAME(NAME* heap, int id, KEY key) {                     \
+    NAME##Entry* entries = heap->entries;                                   \
+    int index = heap->positions[id];                                        \
+    if (index == NOTHING) index = heap->size++;                             \
+    while (index > 0 && entries[(index - 1) / 2].key > key) {               \
+      entries[index] = entries[(index - 1) / 2];                            \
+      heap->positions[entries[index].id] = index;                           \
+      index = (index - 1) / 2;                                              \
+    }                                                                       \
+    entries[index].key = key;                                               \
+    entries[index].id = id;                                                 \
+    heap->positions[id] = index;                                            \
+  }                                                                         \
+                                                                            \
+  static int pop##NAME(NAME* heap, KEY* key) {                              \
+    NAME##Entry* entries = heap->entries;                                   \
+    NAME##Entry top = entries[0];                                           \
+    NAME##Entry last = entries[--heap->size];                               \
+    heap->positions[top.id] = NOTHING;                                      \
+    int index = 0;                                                          \
+    while (heap->size > 0) {                                                \
+      int child = 2 * index + 1;                                            \
+      if (child >= heap->size) break;                                       \
+      if (child + 1 < heap->size &&                                         \
+          entries[child + 1].key < entries[child].key) {                    \
+        child++;                                                            \
+      }                                                                     \
+      if (entries[child].key >= last.key) break;                            \
+      entries[index] = entries[child];                                      \
+      heap->positions[entries[index].id] = index;                           \
+      index = child;                                                        \
+    }                                                                       \
+    if (heap->size > 0) {                                                   \
+      entries[index] = last;                                                \
+      heap->positions[last.id] = index;                                     \
+    }                                                                       \
+    *key = top.key;                                                         \
+    return top.id;                                                          \
+  }                                                                         \
+                                                                            \
+  static void free##NAME(NAME* heap) {                                      \
+    free(heap->entries);                                                    \
+    free(heap->positions);                                                  \
+  }
+
+DEFINE_NARROW_HEAP(Heap8, uint8_t)
+DEFINE_NARROW_HEAP(Heap16, uint16_t)
+DEFINE_NARROW_HEAP(Heap32, uint32_t)
+DEFINE_NARROW_HEAP(Heap64, uint64_t)
+
+/*************************************************************************
+ ** Kernels
+ *************************************************************************/
+
+/* Defines NAME(graph, source, distances, parents), Dijkstra's algorithm on
+ * a graph with WEIGHT weights, accumulating distances in DIST with NONE
+ * for "not reachable", using heap type HEAP.
+ */
+#define DEFINE_NARROW_DIJKSTRA(NAME, WEIGHT, DIST, NONE, HEAP)              \
+  static void NAME(NarrowGraph* graph, int source, DIST* distances,         \
+                   int* parents) {                                          \
+    const WEIGHT* weights = (const WEIGHT*)graph->weights;                  \
+    const int* offsets = graph->offsets;                                    \
+    const int* heads = graph->heads;                                        \
+    for (int v = 0; v < graph->numVertices; v++) {                          \
+      distances[v] = NONE;                                                  \
+      parents[v] = NOTHING;                                                 \
+    }                                                                       \
+                                                                            \
+    HEAP heap;                                                              \
+    init##HEAP(&heap, graph->numVertices);                                  \
+    distances[source] = 0;                                                  \
+    push##HEAP(&heap, source, 0);                                           \
+    while (heap.size > 0) {                                                 \
+      DIST distance;                                                        \
+      int u = pop##HEAP(&heap, &distance);                                  \
+      for (int i = offsets[u]; i < offsets[u + 1]; i++) {                   \
+        int v = heads[i];                                                   \
+        DIST candidate = distance + weights[i];                             \
+        if (candidate < distances[v]) {                                     \
+          distances[v] = candidate;                                         \
+          parents[v] = u;                                                   \
+          push##HEAP(&heap, v, candidate);                                  \
+        }                                                                   \
+      }                                                                     \
+    }                                                                       \
+    free##HEAP(&heap);                                                      \
+  }
+
+/* Defines NAME(graph, source, tree), Prim's algorithm on a graph with
+ * WEIGHT weights using heap type HEAP, which writes the MST edges to
+ * 'tree' and returns their number.
+ */
+#define DEFINE_NARROW_PRIM(NAME, WEIGHT, HEAP)                              \
+  static int NAME(NarrowGraph* graph, int source, Edge* tree) {             \
+    const WEIGHT* weights = (const WEIGHT*)graph->weights;                  \
+    const int* offsets = graph->offsets;                                    \
+    const int* heads = graph->heads;                                        \
+    int numVertices = graph->numVertices;                                   \
+    WEIGHT* keys = (WEIGHT*)malloc(sizeof(WEIGHT) * numVertices);           \
+    int* parents = (int*)malloc(sizeof(int) * numVertices);                 \
+    bool* inTree = (bool*)calloc(numVertices, sizeof(bool));                \
+    if (keys == NULL || parents == NULL || inTree == NULL) {                \
+      printf("Error: Memory allocation failed for narrow Prim\n");          \
+      exit(1);                                                              \
+    }                                                                       \
+    for (int v = 0; v < numVertices; v++) parents[v] = NOTHING;             \
+                                                                            \
+    HEAP heap;                                                              \
+    init##HEAP(&heap, numVertices);                                         \
+    push##HEAP(&heap, source, 0);                                           \
+    int numEdges = 0;                                                       \
+    while (heap.size > 0) {                                                 \
+      WEIGHT key;                                                           \
+      int u = pop##HEAP(&heap, &key);                                       \
+      inTree[u] = true;                                                     \
+      if (parents[u] != NOTHING) {                                          \
+        tree[numEdges].fromVertex = parents[u];                             \
+        tree[numEdges].toVertex = u;                                        \
+        tree[numEdges].weight = key;                                        \
+        numEdges++;                                                         \
+      }                                                                     \
+      for (int i = offsets[u]; i < offsets[u + 1]; i++) {                   \
+        int v = heads[i];                                                   \
+        if (inTree[v]) continue;                                            \
+        if (parents[v] == NOTHING || weights[i] < keys[v]) {                \
+          keys[v] = weights[i];                                             \
+          parents[v] = u;                                                   \
+          push##HEAP(&heap, v, weights[i]);                                 \
+        }                                                                   \
+      }                                                                     \
+    }                                                                       \
+                                                                            \
+    free##HEAP(&heap);                                                      \
+    free(keys);                                                             \
+    free(parents);                                                          \
+    free(inTree);                                                           \
+    return numEdges;                                                        \
+  }
+
+DEFINE_NARROW_DIJKSTRA(dijkstra8x32, uint8_t, uint32_t, UINT32_MAX, Heap32)
+DEFINE_NARROW_DIJKSTRA(dijkstra16x32, uint16_t, uint32_t, UINT32_MAX, Heap32)
+DEFINE_NARROW_DIJKSTRA(dijkstra32x32, uint32_t, uint32_t, UINT32_MAX, Heap32)
+DEFINE_NARROW_DIJKSTRA(dijkstra8x64, uint8_t, uint64_t, UINT64_MAX, Heap64)
+DEFINE_NARROW_DIJKSTRA(dijkstra16x64, uint16_t, uint64_t, UINT64_MAX, Heap64)
+DEFINE_NARROW_DIJKSTRA(dijkstra32x64, uint32_t, uint64_t, UINT64_MAX, Heap64)
+
+DEFINE_NARROW_PRIM(prim8, uint8_t, Heap8)
+DEFINE_NARROW_PRIM(prim16, uint16_t, Heap16)
+DEFINE_NARROW_PRIM(prim32, uint32_t, Heap32)
+
+/*************************************************************************
+ ** Building
+ *************************************************************************/
+
+/* Returns a NarrowGraph on 'numVertices' vertices with the 'numEdges'
+ * edges in 'offsets', 'heads' and 'weights' (copied), or NULL if a weight
+ * is negative.
+ */
+static NarrowGraph* newNarrowGraphFromArrays(int numVertices, int numEdges,
+                                             const int* offsets,
+                                             const int* heads,
+                                             const int* weights) {
+  int maxWeight = 0;
+  for (int i = 0; i < numEdges; i++) {
+    if (weights[i] < 0) return NULL;
+    if (weights[i] > maxWeight) maxWeight = weights[i];
+  }
+
+  NarrowGraph* graph = (NarrowGraph*)malloc(sizeof(NarrowGraph));
+  if (graph == NULL) {
+    printf("Error: Memory allocation failed for narrow graph\n");
+    exit(1);
+  }
+  graph->numVertices = numVertices;
+  graph->numEdges = numEdges;
+  graph->maxWeight = maxWeight;
+  graph->width = maxWeight <= UINT8_MAX    ? WEIGHTS_8
+                 : maxWeight <= UINT16_MAX ? WEIGHTS_16
+                                           : WEIGHTS_32;
+  // a settled distance covers at most numVertices - 1 edges, and the
+  // kernels relax every edge of a settled vertex, settled heads included,
+  // so a candidate distance covers at most numVertices edges
+  graph->wideDistances = (uint64_t)maxWeight * numVertices >= UINT32_MAX;
+
+  size_t weightSize = graph->width == WEIGHTS_8    ? sizeof(uint8_t)
+                      : graph->width == WEIGHTS_16 ? sizeof(uint16_t)
+                                                   : sizeof(uint32_t);
+  graph->offsets = (int*)malloc(sizeof(int) * (numVertices + 1));
+  graph->heads = (int*)malloc(sizeof(int) * (numEdges + 1));
+  graph->weights = malloc(weightSize * (numEdges + 1));
+  if (graph->offsets == NULL || graph->heads == NULL ||
+      graph->weights == NULL) {
+    printf("Error: Memory allocation failed for narrow graph edges\n");
+    exit(1);
+  }
+  memcpy(graph->offsets, offsets, sizeof(int) * (numVertices + 1));
+  memcpy(graph->heads, heads, sizeof(int) * numEdges);
+  for (int i = 0; i < numEdges; i++) {
+    switch (graph->width) {
+      case WEIGHTS_8:
+        ((uint8_t*)graph->weights)[i] = (uint8_t)weights[i];
+        break;
+      case WEIGHTS_16:
+        ((uint16_t*)graph->weights)[i] = (uint16_t)weights[i];
+        break;
+      case WEIGHTS_32:
+        ((uint32_t*)graph->weights)[i] = (uint32_t)weights[i];
+        break;
+    }
+  }
+  return graph;
+}
+
+NarrowGraph* newNarrowGraph(Graph* graph) {
+  int numVertices = graph->numVertices;
+  int* offsets = (int*)malloc(sizeof(int) * (numVertices + 1));
+  if (offsets == NULL) {
+    printf("Error: Memory allocation failed for narrow graph offsets\n");
+    exit(1);
+  }
+  int numEdges = 0;
+  for (int v = 0; v < numVertices; v++) {
+    offsets[v] = numEdges;
+    if (graph->vertices[v] == NULL) continue;
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      numEdges++;
+    }
+  }
+  offsets[numVertices] = numEdges;
+
+  int* heads = (int*)malloc(sizeof(int) * (numEdges + 1));
+  int* weights = (int*)malloc(sizeof(int) * (numEdges + 1));
+  if (heads == NULL || weights == NULL) {
+    printf("Error: Memory allocation failed for narrow graph edges\n");
+    exit(1);
+  }
+  for (int v = 0; v < numVertices; v++) {
+    if (graph->vertices[v] == NULL) continue;
+    int i = offsets[v];
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      heads[i] = e->edge->toVertex;
+      weights[i] = e->edge->weight;
+      i++;
+    }
+  }
+
+  NarrowGraph* narrow = newNarrowGraphFromArrays(numVertices, numEdges,
+                                                 offsets, heads, weights);
+  free(offsets);
+  free(heads);
+  free(weights);
+  return narrow;
+}
+
+NarrowGraph* newNarrowGraphFromCompact(CompactGraph* graph) {
+  return newNarrowGraphFromArrays(graph->numVertices, graph->numEdges,
+                                  graph->offsets, graph->heads,
+                                  graph->weights);
+}
+
+/*************************************************************************
+ ** Searches
+ *************************************************************************/
+
+NarrowDistances* getDistancesNarrow(NarrowGraph* graph, int startVertex) {
+  if (startVertex < 0 || startVertex >= graph->numVertices) return NULL;
+
+  int numVertices = graph->numVertices;
+  NarrowDistances* result = (NarrowDistances*)malloc(sizeof(NarrowDistances));
+  if (result == NULL) {
+    printf("Error: Memory allocation failed for narrow distances\n");
+    exit(1);
+  }
+  result->source = startVertex;
+  result->numVertices = numVertices;
+  result->wide = graph->wideDistances;
+  result->distances32 = NULL;
+  result->distances64 = NULL;
+  result->parents = (int*)malloc(sizeof(int) * numVertices);
+  if (result->wide) {
+    result->distances64 = (uint64_t*)malloc(sizeof(uint64_t) * numVertices);
+  } else {
+    result->distances32 = (uint32_t*)malloc(sizeof(uint32_t) * numVertices);
+  }
+  if (result->parents == NULL ||
+      (result->distances32 == NULL && result->distances64 == NULL)) {
+    printf("Error: Memory allocation failed for narrow distances\n");
+    exit(1);
+  }
+
+  int* parents = result->parents;
+  switch (graph->width) {
+    case WEIGHTS_8:
+      if (result->wide) {
+        dijkstra8x64(graph, startVertex, result->distances64, parents);
+      } else {
+        dijkstra8x32(graph, startVertex, result->distances32, parents);
+      }
+      break;
+    case WEIGHTS_16:
+      if (result->wide) {
+        dijkstra16x64(graph, startVertex, result->distances64, parents);
+      } else {
+        dijkstra16x32(graph, startVertex, result->distances32, parents);
+      }
+      break;
+    case WEIGHTS_32:
+      if (result->wide) {
+        dijkstra32x64(graph, startVertex, result->distances64, parents);
+      } else {
+        dijkstra32x32(graph, startVertex, result->distances32, parents);
+      }
+      break;
+  }
+  return result;
+}
+
+uint64_t getNarrowDistance(NarrowDistances* result, int id) {
+  if (id < 0 || id >= result->numVertices) return UINT64_MAX;
+  if (result->wide) return result->distances64[id];
+  uint32_t distance = result->distances32[id];
+  return distance == UINT32_MAX ? UINT64_MAX : distance;
+}
+
+Edge* getMSTprimNarrow(NarrowGraph* graph, int startVertex,
+                       int* numTreeEdges) {
+  if (startVertex < 0 || startVertex >= graph->numVertices) return NULL;
+
+  Edge* tree = (Edge*)malloc(sizeof(Edge) * graph->numVertices);
+  if (tree == NULL) {
+    printf("Error: Memory allocation failed for narrow MST\n");
+    exit(1);
+  }
+  int numEdges = 0;
+  switch (graph->width) {
+    case WEIGHTS_8:
+      numEdges = prim8(graph, startVertex, tree);
+      break;
+    case WEIGHTS_16:
+      numEdges = prim16(graph, startVertex, tree);
+      break;
+    case WEIGHTS_32:
+      numEdges = prim32(graph, startVertex, tree);
+      break;
+  }
+  if (numTreeEdges != NULL) *numTreeEdges = numEdges;
+  return tree;
+}
+
+void deleteNarrowGraph(NarrowGraph* graph) {
+  if (graph == NULL) return;
+
+  free(graph->offsets);
+  free(graph->heads);
+  free(graph->weights);
+  free(graph);
+}
+
+void deleteNarrowDistances(NarrowDistances* result) {
+  if (result == NULL) return;
+
+  free(result->distances32);
+  free(result->distances64);
+  free(result->parents);
+  free(result);
+}
@@ -0,0 +1,89 @@
+/*
+ * Header file for graphs with narrow edge weights.
+ *
+ * A NarrowGraph stores its weights in the narrowest of 8, 16 or 32 bits
+ * that fits the largest one, so searches read less memory per edge. The
+ * Dijkstra and Prim kernels and their heaps are instantiated by macros for
+ * every weight width, and Dijkstra also for 32- and 64-bit distances; the
+ * 32-bit version is used only when no relaxed path, of at most
+ * numVertices edges, can overflow it, so neither version needs overflow
+ * checks.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+#include "graph_build.h"
+
+#ifndef __Graph_Narrow_header
+#define __Graph_Narrow_header
+
+typedef enum weight_width {
+  WEIGHTS_8,   // weights are uint8_t
+  WEIGHTS_16,  // weights are uint16_t
+  WEIGHTS_32   // weights are uint32_t
+} WeightWidth;
+
+typedef struct narrow_graph {
+  int numVertices;     // total number of vertices
+  int numEdges;        // total number of edges
+  int* offsets;        // edges leaving id are at [offsets[id], offsets[id+1])
+  int* heads;          // heads[i] is the head of edge i
+  WeightWidth width;   // type of the weights
+  void* weights;       // weights[i] is the weight of edge i, as 'width' says
+  int maxWeight;       // largest weight
+  bool wideDistances;  // true iff distances need 64 bits
+} NarrowGraph;
+
+typedef struct narrow_distances {
+  int source;             // ID of the start vertex
+  int numVertices;        // total number of vertices
+  bool wide;              // true iff 'distances64' is used
+  uint32_t* distances32;  // distances from the source, UINT32_MAX if not
+                          //   reachable, or NULL
+  uint64_t* distances64;  // distances from the source, UINT64_MAX if not
+                          //   reachable, or NULL
+  int* parents;           // parents[id] is the vertex before id on a
+                          //   shortest path, or -1
+} NarrowDistances;
+
+/* Returns a NarrowGraph with the vertices and edges of Graph 'graph', or
+ * NULL if a weight is negative.
+ */
+NarrowGraph* newNarrowGraph(Graph* graph);
+
+/* Returns a NarrowGraph with the vertices and edges of 'graph', or NULL if
+ * a weight is negative.
+ */
+NarrowGraph* newNarrowGraphFromCompact(CompactGraph* graph);
+
+/* Runs Dijkstra's algorithm on 'graph' from vertex with ID 'startVertex'
+ * and returns the distances and parents of all vertices.
+ * Returns NULL if 'startVertex' is not valid in 'graph'.
+ */
+NarrowDistances* getDistancesNarrow(NarrowGraph* graph, int startVertex);
+
+/* Returns the distance from the source of 'result' to vertex 'id', or
+ * UINT64_MAX if it is not reachable.
+ */
+uint64_t getNarrowDistance(NarrowDistances* result, int id);
+
+/* Runs Prim's algorithm on 'graph' from vertex with ID 'startVertex' and
+ * returns the MST in the format produced by getMSTprim, with the number of
+ * its edges in 'numTreeEdges' (if not NULL). Only the component of
+ * 'startVertex' is spanned.
+ * Returns NULL if 'startVertex' is not valid in 'graph'.
+ */
+Edge* getMSTprimNarrow(NarrowGraph* graph, int startVertex,
+                       int* numTreeEdges);
+
+/* Frees all memory allocated for 'graph'. */
+void deleteNarrowGraph(NarrowGraph* graph);
+
+/* Frees all memory allocated for 'result'. */
+void deleteNarrowDistances(NarrowDistances* result);
+
+#endif
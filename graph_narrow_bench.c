@@ -0,0 +1,296 @@
+/*
+ *  Benchmark of the narrow-weight kernels of graph_narrow.h.
+ *
+ *  Builds random connected graphs whose largest weight calls for 8-, 16-
+ *  and 32-bit weights, with 32- and 64-bit distances, and times
+ *  getDistancesNarrow and getMSTprimNarrow against getDistanceTreeDijkstra
+ *  and getMSTprim on the same graph. Checks every distance, parent and MST
+ *  weight against those of graph_algos.h, the same for a NarrowGraph read
+ *  back by loadNarrowGraph from a DIMACS file of the graph, and that paths
+ *  whose length overflows 32 bits get 64-bit distances.
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O3 -Wall -Werror -pthread graph.c minheap.c graph_algos.c \
+ *       graph_build.c graph_narrow.c graph_formats.c graph_narrow_bench.c \
+ *       -o graph_narrow_bench
+ *
+ *   Run:
+ *   ./graph_narrow_bench [numVertices]
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "graph.h"
+#include "graph_algos.h"
+#include "graph_build.h"
+#include "graph_formats.h"
+#include "graph_narrow.h"
+
+#define NOTHING -1
+#define DEFAULT_VERTICES 50000
+#define AVERAGE_DEGREE 8
+#define NUM_SOURCES 3  // start vertices checked and timed per graph
+
+/* graphs */
+Graph* randomGraph(int numVertices, int maxWeight, uint64_t* state);
+NarrowGraph* reloadNarrowGraph(Graph* graph);
+uint64_t nextRandom(uint64_t* state);
+
+/* checking */
+bool checkDistances(Graph* graph, NarrowGraph* narrow, int source,
+                    double* baseTime, double* narrowTime);
+bool checkMST(Graph* graph, NarrowGraph* narrow, double* baseTime,
+              double* narrowTime);
+bool checkOverflow(void);
+
+/* measuring */
+bool timeNarrow(int numVertices, int maxWeight, uint64_t* state);
+double nowSeconds(void);
+
+int main(int argc, char* argv[]) {
+  int numVertices = argc > 1 ? atoi(argv[1]) : DEFAULT_VERTICES;
+  if (numVertices < 2) {
+    printf("Usage: %s [numVertices >= 2]\n", argv[0]);
+    return 1;
+  }
+
+  // 8-, 16- and 32-bit weights, the last with 32-bit distances while
+  // 70000 * numVertices stays below UINT32_MAX, and 64-bit distances
+  int maxWeights[] = {200, 60000, 70000, 100000000};
+  uint64_t state = 88172645463325252ULL;
+  bool agree = checkOverflow();
+  printf("%-22s %12s %12s %7s %12s %12s %7s\n", "weights", "Dijkstra",
+         "narrow", "speedup", "Prim", "narrow", "speedup");
+  for (int w = 0; w < 4; w++) {
+    agree &= timeNarrow(numVertices, maxWeights[w], &state);
+  }
+  return agree ? 0 : 1;
+}
+
+/* Returns a random connected undirected graph on 'numVertices' vertices
+ * with average degree AVERAGE_DEGREE and weights in [1, 'maxWeight']: a
+ * cycle through all vertices in random order, plus random edges.
+ */
+Graph* randomGraph(int numVertices, int maxWeight, uint64_t* state) {
+  int numEdges = numVertices / 2 * AVERAGE_DEGREE;
+  int* from = (int*)malloc(sizeof(int) * numEdges);
+  int* to = (int*)malloc(sizeof(int) * numEdges);
+  int* weights = (int*)malloc(sizeof(int) * numEdges);
+  if (from == NULL || to == NULL || weights == NULL) {
+    printf("Error: Memory allocation failed for random edges\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) to[i] = i;
+  for (int i = numVertices - 1; i > 0; i--) {
+    int j = (int)(nextRandom(state) % (i + 1));
+    int swap = to[i];
+    to[i] = to[j];
+    to[j] = swap;
+  }
+  for (int i = 0; i < numEdges; i++) {
+    if (i < numVertices) {
+      from[i] = to[(i + 1) % numVertices];
+    } else {
+      from[i] = (int)(nextRandom(state) % numVertices);
+      to[i] = (int)(nextRandom(state) % numVertices);
+    }
+    weights[i] = 1 + (int)(nextRandom(state) % maxWeight);
+  }
+
+  int options = BUILD_SYMMETRIZE | BUILD_DEDUPLICATE | BUILD_DROP_SELF_LOOPS;
+  CompactGraph* compact = buildCompactGraph(numVertices, numEdges, from, to,
+                                            weights, options, 1);
+  Graph* graph = newGraphFromCompact(compact);
+  deleteCompactGraph(compact);
+  free(from);
+  free(to);
+  free(weights);
+  return graph;
+}
+
+/* Writes 'graph' to a temporary DIMACS file and returns the NarrowGraph
+ * that loadNarrowGraph reads back from it.
+ */
+NarrowGraph* reloadNarrowGraph(Graph* graph) {
+  FILE* f = tmpfile();
+  if (f == NULL) {
+    printf("Error: Could not create temporary graph file\n");
+    exit(1);
+  }
+  fprintf(f, "p sp %d %d\n", graph->numVertices, graph->numEdges);
+  for (int v = 0; v < graph->numVertices; v++) {
+    if (graph->vertices[v] == NULL) continue;
+    for (EdgeList* e = graph->vertices[v]->adjList; e != NULL; e = e->next) {
+      fprintf(f, "a %d %d %d\n", v + 1, e->edge->toVertex + 1,
+              e->edge->weight);
+    }
+  }
+  rewind(f);
+  NarrowGraph* narrow = loadNarrowGraph(f, FORMAT_DIMACS, 0, 1, NULL);
+  fclose(f);
+  return narrow;
+}
+
+/* Returns true iff getDistancesNarrow on 'narrow' and
+ * getDistanceTreeDijkstra on 'graph', the same graph, agree on every
+ * distance from vertex with ID 'source', and every parent of the former
+ * lies on a shortest path. Adds the time of each search to 'baseTime' and
+ * 'narrowTime'.
+ * Precondition: 'graph' is connected
+ */
+bool checkDistances(Graph* graph, NarrowGraph* narrow, int source,
+                    double* baseTime, double* narrowTime) {
+  int numVertices = graph->numVertices;
+  double start = nowSeconds();
+  Edge* tree = getDistanceTreeDijkstra(graph, source);
+  *baseTime += nowSeconds() - start;
+  start = nowSeconds();
+  NarrowDistances* result = getDistancesNarrow(narrow, source);
+  *narrowTime += nowSeconds() - start;
+
+  // tree edges come in the order their heads were settled
+  long long* distances = (long long*)malloc(sizeof(long long) * numVertices);
+  if (distances == NULL) {
+    printf("Error: Memory allocation failed for distances\n");
+    exit(1);
+  }
+  distances[source] = 0;
+  for (int i = 0; i < numVertices - 1; i++) {
+    distances[tree[i].toVertex] =
+        distances[tree[i].fromVertex] + tree[i].weight;
+  }
+
+  bool agree = result->parents[source] == NOTHING;
+  for (int v = 0; v < numVertices && agree; v++) {
+    agree = getNarrowDistance(result, v) == (uint64_t)distances[v];
+    int parent = result->parents[v];
+    if (agree && v != source) {
+      int weight = INT_MAX;
+      for (EdgeList* e = graph->vertices[parent]->adjList; e != NULL;
+           e = e->next) {
+        if (e->edge->toVertex == v && e->edge->weight < weight) {
+          weight = e->edge->weight;
+        }
+      }
+      agree = weight != INT_MAX && distances[parent] + weight == distances[v];
+    }
+  }
+  free(distances);
+  free(tree);
+  deleteNarrowDistances(result);
+  return agree;
+}
+
+/* Returns true iff getMSTprimNarrow on 'narrow' and getMSTprim on 'graph',
+ * the same connected graph, build trees of the same weight with an edge
+ * per vertex but the start. Adds the time of each to 'baseTime' and
+ * 'narrowTime'.
+ */
+bool checkMST(Graph* graph, NarrowGraph* narrow, double* baseTime,
+              double* narrowTime) {
+  int numVertices = graph->numVertices;
+  double start = nowSeconds();
+  Edge* tree = getMSTprim(graph, 0);
+  *baseTime += nowSeconds() - start;
+  int numTreeEdges;
+  start = nowSeconds();
+  Edge* narrowTree = getMSTprimNarrow(narrow, 0, &numTreeEdges);
+  *narrowTime += nowSeconds() - start;
+
+  long long weight = 0;
+  long long narrowWeight = 0;
+  for (int i = 0; i < numVertices - 1; i++) weight += tree[i].weight;
+  for (int i = 0; i < numTreeEdges; i++) narrowWeight += narrowTree[i].weight;
+  free(tree);
+  free(narrowTree);
+  return numTreeEdges == numVertices - 1 && narrowWeight == weight;
+}
+
+/* Returns true iff paths longer than UINT32_MAX get their exact distances:
+ * on edges 0 -> 1, 1 -> 2 and 2 -> 1 of weight INT_MAX, the path to 2 is
+ * short enough for 32 bits, but relaxing 2 -> 1 afterwards is not.
+ */
+bool checkOverflow(void) {
+  int from[] = {0, 1, 2};
+  int to[] = {1, 2, 1};
+  int weights[] = {INT_MAX, INT_MAX, INT_MAX};
+  CompactGraph* compact = buildCompactGraph(3, 3, from, to, weights, 0, 1);
+  NarrowGraph* narrow = newNarrowGraphFromCompact(compact);
+  NarrowDistances* result = getDistancesNarrow(narrow, 0);
+  bool agree = narrow->wideDistances &&
+               getNarrowDistance(result, 1) == (uint64_t)INT_MAX &&
+               getNarrowDistance(result, 2) == 2 * (uint64_t)INT_MAX &&
+               result->parents[1] == 0 && result->parents[2] == 1;
+  if (!agree) printf("Distances beyond 32 bits disagree\n");
+  deleteNarrowDistances(result);
+  deleteNarrowGraph(narrow);
+  deleteCompactGraph(compact);
+  return agree;
+}
+
+/* Builds a random graph on 'numVertices' vertices with weights up to
+ * 'maxWeight', as a Graph, a NarrowGraph and a NarrowGraph read back by
+ * loadNarrowGraph, and prints the time of Dijkstra's algorithm from
+ * NUM_SOURCES random vertices and of Prim's algorithm on each. Returns
+ * false if any result of the NarrowGraphs disagrees with graph_algos.h.
+ */
+bool timeNarrow(int numVertices, int maxWeight, uint64_t* state) {
+  Graph* graph = randomGraph(numVertices, maxWeight, state);
+  NarrowGraph* narrow = newNarrowGraph(graph);
+  NarrowGraph* loaded = reloadNarrowGraph(graph);
+
+  bool agree = loaded != NULL && loaded->width == narrow->width &&
+               loaded->wideDistances == narrow->wideDistances;
+  double baseTime = 0;
+  double narrowTime = 0;
+  double loadedTime = 0;
+  for (int s = 0; s < NUM_SOURCES && agree; s++) {
+    int source = (int)(nextRandom(state) % numVertices);
+    agree = checkDistances(graph, narrow, source, &baseTime, &narrowTime) &&
+            checkDistances(graph, loaded, source, &loadedTime, &loadedTime);
+  }
+  double primTime = 0;
+  double narrowPrimTime = 0;
+  agree = agree &&
+          checkMST(graph, narrow, &primTime, &narrowPrimTime) &&
+          checkMST(graph, loaded, &loadedTime, &loadedTime);
+
+  int bits = narrow->width == WEIGHTS_8    ? 8
+             : narrow->width == WEIGHTS_16 ? 16
+                                           : 32;
+  char name[32];
+  snprintf(name, sizeof(name), "%d (%dx%d bits)", maxWeight, bits,
+           narrow->wideDistances ? 64 : 32);
+  printf("%-22s %9.2f ms %9.2f ms %6.2fx %9.2f ms %9.2f ms %6.2fx%s\n", name,
+         1000 * baseTime / NUM_SOURCES, 1000 * narrowTime / NUM_SOURCES,
+         baseTime / narrowTime, 1000 * primTime, 1000 * narrowPrimTime,
+         primTime / narrowPrimTime, agree ? "" : "  (disagrees)");
+
+  deleteNarrowGraph(loaded);
+  deleteNarrowGraph(narrow);
+  deleteGraph(graph);
+  return agree;
+}
+
+/* Returns the next value of the xorshift generator with state 'state'. */
+uint64_t nextRandom(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,267 @@
+/*
+ * k-nearest-target queries.
+ *
+ * Vertices enter the heap only when they are first reached, so a query that
+ * stops after k targets never pays for the vertices it did not touch.
+ */
+
+#include <limits.h>
+
+#include "graph_nearest.h"
+#include "minheap.h"
+
+#define NOTHING -1
+
+typedef struct nearest_workspace {
+  int numVertices;    // total number of vertices in the graph
+  MinHeap* heap;      // priority queue of reached, unfinished vertices
+  int* distances;     // distances[id] is the tentative distance of vertex id
+  int* predecessors;  // predecessors[id] is the predecessor of vertex id
+  int* predWeights;   // predWeights[id] is the weight of the edge from
+                      //   predecessors[id] to id
+  bool* finished;     // finished[id] is true iff vertex id is finished
+  int* touched;       // ids of all vertices reached by the current query
+  int numTouched;     // number of vertices in 'touched'
+} NearestWorkspace;
+
+/*************************************************************************
+ ** Helper functions
+ *************************************************************************/
+
+/* Returns a newly created workspace for queries on Graph 'graph', with every
+ * vertex unreached.
+ */
+static NearestWorkspace* newNearestWorkspace(Graph* graph) {
+  NearestWorkspace* ws = (NearestWorkspace*)malloc(sizeof(NearestWorkspace));
+  if (ws == NULL) {
+    printf("Error: Memory allocation failed for nearest workspace\n");
+    exit(1);
+  }
+
+  int numVertices = graph->numVertices;
+  ws->numVertices = numVertices;
+  ws->heap = newHeap(numVertices);
+  ws->distances = (int*)malloc(sizeof(int) * numVertices);
+  ws->predecessors = (int*)malloc(sizeof(int) * numVertices);
+  ws->predWeights = (int*)malloc(sizeof(int) * numVertices);
+  ws->finished = (bool*)malloc(sizeof(bool) * numVertices);
+  ws->touched = (int*)malloc(sizeof(int) * numVertices);
+  if (ws->distances == NULL || ws->predecessors == NULL ||
+      ws->predWeights == NULL || ws->finished == NULL ||
+      ws->touched == NULL) {
+    printf("Error: Memory allocation failed for nearest workspace arrays\n");
+    exit(1);
+  }
+
+  for (int i = 0; i < numVertices; i++) {
+    ws->distances[i] = INT_MAX;
+    ws->predecessors[i] = NOTHING;
+    ws->finished[i] = false;
+  }
+  ws->numTouched = 0;
+
+  return ws;
+}
+
+/* Frees all memory allocated for workspace 'ws'. */
+static void deleteNearestWorkspace(NearestWorkspace* ws) {
+  deleteHeap(ws->heap);
+  free(ws->distances);
+  free(ws->predecessors);
+  free(ws->predWeights);
+  free(ws->finished);
+  free(ws->touched);
+  free(ws);
+}
+
+/* Restores every vertex touched by the last query on 'ws' to unreached, and
+ * empties the heap. Costs O(number of touched vertices).
+ */
+static void resetNearestWorkspace(NearestWorkspace* ws) {
+  for (int i = 0; i < ws->numTouched; i++) {
+    int id = ws->touched[i];
+    ws->distances[id] = INT_MAX;
+    ws->predecessors[id] = NOTHING;
+    ws->finished[id] = false;
+    ws->heap->indexMap[id] = NOTHING;
+  }
+  ws->heap->size = 0;
+  ws->numTouched = 0;
+}
+
+/* Records that vertex 'id' was reached with distance 'distance' over the
+ * edge ('pred' -- 'id', 'weight') and puts it into the heap.
+ */
+static void reachVertex(NearestWorkspace* ws, int id, int distance, int pred,
+                        int weight) {
+  if (ws->distances[id] == INT_MAX) {
+    ws->touched[ws->numTouched++] = id;
+    insert(ws->heap, distance, id);
+  } else {
+    decreasePriority(ws->heap, id, distance);
+  }
+  ws->distances[id] = distance;
+  ws->predecessors[id] = pred;
+  ws->predWeights[id] = weight;
+}
+
+/* Returns true iff 'vertex' is a target according to 'isTarget'. */
+static bool isTargetVertex(Vertex* vertex, TargetPredicate isTarget,
+                           void* context) {
+  if (isTarget == NULL) return vertex->value != NULL;
+  return isTarget(vertex, context);
+}
+
+/* Creates and returns the path from 'vertex' to 'source' recorded in 'ws',
+ * in the format produced by getShortestPaths.
+ */
+static EdgeList* makeNearestPath(NearestWorkspace* ws, int vertex,
+                                 int source) {
+  EdgeList* head = NULL;
+  EdgeList* tail = NULL;
+
+  while (vertex != source) {
+    int pred = ws->predecessors[vertex];
+    EdgeList* node =
+        newEdgeList(newEdge(pred, vertex, ws->predWeights[vertex]), NULL);
+    if (tail == NULL) {
+      head = node;
+    } else {
+      tail->next = node;
+    }
+    tail = node;
+    vertex = pred;
+  }
+
+  return head;
+}
+
+/* Runs one k-nearest query from 'source' using workspace 'ws', which must be
+ * in the reset state, and returns its result.
+ */
+static NearestResult* runNearestQuery(Graph* graph, NearestWorkspace* ws,
+                                      int source, int k,
+                                      TargetPredicate isTarget, void* context,
+                                      bool withPaths) {
+  NearestResult* result = (NearestResult*)malloc(sizeof(NearestResult));
+  if (result == NULL) {
+    printf("Error: Memory allocation failed for nearest result\n");
+    exit(1);
+  }
+  result->source = source;
+  result->numTargets = 0;
+  result->numSettled = 0;
+  // no more targets than vertices can be found
+  if (k > graph->numVertices) k = graph->numVertices;
+  result->targets = (NearestTarget*)malloc(sizeof(NearestTarget) * (k + 1));
+  if (result->targets == NULL) {
+    printf("Error: Memory allocation failed for nearest targets\n");
+    exit(1);
+  }
+
+  if (k > 0) reachVertex(ws, source, 0, NOTHING, 0);
+
+  while (ws->heap->size > 0 && result->numTargets < k) {
+    HeapNode minNode = extractMin(ws->heap);
+    int minVertex = minNode.id;
+    int currDis = minNode.priority;
+
+    ws->finished[minVertex] = true;
+    result->numSettled++;
+
+    Vertex* vertex = graph->vertices[minVertex];
+    if (vertex == NULL) continue;
+
+    if (isTargetVertex(vertex, isTarget, context)) {
+      NearestTarget* target = &result->targets[result->numTargets++];
+      target->vertex = minVertex;
+      target->distance = currDis;
+      target->path =
+          withPaths ? makeNearestPath(ws, minVertex, source) : NULL;
+      if (result->numTargets == k) break;
+    }
+
+    EdgeList* adjList = vertex->adjList;
+    while (adjList != NULL) {
+      Edge* edge = adjList->edge;
+      int toVertex = edge->toVertex;
+      int weight = edge->weight;
+
+      if (!ws->finished[toVertex] && weight <= INT_MAX - 1 - currDis &&
+          currDis + weight < ws->distances[toVertex]) {
+        reachVertex(ws, toVertex, currDis + weight, minVertex, weight);
+      }
+      adjList = adjList->next;
+    }
+  }
+
+  return result;
+}
+
+/* Returns true iff 'source' is a valid vertex ID in 'graph'. */
+static bool isValidSource(Graph* graph, int source) {
+  return source >= 0 && source < graph->numVertices &&
+         graph->vertices[source] != NULL;
+}
+
+/*************************************************************************
+ ** Query functions
+ *************************************************************************/
+
+NearestResult* getKNearestTargets(Graph* graph, int source, int k,
+                                  TargetPredicate isTarget, void* context,
+                                  bool withPaths) {
+  if (graph == NULL || k < 0 || !isValidSource(graph, source)) return NULL;
+
+  NearestWorkspace* ws = newNearestWorkspace(graph);
+  NearestResult* result =
+      runNearestQuery(graph, ws, source, k, isTarget, context, withPaths);
+  deleteNearestWorkspace(ws);
+
+  return result;
+}
+
+NearestResult** getKNearestTargetsBatch(Graph* graph, int* sources,
+                                        int numSources, int k,
+                                        TargetPredicate isTarget,
+                                        void* context, bool withPaths) {
+  if (graph == NULL || k < 0 || numSources < 0) return NULL;
+
+  NearestResult** results =
+      (NearestResult**)malloc(sizeof(NearestResult*) * (numSources + 1));
+  if (results == NULL) {
+    printf("Error: Memory allocation failed for nearest results\n");
+    exit(1);
+  }
+
+  NearestWorkspace* ws = newNearestWorkspace(graph);
+  for (int i = 0; i < numSources; i++) {
+    if (!isValidSource(graph, sources[i])) {
+      results[i] = NULL;
+      continue;
+    }
+    results[i] = runNearestQuery(graph, ws, sources[i], k, isTarget, context,
+                                 withPaths);
+    resetNearestWorkspace(ws);
+  }
+  deleteNearestWorkspace(ws);
+
+  return results;
+}
+
+void deleteNearestResult(NearestResult* result) {
+  if (result == NULL) return;
+
+  for (int i = 0; i < result->numTargets; i++) {
+    deleteEdgeList(result->targets[i].path);
+  }
+  free(result->targets);
+  free(result);
+}
+
+void deleteNearestResults(NearestResult** results, int numResults) {
+  if (results == NULL) return;
+
+  for (int i = 0; i < numResults; i++) deleteNearestResult(results[i]);
+  free(results);
+}
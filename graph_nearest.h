@@ -0,0 +1,67 @@
+/*
+ * Header file for k-nearest-target queries.
+ *
+ * A target is any vertex accepted by a TargetPredicate. By default, a vertex
+ * is a target iff its 'value' is not NULL, which is how facilities are tagged
+ * in our graphs.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Nearest_header
+#define __Graph_Nearest_header
+
+/* Returns true iff 'vertex' is a target. 'context' is passed through
+ * unchanged from the query.
+ */
+typedef bool (*TargetPredicate)(Vertex* vertex, void* context);
+
+typedef struct nearest_target {
+  int vertex;      // id of the target vertex
+  int distance;    // shortest-path distance from the source to 'vertex'
+  EdgeList* path;  // path from 'vertex' to the source, or NULL if not asked
+} NearestTarget;
+
+typedef struct nearest_result {
+  int source;              // id of the source vertex of this query
+  int numTargets;          // number of targets found; 0 <= numTargets <= k
+  NearestTarget* targets;  // numTargets targets, closest first
+  int numSettled;          // number of vertices settled by the search
+} NearestResult;
+
+/* Runs Dijkstra's algorithm on Graph 'graph' from vertex with ID 'source'
+ * and stops as soon as 'k' targets have been settled. Returns the targets
+ * found, closest first; fewer than 'k' are returned if fewer are reachable.
+ * A vertex is a target iff 'isTarget' returns true for it, or, if 'isTarget'
+ * is NULL, iff its value is not NULL. The source itself may be a target.
+ * If 'withPaths' is true, each target carries its path to the source in the
+ * format produced by getShortestPaths.
+ * Returns NULL if 'source' is not valid in 'graph' or 'k' < 0.
+ */
+NearestResult* getKNearestTargets(Graph* graph, int source, int k,
+                                  TargetPredicate isTarget, void* context,
+                                  bool withPaths);
+
+/* Runs getKNearestTargets from each of the 'numSources' vertices in
+ * 'sources' and returns an array of 'numSources' results; result[i] is NULL
+ * iff sources[i] is not valid in 'graph'. The search state is allocated once
+ * and only the part touched by each query is reset, so the per-query cost
+ * does not depend on the size of 'graph'.
+ * Returns NULL if 'k' < 0.
+ */
+NearestResult** getKNearestTargetsBatch(Graph* graph, int* sources,
+                                        int numSources, int k,
+                                        TargetPredicate isTarget,
+                                        void* context, bool withPaths);
+
+/* Frees all memory allocated for 'result', including target paths. */
+void deleteNearestResult(NearestResult* result);
+
+/* Frees all 'numResults' results in 'results', and the array itself. */
+void deleteNearestResults(NearestResult** results, int numResults);
+
+#endif
@@ -0,0 +1,288 @@
+/*
+ * Landmark distance oracles.
+ *
+ * For landmarks L_i, the triangle inequality gives
+ *   d(s, t) >= d(L_i, t) - d(L_i, s),   d(s, t) >= d(s, L_i) - d(t, L_i),
+ *   d(s, t) <= d(s, L_i) + d(L_i, t).
+ * Each bound is a max or min over the landmark vectors of s and t. The
+ * exact loops are written without branches so the compiler can vectorize
+ * them; the 16-bit loops use SSE2 directly, eight landmarks at a time.
+ * Quantized values are rounded down, so bounds widen by one quantum per
+ * term to stay valid.
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "graph_oracle.h"
+
+#define QUANTIZED_MAX 32766       // largest quantized distance
+#define QUANTIZED_NONE 0xFFFF     // quantized "unreachable"
+#define VECTOR_LANES 8            // 16-bit lanes in one SSE2 register
+
+/*************************************************************************
+ ** Exact vectors
+ *************************************************************************/
+
+/* Returns the largest landmark lower bound on d('s', 't') in exact
+ * 'oracle'.
+ */
+static int exactLowerBound(DistanceOracle* oracle, int s, int t) {
+  size_t stride = oracle->stride;
+  int* fromS = &oracle->fromExact[s * stride];
+  int* fromT = &oracle->fromExact[t * stride];
+  int* toS = &oracle->toExact[s * stride];
+  int* toT = &oracle->toExact[t * stride];
+
+  int bound = 0;
+  for (size_t i = 0; i < stride; i++) {
+    int known = fromS[i] != INT_MAX && fromT[i] != INT_MAX;
+    int term = known ? fromT[i] - fromS[i] : 0;
+    bound = term > bound ? term : bound;
+    known = toS[i] != INT_MAX && toT[i] != INT_MAX;
+    term = known ? toS[i] - toT[i] : 0;
+    bound = term > bound ? term : bound;
+  }
+  return bound;
+}
+
+/* Returns the shortest route from 's' to 't' through a landmark of exact
+ * 'oracle', or INT_MAX if there is none.
+ */
+static int exactUpperBound(DistanceOracle* oracle, int s, int t) {
+  size_t stride = oracle->stride;
+  int* toS = &oracle->toExact[s * stride];
+  int* fromT = &oracle->fromExact[t * stride];
+
+  // unreachable entries are INT_MAX, so their sums stay >= INT_MAX
+  unsigned int best = UINT_MAX;
+  for (size_t i = 0; i < stride; i++) {
+    unsigned int sum = (unsigned int)toS[i] + (unsigned int)fromT[i];
+    best = sum < best ? sum : best;
+  }
+  return best >= INT_MAX ? INT_MAX : (int)best;
+}
+
+/*************************************************************************
+ ** Quantized vectors
+ *************************************************************************/
+
+/* Returns the largest quantized lower bound term for 's' and 't' in
+ * quantized 'oracle', before widening.
+ */
+static int quantizedLowerTerm(DistanceOracle* oracle, int s, int t) {
+  size_t stride = oracle->stride;
+  uint16_t* fromS = &oracle->fromQuantized[s * stride];
+  uint16_t* fromT = &oracle->fromQuantized[t * stride];
+  uint16_t* toS = &oracle->toQuantized[s * stride];
+  uint16_t* toT = &oracle->toQuantized[t * stride];
+
+#ifdef __SSE2__
+  __m128i none = _mm_set1_epi16((short)QUANTIZED_NONE);
+  __m128i best = _mm_setzero_si128();
+  for (size_t i = 0; i < stride; i += VECTOR_LANES) {
+    __m128i a = _mm_loadu_si128((__m128i*)&fromS[i]);
+    __m128i b = _mm_loadu_si128((__m128i*)&fromT[i]);
+    __m128i unknown =
+        _mm_or_si128(_mm_cmpeq_epi16(a, none), _mm_cmpeq_epi16(b, none));
+    __m128i term = _mm_andnot_si128(unknown, _mm_subs_epu16(b, a));
+    best = _mm_add_epi16(_mm_subs_epu16(best, term), term);  // unsigned max
+
+    a = _mm_loadu_si128((__m128i*)&toS[i]);
+    b = _mm_loadu_si128((__m128i*)&toT[i]);
+    unknown =
+        _mm_or_si128(_mm_cmpeq_epi16(a, none), _mm_cmpeq_epi16(b, none));
+    term = _mm_andnot_si128(unknown, _mm_subs_epu16(a, b));
+    best = _mm_add_epi16(_mm_subs_epu16(best, term), term);
+  }
+
+  uint16_t lanes[VECTOR_LANES];
+  _mm_storeu_si128((__m128i*)lanes, best);
+  int bound = 0;
+  for (int i = 0; i < VECTOR_LANES; i++) {
+    if (lanes[i] > bound) bound = lanes[i];
+  }
+  return bound;
+#else
+  int bound = 0;
+  for (size_t i = 0; i < stride; i++) {
+    int known = fromS[i] != QUANTIZED_NONE && fromT[i] != QUANTIZED_NONE;
+    int term = known ? fromT[i] - fromS[i] : 0;
+    bound = term > bound ? term : bound;
+    known = toS[i] != QUANTIZED_NONE && toT[i] != QUANTIZED_NONE;
+    term = known ? toS[i] - toT[i] : 0;
+    bound = term > bound ? term : bound;
+  }
+  return bound;
+#endif
+}
+
+/* Returns the smallest quantized route from 's' to 't' through a landmark
+ * of quantized 'oracle', before widening, or QUANTIZED_NONE if there is
+ * none.
+ */
+static int quantizedUpperSum(DistanceOracle* oracle, int s, int t) {
+  size_t stride = oracle->stride;
+  uint16_t* toS = &oracle->toQuantized[s * stride];
+  uint16_t* fromT = &oracle->fromQuantized[t * stride];
+
+#ifdef __SSE2__
+  // sums of two quantized distances fit below QUANTIZED_NONE, and any sum
+  // with an unreachable entry saturates to it
+  __m128i best = _mm_set1_epi16((short)QUANTIZED_NONE);
+  for (size_t i = 0; i < stride; i += VECTOR_LANES) {
+    __m128i sum = _mm_adds_epu16(_mm_loadu_si128((__m128i*)&toS[i]),
+                                 _mm_loadu_si128((__m128i*)&fromT[i]));
+    best = _mm_sub_epi16(best, _mm_subs_epu16(best, sum));  // unsigned min
+  }
+
+  uint16_t lanes[VECTOR_LANES];
+  _mm_storeu_si128((__m128i*)lanes, best);
+  int sum = QUANTIZED_NONE;
+  for (int i = 0; i < VECTOR_LANES; i++) {
+    if (lanes[i] < sum) sum = lanes[i];
+  }
+  return sum;
+#else
+  int best = QUANTIZED_NONE;
+  for (size_t i = 0; i < stride; i++) {
+    int sum = toS[i] + fromT[i];
+    if (toS[i] == QUANTIZED_NONE || fromT[i] == QUANTIZED_NONE) {
+      sum = QUANTIZED_NONE;
+    }
+    best = sum < best ? sum : best;
+  }
+  return best;
+#endif
+}
+
+/*************************************************************************
+ ** Oracles
+ *************************************************************************/
+
+/* Returns 'distance' quantized with 'quantum'. */
+static uint16_t quantize(int distance, int quantum) {
+  if (distance == INT_MAX) return QUANTIZED_NONE;
+  return (uint16_t)(distance / quantum);
+}
+
+DistanceOracle* newDistanceOracle(LandmarkTable* table, bool quantized) {
+  if (table == NULL) return NULL;
+
+  DistanceOracle* oracle = (DistanceOracle*)malloc(sizeof(DistanceOracle));
+  if (oracle == NULL) {
+    printf("Error: Memory allocation failed for distance oracle\n");
+    exit(1);
+  }
+
+  int k = table->numLandmarks;
+  size_t numVertices = table->numVertices;
+  size_t stride = (k + VECTOR_LANES - 1) / VECTOR_LANES * VECTOR_LANES;
+  size_t numValues = numVertices * stride;
+  oracle->numVertices = table->numVertices;
+  oracle->numLandmarks = k;
+  oracle->stride = (int)stride;
+  oracle->quantized = quantized;
+  oracle->fromExact = NULL;
+  oracle->toExact = NULL;
+  oracle->fromQuantized = NULL;
+  oracle->toQuantized = NULL;
+
+  // the largest finite distance decides the quantum
+  int maxDistance = 0;
+  for (size_t i = 0; i < numVertices * k; i++) {
+    if (table->fromLandmark[i] != INT_MAX &&
+        table->fromLandmark[i] > maxDistance) {
+      maxDistance = table->fromLandmark[i];
+    }
+    if (table->toLandmark[i] != INT_MAX &&
+        table->toLandmark[i] > maxDistance) {
+      maxDistance = table->toLandmark[i];
+    }
+  }
+  oracle->quantum = quantized ? maxDistance / QUANTIZED_MAX + 1 : 1;
+
+  if (quantized) {
+    oracle->numBytes = 2 * numValues * sizeof(uint16_t);
+    oracle->fromQuantized = (uint16_t*)malloc(sizeof(uint16_t) * numValues);
+    oracle->toQuantized = (uint16_t*)malloc(sizeof(uint16_t) * numValues);
+    if (oracle->fromQuantized == NULL || oracle->toQuantized == NULL) {
+      printf("Error: Memory allocation failed for oracle vectors\n");
+      exit(1);
+    }
+    for (size_t v = 0; v < numVertices; v++) {
+      for (size_t i = 0; i < stride; i++) {
+        bool isLandmark = i < (size_t)k;
+        oracle->fromQuantized[v * stride + i] =
+            isLandmark ? quantize(table->fromLandmark[v * k + i],
+                                  oracle->quantum)
+                       : QUANTIZED_NONE;
+        oracle->toQuantized[v * stride + i] =
+            isLandmark
+                ? quantize(table->toLandmark[v * k + i], oracle->quantum)
+                : QUANTIZED_NONE;
+      }
+    }
+  } else {
+    oracle->numBytes = 2 * numValues * sizeof(int);
+    oracle->fromExact = (int*)malloc(sizeof(int) * numValues);
+    oracle->toExact = (int*)malloc(sizeof(int) * numValues);
+    if (oracle->fromExact == NULL || oracle->toExact == NULL) {
+      printf("Error: Memory allocation failed for oracle vectors\n");
+      exit(1);
+    }
+    for (size_t v = 0; v < numVertices; v++) {
+      for (size_t i = 0; i < stride; i++) {
+        bool isLandmark = i < (size_t)k;
+        oracle->fromExact[v * stride + i] =
+            isLandmark ? table->fromLandmark[v * k + i] : INT_MAX;
+        oracle->toExact[v * stride + i] =
+            isLandmark ? table->toLandmark[v * k + i] : INT_MAX;
+      }
+    }
+  }
+
+  return oracle;
+}
+
+int getOracleLowerBound(DistanceOracle* oracle, int fromVertex, int toVertex) {
+  if (fromVertex < 0 || fromVertex >= oracle->numVertices || toVertex < 0 ||
+      toVertex >= oracle->numVertices) {
+    return -1;
+  }
+  if (!oracle->quantized) return exactLowerBound(oracle, fromVertex, toVertex);
+
+  int term = quantizedLowerTerm(oracle, fromVertex, toVertex);
+  if (oracle->quantum == 1) return term;  // nothing was rounded
+  return term > 1 ? (term - 1) * oracle->quantum : 0;
+}
+
+int getOracleUpperBound(DistanceOracle* oracle, int fromVertex, int toVertex) {
+  if (fromVertex < 0 || fromVertex >= oracle->numVertices || toVertex < 0 ||
+      toVertex >= oracle->numVertices) {
+    return -1;
+  }
+  if (!oracle->quantized) return exactUpperBound(oracle, fromVertex, toVertex);
+
+  int sum = quantizedUpperSum(oracle, fromVertex, toVertex);
+  if (sum == QUANTIZED_NONE) return INT_MAX;
+  if (oracle->quantum == 1) return sum;
+
+  // each of the two distances is at most (q + 1) * quantum - 1
+  long long bound = ((long long)sum + 2) * oracle->quantum - 2;
+  return bound >= INT_MAX ? INT_MAX : (int)bound;
+}
+
+void deleteDistanceOracle(DistanceOracle* oracle) {
+  if (oracle == NULL) return;
+
+  free(oracle->fromExact);
+  free(oracle->toExact);
+  free(oracle->fromQuantized);
+  free(oracle->toQuantized);
+  free(oracle);
+}
@@ -0,0 +1,63 @@
+/*
+ * Header file for landmark distance oracles.
+ *
+ * A DistanceOracle keeps, for every vertex, its distances to and from a set
+ * of landmarks as one contiguous vector, and answers lower and upper bounds
+ * on d(s, t) by combining the vectors of s and t in O(k), without searching
+ * the graph. Vectors can be stored exactly as ints, or quantized to 16 bits
+ * for half the memory at some loss of accuracy.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+#include "graph_alt.h"
+
+#ifndef __Graph_Oracle_header
+#define __Graph_Oracle_header
+
+typedef struct distance_oracle {
+  int numVertices;          // total number of vertices in the graph
+  int numLandmarks;         // number of landmarks k
+  int stride;               // length of each vector: k rounded up to a
+                            //   multiple of 8, padded with "unreachable"
+  bool quantized;           // true iff the 16-bit vectors are used
+  int quantum;              // a quantized value q stands for a distance in
+                            //   [q * quantum, (q + 1) * quantum)
+  int* fromExact;           // fromExact[id * stride + i] is d(L_i, id), or
+                            //   INT_MAX if unreachable; NULL if quantized
+  int* toExact;             // toExact[id * stride + i] is d(id, L_i), or
+                            //   INT_MAX if unreachable; NULL if quantized
+  uint16_t* fromQuantized;  // quantized d(L_i, id), or 0xFFFF if
+                            //   unreachable; NULL if not quantized
+  uint16_t* toQuantized;    // quantized d(id, L_i), or 0xFFFF if
+                            //   unreachable; NULL if not quantized
+  size_t numBytes;          // memory used by the vectors
+} DistanceOracle;
+
+/* Returns an oracle built from the distances in landmark table 'table'.
+ * If 'quantized' is true, distances are stored in 16 bits each.
+ * Returns NULL if 'table' is NULL.
+ */
+DistanceOracle* newDistanceOracle(LandmarkTable* table, bool quantized);
+
+/* Returns a lower bound on the distance from vertex with ID 'fromVertex' to
+ * vertex with ID 'toVertex' in the graph of 'oracle'. Returns -1 if either
+ * vertex is not valid.
+ */
+int getOracleLowerBound(DistanceOracle* oracle, int fromVertex, int toVertex);
+
+/* Returns an upper bound on the distance from vertex with ID 'fromVertex'
+ * to vertex with ID 'toVertex' in the graph of 'oracle': the length of the
+ * shortest route through a landmark, or INT_MAX if there is none. Returns
+ * -1 if either vertex is not valid.
+ */
+int getOracleUpperBound(DistanceOracle* oracle, int fromVertex, int toVertex);
+
+/* Frees all memory allocated for 'oracle'. */
+void deleteDistanceOracle(DistanceOracle* oracle);
+
+#endif
@@ -0,0 +1,190 @@
+/*
+ *  Accuracy versus memory benchmark for landmark distance oracles.
+ *
+ *  For several landmark counts, builds exact and 16-bit oracles, compares
+ *  their bounds with true distances for random pairs, and measures how many
+ *  estimates per second each answers.
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O3 -march=native -Wall -Werror graph.c minheap.c graph_algos.c \
+ *       graph_io.c graph_alt.c graph_search.c graph_oracle.c \
+ *       graph_oracle_bench.c -o graph_oracle_bench
+ *
+ *   Run:
+ *   ./graph_oracle_bench sample_input.txt [numSources] [targetsPerSource]
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "graph.h"
+#include "graph_alt.h"
+#include "graph_io.h"
+#include "graph_oracle.h"
+#include "graph_search.h"
+
+#define DEFAULT_SOURCES 20
+#define DEFAULT_TARGETS 500
+#define QUERY_ROUNDS 20
+
+typedef struct sample_pair {
+  int source;    // ID of the source vertex
+  int target;    // ID of the target vertex
+  int distance;  // true distance from source to target
+} SamplePair;
+
+/* sampling */
+SamplePair* samplePairs(Graph* graph, int numSources, int numTargets,
+                        int* numPairs);
+uint64_t nextRandom(uint64_t* state);
+
+/* measuring */
+void measureOracle(DistanceOracle* oracle, SamplePair* pairs, int numPairs);
+double nowSeconds(void);
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    printf("Usage: %s graph_file [numSources] [targetsPerSource]\n", argv[0]);
+    return 1;
+  }
+  int numSources = argc > 2 ? atoi(argv[2]) : DEFAULT_SOURCES;
+  int numTargets = argc > 3 ? atoi(argv[3]) : DEFAULT_TARGETS;
+
+  FILE* f = fopen(argv[1], "r");
+  if (f == NULL) {
+    fprintf(stderr, "Unable to open the specified input file: %s\n", argv[1]);
+    return 1;
+  }
+  Graph* graph = createGraph(f);
+  fclose(f);
+  if (graph == NULL) return 1;
+  for (int v = 0; v < graph->numVertices; v++) {
+    if (graph->vertices[v] == NULL) {
+      graph->vertices[v] = newVertex(v, NULL, NULL);
+    }
+  }
+
+  int numPairs = 0;
+  SamplePair* pairs = samplePairs(graph, numSources, numTargets, &numPairs);
+  if (numPairs == 0) {
+    printf("No reachable pairs to measure. Giving up.\n");
+    return 1;
+  }
+  printf("%d vertices, %d edges, %d reachable pairs\n", graph->numVertices,
+         graph->numEdges, numPairs);
+  printf("%9s %6s %12s %12s %12s %14s\n", "landmarks", "bits", "memory(KB)",
+         "lower err", "upper err", "estimates/s");
+
+  int landmarkCounts[] = {4, 8, 16, 32};
+  for (int c = 0; c < 4; c++) {
+    int k = landmarkCounts[c];
+    if (k > graph->numVertices) break;
+    LandmarkTable* table = newLandmarkTable(graph, k, LANDMARKS_AVOID);
+    for (int bits = 32; bits >= 16; bits -= 16) {
+      DistanceOracle* oracle = newDistanceOracle(table, bits == 16);
+      printf("%9d %6d %12.1f ", k, bits, oracle->numBytes / 1024.0);
+      measureOracle(oracle, pairs, numPairs);
+      deleteDistanceOracle(oracle);
+    }
+    deleteLandmarkTable(table);
+  }
+
+  free(pairs);
+  deleteGraph(graph);
+  return 0;
+}
+
+/* Returns up to 'numSources' * 'numTargets' random pairs of vertices of
+ * 'graph' with the target reachable from the source, and their true
+ * distances, and stores their number in 'numPairs'.
+ */
+SamplePair* samplePairs(Graph* graph, int numSources, int numTargets,
+                        int* numPairs) {
+  SamplePair* pairs =
+      (SamplePair*)malloc(sizeof(SamplePair) * (numSources * numTargets + 1));
+  if (pairs == NULL) {
+    printf("Error: Memory allocation failed for sample pairs\n");
+    exit(1);
+  }
+
+  uint64_t state = 88172645463325252ULL;
+  *numPairs = 0;
+  for (int i = 0; i < numSources && graph->numVertices > 0; i++) {
+    int source = (int)(nextRandom(&state) % graph->numVertices);
+    DijkstraSearch* search = newDijkstraSearch(graph, source);
+    runDijkstraSearch(search, 0, 0, NULL, NULL);
+    for (int j = 0; j < numTargets; j++) {
+      int target = (int)(nextRandom(&state) % graph->numVertices);
+      if (search->distances[target] == INT_MAX) continue;
+      pairs[*numPairs].source = source;
+      pairs[*numPairs].target = target;
+      pairs[*numPairs].distance = search->distances[target];
+      (*numPairs)++;
+    }
+    deleteDijkstraSearch(search);
+  }
+  return pairs;
+}
+
+/* Returns the next value of the xorshift generator with state 'state'. */
+uint64_t nextRandom(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/* Prints the mean relative error of the lower and upper bounds of 'oracle'
+ * over the 'numPairs' pairs in 'pairs', and its query rate. Exits if a
+ * bound is not valid.
+ */
+void measureOracle(DistanceOracle* oracle, SamplePair* pairs, int numPairs) {
+  double lowerError = 0;
+  double upperError = 0;
+  int numMeasured = 0;
+  for (int i = 0; i < numPairs; i++) {
+    SamplePair* pair = &pairs[i];
+    int lower = getOracleLowerBound(oracle, pair->source, pair->target);
+    int upper = getOracleUpperBound(oracle, pair->source, pair->target);
+    if (lower > pair->distance || upper < pair->distance) {
+      printf("\nInvalid bound for %d -> %d: %d <= %d <= %d does not hold\n",
+             pair->source, pair->target, lower, pair->distance, upper);
+      exit(1);
+    }
+    if (pair->distance == 0 || upper == INT_MAX) continue;
+    lowerError += (double)(pair->distance - lower) / pair->distance;
+    upperError += (double)(upper - pair->distance) / pair->distance;
+    numMeasured++;
+  }
+
+  // time both bounds over every pair, several times over; the sum keeps
+  // the calls from being optimized away
+  volatile long long checksum = 0;
+  double start = nowSeconds();
+  for (int round = 0; round < QUERY_ROUNDS; round++) {
+    for (int i = 0; i < numPairs; i++) {
+      checksum += getOracleLowerBound(oracle, pairs[i].source, pairs[i].target);
+      checksum += getOracleUpperBound(oracle, pairs[i].source, pairs[i].target);
+    }
+  }
+  double elapsed = nowSeconds() - start;
+
+  printf("%11.2f%% %11.2f%% %14.0f\n",
+         numMeasured > 0 ? 100 * lowerError / numMeasured : 0.0,
+         numMeasured > 0 ? 100 * upperError / numMeasured : 0.0,
+         2.0 * QUERY_ROUNDS * numPairs / elapsed);
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,608 @@
+/*
+ * Shortest paths on a graph partitioned across processes.
+ *
+ * The coordinator and each worker share one socket pair and take turns:
+ * the coordinator writes a command to every worker before reading any
+ * reply, and a worker reads its whole command before it writes, so no
+ * write waits on a peer that is itself waiting to write. A command is
+ * three int32 values (type, bound, count) followed by 'count' triples
+ * (vertex, distance, parent); a reply is two values (queue minimum, count)
+ * followed by 'count' triples. A shard is sent once as (first vertex,
+ * number of vertices, number of edges) and the offsets, heads and weights
+ * of its compact adjacency arrays.
+ *
+ * Workers keep their queue between rounds. A vertex settled in one round
+ * may still be improved by a relaxation from another worker in a later one,
+ * and is then searched again; the lazy heap takes such entries back.
+ */
+
+#include <limits.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "graph_partition.h"
+#include "graph_protocol.h"
+#include "graph_queue.h"
+
+#define NOTHING -1
+#define TRIPLE 3              // int32 values per relaxation
+#define INITIAL_MESSAGE 1024  // values a new message buffer has room for
+
+typedef enum command_type {
+  COMMAND_START = 1,    // forget the last query
+  COMMAND_ROUND = 2,    // apply relaxations and search up to the bound
+  COMMAND_COLLECT = 3,  // send (vertex, distance, parent) of every reached
+                        //   vertex
+  COMMAND_EXIT = 4      // stop the worker
+} CommandType;
+
+typedef struct settled {  // a reached vertex, for ordering the tree
+  int distance;  // distance from the start vertex
+  int depth;     // number of tree edges from the start vertex
+  int id;        // ID of the vertex
+} Settled;
+
+typedef struct shard {  // what a worker owns
+  int firstVertex;       // ID of the first vertex of the range
+  int numVertices;       // number of vertices in the range
+  int numEdges;          // number of edges leaving them
+  int32_t* offsets;      // edges leaving firstVertex + i are at
+                         //   [offsets[i], offsets[i+1])
+  int32_t* heads;        // heads[j] is the head of edge j
+  int32_t* weights;      // weights[j] is the weight of edge j
+  int* distances;        // distances[i] is the best known distance to
+                         //   firstVertex + i
+  int* parents;          // parents[i] is the vertex before it, or -1
+  PriorityQueue* queue;  // local IDs waiting to be settled
+} Shard;
+
+/*************************************************************************
+ ** Messages
+ *************************************************************************/
+
+/* Returns the current time in seconds on a monotonic clock. */
+static double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Makes room for 'size' values in 'buffer'. */
+static void reserveValues(MessageBuffer* buffer, int size) {
+  if (size <= buffer->capacity) return;
+
+  int capacity = buffer->capacity > 0 ? buffer->capacity : INITIAL_MESSAGE;
+  while (capacity < size) capacity *= 2;
+  buffer->values =
+      (int32_t*)realloc(buffer->values, sizeof(int32_t) * capacity);
+  if (buffer->values == NULL) {
+    printf("Error: Memory allocation failed for message buffer\n");
+    exit(1);
+  }
+  buffer->capacity = capacity;
+}
+
+/* Appends the triple ('a', 'b', 'c') to 'buffer'. */
+static void appendTriple(MessageBuffer* buffer, int a, int b, int c) {
+  reserveValues(buffer, buffer->size + TRIPLE);
+  int32_t* triple = buffer->values + buffer->size;
+  triple[0] = a;
+  triple[1] = b;
+  triple[2] = c;
+  buffer->size += TRIPLE;
+}
+
+/* Reads 'count' triples from 'fd' into 'buffer'. Returns false on end of
+ * file or error.
+ */
+static bool receiveTriples(int fd, MessageBuffer* buffer, int count) {
+  if (count < 0) return false;
+
+  reserveValues(buffer, TRIPLE * count);
+  buffer->size = TRIPLE * count;
+  return readFully(fd, buffer->values, sizeof(int32_t) * buffer->size);
+}
+
+/* Writes the 'headerSize' values of 'header' and then the triples of
+ * 'body' to 'fd', adding the bytes to 'bytes'. Returns false on error.
+ */
+static bool sendMessage(int fd, const int32_t* header, int headerSize,
+                        MessageBuffer* body, long long* bytes) {
+  size_t size = sizeof(int32_t) * body->size;
+  *bytes += sizeof(int32_t) * headerSize + size;
+  return writeFully(fd, header, sizeof(int32_t) * headerSize) &&
+         (size == 0 || writeFully(fd, body->values, size));
+}
+
+/*************************************************************************
+ ** Workers
+ *************************************************************************/
+
+/* Reads a shard from 'fd' into 'shard'. Returns false on end of file or
+ * error.
+ */
+static bool receiveShard(int fd, Shard* shard) {
+  int32_t header[3];
+  if (!readFully(fd, header, sizeof(header))) return false;
+  shard->firstVertex = header[0];
+  shard->numVertices = header[1];
+  shard->numEdges = header[2];
+
+  int numVertices = shard->numVertices;
+  shard->offsets = (int32_t*)malloc(sizeof(int32_t) * (numVertices + 1));
+  shard->heads = (int32_t*)malloc(sizeof(int32_t) * (shard->numEdges + 1));
+  shard->weights = (int32_t*)malloc(sizeof(int32_t) * (shard->numEdges + 1));
+  shard->distances = (int*)malloc(sizeof(int) * (numVertices + 1));
+  shard->parents = (int*)malloc(sizeof(int) * (numVertices + 1));
+  if (shard->offsets == NULL || shard->heads == NULL ||
+      shard->weights == NULL || shard->distances == NULL ||
+      shard->parents == NULL) {
+    printf("Error: Memory allocation failed for shard\n");
+    exit(1);
+  }
+  shard->queue = NULL;
+  return readFully(fd, shard->offsets, sizeof(int32_t) * (numVertices + 1)) &&
+         readFully(fd, shard->heads, sizeof(int32_t) * shard->numEdges) &&
+         readFully(fd, shard->weights, sizeof(int32_t) * shard->numEdges);
+}
+
+/* Forgets the last query of 'shard'. */
+static void resetShard(Shard* shard) {
+  for (int i = 0; i < shard->numVertices; i++) {
+    shard->distances[i] = INT_MAX;
+    shard->parents[i] = NOTHING;
+  }
+  if (shard->queue != NULL) deletePriorityQueue(shard->queue);
+  shard->queue = newPriorityQueue(QUEUE_LAZY_HEAP, shard->numVertices);
+}
+
+/* Applies the relaxations in 'in' to 'shard' and settles its vertices up to
+ * distance 'bound', appending relaxations of edges that leave the shard to
+ * 'out'. Returns the distance of the closest vertex left unsettled, or
+ * INT_MAX if there is none.
+ */
+static int runRound(Shard* shard, int bound, MessageBuffer* in,
+                    MessageBuffer* out) {
+  int first = shard->firstVertex;
+  for (int t = 0; t < in->size; t += TRIPLE) {
+    int i = in->values[t] - first;
+    int distance = in->values[t + 1];
+    if (i < 0 || i >= shard->numVertices) continue;
+    if (distance >= shard->distances[i]) continue;
+
+    shard->distances[i] = distance;
+    shard->parents[i] = in->values[t + 2];
+    pushQueue(shard->queue, i, distance);
+  }
+
+  out->size = 0;
+  int i, distance;
+  while (popQueue(shard->queue, &i, &distance)) {
+    if (distance > shard->distances[i]) continue;  // stale
+    if (distance > bound) {
+      pushQueue(shard->queue, i, distance);
+      return distance;
+    }
+
+    for (int e = shard->offsets[i]; e < shard->offsets[i + 1]; e++) {
+      int head = shard->heads[e];
+      int weight = shard->weights[e];
+      if (weight >= INT_MAX - distance) continue;  // would overflow
+      int newDistance = distance + weight;
+
+      int local = head - first;
+      if (local < 0 || local >= shard->numVertices) {
+        appendTriple(out, head, newDistance, first + i);
+      } else if (newDistance < shard->distances[local]) {
+        shard->distances[local] = newDistance;
+        shard->parents[local] = first + i;
+        pushQueue(shard->queue, local, newDistance);
+      }
+    }
+  }
+  return INT_MAX;
+}
+
+/* Serves the coordinator on socket 'fd' until it sends COMMAND_EXIT or
+ * hangs up, then ends the process.
+ */
+static void runWorker(int fd) {
+  Shard shard;
+  if (!receiveShard(fd, &shard)) _exit(1);
+  resetShard(&shard);
+
+  MessageBuffer in = {NULL, 0, 0};
+  MessageBuffer out = {NULL, 0, 0};
+  long long bytes = 0;
+  bool running = true;
+  while (running) {
+    int32_t command[3];
+    if (!readFully(fd, command, sizeof(command)) ||
+        !receiveTriples(fd, &in, command[2])) {
+      break;
+    }
+
+    int32_t reply[2] = {INT_MAX, 0};
+    switch (command[0]) {
+      case COMMAND_START:
+        resetShard(&shard);
+        continue;  // no reply
+
+      case COMMAND_ROUND:
+        reply[0] = runRound(&shard, command[1], &in, &out);
+        break;
+
+      case COMMAND_COLLECT:
+        out.size = 0;
+        for (int i = 0; i < shard.numVertices; i++) {
+          if (shard.distances[i] == INT_MAX) continue;
+          appendTriple(&out, shard.firstVertex + i, shard.distances[i],
+                       shard.parents[i]);
+        }
+        break;
+
+      default:
+        running = false;
+        continue;
+    }
+    reply[1] = out.size / TRIPLE;
+    if (!sendMessage(fd, reply, 2, &out, &bytes)) break;
+  }
+
+  deletePriorityQueue(shard.queue);
+  free(shard.offsets);
+  free(shard.heads);
+  free(shard.weights);
+  free(shard.distances);
+  free(shard.parents);
+  free(in.values);
+  free(out.values);
+  close(fd);
+  _exit(0);  // without flushing the stdio buffers copied from the parent
+}
+
+/*************************************************************************
+ ** Coordinator
+ *************************************************************************/
+
+/* Returns the worker of 'graph' that owns vertex 'id'. */
+static int ownerOf(PartitionedGraph* graph, int id) {
+  int low = 0;
+  int high = graph->numWorkers - 1;
+  while (low < high) {
+    int middle = (low + high + 1) / 2;
+    if (graph->firstVertex[middle] <= id) {
+      low = middle;
+    } else {
+      high = middle - 1;
+    }
+  }
+  return low;
+}
+
+/* Sends the edges of 'source' that leave the vertices of worker 'w' of
+ * 'graph' to that worker. Returns false on error.
+ */
+static bool sendShard(PartitionedGraph* graph, Graph* source, int w) {
+  int first = graph->firstVertex[w];
+  int numVertices = graph->firstVertex[w + 1] - first;
+  MessageBuffer body = {NULL, 0, 0};
+  reserveValues(&body, numVertices + 1);
+  body.values[0] = 0;
+  for (int i = 0; i < numVertices; i++) {
+    Vertex* vertex = source->vertices[first + i];
+    int degree = 0;
+    for (EdgeList* e = vertex == NULL ? NULL : vertex->adjList; e != NULL;
+         e = e->next) {
+      degree++;
+    }
+    body.values[i + 1] = body.values[i] + degree;
+  }
+
+  int numEdges = body.values[numVertices];
+  reserveValues(&body, numVertices + 1 + 2 * numEdges);
+  int32_t* heads = body.values + numVertices + 1;
+  int32_t* weights = heads + numEdges;
+  for (int i = 0; i < numVertices; i++) {
+    Vertex* vertex = source->vertices[first + i];
+    int j = body.values[i];
+    for (EdgeList* e = vertex == NULL ? NULL : vertex->adjList; e != NULL;
+         e = e->next, j++) {
+      heads[j] = e->edge->toVertex;
+      weights[j] = e->edge->weight;
+    }
+  }
+  body.size = numVertices + 1 + 2 * numEdges;
+
+  int32_t header[3] = {first, numVertices, numEdges};
+  long long bytes = 0;
+  bool sent = sendMessage(graph->sockets[w], header, 3, &body, &bytes);
+  free(body.values);
+  return sent;
+}
+
+PartitionedGraph* newPartitionedGraph(Graph* graph, int numWorkers,
+                                      int delta) {
+  if (numWorkers < 1 || delta < 0) return NULL;
+  if (numWorkers > graph->numVertices) numWorkers = graph->numVertices;
+
+  PartitionedGraph* result =
+      (PartitionedGraph*)calloc(1, sizeof(PartitionedGraph));
+  if (result == NULL) {
+    printf("Error: Memory allocation failed for partitioned graph\n");
+    exit(1);
+  }
+  result->numVertices = graph->numVertices;
+  result->numWorkers = 0;  // none started yet
+  result->delta = delta;
+  result->firstVertex = (int*)malloc(sizeof(int) * (numWorkers + 1));
+  result->sockets = (int*)malloc(sizeof(int) * numWorkers);
+  result->pids = (pid_t*)malloc(sizeof(pid_t) * numWorkers);
+  result->bestSent = (int*)malloc(sizeof(int) * graph->numVertices);
+  result->outbox = (MessageBuffer*)calloc(numWorkers, sizeof(MessageBuffer));
+  if (result->firstVertex == NULL || result->sockets == NULL ||
+      result->pids == NULL || result->bestSent == NULL ||
+      result->outbox == NULL) {
+    printf("Error: Memory allocation failed for partitioned graph\n");
+    exit(1);
+  }
+
+  // ranges of about equal numbers of vertices plus edges
+  long long total = graph->numVertices + (long long)graph->numEdges;
+  long long cost = 0;
+  int w = 0;
+  result->firstVertex[0] = 0;
+  for (int id = 0; id < graph->numVertices && w + 1 < numWorkers; id++) {
+    Vertex* vertex = graph->vertices[id];
+    cost++;
+    for (EdgeList* e = vertex == NULL ? NULL : vertex->adjList; e != NULL;
+         e = e->next) {
+      cost++;
+    }
+    while (w + 1 < numWorkers && cost * numWorkers >= total * (w + 1)) {
+      result->firstVertex[++w] = id + 1;
+    }
+  }
+  while (w + 1 <= numWorkers) result->firstVertex[++w] = graph->numVertices;
+
+  fflush(stdout);
+  for (w = 0; w < numWorkers; w++) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+      printf("Could not create a socket for worker %d. Giving up.\n", w);
+      deletePartitionedGraph(result);
+      return NULL;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+      // the worker keeps only its own end of its own socket
+      for (int other = 0; other < w; other++) close(result->sockets[other]);
+      close(fds[0]);
+      runWorker(fds[1]);
+    }
+    close(fds[1]);
+    if (pid < 0) {
+      printf("Could not start worker %d. Giving up.\n", w);
+      close(fds[0]);
+      deletePartitionedGraph(result);
+      return NULL;
+    }
+    result->sockets[w] = fds[0];
+    result->pids[w] = pid;
+    result->numWorkers = w + 1;
+  }
+
+  for (w = 0; w < numWorkers; w++) {
+    if (!sendShard(result, graph, w)) {
+      printf("Lost connection to worker %d. Giving up.\n", w);
+      deletePartitionedGraph(result);
+      return NULL;
+    }
+  }
+  return result;
+}
+
+/* Compares Settled vertices by distance, then depth, then ID. */
+static int compareSettled(const void* a, const void* b) {
+  const Settled* x = (const Settled*)a;
+  const Settled* y = (const Settled*)b;
+  if (x->distance != y->distance) return x->distance < y->distance ? -1 : 1;
+  if (x->depth != y->depth) return x->depth < y->depth ? -1 : 1;
+  return (x->id > y->id) - (x->id < y->id);
+}
+
+/* Stores in depths[id] the number of edges from the root to every reached
+ * vertex id of the tree given by 'parents', using 'path' for the walks up.
+ * depths[id] must be -1 for the reached vertices on entry.
+ */
+static void findDepths(Settled* order, int numReached, const int* parents,
+                       int* depths, int* path) {
+  for (int r = 0; r < numReached; r++) {
+    int length = 0;
+    int id = order[r].id;
+    while (depths[id] == NOTHING && parents[id] != NOTHING) {
+      path[length++] = id;
+      id = parents[id];
+    }
+    if (depths[id] == NOTHING) depths[id] = 0;  // the root
+    int depth = depths[id];
+    while (length > 0) depths[path[--length]] = ++depth;
+  }
+  for (int r = 0; r < numReached; r++) order[r].depth = depths[order[r].id];
+}
+
+/* Runs rounds on the workers of 'graph' from vertex 'startVertex' until no
+ * work is left, counting them in 'stats'. Returns false, after reporting
+ * the worker, if a worker could not be reached.
+ */
+static bool runRounds(PartitionedGraph* graph, int startVertex,
+                      PartitionStats* stats) {
+  for (int id = 0; id < graph->numVertices; id++) {
+    graph->bestSent[id] = INT_MAX;
+  }
+  for (int w = 0; w < graph->numWorkers; w++) graph->outbox[w].size = 0;
+
+  int32_t start[3] = {COMMAND_START, 0, 0};
+  for (int w = 0; w < graph->numWorkers; w++) {
+    if (!sendMessage(graph->sockets[w], start, 3, &graph->outbox[w],
+                     &stats->bytesSent)) {
+      printf("Lost connection to worker %d. Giving up.\n", w);
+      return false;
+    }
+  }
+  graph->bestSent[startVertex] = 0;
+  appendTriple(&graph->outbox[ownerOf(graph, startVertex)], startVertex, 0,
+               NOTHING);
+
+  int bound = graph->delta == NO_BOUND ? INT_MAX : graph->delta;
+  while (true) {
+    for (int w = 0; w < graph->numWorkers; w++) {
+      int32_t command[3] = {COMMAND_ROUND, bound,
+                            graph->outbox[w].size / TRIPLE};
+      if (!sendMessage(graph->sockets[w], command, 3, &graph->outbox[w],
+                       &stats->bytesSent)) {
+        printf("Lost connection to worker %d. Giving up.\n", w);
+        return false;
+      }
+      graph->outbox[w].size = 0;
+    }
+    stats->numRounds++;
+
+    // route the batches, dropping relaxations no better than one sent
+    int closest = INT_MAX;
+    for (int w = 0; w < graph->numWorkers; w++) {
+      int32_t reply[2];
+      if (!readFully(graph->sockets[w], reply, sizeof(reply)) ||
+          !receiveTriples(graph->sockets[w], &graph->inbox, reply[1])) {
+        printf("Lost connection to worker %d. Giving up.\n", w);
+        return false;
+      }
+      stats->bytesSent += sizeof(reply) + sizeof(int32_t) * graph->inbox.size;
+      if (reply[0] < closest) closest = reply[0];
+
+      for (int t = 0; t < graph->inbox.size; t += TRIPLE) {
+        int head = graph->inbox.values[t];
+        int distance = graph->inbox.values[t + 1];
+        if (distance >= graph->bestSent[head]) continue;
+        graph->bestSent[head] = distance;
+        appendTriple(&graph->outbox[ownerOf(graph, head)], head, distance,
+                     graph->inbox.values[t + 2]);
+        stats->numMessages++;
+        if (distance < closest) closest = distance;
+      }
+    }
+    if (closest == INT_MAX) return true;
+
+    if (graph->delta == NO_BOUND || closest > INT_MAX - graph->delta) {
+      bound = INT_MAX;
+    } else {
+      bound = closest + graph->delta;
+    }
+  }
+}
+
+Edge* getDistanceTreePartitioned(PartitionedGraph* graph, int startVertex,
+                                 int* numTreeEdges, PartitionStats* stats) {
+  if (startVertex < 0 || startVertex >= graph->numVertices) return NULL;
+
+  PartitionStats counts = {0, 0, 0, 0.0};
+  double started = nowSeconds();
+  if (!runRounds(graph, startVertex, &counts)) return NULL;
+
+  // gather the distances and parents of the reached vertices
+  int* distances = (int*)malloc(sizeof(int) * graph->numVertices);
+  int* parents = (int*)malloc(sizeof(int) * graph->numVertices);
+  Settled* order = (Settled*)malloc(sizeof(Settled) * graph->numVertices);
+  if (distances == NULL || parents == NULL || order == NULL) {
+    printf("Error: Memory allocation failed for distance tree\n");
+    exit(1);
+  }
+  int numReached = 0;
+  int32_t collect[3] = {COMMAND_COLLECT, 0, 0};
+  MessageBuffer empty = {NULL, 0, 0};
+  for (int w = 0; w < graph->numWorkers; w++) {
+    int32_t reply[2];
+    if (!sendMessage(graph->sockets[w], collect, 3, &empty,
+                     &counts.bytesSent) ||
+        !readFully(graph->sockets[w], reply, sizeof(reply)) ||
+        !receiveTriples(graph->sockets[w], &graph->inbox, reply[1])) {
+      printf("Lost connection to worker %d. Giving up.\n", w);
+      free(distances);
+      free(parents);
+      free(order);
+      return NULL;
+    }
+    counts.bytesSent += sizeof(reply) + sizeof(int32_t) * graph->inbox.size;
+
+    for (int t = 0; t < graph->inbox.size; t += TRIPLE) {
+      int id = graph->inbox.values[t];
+      distances[id] = graph->inbox.values[t + 1];
+      parents[id] = graph->inbox.values[t + 2];
+      order[numReached].distance = distances[id];
+      order[numReached].id = id;
+      numReached++;
+    }
+  }
+
+  // tree edges in an order Dijkstra's algorithm could settle their heads,
+  // with parents first even across edges of weight 0
+  int* depths = (int*)malloc(sizeof(int) * graph->numVertices);
+  int* path = (int*)malloc(sizeof(int) * graph->numVertices);
+  if (depths == NULL || path == NULL) {
+    printf("Error: Memory allocation failed for distance tree\n");
+    exit(1);
+  }
+  for (int r = 0; r < numReached; r++) depths[order[r].id] = NOTHING;
+  findDepths(order, numReached, parents, depths, path);
+  free(depths);
+  free(path);
+  qsort(order, numReached, sizeof(Settled), compareSettled);
+  Edge* tree = (Edge*)malloc(sizeof(Edge) * (numReached > 1 ? numReached : 1));
+  if (tree == NULL) {
+    printf("Error: Memory allocation failed for distance tree\n");
+    exit(1);
+  }
+  int numEdges = 0;
+  for (int r = 0; r < numReached; r++) {
+    int id = order[r].id;
+    if (parents[id] == NOTHING) continue;  // the start vertex
+    tree[numEdges].fromVertex = parents[id];
+    tree[numEdges].toVertex = id;
+    tree[numEdges].weight = distances[id] - distances[parents[id]];
+    numEdges++;
+  }
+
+  free(distances);
+  free(parents);
+  free(order);
+  counts.seconds = nowSeconds() - started;
+  if (numTreeEdges != NULL) *numTreeEdges = numEdges;
+  if (stats != NULL) *stats = counts;
+  return tree;
+}
+
+void deletePartitionedGraph(PartitionedGraph* graph) {
+  if (graph == NULL) return;
+
+  int32_t command[3] = {COMMAND_EXIT, 0, 0};
+  MessageBuffer empty = {NULL, 0, 0};
+  long long bytes = 0;
+  for (int w = 0; w < graph->numWorkers; w++) {
+    sendMessage(graph->sockets[w], command, 3, &empty, &bytes);
+    close(graph->sockets[w]);
+  }
+  for (int w = 0; w < graph->numWorkers; w++) {
+    waitpid(graph->pids[w], NULL, 0);
+    free(graph->outbox[w].values);
+  }
+  free(graph->inbox.values);
+  free(graph->outbox);
+  free(graph->bestSent);
+  free(graph->pids);
+  free(graph->sockets);
+  free(graph->firstVertex);
+  free(graph);
+}
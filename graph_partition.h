@@ -0,0 +1,95 @@
+/*
+ * Header file for shortest paths on a graph partitioned across processes.
+ *
+ * A PartitionedGraph splits the vertices into one range of consecutive IDs
+ * per worker process, balanced by vertices plus edges. Each worker is sent
+ * the edges leaving its range over a Unix socket and keeps only those, its
+ * shard, plus the distances and parents of its own vertices. The process
+ * that created the graph coordinates every query in rounds:
+ *   - it sends each worker the boundary relaxations addressed to its
+ *     vertices, and a distance bound;
+ *   - each worker applies them and runs Dijkstra's algorithm on its shard,
+ *     settling vertices up to the bound and collecting relaxations of edges
+ *     that leave its range in one batch;
+ *   - the coordinator routes the batches to the owners of their heads,
+ *     keeping only the best relaxation seen for every vertex, and sets the
+ *     next bound to the closest pending distance plus 'delta'.
+ * The query ends when no worker has a vertex left to settle and no
+ * relaxation is in flight, and the coordinator then collects the distances
+ * and parents of all workers. With a small delta the rounds follow
+ * Dijkstra's order closely, like delta-stepping, and little work is
+ * repeated; with no bound every worker runs to completion each round and
+ * fewer, larger rounds are needed.
+ *
+ * Workers are forked from the coordinator but use nothing of its memory
+ * except what they are sent. Since a worker and the coordinator talk only
+ * through their socket, all workers run on one machine.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Partition_header
+#define __Graph_Partition_header
+
+#define NO_BOUND 0  // delta for rounds that run every worker to completion
+
+typedef struct message_buffer {  // int32 values to send or just received
+  int32_t* values;  // the values
+  int size;         // number of values in 'values'
+  int capacity;     // number of values 'values' has room for
+} MessageBuffer;
+
+typedef struct partition_stats {
+  int numRounds;          // rounds of local searches and exchanges
+  long long numMessages;  // boundary relaxations routed between workers
+  long long bytesSent;    // bytes over all sockets, both ways
+  double seconds;         // wall time of the query
+} PartitionStats;
+
+typedef struct partitioned_graph {
+  int numVertices;        // total number of vertices
+  int numWorkers;         // number of worker processes
+  int delta;              // bound step, or NO_BOUND
+  int* firstVertex;       // worker w owns [firstVertex[w], firstVertex[w+1])
+  int* sockets;           // sockets[w] is connected to worker w
+  pid_t* pids;            // pids[w] is the process ID of worker w
+  int* bestSent;          // bestSent[id] is the smallest distance routed
+                          //   to id in this query, or INT_MAX
+  MessageBuffer* outbox;  // outbox[w] holds what is routed to worker w next
+  MessageBuffer inbox;    // what a worker just sent
+} PartitionedGraph;
+
+/* Returns a new PartitionedGraph of Graph 'graph' with 'numWorkers' worker
+ * processes, each sent its shard, whose queries step their bound by
+ * 'delta', or run every worker to completion if 'delta' is NO_BOUND.
+ * 'graph' is not needed afterwards.
+ * Returns NULL if 'numWorkers' < 1 or 'delta' < 0, or if the workers could
+ * not be started.
+ */
+PartitionedGraph* newPartitionedGraph(Graph* graph, int numWorkers,
+                                      int delta);
+
+/* Runs Dijkstra's algorithm on 'graph' from vertex with ID 'startVertex'
+ * across its workers, and returns the distance tree in the format produced
+ * by getDistanceTreeDijkstra, with the number of its edges in
+ * 'numTreeEdges' (if not NULL) and the cost of the query in 'stats' (if
+ * not NULL).
+ * Returns NULL if 'startVertex' is not valid in 'graph', or if a worker
+ * could not be reached.
+ * Precondition: no edge weight is negative
+ */
+Edge* getDistanceTreePartitioned(PartitionedGraph* graph, int startVertex,
+                                 int* numTreeEdges, PartitionStats* stats);
+
+/* Stops the workers of 'graph', waits for them to exit, and frees all
+ * memory allocated for it.
+ */
+void deletePartitionedGraph(PartitionedGraph* graph);
+
+#endif
@@ -0,0 +1,220 @@
+/*
+ *  Benchmark of the partitioned shortest path queries of graph_partition.h.
+ *
+ *  Builds a random graph, runs Dijkstra's algorithm from the same random
+ *  sources with getDistanceTreeDijkstra and with getDistanceTreePartitioned
+ *  for several numbers of worker processes and bound steps, checks that all
+ *  runs agree, and prints the query time, the number of rounds, and the
+ *  relaxations and bytes exchanged.
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O3 -Wall -Werror -pthread graph.c minheap.c graph_algos.c \
+ *       graph_build.c graph_queue.c graph_protocol.c graph_partition.c \
+ *       graph_partition_bench.c -o graph_partition_bench
+ *
+ *   Run:
+ *   ./graph_partition_bench [numVertices] [numSources]
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "graph.h"
+#include "graph_algos.h"
+#include "graph_build.h"
+#include "graph_partition.h"
+
+#define DEFAULT_VERTICES 200000
+#define DEFAULT_SOURCES 8
+#define AVERAGE_DEGREE 8
+#define MAX_WEIGHT 1000
+
+/* graphs */
+Graph* randomGraph(int numVertices, uint64_t* state);
+uint64_t nextRandom(uint64_t* state);
+
+/* measuring */
+bool timePartitioned(Graph* graph, const int* sources, int numSources,
+                     int numWorkers, int delta, long long expected,
+                     double baseTime);
+long long distanceSum(Edge* tree, int numTreeEdges, int numVertices);
+double nowSeconds(void);
+
+int main(int argc, char* argv[]) {
+  int numVertices = argc > 1 ? atoi(argv[1]) : DEFAULT_VERTICES;
+  int numSources = argc > 2 ? atoi(argv[2]) : DEFAULT_SOURCES;
+  if (numVertices < 2 || numSources < 1) {
+    printf("Usage: %s [numVertices >= 2] [numSources]\n", argv[0]);
+    return 1;
+  }
+  signal(SIGPIPE, SIG_IGN);  // a worker that fails is reported instead
+
+  uint64_t state = 88172645463325252ULL;
+  Graph* graph = randomGraph(numVertices, &state);
+  int sources[numSources];
+  for (int s = 0; s < numSources; s++) {
+    sources[s] = (int)(nextRandom(&state) % numVertices);
+  }
+  printf("%d vertices, %d edges, %d sources\n\n", numVertices,
+         graph->numEdges, numSources);
+
+  // the sum over all sources of the distances to all vertices
+  long long expected = 0;
+  double start = nowSeconds();
+  for (int s = 0; s < numSources; s++) {
+    Edge* tree = getDistanceTreeDijkstra(graph, sources[s]);
+    expected += distanceSum(tree, numVertices - 1, numVertices);
+    free(tree);
+  }
+  double baseTime = (nowSeconds() - start) / numSources;
+  printf("%-24s %9.1f ms/query\n", "getDistanceTreeDijkstra",
+         1000 * baseTime);
+
+  int workerCounts[] = {1, 2, 4, 8};
+  int deltas[] = {NO_BOUND, MAX_WEIGHT, MAX_WEIGHT / 10};
+  for (int w = 0; w < 4; w++) {
+    for (int d = 0; d < 3; d++) {
+      if (!timePartitioned(graph, sources, numSources, workerCounts[w],
+                           deltas[d], expected, baseTime)) {
+        return 1;
+      }
+    }
+  }
+
+  deleteGraph(graph);
+  return 0;
+}
+
+/* Returns a random connected undirected graph on 'numVertices' vertices
+ * with average degree AVERAGE_DEGREE and weights in [1, MAX_WEIGHT]: a
+ * cycle through all vertices in random order, plus random edges.
+ */
+Graph* randomGraph(int numVertices, uint64_t* state) {
+  int numEdges = numVertices / 2 * AVERAGE_DEGREE;
+  int* from = (int*)malloc(sizeof(int) * numEdges);
+  int* to = (int*)malloc(sizeof(int) * numEdges);
+  int* weights = (int*)malloc(sizeof(int) * numEdges);
+  if (from == NULL || to == NULL || weights == NULL) {
+    printf("Error: Memory allocation failed for random edges\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) to[i] = i;
+  for (int i = numVertices - 1; i > 0; i--) {
+    int j = (int)(nextRandom(state) % (i + 1));
+    int swap = to[i];
+    to[i] = to[j];
+    to[j] = swap;
+  }
+  for (int i = 0; i < numEdges; i++) {
+    if (i < numVertices) {
+      from[i] = to[(i + 1) % numVertices];
+    } else {
+      from[i] = (int)(nextRandom(state) % numVertices);
+      to[i] = (int)(nextRandom(state) % numVertices);
+    }
+    weights[i] = 1 + (int)(nextRandom(state) % MAX_WEIGHT);
+  }
+
+  // without parallel edges, so that every tree edge has a unique weight
+  int options = BUILD_SYMMETRIZE | BUILD_DEDUPLICATE | BUILD_DROP_SELF_LOOPS;
+  CompactGraph* compact = buildCompactGraph(numVertices, numEdges, from, to,
+                                            weights, options, 1);
+  Graph* graph = newGraphFromCompact(compact);
+  deleteCompactGraph(compact);
+  free(from);
+  free(to);
+  free(weights);
+  return graph;
+}
+
+/* Runs getDistanceTreePartitioned on 'graph' with 'numWorkers' workers and
+ * bound step 'delta' from the 'numSources' vertices in 'sources', and
+ * prints its time per query against 'baseTime' and what it exchanged.
+ * Returns false if the workers could not be started, or if its distances
+ * do not sum to 'expected'.
+ */
+bool timePartitioned(Graph* graph, const int* sources, int numSources,
+                     int numWorkers, int delta, long long expected,
+                     double baseTime) {
+  PartitionedGraph* partitioned =
+      newPartitionedGraph(graph, numWorkers, delta);
+  if (partitioned == NULL) return false;
+
+  long long total = 0;
+  double seconds = 0;
+  long long numRounds = 0;
+  long long numMessages = 0;
+  long long bytesSent = 0;
+  for (int s = 0; s < numSources; s++) {
+    int numTreeEdges;
+    PartitionStats stats;
+    Edge* tree = getDistanceTreePartitioned(partitioned, sources[s],
+                                            &numTreeEdges, &stats);
+    if (tree == NULL) return false;
+    total += distanceSum(tree, numTreeEdges, graph->numVertices);
+    free(tree);
+    seconds += stats.seconds;
+    numRounds += stats.numRounds;
+    numMessages += stats.numMessages;
+    bytesSent += stats.bytesSent;
+  }
+  deletePartitionedGraph(partitioned);
+  if (total != expected) {
+    printf("%d workers with delta %d disagree: %lld, expected %lld\n",
+           numWorkers, delta, total, expected);
+    return false;
+  }
+
+  char name[32];
+  if (delta == NO_BOUND) {
+    snprintf(name, sizeof(name), "%d workers, no bound", numWorkers);
+  } else {
+    snprintf(name, sizeof(name), "%d workers, delta %d", numWorkers, delta);
+  }
+  printf("%-24s %9.1f ms/query  %5.2fx  %6lld rounds  %9lld relaxations  "
+         "%7.1f MB\n", name, 1000 * seconds / numSources,
+         baseTime * numSources / seconds, numRounds / numSources,
+         numMessages / numSources, bytesSent / 1e6 / numSources);
+  return true;
+}
+
+/* Returns the next value of the xorshift generator with state 'state'. */
+uint64_t nextRandom(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/* Returns the sum of the distances from the root of the tree 'tree', with
+ * 'numTreeEdges' edges in the order their heads were settled, to all
+ * vertices of a graph with 'numVertices' vertices.
+ */
+long long distanceSum(Edge* tree, int numTreeEdges, int numVertices) {
+  long long* distance = (long long*)calloc(numVertices, sizeof(long long));
+  if (distance == NULL) {
+    printf("Error: Memory allocation failed for distances\n");
+    exit(1);
+  }
+  long long total = 0;
+  for (int i = 0; i < numTreeEdges; i++) {
+    distance[tree[i].toVertex] = distance[tree[i].fromVertex] + tree[i].weight;
+    total += distance[tree[i].toVertex];
+  }
+  free(distance);
+  return total;
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
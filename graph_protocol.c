@@ -0,0 +1,32 @@
+/*
+ * Helpers for the graph query protocol.
+ */
+
+#include <errno.h>
+#include <unistd.h>
+
+#include "graph_protocol.h"
+
+bool readFully(int fd, void* buffer, size_t size) {
+  char* next = (char*)buffer;
+  while (size > 0) {
+    ssize_t got = read(fd, next, size);
+    if (got < 0 && errno == EINTR) continue;
+    if (got <= 0) return false;
+    next += got;
+    size -= got;
+  }
+  return true;
+}
+
+bool writeFully(int fd, const void* buffer, size_t size) {
+  const char* next = (const char*)buffer;
+  while (size > 0) {
+    ssize_t put = write(fd, next, size);
+    if (put < 0 && errno == EINTR) continue;
+    if (put <= 0) return false;
+    next += put;
+    size -= put;
+  }
+  return true;
+}
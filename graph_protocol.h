@@ -0,0 +1,61 @@
+/*
+ * Header file for the binary protocol spoken by graph_server and
+ * graph_client over a Unix domain socket.
+ *
+ * A client may send any number of requests without waiting for responses.
+ * Every response carries the ID of its request; responses to requests on
+ * one connection may arrive in any order. All integers are in host byte
+ * order, since both ends run on the same machine.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef __Graph_Protocol_header
+#define __Graph_Protocol_header
+
+typedef enum request_type {
+  REQUEST_INFO = 1,       // value: number of vertices
+  REQUEST_PATH = 2,       // value: distance source -> target;
+                          //   items: path edges as in getShortestPaths
+  REQUEST_TREE = 3,       // items: distance tree edges from source
+  REQUEST_ISOCHRONE = 4,  // items: (vertex, distance) for every vertex
+                          //   within 'limit' of source
+  REQUEST_MST_WEIGHT = 5  // value: total weight of the MST
+} RequestType;
+
+typedef enum response_status {
+  RESPONSE_OK = 0,           // the request was answered
+  RESPONSE_BAD_REQUEST = 1,  // unknown type or invalid vertex
+  RESPONSE_UNREACHABLE = 2   // the target cannot be reached
+} ResponseStatus;
+
+typedef struct request {
+  uint32_t requestId;  // chosen by the client, echoed in the response
+  int32_t type;        // a RequestType
+  int32_t source;      // ID of the source vertex, if used
+  int32_t target;      // ID of the target vertex, if used
+  int32_t limit;       // distance limit of an isochrone
+} Request;
+
+typedef struct response_header {
+  uint32_t requestId;  // ID of the request this answers
+  int32_t type;        // type of that request
+  int32_t status;      // a ResponseStatus
+  int64_t value;       // type-specific scalar result
+  int32_t numItems;    // number of items following this header
+  int32_t itemSize;    // number of int32 values per item (3 for edges)
+} ResponseHeader;
+
+/* Reads exactly 'size' bytes from 'fd' into 'buffer'. Returns false on end
+ * of file or error.
+ */
+bool readFully(int fd, void* buffer, size_t size);
+
+/* Writes exactly 'size' bytes from 'buffer' to 'fd'. Returns false on
+ * error.
+ */
+bool writeFully(int fd, const void* buffer, size_t size);
+
+#endif
@@ -0,0 +1,475 @@
+/*
+ * Pluggable priority queues.
+ *
+ * The pairing heap keeps one node per vertex ID, linked as first child and
+ * next sibling; 'prev' is the parent for a first child and the previous
+ * sibling otherwise, so a node can be cut out in O(1) when its priority
+ * drops. Extract-min melds the root's children in pairs from left to
+ * right, then melds the pairs from right to left.
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#include "graph_queue.h"
+#include "minheap.h"
+
+#define NOTHING -1
+#define LAZY_INITIAL_CAPACITY 64  // entries in a new lazy heap
+
+typedef struct pairing_node {
+  int priority;  // priority of this node
+  int child;     // first child, or NOTHING
+  int sibling;   // next sibling, or NOTHING
+  int prev;      // parent if first child, else previous sibling, or NOTHING
+  bool inHeap;   // true iff this ID is in the heap
+} PairingNode;
+
+typedef struct pairing_heap {
+  PairingNode* nodes;  // nodes[id] is the node of ID id
+  int root;            // ID of the root, or NOTHING if empty
+} PairingHeap;
+
+typedef struct lazy_heap {
+  HeapNode* entries;  // binary heap of entries, root at index 0
+  int size;           // number of entries
+  int capacity;       // number of entries that fit in 'entries'
+} LazyHeap;
+
+/*************************************************************************
+ ** Indexed binary heap
+ *************************************************************************/
+
+static void pushBinary(void* state, int id, int priority) {
+  MinHeap* heap = (MinHeap*)state;
+  int index = heap->indexMap[id];
+  if (index >= 1 && index <= heap->size && heap->arr[index].id == id) {
+    decreasePriority(heap, id, priority);
+  } else {
+    insert(heap, priority, id);
+  }
+}
+
+static bool popBinary(void* state, int* id, int* priority) {
+  MinHeap* heap = (MinHeap*)state;
+  if (heap->size == 0) return false;
+
+  HeapNode node = extractMin(heap);
+  heap->indexMap[node.id] = NOTHING;
+  *id = node.id;
+  *priority = node.priority;
+  return true;
+}
+
+static bool isEmptyBinary(void* state) {
+  return ((MinHeap*)state)->size == 0;
+}
+
+static void destroyBinary(void* state) { deleteHeap((MinHeap*)state); }
+
+/*************************************************************************
+ ** Pairing heap
+ *************************************************************************/
+
+/* Makes the one of roots 'a' and 'b' with the larger priority the first
+ * child of the other, and returns the other.
+ */
+static int linkPairing(PairingNode* nodes, int a, int b) {
+  if (nodes[b].priority < nodes[a].priority) {
+    int t = a;
+    a = b;
+    b = t;
+  }
+  nodes[b].sibling = nodes[a].child;
+  if (nodes[a].child != NOTHING) nodes[nodes[a].child].prev = b;
+  nodes[b].prev = a;
+  nodes[a].child = b;
+  return a;
+}
+
+static void pushPairing(void* state, int id, int priority) {
+  PairingHeap* heap = (PairingHeap*)state;
+  PairingNode* nodes = heap->nodes;
+  PairingNode* node = &nodes[id];
+  node->priority = priority;
+
+  if (!node->inHeap) {
+    node->child = NOTHING;
+    node->sibling = NOTHING;
+    node->prev = NOTHING;
+    node->inHeap = true;
+  } else {
+    if (id == heap->root) return;
+    // cut the subtree of 'id' out and meld it with the root
+    if (nodes[node->prev].child == id) {
+      nodes[node->prev].child = node->sibling;
+    } else {
+      nodes[node->prev].sibling = node->sibling;
+    }
+    if (node->sibling != NOTHING) nodes[node->sibling].prev = node->prev;
+    node->sibling = NOTHING;
+    node->prev = NOTHING;
+  }
+  heap->root = heap->root == NOTHING ? id : linkPairing(nodes, heap->root, id);
+}
+
+static bool popPairing(void* state, int* id, int* priority) {
+  PairingHeap* heap = (PairingHeap*)state;
+  PairingNode* nodes = heap->nodes;
+  if (heap->root == NOTHING) return false;
+
+  *id = heap->root;
+  *priority = nodes[heap->root].priority;
+  nodes[heap->root].inHeap = false;
+
+  // first pass: meld children in pairs, collecting the pairs in reverse
+  int pairs = NOTHING;
+  int child = nodes[heap->root].child;
+  while (child != NOTHING) {
+    int a = child;
+    int b = nodes[a].sibling;
+    child = b == NOTHING ? NOTHING : nodes[b].sibling;
+    nodes[a].sibling = NOTHING;
+    nodes[a].prev = NOTHING;
+    if (b != NOTHING) {
+      nodes[b].sibling = NOTHING;
+      nodes[b].prev = NOTHING;
+      a = linkPairing(nodes, a, b);
+    }
+    nodes[a].sibling = pairs;
+    pairs = a;
+  }
+
+  // second pass: meld the pairs from right to left
+  int root = pairs;
+  if (root != NOTHING) {
+    int next = nodes[root].sibling;
+    nodes[root].sibling = NOTHING;
+    while (next != NOTHING) {
+      int pair = next;
+      next = nodes[pair].sibling;
+      nodes[pair].sibling = NOTHING;
+      root = linkPairing(nodes, root, pair);
+    }
+  }
+  heap->root = root;
+  return true;
+}
+
+static bool isEmptyPairing(void* state) {
+  return ((PairingHeap*)state)->root == NOTHING;
+}
+
+static void destroyPairing(void* state) {
+  PairingHeap* heap = (PairingHeap*)state;
+  free(heap->nodes);
+  free(heap);
+}
+
+/*************************************************************************
+ ** Lazy-deletion heap
+ *************************************************************************/
+
+static void pushLazy(void* state, int id, int priority) {
+  LazyHeap* heap = (LazyHeap*)state;
+  if (heap->size == heap->capacity) {
+    heap->capacity *= 2;
+    heap->entries = (HeapNode*)realloc(heap->entries,
+                                       sizeof(HeapNode) * heap->capacity);
+    if (heap->entries == NULL) {
+      printf("Error: Memory allocation failed for lazy heap\n");
+      exit(1);
+    }
+  }
+
+  HeapNode* entries = heap->entries;
+  int index = heap->size++;
+  while (index > 0 && entries[(index - 1) / 2].priority > priority) {
+    entries[index] = entries[(index - 1) / 2];
+    index = (index - 1) / 2;
+  }
+  entries[index].priority = priority;
+  entries[index].id = id;
+}
+
+static bool popLazy(void* state, int* id, int* priority) {
+  LazyHeap* heap = (LazyHeap*)state;
+  if (heap->size == 0) return false;
+
+  HeapNode* entries = heap->entries;
+  *id = entries[0].id;
+  *priority = entries[0].priority;
+
+  HeapNode last = entries[--heap->size];
+  int index = 0;
+  while (true) {
+    int smallest = 2 * index + 1;
+    if (smallest >= heap->size) break;
+    if (smallest + 1 < heap->size &&
+        entries[smallest + 1].priority < entries[smallest].priority) {
+      smallest++;
+    }
+    if (entries[smallest].priority >= last.priority) break;
+    entries[index] = entries[smallest];
+    index = smallest;
+  }
+  entries[index] = last;
+  return true;
+}
+
+static bool isEmptyLazy(void* state) { return ((LazyHeap*)state)->size == 0; }
+
+static void destroyLazy(void* state) {
+  LazyHeap* heap = (LazyHeap*)state;
+  free(heap->entries);
+  free(heap);
+}
+
+/*************************************************************************
+ ** Queues
+ *************************************************************************/
+
+PriorityQueue* newPriorityQueue(QueueKind kind, int numVertices) {
+  if (numVertices < 0) return NULL;
+
+  PriorityQueue* queue = (PriorityQueue*)malloc(sizeof(PriorityQueue));
+  if (queue == NULL) {
+    printf("Error: Memory allocation failed for priority queue\n");
+    exit(1);
+  }
+  queue->kind = kind;
+
+  switch (kind) {
+    case QUEUE_BINARY_HEAP:
+      queue->state = newHeap(numVertices);
+      queue->push = pushBinary;
+      queue->pop = popBinary;
+      queue->isEmpty = isEmptyBinary;
+      queue->destroy = destroyBinary;
+      break;
+
+    case QUEUE_PAIRING_HEAP: {
+      PairingHeap* heap = (PairingHeap*)malloc(sizeof(PairingHeap));
+      if (heap == NULL) {
+        printf("Error: Memory allocation failed for pairing heap\n");
+        exit(1);
+      }
+      // calloc leaves pages of untouched IDs unmapped until first used
+      heap->nodes = (PairingNode*)calloc(numVertices + 1, sizeof(PairingNode));
+      if (heap->nodes == NULL) {
+        printf("Error: Memory allocation failed for pairing heap nodes\n");
+        exit(1);
+      }
+      heap->root = NOTHING;
+      queue->state = heap;
+      queue->push = pushPairing;
+      queue->pop = popPairing;
+      queue->isEmpty = isEmptyPairing;
+      queue->destroy = destroyPairing;
+      break;
+    }
+
+    case QUEUE_LAZY_HEAP: {
+      LazyHeap* heap = (LazyHeap*)malloc(sizeof(LazyHeap));
+      if (heap == NULL) {
+        printf("Error: Memory allocation failed for lazy heap\n");
+        exit(1);
+      }
+      heap->size = 0;
+      heap->capacity = LAZY_INITIAL_CAPACITY;
+      heap->entries = (HeapNode*)malloc(sizeof(HeapNode) * heap->capacity);
+      if (heap->entries == NULL) {
+        printf("Error: Memory allocation failed for lazy heap\n");
+        exit(1);
+      }
+      queue->state = heap;
+      queue->push = pushLazy;
+      queue->pop = popLazy;
+      queue->isEmpty = isEmptyLazy;
+      queue->destroy = destroyLazy;
+      break;
+    }
+  }
+  return queue;
+}
+
+const char* getQueueName(QueueKind kind) {
+  switch (kind) {
+    case QUEUE_BINARY_HEAP:
+      return "binary";
+    case QUEUE_PAIRING_HEAP:
+      return "pairing";
+    case QUEUE_LAZY_HEAP:
+      return "lazy";
+  }
+  return "unknown";
+}
+
+void pushQueue(PriorityQueue* queue, int id, int priority) {
+  queue->push(queue->state, id, priority);
+}
+
+bool popQueue(PriorityQueue* queue, int* id, int* priority) {
+  return queue->pop(queue->state, id, priority);
+}
+
+bool isQueueEmpty(PriorityQueue* queue) {
+  return queue->isEmpty(queue->state);
+}
+
+void deletePriorityQueue(PriorityQueue* queue) {
+  if (queue == NULL) return;
+
+  queue->destroy(queue->state);
+  free(queue);
+}
+
+/*************************************************************************
+ ** Algorithms
+ *************************************************************************/
+
+QueueWorkspace* newQueueWorkspace(Graph* graph, QueueKind kind) {
+  QueueWorkspace* ws = (QueueWorkspace*)malloc(sizeof(QueueWorkspace));
+  if (ws == NULL) {
+    printf("Error: Memory allocation failed for queue workspace\n");
+    exit(1);
+  }
+  int numVertices = graph->numVertices;
+  ws->graph = graph;
+  ws->queue = newPriorityQueue(kind, numVertices);
+  ws->keys = (int*)malloc(sizeof(int) * (numVertices + 1));
+  ws->preds = (int*)malloc(sizeof(int) * (numVertices + 1));
+  ws->predWeights = (int*)malloc(sizeof(int) * (numVertices + 1));
+  ws->finished = (bool*)calloc(numVertices + 1, sizeof(bool));
+  ws->touched = (int*)malloc(sizeof(int) * (numVertices + 1));
+  ws->settled = (int*)malloc(sizeof(int) * (numVertices + 1));
+  if (ws->keys == NULL || ws->preds == NULL || ws->predWeights == NULL ||
+      ws->finished == NULL || ws->touched == NULL || ws->settled == NULL) {
+    printf("Error: Memory allocation failed for queue workspace arrays\n");
+    exit(1);
+  }
+  for (int v = 0; v < numVertices; v++) {
+    ws->keys[v] = INT_MAX;
+    ws->preds[v] = NOTHING;
+  }
+  ws->numTouched = 0;
+  return ws;
+}
+
+void deleteQueueWorkspace(QueueWorkspace* ws) {
+  if (ws == NULL) return;
+
+  deletePriorityQueue(ws->queue);
+  free(ws->keys);
+  free(ws->preds);
+  free(ws->predWeights);
+  free(ws->finished);
+  free(ws->touched);
+  free(ws->settled);
+  free(ws);
+}
+
+/* Restores every vertex touched by the last search on 'ws' to unreached.
+ * The search drained the queue, so it is empty already. Costs O(number of
+ * touched vertices).
+ */
+static void resetQueueWorkspace(QueueWorkspace* ws) {
+  for (int i = 0; i < ws->numTouched; i++) {
+    int id = ws->touched[i];
+    ws->keys[id] = INT_MAX;
+    ws->preds[id] = NOTHING;
+    ws->finished[id] = false;
+  }
+  ws->numTouched = 0;
+}
+
+/* Grows a tree in the graph of 'ws' from 'startVertex', and returns its
+ * edges in the order their heads are settled, with their number in
+ * 'numTreeEdges' (if not NULL): a shortest path tree if 'shortestPaths',
+ * or else a minimum spanning tree. Leaves 'ws' reset, so the search costs
+ * time proportional to the vertices and edges it reaches.
+ */
+static Edge* growTree(QueueWorkspace* ws, int startVertex,
+                      bool shortestPaths, int* numTreeEdges) {
+  Graph* graph = ws->graph;
+  if (startVertex < 0 || startVertex >= graph->numVertices ||
+      graph->vertices[startVertex] == NULL) {
+    return NULL;
+  }
+
+  int* keys = ws->keys;
+  int* preds = ws->preds;
+  int* predWeights = ws->predWeights;
+  bool* finished = ws->finished;
+  keys[startVertex] = 0;
+  ws->touched[ws->numTouched++] = startVertex;
+  pushQueue(ws->queue, startVertex, 0);
+
+  int numSettled = 0;
+  int u, key;
+  while (popQueue(ws->queue, &u, &key)) {
+    if (finished[u]) continue;  // a stale entry of the lazy heap
+    finished[u] = true;
+    ws->settled[numSettled++] = u;
+
+    if (graph->vertices[u] == NULL) continue;
+    for (EdgeList* e = graph->vertices[u]->adjList; e != NULL; e = e->next) {
+      int to = e->edge->toVertex;
+      int weight = e->edge->weight;
+      if (finished[to]) continue;
+      if (shortestPaths && weight > INT_MAX - 1 - key) continue;
+
+      int candidate = shortestPaths ? key + weight : weight;
+      if (candidate < keys[to]) {
+        if (keys[to] == INT_MAX) ws->touched[ws->numTouched++] = to;
+        keys[to] = candidate;
+        preds[to] = u;
+        predWeights[to] = weight;
+        pushQueue(ws->queue, to, candidate);
+      }
+    }
+  }
+
+  // every settled vertex but the start brings one tree edge
+  int numEdges = numSettled - 1;
+  Edge* tree = (Edge*)malloc(sizeof(Edge) * (numEdges + 1));
+  if (tree == NULL) {
+    printf("Error: Memory allocation failed for queue search tree\n");
+    exit(1);
+  }
+  for (int i = 0; i < numEdges; i++) {
+    int id = ws->settled[i + 1];
+    tree[i].fromVertex = preds[id];
+    tree[i].toVertex = id;
+    tree[i].weight = predWeights[id];
+  }
+  resetQueueWorkspace(ws);
+  if (numTreeEdges != NULL) *numTreeEdges = numEdges;
+  return tree;
+}
+
+Edge* getMSTprimWorkspace(QueueWorkspace* ws, int startVertex,
+                          int* numTreeEdges) {
+  return growTree(ws, startVertex, false, numTreeEdges);
+}
+
+Edge* getDistanceTreeWorkspace(QueueWorkspace* ws, int startVertex,
+                               int* numTreeEdges) {
+  return growTree(ws, startVertex, true, numTreeEdges);
+}
+
+Edge* getMSTprimQueue(Graph* graph, int startVertex, QueueKind kind,
+                      int* numTreeEdges) {
+  QueueWorkspace* ws = newQueueWorkspace(graph, kind);
+  Edge* tree = growTree(ws, startVertex, false, numTreeEdges);
+  deleteQueueWorkspace(ws);
+  return tree;
+}
+
+Edge* getDistanceTreeQueue(Graph* graph, int startVertex, QueueKind kind,
+                           int* numTreeEdges) {
+  QueueWorkspace* ws = newQueueWorkspace(graph, kind);
+  Edge* tree = growTree(ws, startVertex, true, numTreeEdges);
+  deleteQueueWorkspace(ws);
+  return tree;
+}
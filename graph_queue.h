@@ -0,0 +1,121 @@
+/*
+ * Header file for pluggable priority queues.
+ *
+ * A PriorityQueue holds vertex IDs keyed by int priorities behind a small
+ * table of operations, so searches can be written once and run on any
+ * backend:
+ *   - QUEUE_BINARY_HEAP: the indexed binary MinHeap of minheap.h;
+ *   - QUEUE_PAIRING_HEAP: a pairing heap, with O(1) insert and amortized
+ *     O(1) decrease-key, and O(log n) amortized extract-min;
+ *   - QUEUE_LAZY_HEAP: a binary heap of (priority, ID) entries without an
+ *     index map, where lowering a priority adds a second entry. Its memory
+ *     grows with the number of pushes rather than the number of vertices,
+ *     and popped IDs may be stale, so searches must skip IDs they have
+ *     already finished.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Queue_header
+#define __Graph_Queue_header
+
+typedef enum queue_kind {
+  QUEUE_BINARY_HEAP,
+  QUEUE_PAIRING_HEAP,
+  QUEUE_LAZY_HEAP
+} QueueKind;
+
+typedef struct priority_queue {
+  QueueKind kind;                                    // backend of this queue
+  void* state;                                       // backend data
+  void (*push)(void* state, int id, int priority);   // insert, or lower
+  bool (*pop)(void* state, int* id, int* priority);  // remove the minimum
+  bool (*isEmpty)(void* state);                      // true iff no entries
+  void (*destroy)(void* state);                      // free 'state'
+} PriorityQueue;
+
+typedef struct queue_workspace {  // state of searches, reused across them
+  Graph* graph;           // the graph searched
+  PriorityQueue* queue;   // empty between searches
+  int* keys;              // keys[id] is the key of id, or INT_MAX if id
+                          //   was not reached
+  int* preds;             // preds[id] is the tree neighbour of id, or -1
+  int* predWeights;       // predWeights[id] is the weight of that edge
+  bool* finished;         // finished[id] is true iff id has been settled
+  int* touched;           // vertices reached by the current search
+  int numTouched;         // number of vertices in 'touched'
+  int* settled;           // vertices settled by the current search, in
+                          //   the order they were settled
+} QueueWorkspace;
+
+/* Returns a new empty PriorityQueue of kind 'kind' for IDs in
+ * [0, 'numVertices'), or NULL if 'numVertices' < 0.
+ */
+PriorityQueue* newPriorityQueue(QueueKind kind, int numVertices);
+
+/* Returns the name of queue kind 'kind'. */
+const char* getQueueName(QueueKind kind);
+
+/* Inserts 'id' into 'queue' with priority 'priority', or lowers its
+ * priority to 'priority' if it is already there.
+ * Precondition: 'priority' is lower than the current priority of 'id', if
+ *   any, and 'id' has not been popped from 'queue'
+ */
+void pushQueue(PriorityQueue* queue, int id, int priority);
+
+/* Removes an entry of minimum priority from 'queue' and stores it in 'id'
+ * and 'priority'. Returns false if 'queue' is empty.
+ */
+bool popQueue(PriorityQueue* queue, int* id, int* priority);
+
+/* Returns true iff 'queue' has no entries. */
+bool isQueueEmpty(PriorityQueue* queue);
+
+/* Frees all memory allocated for 'queue'. */
+void deletePriorityQueue(PriorityQueue* queue);
+
+/* Returns a new QueueWorkspace for searches on Graph 'graph' with a queue
+ * of kind 'kind'. Creating it costs O(numVertices), once; every search on
+ * it then resets only what it touched, so its cost does not depend on the
+ * size of 'graph'. 'graph' must keep its number of vertices meanwhile.
+ */
+QueueWorkspace* newQueueWorkspace(Graph* graph, QueueKind kind);
+
+/* Frees all memory allocated for 'ws'. */
+void deleteQueueWorkspace(QueueWorkspace* ws);
+
+/* Like getMSTprimQueue, on the graph and queue of 'ws'. */
+Edge* getMSTprimWorkspace(QueueWorkspace* ws, int startVertex,
+                          int* numTreeEdges);
+
+/* Like getDistanceTreeQueue, on the graph and queue of 'ws'. */
+Edge* getDistanceTreeWorkspace(QueueWorkspace* ws, int startVertex,
+                               int* numTreeEdges);
+
+/* Runs Prim's algorithm on Graph 'graph' from vertex with ID 'startVertex'
+ * with a queue of kind 'kind', and returns the MST in the format produced
+ * by getMSTprim, with the number of its edges in 'numTreeEdges' (if not
+ * NULL). Only the component of 'startVertex' is spanned, and the array
+ * holds just its edges. Sets up a QueueWorkspace for the one search; use
+ * one directly for many searches on the same graph.
+ * Returns NULL if 'startVertex' is not valid in 'graph'.
+ */
+Edge* getMSTprimQueue(Graph* graph, int startVertex, QueueKind kind,
+                      int* numTreeEdges);
+
+/* Runs Dijkstra's algorithm on Graph 'graph' from vertex with ID
+ * 'startVertex' with a queue of kind 'kind', and returns the distance tree
+ * in the format produced by getDistanceTreeDijkstra, with the number of its
+ * edges in 'numTreeEdges' (if not NULL). The array holds just the edges to
+ * vertices reached. Sets up a QueueWorkspace for the one search, as
+ * getMSTprimQueue does.
+ * Returns NULL if 'startVertex' is not valid in 'graph'.
+ */
+Edge* getDistanceTreeQueue(Graph* graph, int startVertex, QueueKind kind,
+                           int* numTreeEdges);
+
+#endif
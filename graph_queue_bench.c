@@ -0,0 +1,257 @@
+/*
+ *  Benchmark of the priority queue backends of graph_queue.h.
+ *
+ *  Builds graphs of several classes, runs Dijkstra's algorithm from a few
+ *  random sources, on one QueueWorkspace, and Prim's algorithm once with
+ *  every backend, checks that all backends agree and that a reused
+ *  workspace agrees with a fresh one, and prints the times and the winner
+ *  of each class.
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O3 -Wall -Werror graph.c minheap.c graph_queue.c \
+ *       graph_queue_bench.c -o graph_queue_bench
+ *
+ *   Run:
+ *   ./graph_queue_bench [scale] [numSources]
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "graph.h"
+#include "graph_queue.h"
+
+#define DEFAULT_SCALE 100000
+#define DEFAULT_SOURCES 5
+#define NUM_CLASSES 4
+#define NUM_KINDS 3
+#define MAX_WEIGHT 1000
+
+/* graphs */
+Graph* gridGraph(int scale, uint64_t* state);
+Graph* sparseGraph(int scale, uint64_t* state);
+Graph* denseGraph(int scale, uint64_t* state);
+Graph* powerLawGraph(int scale, uint64_t* state);
+Graph* emptyGraph(int numVertices);
+void addUndirectedEdge(Graph* graph, int u, int v, uint64_t* state);
+uint64_t nextRandom(uint64_t* state);
+
+/* measuring */
+long long treeSum(Edge* tree, int numTreeEdges, int numVertices,
+                  bool distances);
+double nowSeconds(void);
+
+int main(int argc, char* argv[]) {
+  int scale = argc > 1 ? atoi(argv[1]) : DEFAULT_SCALE;
+  int numSources = argc > 2 ? atoi(argv[2]) : DEFAULT_SOURCES;
+  if (scale < 100 || numSources < 1) {
+    printf("Usage: %s [scale >= 100] [numSources]\n", argv[0]);
+    return 1;
+  }
+
+  const char* classNames[NUM_CLASSES] = {"grid", "sparse", "dense",
+                                         "power-law"};
+  Graph* (*builders[NUM_CLASSES])(int, uint64_t*) = {
+      gridGraph, sparseGraph, denseGraph, powerLawGraph};
+  QueueKind kinds[NUM_KINDS] = {QUEUE_BINARY_HEAP, QUEUE_PAIRING_HEAP,
+                                QUEUE_LAZY_HEAP};
+
+  printf("%-10s %9s %10s %8s %12s %12s\n", "class", "vertices", "edges",
+         "queue", "dijkstra", "prim");
+  uint64_t state = 88172645463325252ULL;
+  for (int c = 0; c < NUM_CLASSES; c++) {
+    Graph* graph = builders[c](scale, &state);
+    int sources[numSources];
+    for (int s = 0; s < numSources; s++) {
+      sources[s] = (int)(nextRandom(&state) % graph->numVertices);
+    }
+
+    long long expectedDistances = -1;
+    long long expectedWeight = -1;
+    int bestKind = 0;
+    double bestTime = 0;
+    for (int k = 0; k < NUM_KINDS; k++) {
+      int numTreeEdges;
+      long long distanceTotal = 0;
+      long long lastTotal = 0;
+      double start = nowSeconds();
+      QueueWorkspace* ws = newQueueWorkspace(graph, kinds[k]);
+      for (int s = 0; s < numSources; s++) {
+        Edge* tree = getDistanceTreeWorkspace(ws, sources[s], &numTreeEdges);
+        lastTotal = treeSum(tree, numTreeEdges, graph->numVertices, true);
+        distanceTotal += lastTotal;
+        free(tree);
+      }
+      deleteQueueWorkspace(ws);
+      double dijkstraTime = (nowSeconds() - start) / numSources;
+
+      // the last search ran on a workspace reset by the others
+      Edge* fresh = getDistanceTreeQueue(graph, sources[numSources - 1],
+                                         kinds[k], &numTreeEdges);
+      long long freshTotal =
+          treeSum(fresh, numTreeEdges, graph->numVertices, true);
+      free(fresh);
+
+      start = nowSeconds();
+      Edge* tree = getMSTprimQueue(graph, 0, kinds[k], &numTreeEdges);
+      double primTime = nowSeconds() - start;
+      long long weight = treeSum(tree, numTreeEdges, graph->numVertices, false);
+      free(tree);
+
+      if (k == 0) {
+        expectedDistances = distanceTotal;
+        expectedWeight = weight;
+      }
+      if (distanceTotal != expectedDistances || weight != expectedWeight ||
+          lastTotal != freshTotal) {
+        printf("Backend %s disagrees on %s graphs\n", getQueueName(kinds[k]),
+               classNames[c]);
+        return 1;
+      }
+      if (k == 0 || dijkstraTime + primTime < bestTime) {
+        bestKind = k;
+        bestTime = dijkstraTime + primTime;
+      }
+      printf("%-10s %9d %10d %8s %10.2fms %10.2fms\n", classNames[c],
+             graph->numVertices, graph->numEdges, getQueueName(kinds[k]),
+             1000 * dijkstraTime, 1000 * primTime);
+    }
+    printf("%-10s winner: %s\n\n", classNames[c],
+           getQueueName(kinds[bestKind]));
+    deleteGraph(graph);
+  }
+  return 0;
+}
+
+/* Returns a road-like square grid of about 'scale' vertices. */
+Graph* gridGraph(int scale, uint64_t* state) {
+  int side = 1;
+  while ((side + 1) * (side + 1) <= scale) side++;
+  Graph* graph = emptyGraph(side * side);
+  for (int r = 0; r < side; r++) {
+    for (int c = 0; c < side; c++) {
+      int v = r * side + c;
+      if (c + 1 < side) addUndirectedEdge(graph, v, v + 1, state);
+      if (r + 1 < side) addUndirectedEdge(graph, v, v + side, state);
+    }
+  }
+  return graph;
+}
+
+/* Returns a random graph on 'scale' vertices with average degree 8. */
+Graph* sparseGraph(int scale, uint64_t* state) {
+  Graph* graph = emptyGraph(scale);
+  for (int i = 0; i < 4 * scale; i++) {
+    addUndirectedEdge(graph, (int)(nextRandom(state) % scale),
+                      (int)(nextRandom(state) % scale), state);
+  }
+  return graph;
+}
+
+/* Returns a random graph on 'scale' / 20 vertices with average degree
+ * 200.
+ */
+Graph* denseGraph(int scale, uint64_t* state) {
+  int numVertices = scale / 20;
+  Graph* graph = emptyGraph(numVertices);
+  for (int i = 0; i < 100 * numVertices; i++) {
+    addUndirectedEdge(graph, (int)(nextRandom(state) % numVertices),
+                      (int)(nextRandom(state) % numVertices), state);
+  }
+  return graph;
+}
+
+/* Returns a preferential attachment graph on 'scale' vertices, where each
+ * new vertex links to 3 earlier ones chosen in proportion to their degree.
+ */
+Graph* powerLawGraph(int scale, uint64_t* state) {
+  Graph* graph = emptyGraph(scale);
+  int* ends = (int*)malloc(sizeof(int) * 6 * scale);
+  if (ends == NULL) {
+    printf("Error: Memory allocation failed for edge ends\n");
+    exit(1);
+  }
+
+  int numEnds = 0;
+  addUndirectedEdge(graph, 0, 1, state);
+  ends[numEnds++] = 0;
+  ends[numEnds++] = 1;
+  for (int v = 2; v < scale; v++) {
+    for (int i = 0; i < 3; i++) {
+      int u = ends[nextRandom(state) % numEnds];
+      addUndirectedEdge(graph, v, u, state);
+      ends[numEnds++] = u;
+      ends[numEnds++] = v;
+    }
+  }
+  free(ends);
+  return graph;
+}
+
+/* Returns a graph with 'numVertices' vertices and no edges. */
+Graph* emptyGraph(int numVertices) {
+  Graph* graph = newGraph(numVertices);
+  for (int v = 0; v < numVertices; v++) {
+    graph->vertices[v] = newVertex(v, NULL, NULL);
+  }
+  return graph;
+}
+
+/* Adds edges between 'u' and 'v' of the same random weight in both
+ * directions.
+ */
+void addUndirectedEdge(Graph* graph, int u, int v, uint64_t* state) {
+  int weight = 1 + (int)(nextRandom(state) % MAX_WEIGHT);
+  graph->vertices[u]->adjList =
+      newEdgeList(newEdge(u, v, weight), graph->vertices[u]->adjList);
+  graph->vertices[v]->adjList =
+      newEdgeList(newEdge(v, u, weight), graph->vertices[v]->adjList);
+  graph->numEdges += 2;
+}
+
+/* Returns the next value of the xorshift generator with state 'state'. */
+uint64_t nextRandom(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/* Returns the sum of the distances from the root of the tree 'tree', with
+ * 'numTreeEdges' edges in the order their heads were settled, to all
+ * vertices of a graph with 'numVertices' vertices if 'distances', or else
+ * the total weight of 'tree'.
+ */
+long long treeSum(Edge* tree, int numTreeEdges, int numVertices,
+                  bool distances) {
+  long long total = 0;
+  if (!distances) {
+    for (int i = 0; i < numTreeEdges; i++) total += tree[i].weight;
+    return total;
+  }
+
+  long long* distance = (long long*)calloc(numVertices, sizeof(long long));
+  if (distance == NULL) {
+    printf("Error: Memory allocation failed for distances\n");
+    exit(1);
+  }
+  for (int i = 0; i < numTreeEdges; i++) {
+    distance[tree[i].toVertex] = distance[tree[i].fromVertex] + tree[i].weight;
+    total += distance[tree[i].toVertex];
+  }
+  free(distance);
+  return total;
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
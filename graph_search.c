@@ -0,0 +1,221 @@
+/*
+ * Incremental Dijkstra searches.
+ *
+ * Vertices are put into the heap when first reached, so a search that is
+ * paused or cancelled early has only paid for what it touched, apart from
+ * the initial allocation of its arrays.
+ */
+
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+
+#include "graph_search.h"
+
+#define NOTHING -1
+#define CLOCK_CHECK_INTERVAL 64
+
+/*************************************************************************
+ ** Helper functions
+ *************************************************************************/
+
+/* Returns the current time in seconds on a monotonic clock. */
+static double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*************************************************************************
+ ** Searches
+ *************************************************************************/
+
+DijkstraSearch* newDijkstraSearch(Graph* graph, int startVertex) {
+  if (graph == NULL || startVertex < 0 || startVertex >= graph->numVertices ||
+      graph->vertices[startVertex] == NULL) {
+    return NULL;
+  }
+
+  DijkstraSearch* search = (DijkstraSearch*)malloc(sizeof(DijkstraSearch));
+  if (search == NULL) {
+    printf("Error: Memory allocation failed for Dijkstra search\n");
+    exit(1);
+  }
+
+  int numVertices = graph->numVertices;
+  search->graph = graph;
+  search->source = startVertex;
+  search->heap = newHeap(numVertices);
+  search->finished = (bool*)malloc(sizeof(bool) * numVertices);
+  search->predecessors = (int*)malloc(sizeof(int) * numVertices);
+  search->predWeights = (int*)malloc(sizeof(int) * numVertices);
+  search->distances = (int*)malloc(sizeof(int) * numVertices);
+  search->tree = (Edge*)malloc(sizeof(Edge) * numVertices);
+  if (search->finished == NULL || search->predecessors == NULL ||
+      search->predWeights == NULL || search->distances == NULL ||
+      search->tree == NULL) {
+    printf("Error: Memory allocation failed for Dijkstra search arrays\n");
+    exit(1);
+  }
+
+  for (int i = 0; i < numVertices; i++) {
+    search->finished[i] = false;
+    search->predecessors[i] = NOTHING;
+    search->distances[i] = INT_MAX;
+  }
+  search->numTreeEdges = 0;
+  search->numSettled = 0;
+  atomic_init(&search->cancelled, false);
+
+  search->distances[startVertex] = 0;
+  insert(search->heap, 0, startVertex);
+
+  return search;
+}
+
+int nextSettledVertex(DijkstraSearch* search, int* distance) {
+  if (search == NULL || atomic_load(&search->cancelled) ||
+      search->heap->size == 0) {
+    return NOTHING;
+  }
+
+  HeapNode minNode = extractMin(search->heap);
+  int minVertex = minNode.id;
+  int currDis = minNode.priority;
+
+  search->finished[minVertex] = true;
+  search->numSettled++;
+
+  int pred = search->predecessors[minVertex];
+  if (pred != NOTHING) {
+    Edge* treeEdge = &search->tree[search->numTreeEdges++];
+    treeEdge->fromVertex = pred;
+    treeEdge->toVertex = minVertex;
+    treeEdge->weight = search->predWeights[minVertex];
+  }
+
+  Vertex* vertex = search->graph->vertices[minVertex];
+  EdgeList* adjList = vertex == NULL ? NULL : vertex->adjList;
+  while (adjList != NULL) {
+    Edge* edge = adjList->edge;
+    int toVertex = edge->toVertex;
+    int weight = edge->weight;
+
+    if (!search->finished[toVertex] && weight <= INT_MAX - 1 - currDis &&
+        currDis + weight < search->distances[toVertex]) {
+      if (search->distances[toVertex] == INT_MAX) {
+        insert(search->heap, currDis + weight, toVertex);
+      } else {
+        decreasePriority(search->heap, toVertex, currDis + weight);
+      }
+      search->distances[toVertex] = currDis + weight;
+      search->predecessors[toVertex] = minVertex;
+      search->predWeights[toVertex] = weight;
+    }
+    adjList = adjList->next;
+  }
+
+  if (distance != NULL) *distance = currDis;
+  return minVertex;
+}
+
+SearchStatus runDijkstraSearch(DijkstraSearch* search, int maxSteps,
+                               double maxSeconds, int* settled,
+                               int* numSettled) {
+  int count = 0;
+  if (numSettled != NULL) *numSettled = 0;
+  if (search == NULL) return SEARCH_CANCELLED;
+
+  double deadline = maxSeconds > 0 ? nowSeconds() + maxSeconds : 0;
+
+  while (maxSteps <= 0 || count < maxSteps) {
+    int vertex = nextSettledVertex(search, NULL);
+    if (vertex == NOTHING) break;
+
+    // without a step limit, 'settled' has room for every vertex
+    if (settled != NULL) settled[count] = vertex;
+    count++;
+
+    if (deadline > 0 && count % CLOCK_CHECK_INTERVAL == 0 &&
+        nowSeconds() >= deadline) {
+      break;
+    }
+  }
+
+  if (numSettled != NULL) *numSettled = count;
+  return getSearchStatus(search);
+}
+
+void cancelDijkstraSearch(DijkstraSearch* search) {
+  if (search == NULL) return;
+  atomic_store(&search->cancelled, true);
+}
+
+SearchStatus getSearchStatus(DijkstraSearch* search) {
+  if (search == NULL || atomic_load(&search->cancelled)) {
+    return SEARCH_CANCELLED;
+  }
+  return search->heap->size == 0 ? SEARCH_DONE : SEARCH_PAUSED;
+}
+
+Edge* getSearchDistanceTree(DijkstraSearch* search, int* numTreeEdges) {
+  if (search == NULL) return NULL;
+
+  Edge* distTree = (Edge*)malloc(sizeof(Edge) * (search->numTreeEdges + 1));
+  if (distTree == NULL) {
+    printf("Error: Memory allocation failed for distance tree\n");
+    exit(1);
+  }
+  memcpy(distTree, search->tree, sizeof(Edge) * search->numTreeEdges);
+
+  if (numTreeEdges != NULL) *numTreeEdges = search->numTreeEdges;
+  return distTree;
+}
+
+/* Marks vertex 'id' of 'search' as not reached. */
+static void forgetVertex(DijkstraSearch* search, int id) {
+  search->finished[id] = false;
+  search->predecessors[id] = NOTHING;
+  search->distances[id] = INT_MAX;
+  search->heap->indexMap[id] = NOTHING;
+}
+
+bool restartDijkstraSearch(DijkstraSearch* search, int startVertex) {
+  if (search == NULL || startVertex < 0 ||
+      startVertex >= search->graph->numVertices ||
+      search->graph->vertices[startVertex] == NULL) {
+    return false;
+  }
+
+  // every reached vertex is the source, a tree edge's head, or in the heap
+  forgetVertex(search, search->source);
+  for (int i = 0; i < search->numTreeEdges; i++) {
+    forgetVertex(search, search->tree[i].toVertex);
+  }
+  for (int i = 1; i <= search->heap->size; i++) {
+    forgetVertex(search, search->heap->arr[i].id);
+  }
+
+  search->source = startVertex;
+  search->heap->size = 0;
+  search->numTreeEdges = 0;
+  search->numSettled = 0;
+  atomic_store(&search->cancelled, false);
+
+  search->distances[startVertex] = 0;
+  insert(search->heap, 0, startVertex);
+
+  return true;
+}
+
+void deleteDijkstraSearch(DijkstraSearch* search) {
+  if (search == NULL) return;
+
+  deleteHeap(search->heap);
+  free(search->finished);
+  free(search->predecessors);
+  free(search->predWeights);
+  free(search->distances);
+  free(search->tree);
+  free(search);
+}
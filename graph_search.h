@@ -0,0 +1,90 @@
+/*
+ * Header file for incremental Dijkstra searches.
+ *
+ * A DijkstraSearch keeps the heap, finished and predecessors state of one
+ * run of Dijkstra's algorithm between calls, so a search can settle a few
+ * vertices, be put aside, and be resumed later from where it stopped.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+#include "minheap.h"
+
+#ifndef __Graph_Search_header
+#define __Graph_Search_header
+
+typedef enum search_status {
+  SEARCH_PAUSED,    // the budget ran out; the search can be resumed
+  SEARCH_DONE,      // every vertex reachable from the source is finished
+  SEARCH_CANCELLED  // the search was cancelled and will not settle more
+} SearchStatus;
+
+typedef struct dijkstra_search {
+  Graph* graph;           // graph being searched
+  int source;             // ID of the start vertex
+  MinHeap* heap;          // priority queue of reached, unfinished vertices
+  bool* finished;         // finished[id] is true iff vertex id is finished
+  int* predecessors;      // predecessors[id] is the predecessor of id
+  int* predWeights;       // predWeights[id] is the weight of the edge from
+                          //   predecessors[id] to id
+  int* distances;         // distances[id] is the tentative distance of id,
+                          //   or INT_MAX if id is not reached yet
+  Edge* tree;             // distance tree edges of the finished vertices
+  int numTreeEdges;       // number of edges in 'tree'
+  int numSettled;         // number of finished vertices
+  atomic_bool cancelled;  // set by cancelDijkstraSearch
+} DijkstraSearch;
+
+/* Returns a new search on Graph 'graph' from vertex with ID 'startVertex'
+ * that has not settled any vertex yet.
+ * Returns NULL if 'startVertex' is not valid in 'graph'.
+ */
+DijkstraSearch* newDijkstraSearch(Graph* graph, int startVertex);
+
+/* Settles the next vertex of 'search' and returns its ID, storing its
+ * distance in 'distance' if not NULL. Returns -1 if the search is done or
+ * cancelled.
+ */
+int nextSettledVertex(DijkstraSearch* search, int* distance);
+
+/* Settles vertices of 'search' until it is done or cancelled, 'maxSteps'
+ * vertices have been settled in this call, or 'maxSeconds' seconds have
+ * passed. A budget <= 0 means no limit. The IDs of the vertices settled in
+ * this call are stored in 'settled' (if not NULL, with room for 'maxSteps'
+ * IDs, or for as many IDs as the graph has vertices if 'maxSteps' <= 0)
+ * and their number in 'numSettled' (if not NULL).
+ * Returns SEARCH_PAUSED if the search can be resumed with another call.
+ */
+SearchStatus runDijkstraSearch(DijkstraSearch* search, int maxSteps,
+                               double maxSeconds, int* settled,
+                               int* numSettled);
+
+/* Cancels 'search'; it settles no more vertices after its current step.
+ * May be called from any thread.
+ */
+void cancelDijkstraSearch(DijkstraSearch* search);
+
+/* Returns the status of 'search' without settling anything. */
+SearchStatus getSearchStatus(DijkstraSearch* search);
+
+/* Returns the distance tree of the vertices 'search' has finished so far,
+ * in the format of getDistanceTreeDijkstra, and stores its number of edges
+ * in 'numTreeEdges'. The caller owns the returned array.
+ */
+Edge* getSearchDistanceTree(DijkstraSearch* search, int* numTreeEdges);
+
+/* Restarts 'search' from vertex with ID 'startVertex', discarding its
+ * state, so one search can serve many queries. Costs only as much as the
+ * number of vertices the previous run reached.
+ * Returns false, leaving 'search' unchanged, if 'startVertex' is not valid.
+ */
+bool restartDijkstraSearch(DijkstraSearch* search, int startVertex);
+
+/* Frees all memory allocated for 'search'. */
+void deleteDijkstraSearch(DijkstraSearch* search);
+
+#endif
@@ -0,0 +1,432 @@
+/*
+ *  A long-running server that loads a graph once and answers shortest path,
+ *  distance tree, isochrone and MST weight queries over a Unix domain
+ *  socket, using the protocol in graph_protocol.h.
+ *
+ *  Every connection has a reader thread that queues its requests; a pool of
+ *  worker threads answers them, each with its own reusable DijkstraSearch,
+ *  and writes responses as soon as they are ready. On machines with several
+ *  NUMA nodes the workers are pinned to the nodes in turn, so the search
+ *  each one allocates stays on its node; the server reports how many could
+ *  be pinned once all have started.
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O2 -Wall -Werror -pthread graph.c minheap.c graph_algos.c \
+ *       graph_io.c graph_search.c graph_protocol.c graph_components.c \
+ *       graph_memory.c graph_server.c -o graph_server
+ *
+ *   Run:
+ *   ./graph_server sample_input.txt /tmp/graph.sock [numWorkers]
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "graph.h"
+#include "graph_algos.h"
+#include "graph_components.h"
+#include "graph_io.h"
+#include "graph_memory.h"
+#include "graph_protocol.h"
+#include "graph_search.h"
+
+#define NOTHING -1
+#define DEFAULT_WORKERS 4
+#define LISTEN_BACKLOG 64
+
+typedef struct connection {
+  int fd;                     // socket of this client
+  pthread_mutex_t writeLock;  // serializes responses on 'fd'
+  pthread_mutex_t lock;       // protects 'pending'
+  pthread_cond_t idle;        // signalled when 'pending' drops to 0
+  int pending;                // number of queued or running requests
+} Connection;
+
+typedef struct job {  // a request waiting for a worker
+  Request request;   // the request to answer
+  Connection* conn;  // where to send the response
+  struct job* next;  // the next job in the queue
+} Job;
+
+typedef struct job_queue {
+  Job* head;                // oldest job, or NULL if empty
+  Job* tail;                // newest job, or NULL if empty
+  pthread_mutex_t lock;     // protects this queue
+  pthread_cond_t nonEmpty;  // signalled when a job is added
+} JobQueue;
+
+typedef struct server {
+  Graph* graph;               // the graph all queries run on
+  Components* components;     // its connected components, found at startup
+  long long mstWeight;        // total weight of the minimum spanning forest,
+                              //   computed at startup
+  JobQueue queue;             // requests waiting for a worker
+  int numStarted;             // workers that have tried to pin themselves
+  int numPinned;              // workers pinned to their NUMA node
+  pthread_mutex_t startLock;  // protects 'numStarted' and 'numPinned'
+  pthread_cond_t started;     // signalled when a worker has started
+} Server;
+
+typedef struct worker {  // state owned by one worker thread
+  Server* server;          // the server this worker belongs to
+  int node;                // NUMA node to pin this worker to, or -1
+  DijkstraSearch* search;  // reusable search, NULL until first needed
+  int32_t* items;          // response items being built
+  int numValues;           // number of int32 values in 'items'
+  int capacity;            // number of int32 values that fit in 'items'
+} Worker;
+
+/* request handling */
+void* runWorker(void* arg);
+void answerRequest(Worker* worker, Request* request, ResponseHeader* header);
+bool startSearch(Worker* worker, int source);
+void addItem(Worker* worker, int32_t a, int32_t b, int32_t c, int itemSize);
+
+/* connections */
+void* runConnection(void* arg);
+void pushJob(JobQueue* queue, Job* job);
+Job* popJob(JobQueue* queue);
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    printf("Usage: %s graph_file socket_path [numWorkers]\n", argv[0]);
+    return 1;
+  }
+  int numWorkers = argc > 3 ? atoi(argv[3]) : DEFAULT_WORKERS;
+  if (numWorkers < 1) numWorkers = 1;
+
+  FILE* f = fopen(argv[1], "r");
+  if (f == NULL) {
+    fprintf(stderr, "Unable to open the specified input file: %s\n", argv[1]);
+    return 1;
+  }
+  Graph* graph = createGraph(f);
+  fclose(f);
+  if (graph == NULL) return 1;
+
+  Server server;
+  server.graph = graph;
+  server.components = getConnectedComponents(graph, numWorkers);
+  SpanningForest* forest =
+      getMinimumSpanningForest(graph, server.components, numWorkers);
+  server.mstWeight = forest->totalWeight;
+  deleteSpanningForest(forest);
+  server.queue.head = NULL;
+  server.queue.tail = NULL;
+  pthread_mutex_init(&server.queue.lock, NULL);
+  pthread_cond_init(&server.queue.nonEmpty, NULL);
+  server.numStarted = 0;
+  server.numPinned = 0;
+  pthread_mutex_init(&server.startLock, NULL);
+  pthread_cond_init(&server.started, NULL);
+
+  signal(SIGPIPE, SIG_IGN);  // a client may hang up before its responses
+
+  int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, argv[2], sizeof(addr.sun_path) - 1);
+  unlink(argv[2]);
+  if (listenFd < 0 ||
+      bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+      listen(listenFd, LISTEN_BACKLOG) != 0) {
+    fprintf(stderr, "Unable to listen on socket: %s\n", argv[2]);
+    return 1;
+  }
+
+  int numNodes = getNumaNodeCount();
+  for (int i = 0; i < numWorkers; i++) {
+    Worker* worker = (Worker*)calloc(1, sizeof(Worker));
+    if (worker == NULL) {
+      printf("Error: Memory allocation failed for worker\n");
+      exit(1);
+    }
+    worker->server = &server;
+    worker->node = numNodes > 1 ? i % numNodes : NOTHING;
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, runWorker, worker) != 0) {
+      printf("Error: Could not create worker thread\n");
+      exit(1);
+    }
+    pthread_detach(thread);
+  }
+
+  printf("Serving %d vertices in %d components on %s with %d workers.\n",
+         graph->numVertices, server.components->numComponents, argv[2],
+         numWorkers);
+  printf("Minimum spanning forest weight: %lld.\n", server.mstWeight);
+  pthread_mutex_lock(&server.startLock);
+  while (server.numStarted < numWorkers) {
+    pthread_cond_wait(&server.started, &server.startLock);
+  }
+  int numPinned = server.numPinned;
+  pthread_mutex_unlock(&server.startLock);
+  if (numNodes <= 1) {
+    printf("Single NUMA node; workers not pinned.\n");
+  } else if (numPinned == numWorkers) {
+    printf("Workers pinned to %d NUMA nodes in turn.\n", numNodes);
+  } else {
+    printf("Pinned %d of %d workers to %d NUMA nodes; pinning skipped for "
+           "the others.\n", numPinned, numWorkers, numNodes);
+  }
+  fflush(stdout);
+
+  while (true) {
+    int fd = accept(listenFd, NULL, NULL);
+    if (fd < 0) continue;
+
+    Connection* conn = (Connection*)malloc(sizeof(Connection));
+    if (conn == NULL) {
+      printf("Error: Memory allocation failed for connection\n");
+      exit(1);
+    }
+    conn->fd = fd;
+    conn->pending = 0;
+    pthread_mutex_init(&conn->writeLock, NULL);
+    pthread_mutex_init(&conn->lock, NULL);
+    pthread_cond_init(&conn->idle, NULL);
+
+    void** args = (void**)malloc(sizeof(void*) * 2);
+    if (args == NULL) {
+      printf("Error: Memory allocation failed for connection\n");
+      exit(1);
+    }
+    args[0] = &server;
+    args[1] = conn;
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, runConnection, args) != 0) {
+      printf("Error: Could not create connection thread\n");
+      exit(1);
+    }
+    pthread_detach(thread);
+  }
+}
+
+/* Reads requests from one connection and queues them until the client
+ * hangs up, then waits for its outstanding responses and closes it.
+ * 'arg' is an array holding the Server and the Connection.
+ */
+void* runConnection(void* arg) {
+  void** args = (void**)arg;
+  Server* server = (Server*)args[0];
+  Connection* conn = (Connection*)args[1];
+  free(args);
+
+  Request request;
+  while (readFully(conn->fd, &request, sizeof(Request))) {
+    Job* job = (Job*)malloc(sizeof(Job));
+    if (job == NULL) {
+      printf("Error: Memory allocation failed for job\n");
+      exit(1);
+    }
+    job->request = request;
+    job->conn = conn;
+
+    pthread_mutex_lock(&conn->lock);
+    conn->pending++;
+    pthread_mutex_unlock(&conn->lock);
+    pushJob(&server->queue, job);
+  }
+
+  pthread_mutex_lock(&conn->lock);
+  while (conn->pending > 0) pthread_cond_wait(&conn->idle, &conn->lock);
+  pthread_mutex_unlock(&conn->lock);
+
+  close(conn->fd);
+  pthread_mutex_destroy(&conn->writeLock);
+  pthread_mutex_destroy(&conn->lock);
+  pthread_cond_destroy(&conn->idle);
+  free(conn);
+  return NULL;
+}
+
+/* Appends 'job' to 'queue' and wakes up a worker. */
+void pushJob(JobQueue* queue, Job* job) {
+  job->next = NULL;
+  pthread_mutex_lock(&queue->lock);
+  if (queue->tail == NULL) {
+    queue->head = job;
+  } else {
+    queue->tail->next = job;
+  }
+  queue->tail = job;
+  pthread_cond_signal(&queue->nonEmpty);
+  pthread_mutex_unlock(&queue->lock);
+}
+
+/* Removes and returns the oldest job in 'queue', waiting for one if the
+ * queue is empty.
+ */
+Job* popJob(JobQueue* queue) {
+  pthread_mutex_lock(&queue->lock);
+  while (queue->head == NULL) {
+    pthread_cond_wait(&queue->nonEmpty, &queue->lock);
+  }
+  Job* job = queue->head;
+  queue->head = job->next;
+  if (queue->head == NULL) queue->tail = NULL;
+  pthread_mutex_unlock(&queue->lock);
+  return job;
+}
+
+/* Answers queued requests forever. 'arg' is this thread's Worker. */
+void* runWorker(void* arg) {
+  Worker* worker = (Worker*)arg;
+  Server* server = worker->server;
+  bool pinned = worker->node != NOTHING && pinThreadToNode(worker->node);
+  if (worker->node != NOTHING && !pinned) {
+    fprintf(stderr, "Could not pin a worker to NUMA node %d\n", worker->node);
+  }
+  pthread_mutex_lock(&server->startLock);
+  server->numStarted++;
+  if (pinned) server->numPinned++;
+  pthread_cond_signal(&server->started);
+  pthread_mutex_unlock(&server->startLock);
+
+  while (true) {
+    Job* job = popJob(&server->queue);
+    Connection* conn = job->conn;
+
+    ResponseHeader header;
+    worker->numValues = 0;
+    answerRequest(worker, &job->request, &header);
+
+    pthread_mutex_lock(&conn->writeLock);
+    writeFully(conn->fd, &header, sizeof(ResponseHeader));
+    writeFully(conn->fd, worker->items, sizeof(int32_t) * worker->numValues);
+    pthread_mutex_unlock(&conn->writeLock);
+
+    pthread_mutex_lock(&conn->lock);
+    conn->pending--;
+    if (conn->pending == 0) pthread_cond_signal(&conn->idle);
+    pthread_mutex_unlock(&conn->lock);
+    free(job);
+  }
+  return NULL;
+}
+
+/* Appends an item of 'itemSize' (2 or 3) values to the response of
+ * 'worker'.
+ */
+void addItem(Worker* worker, int32_t a, int32_t b, int32_t c, int itemSize) {
+  if (worker->numValues + itemSize > worker->capacity) {
+    worker->capacity = worker->capacity == 0 ? 256 : worker->capacity * 2;
+    worker->items = (int32_t*)realloc(worker->items,
+                                      sizeof(int32_t) * worker->capacity);
+    if (worker->items == NULL) {
+      printf("Error: Memory allocation failed for response items\n");
+      exit(1);
+    }
+  }
+  worker->items[worker->numValues++] = a;
+  worker->items[worker->numValues++] = b;
+  if (itemSize == 3) worker->items[worker->numValues++] = c;
+}
+
+/* Points the search of 'worker' at vertex 'source'. Returns false if
+ * 'source' is not a valid vertex.
+ */
+bool startSearch(Worker* worker, int source) {
+  if (worker->search == NULL) {
+    worker->search = newDijkstraSearch(worker->server->graph, source);
+    return worker->search != NULL;
+  }
+  return restartDijkstraSearch(worker->search, source);
+}
+
+/* Computes the answer to 'request' into 'header' and the items of
+ * 'worker'.
+ */
+void answerRequest(Worker* worker, Request* request, ResponseHeader* header) {
+  Graph* graph = worker->server->graph;
+  DijkstraSearch* search;
+
+  header->requestId = request->requestId;
+  header->type = request->type;
+  header->status = RESPONSE_OK;
+  header->value = 0;
+  header->numItems = 0;
+  header->itemSize = 0;
+
+  switch (request->type) {
+    case REQUEST_INFO:
+      header->value = graph->numVertices;
+      return;
+
+    case REQUEST_MST_WEIGHT:
+      header->value = worker->server->mstWeight;
+      return;
+
+    case REQUEST_PATH: {
+      int target = request->target;
+      if (target < 0 || target >= graph->numVertices ||
+          !startSearch(worker, request->source)) {
+        break;
+      }
+      if (!areConnected(worker->server->components, request->source,
+                        target)) {
+        header->status = RESPONSE_UNREACHABLE;
+        return;
+      }
+      search = worker->search;
+
+      int vertex;
+      do {
+        vertex = nextSettledVertex(search, NULL);
+      } while (vertex != NOTHING && vertex != target);
+      if (vertex == NOTHING) {
+        header->status = RESPONSE_UNREACHABLE;
+        return;
+      }
+
+      header->value = search->distances[target];
+      header->itemSize = 3;
+      for (int v = target; v != search->source;
+           v = search->predecessors[v]) {
+        addItem(worker, search->predecessors[v], v, search->predWeights[v],
+                3);
+        header->numItems++;
+      }
+      return;
+    }
+
+    case REQUEST_TREE:
+      if (!startSearch(worker, request->source)) break;
+      search = worker->search;
+
+      runDijkstraSearch(search, 0, 0, NULL, NULL);
+      header->itemSize = 3;
+      header->numItems = search->numTreeEdges;
+      for (int i = 0; i < search->numTreeEdges; i++) {
+        Edge* edge = &search->tree[i];
+        addItem(worker, edge->fromVertex, edge->toVertex, edge->weight, 3);
+      }
+      return;
+
+    case REQUEST_ISOCHRONE:
+      if (!startSearch(worker, request->source)) break;
+      search = worker->search;
+
+      header->itemSize = 2;
+      int distance;
+      int vertex;
+      while ((vertex = nextSettledVertex(search, &distance)) != NOTHING &&
+             distance <= request->limit) {
+        addItem(worker, vertex, distance, 0, 2);
+        header->numItems++;
+      }
+      return;
+  }
+
+  header->status = RESPONSE_BAD_REQUEST;
+}
@@ -0,0 +1,264 @@
+/*
+ * Copy-on-write graph snapshots with epoch-based reclamation.
+ *
+ * A reader pins by announcing the current epoch in its slot and then
+ * loading the current version. A writer replaces the current version,
+ * tags the old one with the epoch at that moment, and then advances the
+ * epoch. A reader that announced a later epoch must have loaded a newer
+ * version, so a retired version can be freed once every pinned reader
+ * announced an epoch later than its tag.
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#include "graph_snapshot.h"
+
+/*************************************************************************
+ ** Copying vertices
+ *************************************************************************/
+
+/* Returns a copy of the list starting at 'head', in the same order. */
+static EdgeList* copyEdgeList(EdgeList* head) {
+  EdgeList* copy = NULL;
+  EdgeList** tail = &copy;
+  for (EdgeList* e = head; e != NULL; e = e->next) {
+    *tail = newEdgeList(
+        newEdge(e->edge->fromVertex, e->edge->toVertex, e->edge->weight),
+        NULL);
+    tail = &(*tail)->next;
+  }
+  return copy;
+}
+
+/* Returns the vertex with ID 'id' of 'graph', which is being built as
+ * version 'version', copying it first unless this version already did.
+ * Replaced vertices are added to 'replaced', whose length is
+ * 'numReplaced'.
+ */
+static Vertex* getWritableVertex(SnapshotStore* store, Graph* graph, int id,
+                                 unsigned long version, Vertex** replaced,
+                                 int* numReplaced) {
+  if (store->copiedIn[id] == version) return graph->vertices[id];
+
+  Vertex* old = graph->vertices[id];
+  Vertex* copy = old == NULL
+                     ? newVertex(id, NULL, NULL)
+                     : newVertex(id, old->value, copyEdgeList(old->adjList));
+  if (old != NULL) replaced[(*numReplaced)++] = old;
+  graph->vertices[id] = copy;
+  store->copiedIn[id] = version;
+  return copy;
+}
+
+/* Removes every edge to vertex with ID 'to' from the list of 'vertex', and
+ * returns the number removed.
+ */
+static int removeEdgesTo(Vertex* vertex, int to) {
+  int numRemoved = 0;
+  EdgeList** link = &vertex->adjList;
+  while (*link != NULL) {
+    EdgeList* node = *link;
+    if (node->edge->toVertex == to) {
+      *link = node->next;
+      free(node->edge);
+      free(node);
+      numRemoved++;
+    } else {
+      link = &node->next;
+    }
+  }
+  return numRemoved;
+}
+
+/*************************************************************************
+ ** Reclamation
+ *************************************************************************/
+
+/* Frees 'retired': its graph's vertex array, and the vertices of its graph
+ * that the next version copied rather than shared.
+ */
+static void freeRetiredSnapshot(RetiredSnapshot* retired) {
+  for (int i = 0; i < retired->numReplaced; i++) {
+    deleteVertex(retired->replaced[i]);
+  }
+  free(retired->replaced);
+  free(retired->snapshot->graph->vertices);
+  free(retired->snapshot->graph);
+  free(retired->snapshot);
+  free(retired);
+}
+
+/* Frees the retired versions of 'store' that no reader can still use.
+ * The caller must hold the write lock.
+ */
+static int reclaimLocked(SnapshotStore* store) {
+  unsigned long oldest = ULONG_MAX;
+  for (int r = 0; r < store->maxReaders; r++) {
+    unsigned long epoch = atomic_load(&store->readerEpochs[r]);
+    if (epoch != 0 && epoch < oldest) oldest = epoch;
+  }
+
+  // 'retired' is newest first, so everything after the first version
+  // that is safe to free is safe as well
+  RetiredSnapshot** link = &store->retired;
+  while (*link != NULL && (*link)->epoch >= oldest) link = &(*link)->next;
+
+  int numFreed = 0;
+  RetiredSnapshot* retired = *link;
+  *link = NULL;
+  while (retired != NULL) {
+    RetiredSnapshot* next = retired->next;
+    freeRetiredSnapshot(retired);
+    numFreed++;
+    retired = next;
+  }
+  store->numRetired -= numFreed;
+  return numFreed;
+}
+
+/*************************************************************************
+ ** Snapshot store
+ *************************************************************************/
+
+SnapshotStore* newSnapshotStore(Graph* graph, int maxReaders) {
+  SnapshotStore* store = (SnapshotStore*)malloc(sizeof(SnapshotStore));
+  GraphSnapshot* snapshot = (GraphSnapshot*)malloc(sizeof(GraphSnapshot));
+  if (store == NULL || snapshot == NULL) {
+    printf("Error: Memory allocation failed for snapshot store\n");
+    exit(1);
+  }
+  if (maxReaders < 0) maxReaders = 0;
+
+  snapshot->graph = graph;
+  snapshot->version = 0;
+  atomic_init(&store->current, snapshot);
+  atomic_init(&store->epoch, 1);
+  store->maxReaders = maxReaders;
+  store->readerEpochs =
+      (atomic_ulong*)malloc(sizeof(atomic_ulong) * (maxReaders + 1));
+  store->copiedIn =
+      (unsigned long*)calloc(graph->numVertices + 1, sizeof(unsigned long));
+  if (store->readerEpochs == NULL || store->copiedIn == NULL) {
+    printf("Error: Memory allocation failed for snapshot store arrays\n");
+    exit(1);
+  }
+  for (int r = 0; r < maxReaders; r++) {
+    atomic_init(&store->readerEpochs[r], 0);
+  }
+  pthread_mutex_init(&store->writeLock, NULL);
+  store->retired = NULL;
+  store->numRetired = 0;
+
+  return store;
+}
+
+GraphSnapshot* pinSnapshot(SnapshotStore* store, int reader) {
+  if (reader < 0 || reader >= store->maxReaders) return NULL;
+
+  atomic_store(&store->readerEpochs[reader], atomic_load(&store->epoch));
+  return atomic_load(&store->current);
+}
+
+void unpinSnapshot(SnapshotStore* store, int reader) {
+  if (reader < 0 || reader >= store->maxReaders) return;
+
+  atomic_store(&store->readerEpochs[reader], 0);
+}
+
+bool publishEdgeUpdates(SnapshotStore* store, EdgeUpdate* updates,
+                        int numUpdates) {
+  pthread_mutex_lock(&store->writeLock);
+  GraphSnapshot* old = atomic_load(&store->current);
+  int numVertices = old->graph->numVertices;
+  for (int i = 0; i < numUpdates; i++) {
+    EdgeUpdate* update = &updates[i];
+    if (update->fromVertex < 0 || update->fromVertex >= numVertices ||
+        update->toVertex < 0 || update->toVertex >= numVertices ||
+        (update->type == EDGE_INSERT && update->weight < 0)) {
+      pthread_mutex_unlock(&store->writeLock);
+      return false;
+    }
+  }
+
+  // the new version shares every vertex until an update touches it
+  GraphSnapshot* snapshot = (GraphSnapshot*)malloc(sizeof(GraphSnapshot));
+  Graph* graph = (Graph*)malloc(sizeof(Graph));
+  Vertex** vertices = (Vertex**)malloc(sizeof(Vertex*) * (numVertices + 1));
+  Vertex** replaced = (Vertex**)malloc(sizeof(Vertex*) * (numUpdates + 1));
+  if (snapshot == NULL || graph == NULL || vertices == NULL ||
+      replaced == NULL) {
+    printf("Error: Memory allocation failed for graph snapshot\n");
+    exit(1);
+  }
+  if (numVertices > 0) {
+    memcpy(vertices, old->graph->vertices, sizeof(Vertex*) * numVertices);
+  }
+  graph->numVertices = numVertices;
+  graph->numEdges = old->graph->numEdges;
+  graph->vertices = vertices;
+  snapshot->graph = graph;
+  snapshot->version = old->version + 1;
+
+  int numReplaced = 0;
+  for (int i = 0; i < numUpdates; i++) {
+    EdgeUpdate* update = &updates[i];
+    Vertex* vertex =
+        getWritableVertex(store, graph, update->fromVertex, snapshot->version,
+                          replaced, &numReplaced);
+    if (update->type == EDGE_INSERT) {
+      vertex->adjList = newEdgeList(
+          newEdge(update->fromVertex, update->toVertex, update->weight),
+          vertex->adjList);
+      graph->numEdges++;
+    } else {
+      graph->numEdges -= removeEdgesTo(vertex, update->toVertex);
+    }
+  }
+
+  RetiredSnapshot* retired =
+      (RetiredSnapshot*)malloc(sizeof(RetiredSnapshot));
+  if (retired == NULL) {
+    printf("Error: Memory allocation failed for retired snapshot\n");
+    exit(1);
+  }
+  retired->snapshot = old;
+  retired->replaced = replaced;
+  retired->numReplaced = numReplaced;
+
+  atomic_store(&store->current, snapshot);
+  retired->epoch = atomic_fetch_add(&store->epoch, 1);
+  retired->next = store->retired;
+  store->retired = retired;
+  store->numRetired++;
+
+  reclaimLocked(store);
+  pthread_mutex_unlock(&store->writeLock);
+  return true;
+}
+
+int reclaimSnapshots(SnapshotStore* store) {
+  pthread_mutex_lock(&store->writeLock);
+  int numFreed = reclaimLocked(store);
+  pthread_mutex_unlock(&store->writeLock);
+  return numFreed;
+}
+
+void deleteSnapshotStore(SnapshotStore* store) {
+  if (store == NULL) return;
+
+  RetiredSnapshot* retired = store->retired;
+  while (retired != NULL) {
+    RetiredSnapshot* next = retired->next;
+    freeRetiredSnapshot(retired);
+    retired = next;
+  }
+
+  GraphSnapshot* current = atomic_load(&store->current);
+  deleteGraph(current->graph);
+  free(current);
+  free(store->readerEpochs);
+  free(store->copiedIn);
+  pthread_mutex_destroy(&store->writeLock);
+  free(store);
+}
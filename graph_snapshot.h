@@ -0,0 +1,92 @@
+/*
+ * Header file for copy-on-write graph snapshots.
+ *
+ * A SnapshotStore publishes a sequence of read-only versions of a graph.
+ * Each version is an ordinary Graph, so getDistanceTreeDijkstra, getMSTprim
+ * and the rest run on it unchanged. Publishing a batch of edge updates
+ * copies only the vertices the batch touches; all other Vertex objects are
+ * shared with the previous version.
+ *
+ * Readers pin the current version without taking a lock. Versions that
+ * have been replaced are freed once no reader that might still be using
+ * them remains pinned (epoch-based reclamation).
+ *
+ * Compile with -pthread.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+#include "graph_dynamic.h"
+
+#ifndef __Graph_Snapshot_header
+#define __Graph_Snapshot_header
+
+typedef struct graph_snapshot {
+  Graph* graph;           // this version of the graph; must not be modified
+  unsigned long version;  // 0 for the initial graph, then 1, 2, ...
+} GraphSnapshot;
+
+typedef struct retired_snapshot {  // a replaced version waiting to be freed
+  GraphSnapshot* snapshot;        // the replaced version
+  Vertex** replaced;              // its vertices that the next version
+  int numReplaced;                //   copied, and their number
+  unsigned long epoch;            // epoch in which it was replaced
+  struct retired_snapshot* next;  // the next older retired version
+} RetiredSnapshot;
+
+typedef struct snapshot_store {
+  _Atomic(GraphSnapshot*) current;  // the latest published version
+  atomic_ulong epoch;               // current epoch, starting at 1
+  atomic_ulong* readerEpochs;       // readerEpochs[r] is the epoch reader r
+                                    //   pinned in, or 0 if not pinned
+  int maxReaders;                   // number of reader slots
+  pthread_mutex_t writeLock;        // serializes publishing and reclaiming
+  RetiredSnapshot* retired;         // replaced versions, newest first
+  int numRetired;                   // number of versions in 'retired'
+  unsigned long* copiedIn;          // copiedIn[id] is the version in which
+                                    //   vertex id was last copied
+} SnapshotStore;
+
+/* Returns a new store whose version 0 is Graph 'graph', with slots for
+ * 'maxReaders' concurrent readers. The store takes ownership of 'graph',
+ * which must not be modified or freed afterwards.
+ */
+SnapshotStore* newSnapshotStore(Graph* graph, int maxReaders);
+
+/* Pins the latest version of 'store' for reader slot 'reader' and returns
+ * it. The version stays valid until unpinSnapshot is called with the same
+ * slot. Each slot must be used by one thread at a time, and a slot pins at
+ * most one version at a time.
+ * Returns NULL if 'reader' is not a valid slot.
+ */
+GraphSnapshot* pinSnapshot(SnapshotStore* store, int reader);
+
+/* Releases the version pinned by reader slot 'reader' of 'store'. */
+void unpinSnapshot(SnapshotStore* store, int reader);
+
+/* Publishes a new version of 'store': the latest version with the
+ * 'numUpdates' updates in 'updates' applied in order, as described for
+ * applyEdgeUpdates. Inserted edges go to the front of adjacency lists.
+ * Replaced versions that no reader can still use are freed.
+ * Returns false, and publishes nothing, if any update names an invalid
+ * vertex or inserts an edge with negative weight.
+ */
+bool publishEdgeUpdates(SnapshotStore* store, EdgeUpdate* updates,
+                        int numUpdates);
+
+/* Frees every replaced version of 'store' that no reader can still use, and
+ * returns the number of versions freed.
+ */
+int reclaimSnapshots(SnapshotStore* store);
+
+/* Frees all memory allocated for 'store', including every version of the
+ * graph. No reader may have a version pinned.
+ */
+void deleteSnapshotStore(SnapshotStore* store);
+
+#endif
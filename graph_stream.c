@@ -0,0 +1,203 @@
+/*
+ * Minimum spanning forests of edge streams.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "graph_stream.h"
+
+#define NOTHING -1
+#define RADIX_BITS 8                   // bits of the weight per sorting pass
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+/* Returns the current time in seconds on a monotonic clock. */
+static double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Returns the root of the component of 'id' in union-find 'parents',
+ * where a root holds minus the size of its component, halving the path on
+ * the way.
+ */
+static int findRoot(int* parents, int id) {
+  while (parents[id] >= 0) {
+    int parent = parents[id];
+    if (parents[parent] >= 0) parents[id] = parents[parent];
+    id = parent;
+  }
+  return id;
+}
+
+/* Sorts the 'numEdges' Edges in 'edges' by weight, keeping the order of
+ * equal weights, with a radix sort on one byte at a time that skips the
+ * bytes all weights share. 'scratch' needs room for 'numEdges' Edges.
+ */
+static void sortByWeight(Edge* edges, int numEdges, Edge* scratch) {
+  Edge* source = edges;
+  Edge* target = scratch;
+  for (int shift = 0; shift < 32; shift += RADIX_BITS) {
+    int counts[RADIX_BUCKETS] = {0};
+    for (int i = 0; i < numEdges; i++) {
+      counts[((unsigned)source[i].weight >> shift) & (RADIX_BUCKETS - 1)]++;
+    }
+    int first = ((unsigned)source[0].weight >> shift) & (RADIX_BUCKETS - 1);
+    if (counts[first] == numEdges) continue;  // every weight has this byte
+
+    int offset = 0;
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+      int count = counts[b];
+      counts[b] = offset;
+      offset += count;
+    }
+    for (int i = 0; i < numEdges; i++) {
+      int b = ((unsigned)source[i].weight >> shift) & (RADIX_BUCKETS - 1);
+      target[counts[b]++] = source[i];
+    }
+    Edge* swap = source;
+    source = target;
+    target = swap;
+  }
+  if (source != edges) memcpy(edges, source, sizeof(Edge) * numEdges);
+}
+
+/* Replaces the candidate forest and the chunk of 'forest' by a minimum
+ * spanning forest of both: sorts the chunk, and merges it with a copy of
+ * the forest while Kruskal's algorithm picks the edges to keep. The edges
+ * kept never overtake the chunk edges still to be read, so they are
+ * written over the chunk in place.
+ */
+static void filterStreamingForest(StreamingForest* forest) {
+  int numForest = forest->numForest;
+  int numEdges = forest->numEdges;
+  if (numEdges == numForest) return;
+
+  Edge* edges = forest->edges;
+  sortByWeight(&edges[numForest], numEdges - numForest, forest->scratch);
+  memcpy(forest->scratch, edges, sizeof(Edge) * numForest);
+  for (int id = 0; id < forest->numVertices; id++) forest->parents[id] = -1;
+
+  int kept = 0;
+  int i = 0;          // next edge of the old forest
+  int j = numForest;  // next edge of the chunk
+  while ((i < numForest || j < numEdges) &&
+         kept < forest->numVertices - 1) {
+    Edge edge;
+    if (j == numEdges ||
+        (i < numForest && forest->scratch[i].weight <= edges[j].weight)) {
+      edge = forest->scratch[i++];
+    } else {
+      edge = edges[j++];
+    }
+    int fromRoot = findRoot(forest->parents, edge.fromVertex);
+    int toRoot = findRoot(forest->parents, edge.toVertex);
+    if (fromRoot == toRoot) continue;  // heaviest on a cycle
+    if (forest->parents[fromRoot] > forest->parents[toRoot]) {
+      int swap = fromRoot;  // hang the smaller component
+      fromRoot = toRoot;
+      toRoot = swap;
+    }
+    forest->parents[fromRoot] += forest->parents[toRoot];
+    forest->parents[toRoot] = fromRoot;
+    edges[kept++] = edge;
+  }
+
+  forest->stats.numDropped += numEdges - kept;
+  forest->stats.numFilters++;
+  forest->numForest = kept;
+  forest->numEdges = kept;
+}
+
+StreamingForest* newStreamingForest(int numVertices, int chunkSize) {
+  if (numVertices < 1 || chunkSize < 1) return NULL;
+
+  StreamingForest* forest = (StreamingForest*)malloc(sizeof(StreamingForest));
+  if (forest == NULL) {
+    printf("Error: Memory allocation failed for streaming forest\n");
+    exit(1);
+  }
+  forest->numVertices = numVertices;
+  forest->chunkSize = chunkSize;
+  forest->edges =
+      (Edge*)malloc(sizeof(Edge) * ((long long)numVertices - 1 + chunkSize));
+  forest->scratch = (Edge*)malloc(
+      sizeof(Edge) * (numVertices > chunkSize ? numVertices : chunkSize));
+  forest->parents = (int*)malloc(sizeof(int) * numVertices);
+  if (forest->edges == NULL || forest->scratch == NULL ||
+      forest->parents == NULL) {
+    printf("Error: Memory allocation failed for streaming forest\n");
+    exit(1);
+  }
+  forest->numForest = 0;
+  forest->numEdges = 0;
+  memset(&forest->stats, 0, sizeof(StreamStats));
+  return forest;
+}
+
+bool addStreamEdges(StreamingForest* forest, const Edge* edges,
+                    int numEdges) {
+  for (int i = 0; i < numEdges; i++) {
+    if (edges[i].fromVertex < 0 ||
+        edges[i].fromVertex >= forest->numVertices ||
+        edges[i].toVertex < 0 || edges[i].toVertex >= forest->numVertices ||
+        edges[i].weight < 0) {
+      return false;
+    }
+  }
+
+  double start = nowSeconds();
+  for (int i = 0; i < numEdges; i++) {
+    if (edges[i].fromVertex == edges[i].toVertex) {
+      forest->stats.numDropped++;
+      continue;
+    }
+    forest->edges[forest->numEdges++] = edges[i];
+    if (forest->numEdges - forest->numForest == forest->chunkSize) {
+      filterStreamingForest(forest);
+    }
+  }
+  forest->stats.numEdges += numEdges;
+  forest->stats.seconds += nowSeconds() - start;
+  if (forest->stats.seconds > 0) {
+    forest->stats.edgesPerSecond =
+        forest->stats.numEdges / forest->stats.seconds;
+  }
+  return true;
+}
+
+Edge* getStreamingForest(StreamingForest* forest, int* numForestEdges,
+                         long long* totalWeight) {
+  double start = nowSeconds();
+  filterStreamingForest(forest);
+  forest->stats.seconds += nowSeconds() - start;
+  if (forest->stats.seconds > 0) {
+    forest->stats.edgesPerSecond =
+        forest->stats.numEdges / forest->stats.seconds;
+  }
+
+  Edge* result = (Edge*)malloc(sizeof(Edge) * (forest->numForest + 1));
+  if (result == NULL) {
+    printf("Error: Memory allocation failed for spanning forest\n");
+    exit(1);
+  }
+  memcpy(result, forest->edges, sizeof(Edge) * forest->numForest);
+  if (numForestEdges != NULL) *numForestEdges = forest->numForest;
+  if (totalWeight != NULL) {
+    *totalWeight = 0;
+    for (int i = 0; i < forest->numForest; i++) {
+      *totalWeight += result[i].weight;
+    }
+  }
+  return result;
+}
+
+void deleteStreamingForest(StreamingForest* forest) {
+  if (forest == NULL) return;
+
+  free(forest->edges);
+  free(forest->scratch);
+  free(forest->parents);
+  free(forest);
+}
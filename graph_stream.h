@@ -0,0 +1,70 @@
+/*
+ * Header file for minimum spanning forests of edge streams.
+ *
+ * A StreamingForest takes the edges of an undirected graph in chunks, in
+ * any order and each edge once, and never holds more than the current
+ * candidate forest plus one chunk. Whenever a chunk fills up, the candidate
+ * forest and the chunk are filtered by the cycle property: the chunk is
+ * radix sorted by weight and merged with the forest, which is kept sorted,
+ * and Kruskal's algorithm with a fresh union-find keeps an edge only if
+ * its ends are not joined yet by lighter edges. Every edge dropped is the
+ * heaviest on some cycle, so it is in no minimum spanning forest of the
+ * whole stream, and what is kept is a minimum spanning forest of all edges
+ * seen so far. Memory is O(numVertices + chunkSize); a chunk of about the
+ * number of vertices keeps the cost of a filter proportional to the chunk.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Stream_header
+#define __Graph_Stream_header
+
+typedef struct stream_stats {
+  long long numEdges;     // edges added so far
+  long long numDropped;   // self-loops and edges dropped by the filters
+  int numFilters;         // number of filters run
+  double seconds;         // time spent adding and filtering edges
+  double edgesPerSecond;  // numEdges / seconds
+} StreamStats;
+
+typedef struct streaming_forest {
+  int numVertices;    // total number of vertices
+  int chunkSize;      // edges taken between two filters
+  Edge* edges;        // the candidate forest, sorted, then the chunk
+  int numForest;      // number of edges of the candidate forest
+  int numEdges;       // number of edges in 'edges'
+  Edge* scratch;      // room for a copy of the forest or of the chunk
+  int* parents;       // union-find of the filters
+  StreamStats stats;  // work done so far
+} StreamingForest;
+
+/* Returns a new empty StreamingForest on 'numVertices' vertices that
+ * filters its edges every 'chunkSize' edges.
+ * Returns NULL if 'numVertices' < 1 or 'chunkSize' < 1.
+ */
+StreamingForest* newStreamingForest(int numVertices, int chunkSize);
+
+/* Adds the 'numEdges' edges in 'edges' to the stream of 'forest', ignoring
+ * their directions and dropping self-loops.
+ * Returns false, adding no edge, if an edge has an end that is not valid
+ * in 'forest' or a negative weight.
+ */
+bool addStreamEdges(StreamingForest* forest, const Edge* edges, int numEdges);
+
+/* Returns a minimum spanning forest of all edges added to 'forest' so far,
+ * sorted by weight, with the number of its edges in 'numForestEdges' and
+ * their total weight in 'totalWeight' (if not NULL). More edges may be
+ * added afterwards. If the edges added form a connected graph, the forest
+ * is a minimum spanning tree, of the same weight as that of getMSTprim.
+ */
+Edge* getStreamingForest(StreamingForest* forest, int* numForestEdges,
+                         long long* totalWeight);
+
+/* Frees all memory allocated for 'forest'. */
+void deleteStreamingForest(StreamingForest* forest);
+
+#endif
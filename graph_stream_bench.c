@@ -0,0 +1,196 @@
+/*
+ *  Benchmark of the streaming minimum spanning forest of graph_stream.h.
+ *
+ *  Streams the edges of a random connected graph, in random order, into a
+ *  StreamingForest for several chunk sizes, and prints the throughput in
+ *  edges per second, the number of filters, and the memory held, against
+ *  the time of getMSTprim on the whole graph. Checks that every forest
+ *  weighs as much as the tree of getMSTprim.
+ *
+ *  ---------------------------------------------------------------------------
+ *   Compile:
+ *   gcc -O3 -Wall -Werror graph.c minheap.c graph_algos.c graph_build.c \
+ *       graph_stream.c graph_stream_bench.c -o graph_stream_bench
+ *
+ *   Run:
+ *   ./graph_stream_bench [numVertices] [averageDegree]
+ *  ---------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "graph.h"
+#include "graph_algos.h"
+#include "graph_build.h"
+#include "graph_stream.h"
+
+#define DEFAULT_VERTICES 500000
+#define DEFAULT_DEGREE 16
+#define MAX_WEIGHT 1000000
+#define BATCH_EDGES 4096  // edges handed to addStreamEdges at once
+
+/* graphs */
+Edge* randomEdges(int numVertices, int numEdges, uint64_t* state);
+Graph* graphFromEdges(int numVertices, const Edge* edges, int numEdges);
+uint64_t nextRandom(uint64_t* state);
+
+/* measuring */
+bool timeStream(const Edge* edges, int numEdges, int numVertices,
+                int chunkSize, long long expected, double baseTime);
+double nowSeconds(void);
+
+int main(int argc, char* argv[]) {
+  int numVertices = argc > 1 ? atoi(argv[1]) : DEFAULT_VERTICES;
+  int degree = argc > 2 ? atoi(argv[2]) : DEFAULT_DEGREE;
+  if (numVertices < 2 || degree < 2) {
+    printf("Usage: %s [numVertices >= 2] [averageDegree >= 2]\n", argv[0]);
+    return 1;
+  }
+  int numEdges = numVertices / 2 * degree;
+
+  uint64_t state = 88172645463325252ULL;
+  Edge* edges = randomEdges(numVertices, numEdges, &state);
+  printf("%d vertices, %d edges in the stream\n\n", numVertices, numEdges);
+
+  Graph* graph = graphFromEdges(numVertices, edges, numEdges);
+  double start = nowSeconds();
+  Edge* tree = getMSTprim(graph, 0);
+  double baseTime = nowSeconds() - start;
+  long long expected = 0;
+  for (int i = 0; i < numVertices - 1; i++) expected += tree[i].weight;
+  free(tree);
+  deleteGraph(graph);
+  printf("%-22s %9.1f ms  %6.1f M edges/s  weight %lld\n", "getMSTprim",
+         1000 * baseTime, numEdges / baseTime / 1e6, expected);
+
+  int chunkSizes[] = {numVertices / 4, numVertices, 4 * numVertices};
+  bool agree = true;
+  for (int c = 0; c < 3; c++) {
+    if (chunkSizes[c] < 1) continue;
+    agree &= timeStream(edges, numEdges, numVertices, chunkSizes[c],
+                        expected, baseTime);
+  }
+
+  free(edges);
+  return agree ? 0 : 1;
+}
+
+/* Returns 'numEdges' random edges on 'numVertices' vertices with weights
+ * in [1, MAX_WEIGHT], in random order: a cycle through all vertices in
+ * random order, so that the graph is connected, plus random edges.
+ */
+Edge* randomEdges(int numVertices, int numEdges, uint64_t* state) {
+  Edge* edges = (Edge*)malloc(sizeof(Edge) * numEdges);
+  int* cycle = (int*)malloc(sizeof(int) * numVertices);
+  if (edges == NULL || cycle == NULL) {
+    printf("Error: Memory allocation failed for random edges\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) cycle[i] = i;
+  for (int i = numVertices - 1; i > 0; i--) {
+    int j = (int)(nextRandom(state) % (i + 1));
+    int swap = cycle[i];
+    cycle[i] = cycle[j];
+    cycle[j] = swap;
+  }
+  for (int i = 0; i < numEdges; i++) {
+    if (i < numVertices) {
+      edges[i].fromVertex = cycle[i];
+      edges[i].toVertex = cycle[(i + 1) % numVertices];
+    } else {
+      edges[i].fromVertex = (int)(nextRandom(state) % numVertices);
+      edges[i].toVertex = (int)(nextRandom(state) % numVertices);
+    }
+    edges[i].weight = 1 + (int)(nextRandom(state) % MAX_WEIGHT);
+  }
+  free(cycle);
+
+  // the cycle edges must not all come first
+  for (int i = numEdges - 1; i > 0; i--) {
+    int j = (int)(nextRandom(state) % (i + 1));
+    Edge swap = edges[i];
+    edges[i] = edges[j];
+    edges[j] = swap;
+  }
+  return edges;
+}
+
+/* Returns the undirected graph on 'numVertices' vertices with the
+ * 'numEdges' edges in 'edges', without self-loops.
+ */
+Graph* graphFromEdges(int numVertices, const Edge* edges, int numEdges) {
+  int* from = (int*)malloc(sizeof(int) * numEdges);
+  int* to = (int*)malloc(sizeof(int) * numEdges);
+  int* weights = (int*)malloc(sizeof(int) * numEdges);
+  if (from == NULL || to == NULL || weights == NULL) {
+    printf("Error: Memory allocation failed for graph edges\n");
+    exit(1);
+  }
+  for (int i = 0; i < numEdges; i++) {
+    from[i] = edges[i].fromVertex;
+    to[i] = edges[i].toVertex;
+    weights[i] = edges[i].weight;
+  }
+  CompactGraph* compact =
+      buildCompactGraph(numVertices, numEdges, from, to, weights,
+                        BUILD_SYMMETRIZE | BUILD_DROP_SELF_LOOPS, 1);
+  Graph* graph = newGraphFromCompact(compact);
+  deleteCompactGraph(compact);
+  free(from);
+  free(to);
+  free(weights);
+  return graph;
+}
+
+/* Streams the 'numEdges' edges in 'edges' into a StreamingForest on
+ * 'numVertices' vertices with chunks of 'chunkSize' edges, and prints its
+ * throughput against 'baseTime' and the memory it holds.
+ * Returns false if the forest does not weigh 'expected'.
+ */
+bool timeStream(const Edge* edges, int numEdges, int numVertices,
+                int chunkSize, long long expected, double baseTime) {
+  StreamingForest* forest = newStreamingForest(numVertices, chunkSize);
+  for (int i = 0; i < numEdges; i += BATCH_EDGES) {
+    int count = numEdges - i < BATCH_EDGES ? numEdges - i : BATCH_EDGES;
+    addStreamEdges(forest, &edges[i], count);
+  }
+  int numForestEdges;
+  long long weight;
+  Edge* result = getStreamingForest(forest, &numForestEdges, &weight);
+  free(result);
+
+  StreamStats stats = forest->stats;
+  int scratch = numVertices > chunkSize ? numVertices : chunkSize;
+  double megabytes =
+      (sizeof(Edge) * ((double)numVertices + chunkSize + scratch) +
+       sizeof(int) * (double)numVertices) / 1e6;
+  char name[32];
+  snprintf(name, sizeof(name), "chunk %d", chunkSize);
+  printf("%-22s %9.1f ms  %6.1f M edges/s  %5.2fx  %4d filters  "
+         "%7.1f MB%s\n", name, 1000 * stats.seconds,
+         stats.edgesPerSecond / 1e6, baseTime / stats.seconds,
+         stats.numFilters, megabytes,
+         weight == expected ? "" : "  (weight disagrees)");
+  deleteStreamingForest(forest);
+  return weight == expected && numForestEdges == numVertices - 1;
+}
+
+/* Returns the next value of the xorshift generator with state 'state'. */
+uint64_t nextRandom(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+/* Returns the current time in seconds on a monotonic clock. */
+double nowSeconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,146 @@
+/*
+ * Multi-source Dijkstra and graph Voronoi partitioning.
+ *
+ * All sources are seeded into one heap at distance 0; ownership travels
+ * with every relaxation, so a single run yields the nearest source of every
+ * vertex.
+ */
+
+#include <limits.h>
+
+#include "graph_voronoi.h"
+#include "minheap.h"
+
+#define NOTHING -1
+
+/*************************************************************************
+ ** Helper functions
+ *************************************************************************/
+
+/* Returns a newly created partition for 'numVertices' vertices in which no
+ * vertex is reached.
+ */
+static VoronoiPartition* newVoronoiPartition(int numVertices) {
+  VoronoiPartition* partition =
+      (VoronoiPartition*)malloc(sizeof(VoronoiPartition));
+  if (partition == NULL) {
+    printf("Error: Memory allocation failed for voronoi partition\n");
+    exit(1);
+  }
+
+  partition->numVertices = numVertices;
+  partition->numSources = 0;
+  partition->owners = (int*)malloc(sizeof(int) * numVertices);
+  partition->distances = (int*)malloc(sizeof(int) * numVertices);
+  partition->predecessors = (int*)malloc(sizeof(int) * numVertices);
+  partition->forest = (Edge*)malloc(sizeof(Edge) * (numVertices + 1));
+  if (partition->owners == NULL || partition->distances == NULL ||
+      partition->predecessors == NULL || partition->forest == NULL) {
+    printf("Error: Memory allocation failed for voronoi partition arrays\n");
+    exit(1);
+  }
+  partition->numForestEdges = 0;
+
+  for (int i = 0; i < numVertices; i++) {
+    partition->owners[i] = NOTHING;
+    partition->distances[i] = INT_MAX;
+    partition->predecessors[i] = NOTHING;
+  }
+
+  return partition;
+}
+
+/*************************************************************************
+ ** Partitioning
+ *************************************************************************/
+
+VoronoiPartition* getVoronoiPartition(Graph* graph, int* sources,
+                                      int numSources) {
+  if (graph == NULL || numSources < 0) return NULL;
+  for (int i = 0; i < numSources; i++) {
+    if (sources[i] < 0 || sources[i] >= graph->numVertices ||
+        graph->vertices[sources[i]] == NULL) {
+      return NULL;
+    }
+  }
+
+  int numVertices = graph->numVertices;
+  VoronoiPartition* partition = newVoronoiPartition(numVertices);
+  MinHeap* heap = newHeap(numVertices);
+
+  bool* finished = (bool*)malloc(sizeof(bool) * numVertices);
+  int* predWeights = (int*)malloc(sizeof(int) * numVertices);
+  if (finished == NULL || predWeights == NULL) {
+    printf("Error: Memory allocation failed for voronoi records\n");
+    exit(1);
+  }
+  for (int i = 0; i < numVertices; i++) finished[i] = false;
+
+  // seed every source at distance 0; each source owns itself
+  for (int i = 0; i < numSources; i++) {
+    int source = sources[i];
+    if (partition->owners[source] != NOTHING) continue;
+
+    partition->owners[source] = source;
+    partition->distances[source] = 0;
+    partition->numSources++;
+    insert(heap, 0, source);
+  }
+
+  while (heap->size > 0) {
+    HeapNode minNode = extractMin(heap);
+    int minVertex = minNode.id;
+    int currDis = minNode.priority;
+    int owner = partition->owners[minVertex];
+
+    finished[minVertex] = true;
+
+    int pred = partition->predecessors[minVertex];
+    if (pred != NOTHING) {
+      Edge* treeEdge = &partition->forest[partition->numForestEdges++];
+      treeEdge->fromVertex = pred;
+      treeEdge->toVertex = minVertex;
+      treeEdge->weight = predWeights[minVertex];
+    }
+
+    Vertex* vertex = graph->vertices[minVertex];
+    if (vertex == NULL) continue;
+
+    EdgeList* adjList = vertex->adjList;
+    while (adjList != NULL) {
+      Edge* edge = adjList->edge;
+      int toVertex = edge->toVertex;
+      int weight = edge->weight;
+
+      if (!finished[toVertex] && weight <= INT_MAX - 1 - currDis &&
+          currDis + weight < partition->distances[toVertex]) {
+        if (partition->distances[toVertex] == INT_MAX) {
+          insert(heap, currDis + weight, toVertex);
+        } else {
+          decreasePriority(heap, toVertex, currDis + weight);
+        }
+        partition->distances[toVertex] = currDis + weight;
+        partition->owners[toVertex] = owner;
+        partition->predecessors[toVertex] = minVertex;
+        predWeights[toVertex] = weight;
+      }
+      adjList = adjList->next;
+    }
+  }
+
+  free(finished);
+  free(predWeights);
+  deleteHeap(heap);
+
+  return partition;
+}
+
+void deleteVoronoiPartition(VoronoiPartition* partition) {
+  if (partition == NULL) return;
+
+  free(partition->owners);
+  free(partition->distances);
+  free(partition->predecessors);
+  free(partition->forest);
+  free(partition);
+}
@@ -0,0 +1,41 @@
+/*
+ * Header file for multi-source Dijkstra and graph Voronoi partitioning.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Graph_Voronoi_header
+#define __Graph_Voronoi_header
+
+typedef struct voronoi_partition {
+  int numVertices;     // total number of vertices in the graph
+  int numSources;      // number of distinct sources the search started from
+  int* owners;         // owners[id] is the ID of the source nearest to vertex
+                       //   id, or -1 if no source reaches id
+  int* distances;      // distances[id] is the distance from owners[id] to id,
+                       //   or INT_MAX if no source reaches id
+  int* predecessors;   // predecessors[id] is the predecessor of vertex id in
+                       //   the forest, or -1 for sources and unreached vertices
+  Edge* forest;        // edges of the shortest-path forest, in the order their
+                       //   "to" vertices were finished
+  int numForestEdges;  // number of edges in 'forest'
+} VoronoiPartition;
+
+/* Runs Dijkstra's algorithm on Graph 'graph' from all 'numSources' vertices
+ * in 'sources' at once, each at distance 0, and returns the resulting
+ * shortest-path forest: for every vertex, its nearest source, the distance
+ * to it, and its predecessor on a shortest path from that source. Ties are
+ * broken arbitrarily. Repeated sources are ignored.
+ * Returns NULL if any vertex in 'sources' is not valid in 'graph'.
+ */
+VoronoiPartition* getVoronoiPartition(Graph* graph, int* sources,
+                                      int numSources);
+
+/* Frees all memory allocated for 'partition'. */
+void deleteVoronoiPartition(VoronoiPartition* partition);
+
+#endif